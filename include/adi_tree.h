@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include "sparsepp.h"
+#include "index_image.h"
 
 struct adi_node_t;
 
@@ -34,4 +35,9 @@ public:
     void remove(uint32_t id);
 
     const adi_node_t* get_root();
+
+    void save(index_image_writer_t& writer) const;
+
+    // expects an empty tree
+    bool load(index_image_reader_t& reader);
 };
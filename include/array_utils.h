@@ -16,4 +16,15 @@ public:
 
   static size_t exclude_scalar(const uint32_t *src, const size_t lenSrc, const uint32_t *filter, const size_t lenFilter,
                               uint32_t **out);
-};
\ No newline at end of file
+
+  // Vectorized variants of the routines above: dispatches at runtime to AVX2 or SSE4.1 (sse2neon on ARM) kernels,
+  // gallops when one list is much smaller than the other, and falls back to the scalar versions otherwise.
+  // Return values and allocation semantics are identical to the scalar versions. `and_simd` and `exclude_simd`
+  // expect both inputs to be free of duplicates (i.e. ID sets), while `or_simd` de-duplicates just like `or_scalar`.
+  static size_t and_simd(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB, uint32_t **out);
+
+  static size_t or_simd(const uint32_t *A, const size_t lenA, const uint32_t *B, const size_t lenB, uint32_t **out);
+
+  static size_t exclude_simd(const uint32_t *src, const size_t lenSrc, const uint32_t *filter, const size_t lenFilter,
+                             uint32_t **out);
+};
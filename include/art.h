@@ -23,6 +23,9 @@ extern "C" {
 
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
+class art_arena_t;
+class filter_iterator_t;
+
 #if defined(__GNUC__) && !defined(__clang__)
 # if __STDC_VERSION__ >= 199901L && 402 == (__GNUC__ * 100 + __GNUC_MINOR__)
 /*
@@ -122,6 +125,12 @@ struct token_leaf {
 typedef struct {
     art_node *root;
     uint64_t size;
+
+    // bumped whenever a key is added or removed, so that the nodes held outside the tree can be validated
+    uint64_t generation;
+
+    // holds the nodes and leaves of the tree
+    art_arena_t *arena;
 } art_tree;
 
 /*
@@ -275,6 +284,25 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
                      const uint32_t *filter_ids, size_t filter_ids_length,
                      std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves = {});
 
+/**
+ * Collects the nodes whose leaves match a given string within a fuzzy distance of max_cost. The nodes stay valid
+ * for as long as the generation of the tree does not change.
+ */
+void art_fuzzy_nodes(art_tree *t, const unsigned char *term, const int term_len, const int min_cost, const int max_cost,
+                     const bool prefix, std::vector<const art_node *> &nodes);
+
+/**
+ * Same as `art_fuzzy_search()`, but picks the leaves from the nodes collected by `art_fuzzy_nodes()` for the same
+ * term, costs and prefix flag. When a lazy `filter_iterator` is given, it is used in place of `filter_ids`, so that
+ * only the leaves with a filtered ID count towards `max_words`.
+ */
+int art_fuzzy_search_nodes(art_tree *t, const std::vector<const art_node *> &nodes, const unsigned char *term,
+                           const int term_len, const int min_cost, const int max_words,
+                           const token_ordering token_order, const bool prefix,
+                           const uint32_t *filter_ids, size_t filter_ids_length,
+                           filter_iterator_t* filter_iterator,
+                           std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves = {});
+
 void encode_int32(int32_t n, unsigned char *chars);
 
 void encode_int64(int64_t n, unsigned char *chars);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+    Slab allocator for the nodes and leaves of an ART tree.
+
+    Chunks are carved out of slabs in size classes of 16 bytes, so that every node type gets a pool of its own and
+    leaves are pooled by the length of their key. Freed chunks are kept on a free list per size class and handed out
+    again by the next allocation of that class: churn then doesn't fragment the heap, and the nodes allocated
+    together (e.g. along an insertion path) stay close to each other in memory. Anything larger than
+    `max_pooled_size` falls back to malloc().
+
+    Slabs grow geometrically from a few chunks, so that the many small trees (e.g. of fields with few values) stay
+    small. The slabs are only released when the arena is destroyed.
+*/
+class art_arena_t {
+private:
+    static constexpr size_t CHUNK_ALIGN = 16;
+    static constexpr size_t MIN_SLAB_CHUNKS = 8;
+    static constexpr size_t MAX_SLAB_BYTES = 64 * 1024;
+
+    struct pool_t {
+        // freed chunks, each holding the pointer to the next one
+        void* free_chunks = nullptr;
+
+        char* next_chunk = nullptr;
+        size_t num_remaining = 0;
+        size_t slab_chunks = 0;
+    };
+
+    const size_t max_pooled_size;
+    std::vector<pool_t> pools;
+    std::vector<void*> slabs;
+
+    void add_slab(pool_t& pool, size_t chunk_size);
+
+public:
+    explicit art_arena_t(size_t max_pooled_size);
+
+    ~art_arena_t();
+
+    art_arena_t(const art_arena_t&) = delete;
+
+    art_arena_t& operator=(const art_arena_t&) = delete;
+
+    // returns uninitialized memory
+    void* allocate(size_t size);
+
+    // `size` must be the size the chunk was allocated with
+    void deallocate(void* chunk, size_t size);
+
+    [[nodiscard]] size_t num_slabs() const {
+        return slabs.size();
+    }
+};
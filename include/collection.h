@@ -8,6 +8,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <shared_mutex>
+#include <functional>
 #include <art.h>
 #include <index.h>
 #include <number.h>
@@ -20,6 +21,7 @@
 #include <tsl/htrie_map.h>
 #include "tokenizer.h"
 #include "synonym_index.h"
+#include "document_codec.h"
 
 struct doc_seq_id_t {
     uint32_t seq_id;
@@ -47,6 +49,9 @@ private:
 
     const size_t DEFAULT_TOPSTER_SIZE = 250;
 
+    // called after each slice of a batch is applied, with the exclusive lock released
+    std::function<void(size_t)> apply_slice_hook;
+
     struct highlight_t {
         size_t field_index;
         std::string field;
@@ -96,6 +101,9 @@ private:
 
     std::vector<char> token_separators;
 
+    // format in which documents are written to the store: documents in either format can always be read
+    document_format_t document_format;
+
     Index* index;
 
     SynonymIndex* synonym_index;
@@ -158,8 +166,14 @@ private:
     static Option<bool> parse_pinned_hits(const std::string& pinned_hits_str,
                                    std::map<size_t, std::vector<std::string>>& pinned_hits);
 
+    // parses the `lower-upper` ranges of a `field(0-10,10-50,50-)` facet, either bound of a range can be left out
+    static Option<bool> parse_facet_ranges(const std::string& ranges_str, const field& a_field,
+                                           std::vector<facet_range_t>& ranges);
+
     Index* init_index();
 
+    Index* create_index() const;
+
     static std::vector<char> to_char_array(const std::vector<std::string>& strs);
 
     Option<bool> validate_and_standardize_sort_fields(const std::vector<sort_by> & sort_fields,
@@ -167,6 +181,11 @@ private:
 
     Option<bool> persist_collection_meta();
 
+    // rewrites the stored documents that are not yet in the collection's document format
+    Option<bool> migrate_document_format();
+
+    std::string serialize_document(const nlohmann::json& document) const;
+
     Option<bool> batch_alter_data(const std::unordered_map<std::string, field>& schema_additions,
                                   const std::unordered_map<std::string, field>& new_dynamic_fields,
                                   const std::vector<field>& del_fields,
@@ -189,6 +208,10 @@ public:
 
     const size_t GROUP_LIMIT_MAX = 99;
 
+    // Number of preprocessed records that are applied to the index per hold of the exclusive lock, unless an import
+    // asks for another batch size. Searches in between see a batch partly applied.
+    static const size_t DEFAULT_APPLY_BATCH_SIZE = 40;
+
     // Using a $ prefix so that these meta keys stay above record entries in a lexicographically ordered KV store
     static constexpr const char* COLLECTION_META_PREFIX = "$CM";
     static constexpr const char* COLLECTION_NEXT_SEQ_PREFIX = "$CS";
@@ -206,6 +229,7 @@ public:
 
     static constexpr const char* COLLECTION_SYMBOLS_TO_INDEX = "symbols_to_index";
     static constexpr const char* COLLECTION_SEPARATORS = "token_separators";
+    static constexpr const char* COLLECTION_DOCUMENT_FORMAT = "document_format";
 
     // methods
 
@@ -215,7 +239,8 @@ public:
                const uint32_t next_seq_id, Store *store, const std::vector<field>& fields,
                const std::string& default_sorting_field,
                const float max_memory_ratio, const std::string& fallback_field_type,
-               const std::vector<std::string>& symbols_to_index, const std::vector<std::string>& token_separators);
+               const std::vector<std::string>& symbols_to_index, const std::vector<std::string>& token_separators,
+               const document_format_t document_format = document_format_t::JSON);
 
     ~Collection();
 
@@ -260,6 +285,12 @@ public:
 
     Option<bool> get_document_from_store(const uint32_t& seq_id, nlohmann::json & document) const;
 
+    // decodes only the given top-level fields, which avoids a full parse for binary encoded documents
+    Option<bool> get_document_from_store(const std::string & seq_id_key, nlohmann::json & document,
+                                         const spp::sparse_hash_set<std::string>& fields) const;
+
+    document_format_t get_document_format() const;
+
     Option<uint32_t> index_in_memory(nlohmann::json & document, uint32_t seq_id,
                                      const index_operation_t op, const DIRTY_VALUES& dirty_values);
 
@@ -271,9 +302,18 @@ public:
     bool facet_value_to_string(const facet &a_facet, const facet_count_t &facet_count, const nlohmann::json &document,
                                std::string &value) const;
 
+    // selects the `k` most frequent facet values in the order of `facet_count_compare`, without sorting all of them
+    static void select_top_facet_counts(const facet& a_facet, size_t k,
+                                        std::vector<std::pair<uint64_t, facet_count_t>>& top_facet_counts);
+
+    static void populate_range_facet(const facet& a_facet, nlohmann::json& facet_result);
+
+    static void populate_facet_stats(const facet& a_facet, size_t total_values, nlohmann::json& facet_result);
+
     static void populate_result_kvs(Topster *topster, std::vector<std::vector<KV *>> &result_kvs);
 
-    void batch_index(std::vector<index_record>& index_records, std::vector<std::string>& json_out, size_t &num_indexed, const bool& write_docs, const bool& write_id);
+    void batch_index(std::vector<index_record>& index_records, std::vector<std::string>& json_out, size_t &num_indexed, const bool& write_docs, const bool& write_id,
+                     size_t apply_batch_size);
 
     bool is_exceeding_memory_threshold() const;
 
@@ -286,7 +326,13 @@ public:
 
     nlohmann::json get_summary_json() const;
 
-    size_t batch_index_in_memory(std::vector<index_record>& index_records);
+    // Applies the records to the index `apply_batch_size` records at a time, releasing the exclusive lock in between:
+    // a search that runs meanwhile finds the records of the slices applied so far, but not the rest of the batch.
+    size_t batch_index_in_memory(std::vector<index_record>& index_records,
+                                 size_t apply_batch_size = DEFAULT_APPLY_BATCH_SIZE);
+
+    // `hook` is called with the number of records applied so far, after each slice of a batch
+    void _set_apply_slice_hook(const std::function<void(size_t)>& hook);
 
     Option<nlohmann::json> add(const std::string & json_str,
                                const index_operation_t& operation=CREATE, const std::string& id="",
@@ -295,7 +341,8 @@ public:
     nlohmann::json add_many(std::vector<std::string>& json_lines, nlohmann::json& document,
                             const index_operation_t& operation=CREATE, const std::string& id="",
                             const DIRTY_VALUES& dirty_values=DIRTY_VALUES::COERCE_OR_REJECT,
-                            const bool& write_docs=false, const bool& write_id=false);
+                            const bool& write_docs=false, const bool& write_id=false,
+                            size_t apply_batch_size=DEFAULT_APPLY_BATCH_SIZE);
 
     Option<nlohmann::json> search(const std::string & query, const std::vector<std::string> & search_fields,
                                   const std::string & simple_filter_query, const std::vector<std::string> & facet_fields,
@@ -334,7 +381,10 @@ public:
                                   const size_t max_extra_suffix = INT16_MAX,
                                   const size_t facet_query_num_typos = 2,
                                   const size_t filter_curated_hits_option = 2,
-                                  const bool prioritize_token_position = false) const;
+                                  const bool prioritize_token_position = false,
+                                  const bool max_score_pruning = false,
+                                  const size_t facet_sample_percent = 100,
+                                  const size_t facet_sample_threshold = 0) const;
 
     Option<bool> get_filter_ids(const std::string & simple_filter_query,
                                 std::vector<std::pair<size_t, uint32_t*>>& index_ids);
@@ -347,6 +397,18 @@ public:
 
     size_t get_num_documents() const;
 
+    uint64_t get_index_write_generation() const;
+
+    // Writes an image of the in-memory index, tagged with the store's sequence number at `write_generation` of the
+    // index. Fails with a 409 without writing anything when the index has been written to since.
+    Option<bool> save_index_image(const std::string& image_path, uint64_t store_seq_number,
+                                  uint64_t write_generation) const;
+
+    // Restores the in-memory index of a freshly loaded collection from an image. Fails without side effects when the
+    // image is missing, corrupt or was not written at `store_seq_number`: the index must then be rebuilt from the
+    // stored documents.
+    Option<bool> load_index_image(const std::string& image_path, uint64_t store_seq_number);
+
     DIRTY_VALUES parse_dirty_values_option(std::string& dirty_values) const;
 
     std::vector<char> get_symbols_to_index();
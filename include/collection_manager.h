@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <map>
 #include <sparsepp.h>
 #include "store.h"
 #include "field.h"
@@ -116,7 +117,11 @@ public:
     static Option<bool> load_collection(const nlohmann::json& collection_meta,
                                         const size_t batch_size,
                                         const StoreStatus& next_coll_id_status,
-                                        const std::atomic<bool>& quit);
+                                        const std::atomic<bool>& quit,
+                                        const std::string& index_image_dir = "",
+                                        const uint64_t store_seq_number = 0);
+
+    static std::string get_index_image_path(const std::string& index_image_dir, uint32_t collection_id);
 
     void add_to_collections(Collection* collection);
 
@@ -132,7 +137,24 @@ public:
     // only for tests!
     void init(Store *store, const float max_memory_ratio, const std::string & auth_key, std::atomic<bool>& exit);
 
-    Option<bool> load(const size_t collection_batch_size, const size_t document_batch_size);
+    // When `index_image_dir` is given, collections are restored from the index images found there (see
+    // `save_index_images()`), falling back to indexing the stored documents for an image that is missing or stale.
+    Option<bool> load(const size_t collection_batch_size, const size_t document_batch_size,
+                      const std::string& index_image_dir = "");
+
+    // Writes an image of every collection's in-memory index into `index_image_dir`. Writes must be paused, so that
+    // the images correspond to the current sequence number of the store.
+    Option<bool> save_index_images(const std::string& index_image_dir) const;
+
+    // Collection ID -> write generation of the collection's index. Captured along with the store's sequence number
+    // while writes are paused, so that the images can be written once writes have resumed.
+    std::map<uint32_t, uint64_t> get_index_write_generations() const;
+
+    // Writes the images of the collections in `write_generations` as of that point. A collection that has been
+    // written to or dropped since is skipped: it is indexed from the stored documents when the images are loaded.
+    // Only the writes to the collection whose image is being written wait for it.
+    Option<bool> save_index_images(const std::string& index_image_dir, uint64_t store_seq_number,
+                                   const std::map<uint32_t, uint64_t>& write_generations) const;
 
     // frees in-memory data structures when server is shutdown - helps us run a memory leak detector properly
     void dispose();
@@ -150,7 +172,8 @@ public:
                                           const uint64_t created_at = static_cast<uint64_t>(std::time(nullptr)),
                                           const std::string& fallback_field_type = "",
                                           const std::vector<std::string>& symbols_to_index = {},
-                                          const std::vector<std::string>& token_separators = {});
+                                          const std::vector<std::string>& token_separators = {},
+                                          const std::string& document_format = DocumentCodec::JSON_FORMAT);
 
     locked_resource_view_t<Collection> get_collection(const std::string & collection_name) const;
 
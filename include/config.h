@@ -51,6 +51,10 @@ private:
 
     uint32_t thread_pool_size;
 
+    uint32_t search_lane_concurrency;
+    uint32_t write_lane_concurrency;
+    uint32_t admin_lane_concurrency;
+
     bool enable_access_logging;
 
     int disk_used_max_percentage;
@@ -71,6 +75,9 @@ protected:
         this->num_collections_parallel_load = 0;  // will be set dynamically if not overridden
         this->num_documents_parallel_load = 1000;
         this->thread_pool_size = 0; // will be set dynamically if not overridden
+        this->search_lane_concurrency = 0;
+        this->write_lane_concurrency = 0; // will be set dynamically if not overridden
+        this->admin_lane_concurrency = 0;
         this->ssl_refresh_interval_seconds = 8 * 60 * 60;
         this->enable_access_logging = false;
         this->disk_used_max_percentage = 100;
@@ -247,6 +254,18 @@ public:
         return this->thread_pool_size;
     }
 
+    size_t get_search_lane_concurrency() const {
+        return this->search_lane_concurrency;
+    }
+
+    size_t get_write_lane_concurrency() const {
+        return this->write_lane_concurrency;
+    }
+
+    size_t get_admin_lane_concurrency() const {
+        return this->admin_lane_concurrency;
+    }
+
     size_t get_ssl_refresh_interval_seconds() const {
         return this->ssl_refresh_interval_seconds;
     }
@@ -358,6 +377,18 @@ public:
             this->thread_pool_size = std::stoi(get_env("TYPESENSE_THREAD_POOL_SIZE"));
         }
 
+        if(!get_env("TYPESENSE_SEARCH_LANE_CONCURRENCY").empty()) {
+            this->search_lane_concurrency = std::stoi(get_env("TYPESENSE_SEARCH_LANE_CONCURRENCY"));
+        }
+
+        if(!get_env("TYPESENSE_WRITE_LANE_CONCURRENCY").empty()) {
+            this->write_lane_concurrency = std::stoi(get_env("TYPESENSE_WRITE_LANE_CONCURRENCY"));
+        }
+
+        if(!get_env("TYPESENSE_ADMIN_LANE_CONCURRENCY").empty()) {
+            this->admin_lane_concurrency = std::stoi(get_env("TYPESENSE_ADMIN_LANE_CONCURRENCY"));
+        }
+
         if(!get_env("TYPESENSE_SSL_REFRESH_INTERVAL_SECONDS").empty()) {
             this->ssl_refresh_interval_seconds = std::stoi(get_env("TYPESENSE_SSL_REFRESH_INTERVAL_SECONDS"));
         }
@@ -501,6 +532,18 @@ public:
             this->thread_pool_size = (int) reader.GetInteger("server", "thread-pool-size", 0);
         }
 
+        if(reader.Exists("server", "search-lane-concurrency")) {
+            this->search_lane_concurrency = (int) reader.GetInteger("server", "search-lane-concurrency", 0);
+        }
+
+        if(reader.Exists("server", "write-lane-concurrency")) {
+            this->write_lane_concurrency = (int) reader.GetInteger("server", "write-lane-concurrency", 0);
+        }
+
+        if(reader.Exists("server", "admin-lane-concurrency")) {
+            this->admin_lane_concurrency = (int) reader.GetInteger("server", "admin-lane-concurrency", 0);
+        }
+
         if(reader.Exists("server", "ssl-refresh-interval-seconds")) {
             this->ssl_refresh_interval_seconds = (int) reader.GetInteger("server", "ssl-refresh-interval-seconds", 8 * 60 * 60);
         }
@@ -622,6 +665,18 @@ public:
             this->thread_pool_size = options.get<uint32_t>("thread-pool-size");
         }
 
+        if(options.exist("search-lane-concurrency")) {
+            this->search_lane_concurrency = options.get<uint32_t>("search-lane-concurrency");
+        }
+
+        if(options.exist("write-lane-concurrency")) {
+            this->write_lane_concurrency = options.get<uint32_t>("write-lane-concurrency");
+        }
+
+        if(options.exist("admin-lane-concurrency")) {
+            this->admin_lane_concurrency = options.get<uint32_t>("admin-lane-concurrency");
+        }
+
         if(options.exist("ssl-refresh-interval-seconds")) {
             this->ssl_refresh_interval_seconds = options.get<uint32_t>("ssl-refresh-interval-seconds");
         }
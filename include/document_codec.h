@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "json.hpp"
+#include "option.h"
+#include "sparsepp.h"
+
+enum class document_format_t {
+    JSON,
+    BINARY
+};
+
+/*
+    Encoding of the documents that are stored on disk.
+
+    The binary format is a header, followed by a table of fields sorted by name, followed by the field names and the
+    MessagePack encoded field values:
+
+    [marker: 1 byte][version: 1 byte][num_fields: uint32]
+    [name_offset: uint32][name_len: uint32][value_offset: uint32][value_len: uint32] x num_fields
+    [names and values]
+
+    Offsets are relative to the start of the names and values section, so a single field can be located through a
+    binary search over the table and decoded without touching the rest of the document. A JSON document always begins
+    with `{`, so both formats can be told apart by their first byte and documents written in either format can be read
+    back irrespective of the format the collection currently writes.
+*/
+class DocumentCodec {
+private:
+    struct entry_t {
+        uint32_t name_offset;
+        uint32_t name_len;
+        uint32_t value_offset;
+        uint32_t value_len;
+    };
+
+    static constexpr size_t HEADER_SIZE = 1 + 1 + sizeof(uint32_t);
+
+    static bool read_header(const std::string& serialized, uint32_t& num_fields);
+
+    static entry_t read_entry(const std::string& serialized, uint32_t index);
+
+    static bool is_valid_entry(const std::string& serialized, uint32_t num_fields, const entry_t& entry);
+
+    static Option<bool> decode_value(const std::string& serialized, uint32_t num_fields, const entry_t& entry,
+                                     nlohmann::json& value);
+
+public:
+    static constexpr char BINARY_MARKER = 0x00;
+    static constexpr uint8_t BINARY_VERSION = 1;
+
+    static constexpr const char* JSON_FORMAT = "json";
+    static constexpr const char* BINARY_FORMAT = "binary";
+
+    static Option<document_format_t> parse_format(const std::string& format_name);
+
+    static const char* format_name(document_format_t format);
+
+    static bool is_binary(const std::string& serialized);
+
+    static void encode(const nlohmann::json& document, document_format_t format, std::string& serialized);
+
+    // decodes a document stored in either format
+    static Option<bool> decode(const std::string& serialized, nlohmann::json& document);
+
+    // decodes only the given top-level fields of the document
+    static Option<bool> decode_fields(const std::string& serialized, const spp::sparse_hash_set<std::string>& fields,
+                                      nlohmann::json& document);
+
+    // returns false when the field is not present in the document
+    static Option<bool> decode_field(const std::string& serialized, const std::string& field_name,
+                                     nlohmann::json& value);
+
+    // re-encodes a stored document as JSON text
+    static Option<bool> to_json_string(const std::string& serialized, std::string& json_str);
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "sparsepp.h"
+#include "index_image.h"
+
+/*
+    Columnar store of the facet values of a field.
+
+    Distinct facet value hashes are dictionary encoded into dense `uint32_t` ordinals, so that the values of a
+    document are stored as ordinals in flat arrays indexed directly by `seq_id`:
+
+    - single-valued fields hold one ordinal per document (4 bytes per document)
+    - multi-valued fields hold an `(offset, length)` pair per document that points into a shared array of ordinals
+
+    Since ordinals are dense, facet counts of a result set can be accumulated in a flat array indexed by ordinal,
+    instead of a hash map keyed by the facet hash.
+
+    The values of an updated document are appended to the end of the shared array, and the array is compacted once
+    more than half of it is garbage. Ordinals are reference counted and recycled once no document refers to them.
+*/
+class facet_index_t {
+public:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+private:
+    const bool multi_valued;
+
+    // facet hash => ordinal
+    spp::sparse_hash_map<uint64_t, uint32_t> hash_ordinals;
+
+    // ordinal => facet hash, and the number of values that refer to the ordinal
+    std::vector<uint64_t> ordinal_hashes;
+    std::vector<uint32_t> ordinal_refs;
+    std::vector<uint32_t> free_ordinals;
+
+    // single-valued: seq_id => ordinal
+    std::vector<uint32_t> doc_ordinals;
+
+    // multi-valued: seq_id => (offset, length) of the document's ordinals in `values`
+    std::vector<uint32_t> doc_offsets;
+    std::vector<uint32_t> doc_lengths;
+    std::vector<uint32_t> values;
+    size_t num_garbage_values = 0;
+
+    size_t num_docs = 0;
+
+    uint32_t acquire_ordinal(uint64_t hash);
+
+    void release_ordinal(uint32_t ordinal);
+
+    void compact();
+
+public:
+    explicit facet_index_t(bool multi_valued): multi_valued(multi_valued) {
+
+    }
+
+    facet_index_t(const facet_index_t&) = delete;
+
+    facet_index_t& operator=(const facet_index_t&) = delete;
+
+    [[nodiscard]] bool is_multi_valued() const {
+        return multi_valued;
+    }
+
+    // replaces the existing values of `seq_id`; a single-valued field keeps only the first hash
+    void upsert(uint32_t seq_id, const uint64_t* hashes, uint32_t num_hashes);
+
+    void erase(uint32_t seq_id);
+
+    // returns the number of values of the document and points `ordinals` at them
+    inline uint32_t get_ordinals(uint32_t seq_id, const uint32_t*& ordinals) const {
+        if(!multi_valued) {
+            if(seq_id >= doc_ordinals.size() || doc_ordinals[seq_id] == EMPTY) {
+                return 0;
+            }
+
+            ordinals = &doc_ordinals[seq_id];
+            return 1;
+        }
+
+        if(seq_id >= doc_lengths.size() || doc_lengths[seq_id] == 0) {
+            return 0;
+        }
+
+        ordinals = &values[doc_offsets[seq_id]];
+        return doc_lengths[seq_id];
+    }
+
+    [[nodiscard]] inline uint64_t get_hash(uint32_t ordinal) const {
+        return ordinal_hashes[ordinal];
+    }
+
+    // upper bound of the ordinals in use, for sizing arrays indexed by ordinal
+    [[nodiscard]] inline uint32_t num_ordinals() const {
+        return ordinal_hashes.size();
+    }
+
+    [[nodiscard]] size_t num_distinct_values() const;
+
+    // number of documents that have at least one value
+    [[nodiscard]] size_t size() const;
+
+    void save(index_image_writer_t& writer) const;
+
+    // expects an empty index
+    bool load(index_image_reader_t& reader);
+};
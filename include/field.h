@@ -39,6 +39,9 @@ namespace fields {
     static const std::string index = "index";
     static const std::string sort = "sort";
     static const std::string infix = "infix";
+
+    // value of `infix` that keeps the infix index of the field sealed into a suffix array
+    static const std::string infix_fm = "fm";
     static const std::string locale = "locale";
 }
 
@@ -52,6 +55,9 @@ struct field {
     bool sort;
     bool infix;
 
+    // infix index is sealed into a suffix array, for mostly-static vocabularies
+    bool infix_fm = false;
+
     field() {}
 
     field(const std::string &name, const std::string &type, const bool facet, const bool optional = false,
@@ -67,6 +73,15 @@ struct field {
         this->infix = (infix != -1) ? bool(infix) : false;
     }
 
+    nlohmann::json infix_json() const {
+        return infix_fm ? nlohmann::json(fields::infix_fm) : nlohmann::json(infix);
+    }
+
+    // `infix` is either a boolean, or `fm` for a sealed infix index
+    static bool is_infix_fm(const nlohmann::json& infix_val) {
+        return infix_val.is_string() && infix_val.get<std::string>() == fields::infix_fm;
+    }
+
     bool is_auto() const {
         return (type == field_types::AUTO);
     }
@@ -248,7 +263,7 @@ struct field {
             field_val[fields::optional] = field.optional;
             field_val[fields::index] = field.index;
             field_val[fields::sort] = field.sort;
-            field_val[fields::infix] = field.infix;
+            field_val[fields::infix] = field.infix_json();
 
             field_val[fields::locale] = field.locale;
 
@@ -538,10 +553,22 @@ struct facet_stats_t {
             fvsum = 0;
 };
 
+struct facet_range_t {
+    std::string label;
+
+    // bounds are encoded like the values of the sort index: [lower, upper)
+    int64_t lower;
+    int64_t upper;
+};
+
 struct facet {
     const std::string field_name;
     spp::sparse_hash_map<uint64_t, facet_count_t> result_map;
 
+    // numeric range buckets and their counts, in the requested order
+    std::vector<facet_range_t> ranges;
+    std::vector<uint32_t> range_counts;
+
     // used for facet value query
     spp::sparse_hash_map<uint64_t, std::vector<std::string>> hash_tokens;
 
@@ -550,9 +577,17 @@ struct facet {
 
     facet_stats_t stats;
 
+    // counts were computed over a sample of the results and extrapolated
+    bool sampled = false;
+
     explicit facet(const std::string& field_name): field_name(field_name) {
 
     }
+
+    facet(const std::string& field_name, const std::vector<facet_range_t>& ranges):
+            field_name(field_name), ranges(ranges), range_counts(ranges.size(), 0) {
+
+    }
 };
 
 struct facet_info_t {
@@ -573,48 +608,3 @@ struct facet_value_t {
     std::string highlighted;
     uint32_t count;
 };
-
-struct facet_hash_values_t {
-    uint32_t length = 0;
-    uint64_t* hashes = nullptr;
-
-    facet_hash_values_t() {
-        length = 0;
-        hashes = nullptr;
-    }
-
-    facet_hash_values_t(facet_hash_values_t&& hash_values) noexcept {
-        length = hash_values.length;
-        hashes = hash_values.hashes;
-
-        hash_values.length = 0;
-        hash_values.hashes = nullptr;
-    }
-
-    facet_hash_values_t& operator=(facet_hash_values_t&& other) noexcept {
-        if (this != &other) {
-            delete[] hashes;
-
-            hashes = other.hashes;
-            length = other.length;
-
-            other.hashes = nullptr;
-            other.length = 0;
-        }
-
-        return *this;
-    }
-
-    ~facet_hash_values_t() {
-        delete [] hashes;
-        hashes = nullptr;
-    }
-
-    uint64_t size() const {
-        return length;
-    }
-
-    uint64_t back() const {
-        return hashes[length - 1];
-    }
-};
\ No newline at end of file
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "id_list.h"
+#include "posting_list.h"
+
+/*
+    Lazily evaluated filter expression over sorted document IDs.
+
+    Leaves walk the underlying ID lists in place, while AND / OR / NOT nodes combine their children through
+    `skip_to()`, so that a selective text query can leapfrog through a broad filter (e.g. `in_stock: true`)
+    without the filter ever being materialized into an array.
+*/
+class filter_iterator_t {
+public:
+    virtual ~filter_iterator_t() = default;
+
+    [[nodiscard]] virtual bool valid() const = 0;
+
+    // must only be called when the iterator is valid
+    [[nodiscard]] virtual uint32_t id() const = 0;
+
+    virtual void next() = 0;
+
+    // moves forward to the first ID that is >= `id` (never moves backwards)
+    virtual void skip_to(uint32_t id) = 0;
+
+    // rewinds the iterator to its first ID
+    virtual void reset() = 0;
+
+    // upper bound on the number of IDs the iterator will produce
+    [[nodiscard]] virtual size_t estimated_size() const = 0;
+
+    // allocates and fills `out` with the remaining IDs (nullptr when empty) and returns the number of IDs
+    size_t uncompress(uint32_t** out);
+};
+
+// Owns a sorted array of IDs that has already been computed
+class array_filter_iterator_t: public filter_iterator_t {
+private:
+    uint32_t* ids;
+    size_t ids_length;
+    size_t index = 0;
+
+public:
+    array_filter_iterator_t(uint32_t* ids, size_t ids_length);
+
+    ~array_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
+
+// Walks a compact or full ID list (see `ids_t`) without uncompressing it upfront
+class ids_filter_iterator_t: public filter_iterator_t {
+private:
+    const void* obj;
+
+    // used when `obj` is a compact list
+    const uint32_t* compact_ids = nullptr;
+    uint32_t compact_ids_length = 0;
+    uint32_t compact_index = 0;
+
+    // used when `obj` is a full list
+    id_list_t::iterator_t* it = nullptr;
+
+public:
+    explicit ids_filter_iterator_t(const void* obj);
+
+    ~ids_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
+
+// IDs of documents that contain all the tokens whose posting lists are given
+class posting_filter_iterator_t: public filter_iterator_t {
+private:
+    std::vector<posting_list_t*> plists;
+    std::vector<posting_list_t*> expanded_plists;
+    std::vector<posting_list_t::iterator_t> its;
+    bool is_valid = false;
+
+    void align();
+
+public:
+    explicit posting_filter_iterator_t(const std::vector<void*>& raw_posting_lists);
+
+    ~posting_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
+
+// Intersection of the children, which are owned by the node
+class and_filter_iterator_t: public filter_iterator_t {
+private:
+    std::vector<filter_iterator_t*> children;
+    bool is_valid = false;
+    uint32_t curr_id = 0;
+
+    void align();
+
+public:
+    explicit and_filter_iterator_t(const std::vector<filter_iterator_t*>& children);
+
+    ~and_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
+
+// Union of the children, which are owned by the node
+class or_filter_iterator_t: public filter_iterator_t {
+private:
+    std::vector<filter_iterator_t*> children;
+    bool is_valid = false;
+    uint32_t curr_id = 0;
+
+    void find_smallest();
+
+public:
+    explicit or_filter_iterator_t(const std::vector<filter_iterator_t*>& children);
+
+    ~or_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
+
+// IDs of `universe` that are not present in `child` (both owned by the node)
+class not_filter_iterator_t: public filter_iterator_t {
+private:
+    filter_iterator_t* universe;
+    filter_iterator_t* child;
+
+    void skip_excluded();
+
+public:
+    not_filter_iterator_t(filter_iterator_t* universe, filter_iterator_t* child);
+
+    ~not_filter_iterator_t() override;
+
+    [[nodiscard]] bool valid() const override;
+
+    [[nodiscard]] uint32_t id() const override;
+
+    void next() override;
+
+    void skip_to(uint32_t id) override;
+
+    void reset() override;
+
+    [[nodiscard]] size_t estimated_size() const override;
+};
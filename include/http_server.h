@@ -239,6 +239,8 @@ private:
 
     static bool is_write_request(const std::string& root_resource, const std::string& http_method);
 
+    static ThreadPool::lane_t get_request_lane(const std::string& root_resource, const std::string& http_method);
+
 public:
     HttpServer(const std::string & version,
                const std::string & listen_address, uint32_t listen_port,
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+    Roaring-style compressed bitmap of document IDs.
+
+    IDs are partitioned by their high 16 bits into containers. Sparse containers store the low 16 bits in a sorted
+    array, while dense containers (more than 4096 IDs) switch to a fixed 8 KB bitset, so that AND/OR/NOT run as
+    word-level operations and a collection-wide ID set costs at most ~1 bit per document.
+*/
+class id_bitmap_t {
+public:
+    static constexpr uint32_t ARRAY_CONTAINER_MAX = 4096;
+    static constexpr uint32_t BITSET_WORDS = 1024;
+
+private:
+    struct container_t {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+
+        // sorted low 16 bits, used while cardinality <= ARRAY_CONTAINER_MAX
+        std::vector<uint16_t> array;
+
+        // BITSET_WORDS words once the container becomes dense
+        std::vector<uint64_t> bitset;
+
+        [[nodiscard]] bool is_bitset() const {
+            return !bitset.empty();
+        }
+
+        [[nodiscard]] bool contains(uint16_t low) const;
+
+        void add(uint16_t low);
+
+        void add_many(const uint16_t* lows, size_t len);
+
+        void to_bitset();
+
+        void to_array();
+
+        // picks the cheaper representation for the current cardinality
+        void normalize();
+
+        void and_with(const container_t& other);
+
+        void or_with(const container_t& other);
+
+        void andnot_with(const container_t& other);
+    };
+
+    // ordered by key
+    std::vector<container_t> containers;
+
+    container_t& get_or_create(uint16_t key);
+
+    [[nodiscard]] const container_t* find(uint16_t key) const;
+
+public:
+
+    void add(uint32_t id);
+
+    // `ids` must be sorted
+    void add_many(const uint32_t* ids, size_t len);
+
+    [[nodiscard]] bool contains(uint32_t id) const;
+
+    [[nodiscard]] size_t cardinality() const;
+
+    [[nodiscard]] bool empty() const;
+
+    void clear();
+
+    void and_with(const id_bitmap_t& other);
+
+    void or_with(const id_bitmap_t& other);
+
+    // removes IDs present in `other`
+    void andnot_with(const id_bitmap_t& other);
+
+    // allocates and fills `out` with the sorted IDs (nullptr when empty) and returns the number of IDs
+    size_t uncompress(uint32_t** out) const;
+
+    template<class T>
+    void for_each(T func) const;
+};
+
+template<class T>
+void id_bitmap_t::for_each(T func) const {
+    for(const auto& container: containers) {
+        const uint32_t high = uint32_t(container.key) << 16;
+
+        if(container.is_bitset()) {
+            for(uint32_t w = 0; w < BITSET_WORDS; w++) {
+                uint64_t word = container.bitset[w];
+                while(word != 0) {
+                    const uint32_t low = (w << 6) + __builtin_ctzll(word);
+                    func(high | low);
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for(const uint16_t low: container.array) {
+                func(high | low);
+            }
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include <map>
 #include <unordered_map>
 #include "sorted_array.h"
+#include "id_bitmap.h"
 
 typedef uint32_t last_id_t;
 
@@ -144,6 +145,8 @@ public:
     );
 
     uint32_t* uncompress();
+
+    void uncompress(id_bitmap_t& bitmap);
 };
 
 template<class T>
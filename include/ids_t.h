@@ -102,6 +102,8 @@ public:
     static void intersect(const std::vector<void*>& id_lists, std::vector<uint32_t>& result_ids);
 
     static uint32_t* uncompress(void*& obj);
+
+    static void uncompress(void*& obj, id_bitmap_t& bitmap);
 };
 
 template<class T>
@@ -133,7 +135,6 @@ bool ids_t::block_intersector_t::intersect(T func, size_t concurrency) {
 
     size_t num_processed = 0;
     std::mutex m_process;
-    std::condition_variable cv_process;
     size_t num_non_empty = 0;
 
     for(size_t i = 0; i < partial_its_vec.size(); i++) {
@@ -145,18 +146,19 @@ bool ids_t::block_intersector_t::intersect(T func, size_t concurrency) {
 
         num_non_empty++;
 
-        thread_pool->enqueue([this, i, &func, &partial_its, &num_processed, &m_process, &cv_process]() {
+        thread_pool->fork([this, i, &func, &partial_its, &num_processed, &m_process]() {
             auto iter_state_copy = iter_state;
             iter_state_copy.index = i;
             id_list_t::block_intersect<T>(partial_its, iter_state_copy, func);
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
-            cv_process.notify_one();
         });
     }
 
-    std::unique_lock<std::mutex> lock_process(m_process);
-    cv_process.wait(lock_process, [&](){ return num_processed == num_non_empty; });
+    thread_pool->wait_until([&]() {
+        std::unique_lock<std::mutex> lock_process(m_process);
+        return num_processed == num_non_empty;
+    });
 
     return true;
 }
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <shared_mutex>
 #include <condition_variable>
 #include <art.h>
@@ -20,19 +21,20 @@
 #include "magic_enum.hpp"
 #include "match_score.h"
 #include "posting_list.h"
+#include "or_iterator.h"
 #include "threadpool.h"
 #include "adi_tree.h"
 #include "tsl/htrie_set.h"
 #include <tsl/htrie_map.h>
 #include "id_list.h"
+#include "id_bitmap.h"
+#include "sort_column.h"
+#include "filter_iterator.h"
 #include "synonym_index.h"
-
-static constexpr size_t ARRAY_FACET_DIM = 4;
-using facet_map_t = spp::sparse_hash_map<uint32_t, facet_hash_values_t>;
-using array_mapped_facet_t = std::array<facet_map_t*, ARRAY_FACET_DIM>;
-
-static constexpr size_t ARRAY_INFIX_DIM = 4;
-using array_mapped_infix_t = std::vector<tsl::htrie_set<char>*>;
+#include "index_image.h"
+#include "facet_index.h"
+#include "infix_index.h"
+#include "lru/lru.hpp"
 
 struct token_t {
     size_t position;
@@ -332,7 +334,12 @@ struct search_args {
     std::string default_sorting_field;
     bool prioritize_exact_match;
     bool prioritize_token_position;
+    bool max_score_pruning;
     size_t all_result_ids_len;
+
+    // estimated number of matches that `max_score_pruning` skipped without collecting their IDs
+    size_t num_pruned_ids;
+
     bool exhaustive_search;
     size_t concurrency;
     size_t search_cutoff_ms;
@@ -345,6 +352,8 @@ struct search_args {
     const size_t facet_query_num_typos;
     const bool filter_curated_hits;
     const enable_t split_join_tokens;
+    const size_t facet_sample_percent;
+    const size_t facet_sample_threshold;
     tsl::htrie_map<char, token_leaf> qtoken_set;
 
     spp::sparse_hash_set<uint64_t> groups_processed;
@@ -362,11 +371,12 @@ struct search_args {
                 const std::vector<bool>& prefixes, size_t drop_tokens_threshold, size_t typo_tokens_threshold,
                 const std::vector<std::string>& group_by_fields, size_t group_limit,
                 const string& default_sorting_field, bool prioritize_exact_match,
-                const bool prioritize_token_position, bool exhaustive_search,
+                const bool prioritize_token_position, const bool max_score_pruning, bool exhaustive_search,
                 size_t concurrency, size_t search_cutoff_ms,
                 size_t min_len_1typo, size_t min_len_2typo, size_t max_candidates, const std::vector<enable_t>& infixes,
                 const size_t max_extra_prefix, const size_t max_extra_suffix, const size_t facet_query_num_typos,
-                const bool filter_curated_hits, const enable_t split_join_tokens) :
+                const bool filter_curated_hits, const enable_t split_join_tokens,
+                const size_t facet_sample_percent, const size_t facet_sample_threshold) :
             field_query_tokens(field_query_tokens),
             search_fields(search_fields), filters(filters), facets(facets),
             included_ids(included_ids), excluded_ids(excluded_ids), sort_fields_std(sort_fields_std),
@@ -375,12 +385,13 @@ struct search_args {
             drop_tokens_threshold(drop_tokens_threshold), typo_tokens_threshold(typo_tokens_threshold),
             group_by_fields(group_by_fields), group_limit(group_limit), default_sorting_field(default_sorting_field),
             prioritize_exact_match(prioritize_exact_match), prioritize_token_position(prioritize_token_position),
-            all_result_ids_len(0), exhaustive_search(exhaustive_search), concurrency(concurrency),
-            search_cutoff_ms(search_cutoff_ms),
+            max_score_pruning(max_score_pruning), all_result_ids_len(0), num_pruned_ids(0),
+            exhaustive_search(exhaustive_search), concurrency(concurrency), search_cutoff_ms(search_cutoff_ms),
             min_len_1typo(min_len_1typo), min_len_2typo(min_len_2typo), max_candidates(max_candidates),
             infixes(infixes), max_extra_prefix(max_extra_prefix), max_extra_suffix(max_extra_suffix),
             facet_query_num_typos(facet_query_num_typos), filter_curated_hits(filter_curated_hits),
-            split_join_tokens(split_join_tokens) {
+            split_join_tokens(split_join_tokens), facet_sample_percent(facet_sample_percent),
+            facet_sample_threshold(facet_sample_threshold) {
 
         const size_t topster_size = std::max((size_t)1, max_hits);  // needs to be atleast 1 since scoring is mandatory
         topster = new Topster(topster_size, group_limit);
@@ -481,16 +492,49 @@ private:
     spp::sparse_hash_map<std::string, spp::sparse_hash_map<uint32_t, int64_t*>*> geo_array_index;
 
     // facet_field => (seq_id => values)
-    spp::sparse_hash_map<std::string, array_mapped_facet_t> facet_index_v3;
+    spp::sparse_hash_map<std::string, facet_index_t*> facet_index_v3;
 
     // sort_field => (seq_id => value)
-    spp::sparse_hash_map<std::string, spp::sparse_hash_map<uint32_t, int64_t>*> sort_index;
+    spp::sparse_hash_map<std::string, sort_column_t*> sort_index;
 
     // str_sort_field => adi_tree_t
     spp::sparse_hash_map<std::string, adi_tree_t*> str_sort_index;
 
     // infix field => value
-    spp::sparse_hash_map<std::string, array_mapped_infix_t> infix_index;
+    spp::sparse_hash_map<std::string, infix_index_t*> infix_index;
+
+    struct cached_facet_t {
+        // the full key, since entries are looked up by its hash
+        std::string key;
+
+        // sum of the generations of the fields the counts depend on, at the time they were computed
+        uint64_t generation;
+
+        spp::sparse_hash_map<uint64_t, facet_count_t> result_map;
+        std::vector<uint32_t> range_counts;
+        facet_stats_t stats;
+    };
+
+    // facet counts of wildcard searches, keyed on the hash of the filters and the facet field
+    mutable std::mutex m_facet_cache;
+    mutable LRU::Cache<uint64_t, cached_facet_t> facet_cache;
+
+    // field => number of writes to the field, guarded by `m_facet_cache`: cached counts are stale once the generation
+    // of the facet field, or of a field they are filtered on, has moved on
+    spp::sparse_hash_map<std::string, uint64_t> facet_field_generations;
+
+    // bumped on every write, so that an image can tell whether the index has changed since a point in time
+    std::atomic<uint64_t> write_generation{0};
+
+    struct cached_expansion_t {
+        uint64_t generation;
+        std::vector<const art_node*> nodes;
+    };
+
+    // field => fuzzy expansions of query tokens, keyed on the token, the cost and the prefix flag, and valid for as
+    // long as the generation of the field's tree does not change
+    mutable std::mutex m_expansion_cache;
+    mutable spp::sparse_hash_map<std::string, LRU::Cache<std::string, cached_expansion_t>*> expansion_cache;
 
     // this is used for wildcard queries
     id_list_t* seq_ids;
@@ -503,10 +547,10 @@ private:
 
     // used as sentinels
 
-    static spp::sparse_hash_map<uint32_t, int64_t> text_match_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> seq_id_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> geo_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t> str_sentinel_value;
+    static sort_column_t text_match_sentinel_value;
+    static sort_column_t seq_id_sentinel_value;
+    static sort_column_t geo_sentinel_value;
+    static sort_column_t str_sentinel_value;
 
     // Internal utility functions
 
@@ -525,11 +569,51 @@ private:
 
     void log_leaves(int cost, const std::string &token, const std::vector<art_leaf *> &leaves) const;
 
+    void do_flat_facet_counts(facet& a_facet, const facet_index_t* field_facet_index, const field& facet_field,
+                              bool should_compute_stats, const uint32_t* result_ids, size_t results_size) const;
+
     void do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                    const std::vector<facet_info_t>& facet_infos,
                    size_t group_limit, const std::vector<std::string>& group_by_fields,
                    const uint32_t* result_ids, size_t results_size) const;
 
+    // counts the results falling into each range of a numeric range facet, from the field's sort column
+    void do_range_facet(facet& a_facet, const uint32_t* result_ids, size_t results_size) const;
+
+    void do_facet(facet& a_facet, const facet_info_t& facet_info,
+                  size_t group_limit, const std::vector<std::string>& group_by_fields,
+                  const uint32_t* result_ids, size_t results_size) const;
+
+    // sum of the generations of the facet field and of the filtered fields
+    uint64_t get_facet_cache_generation(const std::vector<filter>& filters, const facet& a_facet) const;
+
+    bool get_cached_facet(const std::string& cache_key, uint64_t generation, facet& a_facet) const;
+
+    // the counts are not cached if any of the fields they depend on was written to after `generation` was read
+    void cache_facet(const std::string& cache_key, uint64_t generation, const std::vector<filter>& filters,
+                     const facet& a_facet) const;
+
+    // makes the cached counts that depend on the field stale
+    void invalidate_facet_cache(const std::string& field_name);
+
+    // finds the leaves of the field's tree within `cost` typos of the token, reusing the cached expansion of the token
+    void fuzzy_search_field(const std::string& field_name, const std::string& token, int cost, bool prefix_search,
+                            size_t max_words, token_ordering token_order,
+                            const uint32_t* filter_ids, size_t filter_ids_length, filter_iterator_t* filter_iterator,
+                            std::vector<art_leaf*>& leaves, const std::set<std::string>& exclude_leaves) const;
+
+    void clear_expansion_cache(const std::string& field_name);
+
+    // merges the partial counts of `this_facet` into `acc_facet`
+    static void merge_facet(facet& acc_facet, facet& this_facet, size_t group_limit);
+
+    // deterministically samples roughly `sample_percent` of the results
+    static void sample_result_ids(const uint32_t* result_ids, size_t results_size, size_t sample_percent,
+                                  std::vector<uint32_t>& sampled_ids);
+
+    // scales up the counts of a facet computed over a sample of the results
+    static void extrapolate_facet(facet& a_facet, double scale);
+
     bool static_filter_query_eval(const override_t* override, std::vector<std::string>& tokens,
                                   std::vector<filter>& filters) const;
 
@@ -584,7 +668,7 @@ private:
                                tsl::htrie_map<char, token_leaf>& qtoken_set,
                                Topster* topster,
                                spp::sparse_hash_set<uint64_t>& groups_processed,
-                               uint32_t*& all_result_ids, size_t& all_result_ids_len,
+                               uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
                                const size_t typo_tokens_threshold,
                                const size_t group_limit,
                                const std::vector<std::string>& group_by_fields,
@@ -593,14 +677,18 @@ private:
                                const std::vector<bool>& prefixes,
                                bool prioritize_exact_match,
                                const bool prioritize_token_position,
+                               const bool max_score_pruning,
+                               const bool skip_pruned_blocks,
                                const bool exhaustive_search,
+                               const size_t concurrency,
                                const size_t max_candidates,
                                int syn_orig_num_tokens,
                                const int* sort_order,
-                               std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                               std::array<sort_column_t*, 3>& field_values,
                                const std::vector<size_t>& geopoint_indices,
                                std::set<uint64>& query_hashes,
-                               std::vector<uint32_t>& id_buff) const;
+                               std::vector<uint32_t>& id_buff,
+                               filter_iterator_t* filter_iterator = nullptr) const;
 
     void search_candidates(const uint8_t & field_id,
                            bool field_is_array,
@@ -626,6 +714,9 @@ private:
     void do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length, const std::vector<filter>& filters,
                       const bool enable_short_circuit) const;
 
+    // Returns a lazily evaluated equivalent of `do_filtering` that must be deleted by the caller
+    filter_iterator_t* build_filter_iterator(const std::vector<filter>& filters) const;
+
     void insert_doc(const int64_t score, art_tree *t, uint32_t seq_id,
                     const std::unordered_map<std::string, std::vector<uint32_t>> &token_to_offsets) const;
 
@@ -697,6 +788,33 @@ public:
     // in the query that have the least individual hits one by one until enough results are found.
     static const int DROP_TOKENS_THRESHOLD = 1;
 
+    // Filters smaller than this are materialized upfront, while larger ones are intersected lazily with text matches
+    static const size_t LAZY_FILTER_MIN_IDS = 10000;
+
+    // A numerical clause matching more distinct values than this is materialized instead of being OR-ed lazily
+    static const size_t LAZY_FILTER_MAX_ID_LISTS = 8;
+
+    // Wildcard queries matching fewer documents than this are always scored exhaustively
+    static const size_t SORTED_WILDCARD_MIN_IDS = 10000;
+
+    // Text matches are intersected and scored in parallel only when every token spans at least these many blocks
+    static const size_t TEXT_MATCH_PARALLEL_MIN_BLOCKS = 64;
+
+    // Facets are counted in a flat array indexed by ordinal, unless the field has this many times more distinct
+    // values than the results hold, in which case clearing and scanning the array would outweigh hashing
+    static const size_t FLAT_FACET_COUNT_MAX_ORDINALS_PER_VALUE = 16;
+
+    // Facets of a result set are counted in parallel windows of at least these many results
+    static const size_t FACET_PARALLEL_MIN_IDS = 1000;
+
+    // Number of facet counts of wildcard searches that are cached, and the maximum number of values of a cached facet
+    static const size_t FACET_CACHE_SIZE = 256;
+    static const size_t FACET_CACHE_MAX_VALUES = 10000;
+
+    // Number of fuzzy token expansions that are cached per field, and the maximum number of nodes of a cached expansion
+    static const size_t EXPANSION_CACHE_SIZE = 1024;
+    static const size_t EXPANSION_CACHE_MAX_NODES = 4096;
+
     Index() = delete;
 
     Index(const std::string& name,
@@ -712,6 +830,10 @@ public:
 
     static void concat_topster_ids(Topster* topster, spp::sparse_hash_map<uint64_t, std::vector<KV*>>& topster_ids);
 
+    // Key of the cached counts of `a_facet` under `filters`. Neither the order of the filters nor the order of the
+    // values within a filter changes the key, but the bounds of a range are kept in order.
+    static std::string get_facet_cache_key(const std::vector<filter>& filters, const facet& a_facet);
+
     int64_t score_results2(const std::vector<sort_by> & sort_fields, const uint16_t & query_index,
                            const size_t field_id, const bool field_is_array, const uint32_t total_cost,
                            int64_t& match_score,
@@ -728,7 +850,7 @@ public:
                        Topster *topster, const std::vector<art_leaf *> &query_suggestion,
                        spp::sparse_hash_set<uint64_t> &groups_processed,
                        const uint32_t seq_id, const int sort_order[3],
-                       std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                       std::array<sort_column_t*, 3> field_values,
                        const std::vector<size_t>& geopoint_indices,
                        const size_t group_limit,
                        const std::vector<std::string> &group_by_fields, uint32_t token_bits,
@@ -743,13 +865,15 @@ public:
 
     const spp::sparse_hash_map<std::string, num_tree_t*>& _get_numerical_index() const;
 
-    const spp::sparse_hash_map<std::string, array_mapped_infix_t>& _get_infix_index() const;
+    const spp::sparse_hash_map<std::string, infix_index_t*>& _get_infix_index() const;
 
     static int get_bounded_typo_cost(const size_t max_cost, const size_t token_len,
                                      size_t min_len_1typo, size_t min_len_2typo);
 
     static int64_t float_to_in64_t(float n);
 
+    static float int64_t_to_float(int64_t n);
+
     uint64_t get_distinct_id(const std::vector<std::string>& group_by_fields, const uint32_t seq_id) const;
 
     static void compute_token_offsets_facets(index_record& record,
@@ -777,7 +901,7 @@ public:
                 const std::vector<uint32_t>& num_typos, Topster* topster, Topster* curated_topster,
                 const size_t per_page,
                 const size_t page, const token_ordering token_order, const std::vector<bool>& prefixes,
-                const size_t drop_tokens_threshold, size_t& all_result_ids_len,
+                const size_t drop_tokens_threshold, size_t& all_result_ids_len, size_t& num_pruned_ids,
                 spp::sparse_hash_set<uint64_t>& groups_processed,
                 std::vector<std::vector<art_leaf*>>& searched_queries,
                 tsl::htrie_map<char, token_leaf>& qtoken_set,
@@ -785,11 +909,12 @@ public:
                 const size_t typo_tokens_threshold, const size_t group_limit,
                 const std::vector<std::string>& group_by_fields,
                 const string& default_sorting_field, bool prioritize_exact_match,
-                const bool prioritize_token_position, bool exhaustive_search,
+                const bool prioritize_token_position, const bool max_score_pruning, bool exhaustive_search,
                 size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                 size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                 const size_t max_extra_suffix, const size_t facet_query_num_typos,
-                const bool filter_curated_hits, enable_t split_join_tokens) const;
+                const bool filter_curated_hits, enable_t split_join_tokens,
+                const size_t facet_sample_percent, const size_t facet_sample_threshold) const;
 
     void remove_field(uint32_t seq_id, const nlohmann::json& document, const std::string& field_name);
 
@@ -805,6 +930,27 @@ public:
                                           const std::vector<char>& symbols_to_index,
                                           const bool do_validation);
 
+    // Indexing a batch happens in two phases: `batch_preprocess()` validates and tokenizes the records without
+    // modifying the index, so it only needs a shared lock and can run alongside searches, while
+    // `batch_apply_preprocessed()` writes the results into the index and needs exclusive access.
+    //
+    // This is only a first step towards writes that don't block searches: the apply phase still holds the exclusive
+    // lock for all of its work. Applying into a small mutable head segment instead, while searches read from
+    // immutable sealed segments that a background merger folds the head into, is not built yet.
+
+    static void batch_preprocess(Index *index,
+                                 std::vector<index_record>& iter_batch,
+                                 const std::string& default_sorting_field,
+                                 const std::unordered_map<std::string, field>& search_schema,
+                                 const std::string& fallback_field_type,
+                                 const std::vector<char>& token_separators,
+                                 const std::vector<char>& symbols_to_index,
+                                 const bool do_validation);
+
+    static size_t batch_apply_preprocessed(Index *index,
+                                           std::vector<index_record>& iter_batch,
+                                           const std::unordered_map<std::string, field>& search_schema);
+
     static size_t batch_memory_index(Index *index,
                                      std::vector<index_record>& iter_batch,
                                      const std::string& default_sorting_field,
@@ -852,9 +998,16 @@ public:
                          uint32_t*& all_result_ids, size_t& all_result_ids_len, const uint32_t* filter_ids,
                          uint32_t filter_ids_length, const size_t concurrency,
                          const int* sort_order,
-                         std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                         std::array<sort_column_t*, 3>& field_values,
                          const std::vector<size_t>& geopoint_indices) const;
 
+    bool get_sorted_wildcard_ids(const std::vector<sort_by>& sort_fields, size_t group_limit, size_t top_k,
+                                 const uint32_t* filter_ids, uint32_t filter_ids_length,
+                                 std::vector<uint32_t>& top_ids) const;
+
+    // rebuilds the suffix array of a sealed infix index in the background, once its delta has grown large enough
+    void schedule_infix_rebuild(infix_index_t* field_infix_index) const;
+
     void search_infix(const std::string& query, const std::string& field_name, std::vector<uint32_t>& ids,
                       size_t max_extra_prefix, size_t max_extra_suffix) const;
 
@@ -864,7 +1017,7 @@ public:
 
     void populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                const std::vector<sort_by>& sort_fields_std,
-                               std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values) const;
+                               std::array<sort_column_t*, 3>& field_values) const;
 
     static void remove_matched_tokens(std::vector<std::string>& tokens, const std::set<std::string>& rule_token_set) ;
 
@@ -880,6 +1033,17 @@ public:
 
     size_t num_seq_ids() const;
 
+    [[nodiscard]] uint64_t get_write_generation() const {
+        return write_generation;
+    }
+
+    // Writes all the in-memory structures of the index into an image that `load_image()` can restore from.
+    void save_image(index_image_writer_t& writer) const;
+
+    // Restores an image written by `save_image()` into this freshly created index. On an error (e.g. the image was
+    // written for a different schema) the index is left partially populated and must be discarded.
+    Option<bool> load_image(index_image_reader_t& reader);
+
     void handle_exclusion(const size_t num_search_fields, std::vector<query_tokens_t>& field_query_tokens,
                           const std::vector<search_field_t>& search_fields, uint32_t*& exclude_token_ids,
                           size_t& exclude_token_ids_size) const;
@@ -892,7 +1056,7 @@ public:
                          const size_t max_extra_suffix, const std::vector<token_t>& query_tokens, Topster* actual_topster,
                          const uint32_t *filter_ids, size_t filter_ids_length,
                          const int sort_order[3],
-                         std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                         std::array<sort_column_t*, 3> field_values,
                          const std::vector<size_t>& geopoint_indices,
                          const std::vector<uint32_t>& curated_ids_sorted,
                          uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -906,6 +1070,8 @@ public:
                            const size_t typo_tokens_threshold, const size_t group_limit,
                            const std::vector<std::string>& group_by_fields, bool prioritize_exact_match,
                            const bool prioritize_token_position,
+                           const bool max_score_pruning,
+                           const bool skip_pruned_blocks,
                            const bool exhaustive_search, const size_t concurrency,
                            const std::vector<bool>& prefixes,
                            size_t min_len_1typo,
@@ -917,13 +1083,14 @@ public:
                            int syn_orig_num_tokens,
                            spp::sparse_hash_set<uint64_t>& groups_processed,
                            std::vector<std::vector<art_leaf*>>& searched_queries,
-                           uint32_t*& all_result_ids, size_t& all_result_ids_len,
+                           uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
                            const uint32_t* filter_ids, uint32_t filter_ids_length, 
                            std::set<uint64>& query_hashes,
                            const int* sort_order,
-                           std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                           std::array<sort_column_t*, 3>& field_values,
                            const std::vector<size_t>& geopoint_indices,
-                           tsl::htrie_map<char, token_leaf>& qtoken_set) const;
+                           tsl::htrie_map<char, token_leaf>& qtoken_set,
+                           filter_iterator_t* filter_iterator = nullptr) const;
 
     void do_phrase_search(const size_t num_search_fields, const std::vector<search_field_t>& search_fields,
                           std::vector<query_tokens_t>& field_query_tokens,
@@ -940,22 +1107,26 @@ public:
                              std::vector<std::vector<art_leaf*>>& searched_queries,
                              tsl::htrie_map<char, token_leaf>& qtoken_set,
                              Topster* topster, spp::sparse_hash_set<uint64_t>& groups_processed,
-                             uint32_t*& all_result_ids, size_t& all_result_ids_len,
+                             uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
                              const size_t group_limit, const std::vector<std::string>& group_by_fields,
                              bool prioritize_exact_match,
                              const bool prioritize_token_position,
+                             const bool max_score_pruning,
+                             const bool skip_pruned_blocks,
                              std::set<uint64>& query_hashes,
                              const token_ordering token_order,
                              const std::vector<bool>& prefixes,
                              const size_t typo_tokens_threshold,
                              const bool exhaustive_search,
+                             const size_t concurrency,
                              const size_t max_candidates,
                              size_t min_len_1typo,
                              size_t min_len_2typo,
                              int syn_orig_num_tokens,
                              const int* sort_order,
-                             std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
-                             const std::vector<size_t>& geopoint_indices) const;
+                             std::array<sort_column_t*, 3>& field_values,
+                             const std::vector<size_t>& geopoint_indices,
+                             filter_iterator_t* filter_iterator = nullptr) const;
 
     void find_across_fields(const std::vector<token_t>& query_tokens,
                               const size_t num_query_tokens,
@@ -966,7 +1137,8 @@ public:
                               const uint32_t* filter_ids, uint32_t filter_ids_length,
                               const uint32_t* exclude_token_ids,
                               size_t exclude_token_ids_size,
-                              std::vector<uint32_t>& id_buff) const;
+                              std::vector<uint32_t>& id_buff,
+                              filter_iterator_t* filter_iterator = nullptr) const;
 
     void search_across_fields(const std::vector<token_t>& query_tokens,
                               const std::vector<uint32_t>& num_typos,
@@ -982,17 +1154,21 @@ public:
                               const std::vector<std::string>& group_by_fields,
                               bool prioritize_exact_match,
                               const bool search_all_candidates,
+                              const bool max_score_pruning,
+                              const bool skip_pruned_blocks,
+                              const size_t concurrency,
                               const uint32_t* filter_ids, uint32_t filter_ids_length,
                               const uint32_t total_cost,
                               const int syn_orig_num_tokens,
                               const uint32_t* exclude_token_ids,
                               size_t exclude_token_ids_size,
                               const int* sort_order,
-                              std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                              std::array<sort_column_t*, 3>& field_values,
                               const std::vector<size_t>& geopoint_indices,
                               std::vector<uint32_t>& id_buff,
                               uint32_t*& all_result_ids,
-                              size_t& all_result_ids_len) const;
+                              size_t& all_result_ids_len, size_t& num_pruned_ids,
+                              filter_iterator_t* filter_iterator = nullptr) const;
 
     void
     search_fields(const std::vector<filter>& filters,
@@ -1021,8 +1197,27 @@ public:
                                   token_ordering token_order,
                                   std::vector<filter>& filters) const;
 
+    uint64_t get_max_text_match_score(uint32_t seq_id, const std::vector<or_iterator_t>& its,
+                                      const std::vector<search_field_t>& the_fields, size_t query_len,
+                                      size_t num_query_tokens, uint32_t total_cost, int syn_orig_num_tokens,
+                                      bool prioritize_exact_match, bool prioritize_token_position) const;
+
+    // Bound on the text match score of any ID up to `block_last_id`, the end of the earliest ending block that the
+    // iterators are on. `num_block_ids` is the number of IDs left in that block.
+    uint64_t get_max_block_text_match_score(const std::vector<or_iterator_t>& its,
+                                            const std::vector<search_field_t>& the_fields, size_t query_len,
+                                            size_t num_query_tokens, uint32_t total_cost, int syn_orig_num_tokens,
+                                            bool prioritize_exact_match, bool prioritize_token_position,
+                                            uint32_t& block_last_id, size_t& num_block_ids) const;
+
+    static uint64_t get_text_match_bound(const size_t* field_num_tokens, const bool* field_maybe_verbatim,
+                                         bool fewer_tokens_possible,
+                                         const std::vector<search_field_t>& the_fields, size_t query_len,
+                                         size_t num_query_tokens, uint32_t total_cost, int syn_orig_num_tokens,
+                                         bool prioritize_exact_match, bool prioritize_token_position);
+
     void compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                             std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                             std::array<sort_column_t*, 3> field_values,
                              const std::vector<size_t>& geopoint_indices, uint32_t seq_id,
                              int64_t max_field_match_score,
                              int64_t* scores, int64_t& match_score_index) const;
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <type_traits>
+
+namespace index_image {
+    static constexpr uint32_t MAGIC = 0x54534958;  // "TSIX"
+    static constexpr uint32_t VERSION = 5;
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t FOOTER_SIZE = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2;
+}
+
+/*
+    Sequential binary file holding an image of the in-memory index structures, so that they can be restored on a
+    restart without re-parsing and re-tokenizing every stored document.
+
+    Data is checksummed in fixed-size blocks and terminated by a footer:
+
+    [data ...][num_bytes: uint64][checksum: uint64][version: uint32][magic: uint32]
+
+    The reader memory maps the file read-only for the duration of a load, so that the image is not copied through
+    stream buffers first. ID arrays are padded to a 4 byte boundary in the file, so they can be read as views into
+    the mapping. Loading still copies everything into the in-memory index structures: nothing refers to the mapping
+    once the reader is gone, and queries never read from the image.
+
+    The footer and the checksum of the whole file are verified before handing out any data, so a truncated or
+    corrupted image is rejected up front. Reads are also bounds checked against the data size.
+*/
+class index_image_writer_t {
+private:
+    std::ofstream out;
+    std::string buffer;
+
+    uint64_t num_bytes = 0;
+    uint64_t checksum = 0;
+
+    void flush_buffer();
+
+public:
+    explicit index_image_writer_t(const std::string& file_path);
+
+    [[nodiscard]] bool ok() const;
+
+    void write(const void* data, size_t len);
+
+    template<class T>
+    void write_value(const T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Value must be trivially copyable.");
+        write(&value, sizeof(T));
+    }
+
+    void write_string(const std::string& str);
+
+    void write_ids(const uint32_t* ids, uint32_t num_ids);
+
+    // flushes pending data and writes the footer; the image is usable only when this returns true
+    bool close();
+};
+
+class index_image_reader_t {
+private:
+    const char* data = nullptr;
+    size_t mapped_size = 0;
+
+    uint64_t num_bytes = 0;
+    uint64_t num_read = 0;
+
+    bool valid = false;
+
+    bool map(const std::string& file_path);
+
+    bool verify();
+
+public:
+    explicit index_image_reader_t(const std::string& file_path);
+
+    ~index_image_reader_t();
+
+    index_image_reader_t(const index_image_reader_t&) = delete;
+
+    index_image_reader_t& operator=(const index_image_reader_t&) = delete;
+
+    [[nodiscard]] bool ok() const;
+
+    bool read(void* data, size_t len);
+
+    template<class T>
+    bool read_value(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Value must be trivially copyable.");
+        return read(&value, sizeof(T));
+    }
+
+    bool read_string(std::string& str);
+
+    bool read_ids(std::vector<uint32_t>& ids);
+
+    // `ids` points into the mapped image and stays valid only as long as the reader, so callers copy what they keep
+    bool read_ids(const uint32_t*& ids, uint32_t& num_ids);
+
+    // returns true when all the data has been consumed
+    [[nodiscard]] bool at_end() const;
+};
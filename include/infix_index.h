@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sparsepp.h"
+#include "tsl/htrie_map.h"
+#include "index_image.h"
+
+/*
+    Suffix array over a sorted, immutable set of tokens.
+
+    The tokens are concatenated into a single text, each terminated by a `\0`, and the suffixes that start within
+    a token are sorted up to the end of that token. All the occurrences of a pattern are then a contiguous run of the
+    suffix array, found with two binary searches in O(|pattern| log N).
+*/
+class infix_suffix_array_t {
+private:
+    std::string text;
+
+    // token id => offset of the token in `text`
+    std::vector<uint32_t> token_offsets;
+
+    // offsets of the suffixes in `text`, sorted up to their terminating `\0`
+    std::vector<uint32_t> suffixes;
+
+public:
+    // `tokens` must be sorted and unique
+    explicit infix_suffix_array_t(const std::vector<std::string>& tokens);
+
+    [[nodiscard]] size_t num_tokens() const {
+        return token_offsets.size();
+    }
+
+    [[nodiscard]] std::string get_token(uint32_t token_id) const;
+
+    // returns the id of the token, or -1 when it is not present
+    [[nodiscard]] int64_t find(const std::string& token) const;
+
+    // appends the sorted ids of the tokens that contain `pattern`
+    void search(const std::string& pattern, std::vector<uint32_t>& token_ids) const;
+};
+
+// inputs and output of a background rebuild of the sealed tokens of an `infix_index_t`
+struct infix_rebuild_t {
+    std::shared_ptr<const infix_suffix_array_t> base;
+    std::vector<bool> base_live;
+    std::vector<std::string> delta_tokens;
+
+    std::shared_ptr<const infix_suffix_array_t> sealed;
+    std::atomic<bool> done{false};
+};
+
+/*
+    Trigram index over the distinct tokens of an infix field.
+
+    Every token is given a dense id, and every distinct trigram (3 consecutive bytes) of a token maps to a sorted
+    posting list of the ids of the tokens that contain it. The tokens that contain a query of 3 or more bytes must
+    contain every trigram of the query, so the candidates are found by intersecting the (shortest first) posting
+    lists of the query's trigrams. A shorter query is contained either within one of the trigrams of a token or within
+    a token that is itself shorter than a trigram, so its candidates are the union of the posting lists of the
+    matching trigrams and the short tokens.
+
+    Candidates are then verified against the query, so the cost of a search scales with the number of candidates
+    instead of the size of the vocabulary.
+
+    A sealed index (the `fm` infix mode) keeps most of its tokens in a more compact `infix_suffix_array_t` instead,
+    and only the tokens added since it was built in the trigram index, as a delta. Erased sealed tokens are masked
+    out until the next rebuild. Once the delta grows large enough, the suffix array is rebuilt off a snapshot in
+    the background, while the changes made in the meantime are logged, so that they can be replayed on top of the
+    new suffix array by the next write.
+*/
+class infix_index_t {
+public:
+    static constexpr size_t GRAM_SIZE = 3;
+
+    // the delta is sealed once it has this many tokens, and at least an eighth of the sealed tokens
+    static constexpr size_t MIN_DELTA_TOKENS_TO_SEAL = 1024;
+
+private:
+    const bool sealable;
+
+    // token => id
+    tsl::htrie_map<char, uint32_t> token_ids;
+
+    // id => token
+    std::vector<std::string> id_tokens;
+    std::vector<uint32_t> free_ids;
+
+    // trigram => sorted ids of the tokens that contain it
+    spp::sparse_hash_map<uint32_t, std::vector<uint32_t>> gram_postings;
+
+    // sorted ids of the tokens that are shorter than a trigram
+    std::vector<uint32_t> short_token_ids;
+
+    std::shared_ptr<const infix_suffix_array_t> sealed;
+    std::vector<bool> sealed_live;
+    size_t num_sealed_live = 0;
+
+    // rebuild in flight, and the changes made since its snapshot as (is_insert, token)
+    std::shared_ptr<infix_rebuild_t> rebuild;
+    std::vector<std::pair<bool, std::string>> rebuild_log;
+
+    static inline uint32_t gram_key(const char* gram) {
+        return (uint32_t(uint8_t(gram[0])) << 16) | (uint32_t(uint8_t(gram[1])) << 8) | uint32_t(uint8_t(gram[2]));
+    }
+
+    static void get_gram_keys(const std::string& token, std::vector<uint32_t>& gram_keys);
+
+    static void insert_id(std::vector<uint32_t>& ids, uint32_t id);
+
+    static void erase_id(std::vector<uint32_t>& ids, uint32_t id);
+
+    void insert_delta(const std::string& token);
+
+    bool erase_delta(const std::string& token);
+
+    void clear_delta();
+
+    void find_candidates(const std::string& query, std::vector<uint32_t>& candidate_ids) const;
+
+    // swaps in the sealed tokens of a completed rebuild
+    void apply_rebuild();
+
+    void get_tokens(std::vector<std::string>& tokens) const;
+
+public:
+    explicit infix_index_t(bool sealable = false): sealable(sealable) {
+
+    }
+
+    infix_index_t(const infix_index_t&) = delete;
+
+    infix_index_t& operator=(const infix_index_t&) = delete;
+
+    [[nodiscard]] bool is_sealable() const {
+        return sealable;
+    }
+
+    // inserting an existing token is a no-op
+    void insert(const std::string& token);
+
+    void erase(const std::string& token);
+
+    // appends the tokens that contain `query`, with its first occurrence starting at most `max_extra_prefix` bytes
+    // into the token and ending at most `max_extra_suffix` bytes before the end of the token
+    void search(const std::string& query, size_t max_extra_prefix, size_t max_extra_suffix,
+                std::vector<std::string>& tokens) const;
+
+    // number of distinct tokens
+    [[nodiscard]] size_t size() const;
+
+    // number of tokens held in the trigram index
+    [[nodiscard]] size_t delta_size() const;
+
+    // seals all the tokens right away
+    void seal();
+
+    // snapshots the tokens for a rebuild when the delta has grown large enough (or when forced), and returns the
+    // rebuild to be run through `run_rebuild()`; returns nullptr when no rebuild is needed
+    std::shared_ptr<infix_rebuild_t> begin_rebuild(bool force = false);
+
+    // builds the sealed tokens of a rebuild off its snapshot: safe to run concurrently with the index
+    static void run_rebuild(infix_rebuild_t& rebuild);
+
+    void save(index_image_writer_t& writer) const;
+
+    // expects an empty index
+    bool load(index_image_reader_t& reader);
+};
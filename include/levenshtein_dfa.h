@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/*
+    Lazily compiled Levenshtein automaton of a term, walked in lockstep with the characters of the keys of a tree.
+
+    A state is the last two rows of the (Damerau) Levenshtein matrix of the term against the characters consumed so
+    far, along with the last consumed character (needed for transpositions). Costs are capped at `max_cost + 2`:
+    that keeps the number of distinct states finite, without changing any of the comparisons against `max_cost + 1`
+    or below. Characters that don't occur in the term all behave the same, so transitions are keyed by the class of a
+    character instead of the character itself.
+
+    Transitions are computed once on first use and then served from a table, so that a row of the matrix is computed
+    only once per distinct state instead of once per traversed key character. A state from which no cost can ever
+    get back within `max_cost` is dead, so that its subtree can be pruned right away.
+*/
+class levenshtein_dfa_t {
+public:
+    static constexpr uint32_t INITIAL_STATE = 0;
+
+private:
+    static constexpr int32_t UNKNOWN_STATE = -1;
+
+    int term_len;
+    int max_cost;
+    uint8_t cost_cap;
+
+    // character => class: 0 for the characters that don't occur in the term
+    uint16_t char_classes[256] = {};
+    std::vector<uint16_t> term_classes;
+    size_t num_classes = 1;
+
+    // [previous char class (2 bytes), number of consumed chars (capped at 2), previous row, cost row]
+    size_t state_size;
+    std::vector<uint8_t> states;
+    std::vector<uint8_t> dead_states;
+    std::unordered_map<std::string, uint32_t> state_ids;
+
+    // state * num_classes + char class => next state
+    std::vector<int32_t> transitions;
+
+    uint32_t add_state(const std::string& state);
+
+    uint32_t compute_transition(uint32_t state, uint16_t char_class);
+
+public:
+    levenshtein_dfa_t(const unsigned char* term, int term_len, int max_cost);
+
+    inline uint32_t next(uint32_t state, unsigned char c) {
+        const size_t transition_index = size_t(state) * num_classes + char_classes[c];
+
+        if(transitions[transition_index] == UNKNOWN_STATE) {
+            const uint32_t next_state = compute_transition(state, char_classes[c]);
+            transitions[transition_index] = next_state;
+        }
+
+        return transitions[transition_index];
+    }
+
+    // costs of the term's prefixes against the consumed characters (`term_len + 1` columns), capped at `max_cost + 2`
+    [[nodiscard]] inline const uint8_t* cost_row(uint32_t state) const {
+        return &states[state * state_size + 3 + term_len + 1];
+    }
+
+    // no sequence of characters can bring any cost of the state back within `max_cost`
+    [[nodiscard]] inline bool is_dead(uint32_t state) const {
+        return dead_states[state];
+    }
+
+    [[nodiscard]] size_t num_states() const;
+};
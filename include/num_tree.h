@@ -6,11 +6,15 @@
 #include "array_utils.h"
 #include "art.h"
 #include "ids_t.h"
+#include "index_image.h"
 
 class num_tree_t {
 private:
     std::map<int64_t, void*> int64map;
 
+    // adds the IDs of all the lists at once, so that each container of `ids` is built only once
+    static void add_id_lists(const std::vector<void*>& id_lists, id_bitmap_t& ids);
+
 public:
 
     ~num_tree_t();
@@ -19,11 +23,33 @@ public:
 
     void range_inclusive_search(int64_t start, int64_t end, uint32_t** ids, size_t& ids_len);
 
+    void range_inclusive_search(int64_t start, int64_t end, id_bitmap_t& ids);
+
     size_t get(int64_t value, std::vector<uint32_t>& geo_result_ids);
 
     void search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids, size_t& ids_len);
 
+    void search(NUM_COMPARATOR comparator, int64_t value, id_bitmap_t& ids);
+
+    // collect the matching ID lists (see `ids_t`) without uncompressing them, e.g. for lazy filtering
+
+    void range_inclusive_search(int64_t start, int64_t end, std::vector<void*>& id_lists);
+
+    void search(NUM_COMPARATOR comparator, int64_t value, std::vector<void*>& id_lists);
+
+    // Walks the values in sorted order and collects the IDs that are present in `filter_ids`, stopping once at
+    // least `min_ids` of them are found. IDs of the last visited value are always fully collected, so that ties
+    // are never split. The INT64_MIN value is skipped. Returns false if more than `max_ids_visited` IDs had to be
+    // examined before stopping.
+    bool ordered_search(bool ascending, const uint32_t* filter_ids, size_t filter_ids_length,
+                        size_t min_ids, size_t max_ids_visited, std::vector<uint32_t>& ids);
+
     void remove(uint64_t value, uint32_t id);
 
     size_t size();
+
+    void save(index_image_writer_t& writer) const;
+
+    // expects an empty tree
+    bool load(index_image_reader_t& reader);
 };
\ No newline at end of file
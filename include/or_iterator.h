@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
 #include "posting_list.h"
+#include "threadpool.h"
 
 /*
  *  Takes a list of posting list iterators and returns an unique OR sequence of elements lazily
@@ -48,8 +52,26 @@ public:
 
     static bool take_id(result_iter_state_t& istate, uint32_t id, bool& is_excluded);
 
+    // iterator over the same posting lists, restricted to the blocks that overlap with `[min_id, max_id]`
+    [[nodiscard]] or_iterator_t range_iterator(uint32_t min_id, uint32_t max_id) const;
+
+    // Splits the ID space of `its` into at most `num_ranges` ranges along the block boundaries of the token with the
+    // fewest blocks, and returns the last ID of each range. A single range is returned when there are fewer than
+    // `min_blocks` blocks to split.
+    static void get_range_max_ids(const std::vector<or_iterator_t>& its, size_t num_ranges, size_t min_blocks,
+                                  std::vector<uint32_t>& range_max_ids);
+
+    // `func` may itself move all of the iterators past the ID it is called with (e.g. to skip IDs that can't make it
+    // to the results), and the intersection then resumes from wherever they are
     template<class T>
     static bool intersect(std::vector<or_iterator_t>& its, result_iter_state_t& istate, T func);
+
+    // Intersects disjoint ID ranges of `its` in parallel, so `func` must only touch state that is local to the
+    // range index it is called with. Runs sequentially on range 0 when the lists are too short to be split, or when
+    // `istate` holds a lazy filter iterator, which can't be shared across threads.
+    template<class T>
+    static bool intersect(std::vector<or_iterator_t>& its, result_iter_state_t& istate,
+                          ThreadPool* thread_pool, size_t concurrency, size_t parallelize_min_blocks, T func);
 };
 
 template<class T>
@@ -61,8 +83,12 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
         case 0:
             break;
         case 1:
-            if(istate.filter_ids_length != 0) {
-                its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
+            if(istate.is_filter_provided()) {
+                if(!istate.is_filter_valid()) {
+                    break;
+                }
+
+                its[0].skip_to(istate.get_filter_id());
             }
 
             while(its.size() == it_size && its[0].valid()) {
@@ -71,22 +97,26 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                     func(id, its);
                 }
 
-                if(istate.filter_ids_length != 0 && !is_excluded) {
-                    if(istate.filter_ids_index < istate.filter_ids_length) {
+                if(istate.is_filter_provided() && !is_excluded) {
+                    if(istate.is_filter_valid()) {
                         // skip iterator till next id available in filter
-                        its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
+                        its[0].skip_to(istate.get_filter_id());
                     } else {
                         break;
                     }
-                } else {
+                } else if(its[0].valid() && its[0].id() == id) {
                     its[0].next();
                 }
             }
             break;
         case 2:
-            if(istate.filter_ids_length != 0) {
-                its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
-                its[1].skip_to(istate.filter_ids[istate.filter_ids_index]);
+            if(istate.is_filter_provided()) {
+                if(!istate.is_filter_valid()) {
+                    break;
+                }
+
+                its[0].skip_to(istate.get_filter_id());
+                its[1].skip_to(istate.get_filter_id());
             }
 
             while(its.size() == it_size && !at_end2(its)) {
@@ -96,15 +126,15 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                         func(id, its);
                     }
 
-                    if(istate.filter_ids_length != 0 && !is_excluded) {
-                        if(istate.filter_ids_index < istate.filter_ids_length) {
+                    if(istate.is_filter_provided() && !is_excluded) {
+                        if(istate.is_filter_valid()) {
                             // skip iterator till next id available in filter
-                            its[0].skip_to(istate.filter_ids[istate.filter_ids_index]);
-                            its[1].skip_to(istate.filter_ids[istate.filter_ids_index]);
+                            its[0].skip_to(istate.get_filter_id());
+                            its[1].skip_to(istate.get_filter_id());
                         } else {
                             break;
                         }
-                    } else {
+                    } else if(its[0].valid() && its[0].id() == id) {
                         advance_all2(its);
                     }
                 } else {
@@ -113,9 +143,13 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
             }
             break;
         default:
-            if(istate.filter_ids_length != 0) {
+            if(istate.is_filter_provided()) {
+                if(!istate.is_filter_valid()) {
+                    break;
+                }
+
                 for(auto& it: its) {
-                    it.skip_to(istate.filter_ids[istate.filter_ids_index]);
+                    it.skip_to(istate.get_filter_id());
                 }
             }
 
@@ -126,16 +160,16 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
                         func(id, its);
                     }
 
-                    if(istate.filter_ids_length != 0 && !is_excluded) {
-                        if(istate.filter_ids_index < istate.filter_ids_length) {
+                    if(istate.is_filter_provided() && !is_excluded) {
+                        if(istate.is_filter_valid()) {
                             // skip iterator till next id available in filter
                             for(auto& it: its) {
-                                it.skip_to(istate.filter_ids[istate.filter_ids_index]);
+                                it.skip_to(istate.get_filter_id());
                             }
                         } else {
                             break;
                         }
-                    } else {
+                    } else if(its[0].valid() && its[0].id() == id) {
                         advance_all(its);
                     }
                 } else {
@@ -146,3 +180,71 @@ bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state
 
     return true;
 }
+
+template<class T>
+bool or_iterator_t::intersect(std::vector<or_iterator_t>& its, result_iter_state_t& istate,
+                              ThreadPool* thread_pool, size_t concurrency, size_t parallelize_min_blocks, T func) {
+    std::vector<uint32_t> range_max_ids;
+
+    if(thread_pool != nullptr && istate.filter_iterator == nullptr) {
+        get_range_max_ids(its, concurrency, parallelize_min_blocks, range_max_ids);
+    }
+
+    if(range_max_ids.size() < 2) {
+        return intersect(its, istate, [&func](uint32_t id, std::vector<or_iterator_t>& its) {
+            func(id, its, 0);
+        });
+    }
+
+    size_t num_processed = 0;
+    std::mutex m_process;
+
+    for(size_t range_index = 0; range_index < range_max_ids.size(); range_index++) {
+        const uint32_t min_id = (range_index == 0) ? 0 : range_max_ids[range_index - 1] + 1;
+        const uint32_t max_id = range_max_ids[range_index];
+
+        thread_pool->fork([&its, &istate, &func, range_index, min_id, max_id,
+                           &num_processed, &m_process]() {
+            std::vector<or_iterator_t> range_its;
+            range_its.reserve(its.size());
+
+            for(const auto& it: its) {
+                range_its.push_back(it.range_iterator(min_id, max_id));
+            }
+
+            // filter IDs outside of the range can never match
+            const uint32_t* filter_ids = istate.filter_ids;
+            size_t filter_ids_length = istate.filter_ids_length;
+
+            if(filter_ids_length != 0) {
+                const uint32_t* filter_ids_end = filter_ids + filter_ids_length;
+                filter_ids = std::lower_bound(filter_ids, filter_ids_end, min_id);
+                filter_ids_length = std::upper_bound(filter_ids, filter_ids_end, max_id) - filter_ids;
+            }
+
+            if(istate.filter_ids_length == 0 || filter_ids_length != 0) {
+                result_iter_state_t range_istate(istate.excluded_result_ids, istate.excluded_result_ids_size,
+                                                 filter_ids, filter_ids_length);
+                range_istate.index = range_index;
+
+                intersect(range_its, range_istate, [&func, range_index, max_id]
+                                                   (uint32_t id, std::vector<or_iterator_t>& range_its) {
+                    // last block of a range can hold IDs that belong to the next range
+                    if(id <= max_id) {
+                        func(id, range_its, range_index);
+                    }
+                });
+            }
+
+            std::unique_lock<std::mutex> lock(m_process);
+            num_processed++;
+        });
+    }
+
+    thread_pool->wait_until([&]() {
+        std::unique_lock<std::mutex> lock_process(m_process);
+        return num_processed == range_max_ids.size();
+    });
+
+    return true;
+}
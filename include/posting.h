@@ -37,6 +37,8 @@ struct compact_posting_list_t {
     [[nodiscard]] uint32_t num_ids() const;
 
     bool contains_atleast_one(const uint32_t* target_ids, size_t target_ids_size);
+
+    bool contains_atleast_one(filter_iterator_t* filter_iterator);
 };
 
 class posting_t {
@@ -49,12 +51,14 @@ public:
         std::vector<posting_list_t*> expanded_plists;
         result_iter_state_t& iter_state;
         ThreadPool* thread_pool;
+        size_t parallelize_min_ids;
 
         block_intersector_t(const std::vector<void*>& raw_posting_lists,
                             result_iter_state_t& iter_state,
                             ThreadPool* thread_pool,
                             size_t parallelize_min_ids = 1):
-                            iter_state(iter_state), thread_pool(thread_pool) {
+                            iter_state(iter_state), thread_pool(thread_pool),
+                            parallelize_min_ids(parallelize_min_ids) {
 
             to_expanded_plists(raw_posting_lists, plists, expanded_plists);
 
@@ -73,6 +77,8 @@ public:
 
         template<class T>
         bool intersect(T func, size_t concurrency=4);
+
+        void split_lists(size_t concurrency, std::vector<std::vector<posting_list_t::iterator_t>>& partial_its_vec);
     };
 
     static void to_expanded_plists(const std::vector<void*>& raw_posting_lists, std::vector<posting_list_t*>& plists,
@@ -92,10 +98,17 @@ public:
 
     static bool contains_atleast_one(const void* obj, const uint32_t* target_ids, size_t target_ids_size);
 
+    static bool contains_atleast_one(const void* obj, filter_iterator_t* filter_iterator);
+
     static void merge(const std::vector<void*>& posting_lists, std::vector<uint32_t>& result_ids);
 
     static void intersect(const std::vector<void*>& posting_lists, std::vector<uint32_t>& result_ids);
 
+    // Flattens the list: offsets of `ids[i]` are found in `offsets` from `offset_index[i]` till `offset_index[i+1]`
+    // (or the end of `offsets` for the last ID).
+    static void get_id_offsets(const void* obj, std::vector<uint32_t>& ids, std::vector<uint32_t>& offset_index,
+                               std::vector<uint32_t>& offsets);
+
     static void get_array_token_positions(
         uint32_t id,
         const std::vector<void*>& posting_lists,
@@ -116,17 +129,57 @@ public:
 
 template<class T>
 bool posting_t::block_intersector_t::intersect(T func, size_t concurrency) {
+    // Same approach as `ids_t::block_intersector_t::intersect()`: the posting list with the fewest blocks is split
+    // into N-block windows, and each window is intersected with the overlapping blocks of the other lists in parallel.
+    // The window index is passed to `func` so that callers can collect results without synchronization.
+
     if(plists.empty()) {
         return true;
     }
 
-    std::vector<posting_list_t::iterator_t> its;
-    its.reserve(plists.size());
+    // a lazy filter iterator is consumed in ascending order of IDs and can't be shared across windows
+    if(concurrency <= 1 || thread_pool == nullptr || iter_state.filter_iterator != nullptr ||
+       plists[0]->num_ids() < parallelize_min_ids) {
+        std::vector<posting_list_t::iterator_t> its;
+        its.reserve(plists.size());
 
-    for(const auto& posting_list: plists) {
-        its.push_back(posting_list->new_iterator());
+        for(const auto& posting_list: plists) {
+            its.push_back(posting_list->new_iterator());
+        }
+
+        posting_list_t::block_intersect<T>(its, iter_state, func);
+        return true;
     }
 
-    posting_list_t::block_intersect<T>(its, iter_state, func);
+    std::vector<std::vector<posting_list_t::iterator_t>> partial_its_vec(concurrency);
+    split_lists(concurrency, partial_its_vec);
+
+    size_t num_processed = 0;
+    std::mutex m_process;
+    size_t num_non_empty = 0;
+
+    for(size_t i = 0; i < partial_its_vec.size(); i++) {
+        auto& partial_its = partial_its_vec[i];
+
+        if(partial_its.empty()) {
+            continue;
+        }
+
+        num_non_empty++;
+
+        thread_pool->fork([this, i, &func, &partial_its, &num_processed, &m_process]() {
+            auto iter_state_copy = iter_state;
+            iter_state_copy.index = i;
+            posting_list_t::block_intersect<T>(partial_its, iter_state_copy, func);
+            std::unique_lock<std::mutex> lock(m_process);
+            num_processed++;
+        });
+    }
+
+    thread_pool->wait_until([&]() {
+        std::unique_lock<std::mutex> lock_process(m_process);
+        return num_processed == num_non_empty;
+    });
+
     return true;
 }
@@ -8,6 +8,8 @@
 
 typedef uint32_t last_id_t;
 
+class filter_iterator_t;
+
 struct result_iter_state_t {
     const uint32_t* excluded_result_ids = nullptr;
     const size_t excluded_result_ids_size = 0;
@@ -15,6 +17,9 @@ struct result_iter_state_t {
     const uint32_t* filter_ids = nullptr;
     const size_t filter_ids_length = 0;
 
+    // lazily evaluated alternative to `filter_ids`: consumed in ascending order of IDs
+    filter_iterator_t* filter_iterator = nullptr;
+
     size_t excluded_result_ids_index = 0;
     size_t filter_ids_index = 0;
     size_t index = 0;
@@ -25,6 +30,19 @@ struct result_iter_state_t {
                         const uint32_t* filter_ids, const size_t filter_ids_length) : excluded_result_ids(excluded_result_ids),
                                                                                       excluded_result_ids_size(excluded_result_ids_size),
                                                                                       filter_ids(filter_ids), filter_ids_length(filter_ids_length) {}
+
+    // rewinds `filter_iterator` (when given) since it is shared across iterations
+    result_iter_state_t(const uint32_t* excluded_result_ids, size_t excluded_result_ids_size,
+                        const uint32_t* filter_ids, size_t filter_ids_length,
+                        filter_iterator_t* filter_iterator);
+
+    [[nodiscard]] bool is_filter_provided() const;
+
+    // whether there are filter IDs left to be matched
+    [[nodiscard]] bool is_filter_valid() const;
+
+    // next filter ID that is yet to be matched
+    [[nodiscard]] uint32_t get_filter_id() const;
 };
 
 /*
@@ -45,6 +63,10 @@ public:
         // link to next block
         block_t* next = nullptr;
 
+        // Upper bound on the offsets-derived score of the block: whether any of its documents can be a verbatim
+        // single-token match. Never cleared on erase, so it stays a safe (if loose) bound.
+        bool maybe_verbatim = false;
+
         bool contains(uint32_t id);
 
         void remove_and_shift_offset_index(const uint32_t* indices_sorted, uint32_t num_indices);
@@ -90,11 +112,18 @@ public:
         void set_index(uint32_t index);
         [[nodiscard]] uint32_t id() const;
         [[nodiscard]] uint32_t last_block_id() const;
+        // number of IDs from the current one to the end of the current block
+        [[nodiscard]] uint32_t num_block_ids_left() const;
         [[nodiscard]] inline uint32_t index() const;
         [[nodiscard]] inline block_t* block() const;
         [[nodiscard]] uint32_t get_field_id() const;
+        [[nodiscard]] const std::map<last_id_t, block_t*>* get_id_block_map() const;
 
         posting_list_t::iterator_t clone() const;
+
+        // new iterator on the same posting list, over only the blocks that overlap with `[min_id, max_id]`
+        // and positioned at the first ID >= `min_id`: can still return IDs > `max_id` from its last block
+        [[nodiscard]] posting_list_t::iterator_t range_iterator(uint32_t min_id, uint32_t max_id) const;
     };
 
 public:
@@ -158,6 +187,8 @@ public:
 
     bool contains_atleast_one(const uint32_t* target_ids, size_t target_ids_size);
 
+    bool contains_atleast_one(filter_iterator_t* filter_iterator);
+
     iterator_t new_iterator(block_t* start_block = nullptr, block_t* end_block = nullptr, uint32_t field_id = 0);
 
     static void merge(const std::vector<posting_list_t*>& posting_lists, std::vector<uint32_t>& result_ids);
@@ -180,6 +211,9 @@ public:
 
     static bool is_single_token_verbatim_match(const posting_list_t::iterator_t& it, bool field_is_array);
 
+    // cheap upper bound of `is_single_token_verbatim_match()` that only looks at the block under the iterator
+    static bool maybe_single_token_verbatim_match(const posting_list_t::iterator_t& it);
+
     static void get_exact_matches(std::vector<iterator_t>& its, bool field_is_array,
                                   const uint32_t* ids, const uint32_t num_ids,
                                   uint32_t*& exact_ids, size_t& num_exact_ids);
@@ -8,6 +8,7 @@
 #include <braft/protobuf_file.h>         // braft::ProtoBufFile
 #include <rocksdb/db.h>
 #include <future>
+#include <map>
 #include <sys/statvfs.h>
 
 #include "http_data.h"
@@ -123,6 +124,7 @@ struct cached_disk_stat_t {
 class ReplicationState : public braft::StateMachine {
 private:
     static constexpr const char* db_snapshot_name = "db_snapshot";
+    static constexpr const char* index_image_dir_name = "index_images";
 
     mutable std::shared_mutex node_mutex;
 
@@ -214,7 +216,7 @@ public:
     // Shut this node down.
     void shutdown();
 
-    int init_db();
+    int init_db(const std::string& index_image_dir = "");
 
     Store* get_store();
 
@@ -267,8 +269,13 @@ private:
         braft::SnapshotWriter* writer;
         std::string state_dir_path;
         std::string db_snapshot_path;
+        std::string index_image_path;
         std::string ext_snapshot_path;
         braft::Closure* done;
+
+        // state of the indices at the checkpoint, to write their images from
+        uint64_t store_seq_number;
+        std::map<uint32_t, uint64_t> index_write_generations;
     };
 
     static void *save_snapshot(void* arg);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "index_image.h"
+
+/*
+    Columnar store of `seq_id -> int64_t` values of a numeric sort field.
+
+    Since sequence IDs are assigned densely and monotonically, values are kept in fixed-size chunks of a flat
+    array indexed directly by `seq_id`, along with a presence bitmap for documents that don't have the field.
+    A lookup is therefore two array accesses instead of a hash probe, and a document costs 8 bytes + 1 bit.
+    Chunks are allocated lazily, so that a deleted or never-populated range of IDs costs nothing.
+
+    A dense chunk costs ~32.5KB however few of its slots are filled, so a chunk starts out sparse: sorted offsets
+    along with their values, i.e. 10 bytes per value, looked up by binary search. It is made dense once it holds
+    more than `SPARSE_MAX_VALUES` values, and made sparse again when deletes bring it down to half of that. A field
+    that only a few documents have thus costs about as much as a hash map would.
+*/
+class sort_column_t {
+public:
+    static constexpr uint32_t CHUNK_BITS = 12;
+    static constexpr uint32_t CHUNK_SIZE = (1 << CHUNK_BITS);
+    static constexpr uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    static constexpr uint32_t SPARSE_MAX_VALUES = 256;
+
+private:
+    struct dense_chunk_t {
+        int64_t values[CHUNK_SIZE];
+        uint64_t present[CHUNK_SIZE / 64] = {};
+
+        [[nodiscard]] inline bool contains(uint32_t offset) const {
+            return (present[offset >> 6] >> (offset & 63)) & 1;
+        }
+    };
+
+    struct chunk_t {
+        // set once the chunk has more than `SPARSE_MAX_VALUES` values, the sparse arrays are empty then
+        dense_chunk_t* dense = nullptr;
+
+        std::vector<uint16_t> sparse_offsets;
+        std::vector<int64_t> sparse_values;
+
+        uint32_t num_present = 0;
+
+        ~chunk_t() {
+            delete dense;
+        }
+
+        [[nodiscard]] inline const int64_t* find(uint32_t offset) const {
+            if(dense != nullptr) {
+                return dense->contains(offset) ? &dense->values[offset] : nullptr;
+            }
+
+            auto it = std::lower_bound(sparse_offsets.begin(), sparse_offsets.end(), offset);
+            if(it == sparse_offsets.end() || *it != offset) {
+                return nullptr;
+            }
+
+            return &sparse_values[it - sparse_offsets.begin()];
+        }
+
+        void make_dense();
+
+        void make_sparse();
+    };
+
+    std::vector<chunk_t*> chunks;
+    size_t num_values = 0;
+
+    [[nodiscard]] inline const chunk_t* get_chunk(uint32_t seq_id) const {
+        const uint32_t chunk_index = (seq_id >> CHUNK_BITS);
+        return chunk_index < chunks.size() ? chunks[chunk_index] : nullptr;
+    }
+
+public:
+    sort_column_t() = default;
+
+    ~sort_column_t();
+
+    sort_column_t(const sort_column_t&) = delete;
+
+    sort_column_t& operator=(const sort_column_t&) = delete;
+
+    // inserts the value or overwrites the existing value of `seq_id`
+    void upsert(uint32_t seq_id, int64_t value);
+
+    void erase(uint32_t seq_id);
+
+    [[nodiscard]] inline bool contains(uint32_t seq_id) const {
+        const chunk_t* chunk = get_chunk(seq_id);
+        return chunk != nullptr && chunk->find(seq_id & CHUNK_MASK) != nullptr;
+    }
+
+    // returns `false` when the document has no value for the field
+    inline bool find(uint32_t seq_id, int64_t& value) const {
+        const chunk_t* chunk = get_chunk(seq_id);
+        const int64_t* chunk_value = (chunk == nullptr) ? nullptr : chunk->find(seq_id & CHUNK_MASK);
+
+        if(chunk_value == nullptr) {
+            return false;
+        }
+
+        value = *chunk_value;
+        return true;
+    }
+
+    [[nodiscard]] inline int64_t get_or_default(uint32_t seq_id, int64_t default_value) const {
+        int64_t value;
+        return find(seq_id, value) ? value : default_value;
+    }
+
+    [[nodiscard]] size_t size() const;
+
+    // bytes held by the chunks, excluding the chunk index itself
+    [[nodiscard]] size_t chunk_bytes() const;
+
+    [[nodiscard]] bool empty() const;
+
+    void clear();
+
+    void save(index_image_writer_t& writer) const;
+
+    // expects an empty column
+    bool load(index_image_reader_t& reader);
+};
@@ -1,68 +1,202 @@
-// https://github.com/jhasse/ThreadPool
+// Originally based on https://github.com/jhasse/ThreadPool
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+/*
+    Work-stealing thread pool.
+
+    Every worker owns a queue guarded by its own lock, so that submitting and taking tasks does not contend on a
+    single lock. The queue holds two kinds of tasks:
+
+    - independent tasks (like requests) submitted through `enqueue()`: spread across the workers round-robin when
+      submitted from outside of the pool, and taken in FIFO order.
+    - subtasks of a fan-out submitted through `fork()`: pushed to the queue of the forking worker and taken by it in
+      LIFO order, so that the most recently forked (and cache-warm) work runs first.
+
+    A worker without tasks of its own steals from the other workers, oldest subtasks first. A thread that waits for
+    its subtasks through `wait_until()` runs those of them that are still queued, so that a nested fan-out from within
+    the pool can't exhaust its workers. Only its own subtasks are run, so that waiting does not pick up unrelated work,
+    which could take longer and would clobber thread-local search state.
+
+    Tasks are further separated into lanes (searches, writes and administrative work). Workers serve lanes in the
+    order of their priority, and a lane can be capped to a number of concurrently running tasks, so that a large
+    import can't starve searches of workers. Tasks submitted without a lane inherit the lane of the calling task.
+*/
 class ThreadPool {
 public:
+    enum class lane_t : uint8_t {
+        SEARCH = 0,
+        WRITE = 1,
+        ADMIN = 2
+    };
+
+    static constexpr size_t NUM_LANES = 3;
+
+    struct lane_stats_t {
+        size_t num_queued = 0;
+        size_t num_running = 0;
+        uint64_t num_executed = 0;
+    };
+
+    struct stats_t {
+        size_t num_threads = 0;
+        size_t num_queued = 0;
+        uint64_t num_executed = 0;
+        uint64_t num_stolen = 0;
+        uint64_t num_helped = 0;
+        std::array<lane_stats_t, NUM_LANES> lanes;
+    };
+
     explicit ThreadPool(size_t);
+
+    // `max_concurrency` of 0 means no cap, and lanes with a higher `priority` are served first
+    // must be called before tasks are submitted
+    void set_lane(lane_t lane, size_t max_concurrency, size_t priority);
+
     template<class F, class... Args>
     decltype(auto) enqueue(F&& f, Args&&... args);
+
+    template<class F, class... Args>
+    decltype(auto) enqueue(lane_t lane, F&& f, Args&&... args);
+
+    // submits a subtask of the calling thread, which must be waited upon through `wait_until()`
+    template<class F, class... Args>
+    decltype(auto) fork(F&& f, Args&&... args);
+
+    template<class F, class... Args>
+    decltype(auto) fork(lane_t lane, F&& f, Args&&... args);
+
+    // blocks until `done()` returns true, running queued subtasks forked by the calling thread in the meantime
+    template<class P>
+    void wait_until(P&& done);
+
+    stats_t get_stats() const;
+
     void shutdown();
+
 private:
+    struct fork_t {
+        std::packaged_task<void()> task;
+        std::thread::id owner;
+    };
+
+    struct worker_queue_t {
+        std::mutex mutex;
+        std::deque<std::packaged_task<void()>> tasks[NUM_LANES];
+        std::deque<fork_t> forks[NUM_LANES];
+    };
+
+    struct lane_state_t {
+        std::atomic<size_t> num_queued{0};
+        std::atomic<size_t> num_running{0};
+        std::atomic<uint64_t> num_executed{0};
+        size_t max_concurrency = 0;
+        size_t priority = 0;
+    };
+
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
-    // the task queue
-    std::queue< std::packaged_task<void()> > tasks;
+    std::vector< std::unique_ptr<worker_queue_t> > queues;
+
+    lane_state_t lanes[NUM_LANES];
+
+    // lane indices in descending order of priority
+    std::array<size_t, NUM_LANES> lane_order;
+
+    std::atomic<size_t> num_queued{0};
+    std::atomic<size_t> next_queue{0};
+
+    // bumped whenever a task might have become runnable, so that idle workers don't miss it
+    std::atomic<uint64_t> wake_seq{0};
 
-    // synchronization
-    std::mutex queue_mutex;
+    std::atomic<size_t> num_sleeping{0};
+    std::atomic<size_t> num_waiters{0};
+
+    std::atomic<uint64_t> num_executed{0};
+    std::atomic<uint64_t> num_stolen{0};
+    std::atomic<uint64_t> num_helped{0};
+
+    // synchronization of idle workers, waiting threads and shutdown
+    std::mutex sleep_mutex;
     std::condition_variable condition;
+    std::condition_variable condition_waiters;
     std::condition_variable condition_producers;
-    bool stop;
+    std::atomic<bool> stop{false};
+
+    // set on the threads of a pool, to identify their queue
+    inline static thread_local ThreadPool* current_pool = nullptr;
+    inline static thread_local size_t current_queue = 0;
+
+    // lane of the task that is running on this thread
+    inline static thread_local lane_t current_lane = lane_t::SEARCH;
+
+    template<class F, class... Args>
+    decltype(auto) submit(lane_t lane, bool is_fork, F&& f, Args&&... args);
+
+    void push(std::packaged_task<void()>&& task, lane_t lane, bool is_fork);
+
+    void wake_one();
+
+    bool try_acquire(size_t lane_index);
+
+    void release(size_t lane_index);
+
+    // takes a task for a worker, holding a slot of the returned lane
+    bool pop(std::packaged_task<void()>& task, size_t& lane_index);
+
+    // takes a subtask forked by the calling thread
+    bool pop_own_fork(std::packaged_task<void()>& task, size_t& lane_index);
+
+    bool take(worker_queue_t& queue, size_t lane_index, std::packaged_task<void()>& task, bool own_queue);
+
+    bool take_own_fork(worker_queue_t& queue, std::packaged_task<void()>& task, size_t& lane_index);
+
+    void on_taken(std::unique_lock<std::mutex>& queue_lock, size_t lane_index);
+
+    void run(std::packaged_task<void()>& task, size_t lane_index);
+
+    void work(size_t queue_index);
 };
 
 // the constructor just launches some amount of workers
-inline ThreadPool::ThreadPool(size_t threads)
-        :   stop(false)
-{
-    for(size_t i = 0;i<threads;++i)
-        workers.emplace_back(
-                [this]
-                {
-                    for(;;)
-                    {
-                        std::packaged_task<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(this->queue_mutex);
-                            this->condition.wait(lock,
-                                                 [this]{ return this->stop || !this->tasks.empty(); });
-                            if(this->stop) {
-                                return;
-                            }
-
-                            if(this->tasks.empty()) {
-                                continue;
-                            }
-                            task = std::move(this->tasks.front());
-                            this->tasks.pop();
-                            if (tasks.empty()) {
-                                condition_producers.notify_one(); // notify the destructor that the queue is empty
-                            }
-                        }
-
-                        task();
-                    }
-                }
-        );
+inline ThreadPool::ThreadPool(size_t threads) {
+    lanes[size_t(lane_t::ADMIN)].priority = 2;
+    lanes[size_t(lane_t::SEARCH)].priority = 1;
+    lanes[size_t(lane_t::WRITE)].priority = 0;
+    lane_order = {size_t(lane_t::ADMIN), size_t(lane_t::SEARCH), size_t(lane_t::WRITE)};
+
+    for(size_t i = 0; i < threads; ++i) {
+        queues.emplace_back(new worker_queue_t());
+    }
+
+    for(size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+inline void ThreadPool::set_lane(lane_t lane, size_t max_concurrency, size_t priority) {
+    lanes[size_t(lane)].max_concurrency = max_concurrency;
+    lanes[size_t(lane)].priority = priority;
+
+    std::stable_sort(lane_order.begin(), lane_order.end(), [this](size_t a, size_t b) {
+        return lanes[a].priority > lanes[b].priority;
+    });
 }
 
-// add new work item to the pool
 template<class F, class... Args>
-decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args)
+decltype(auto) ThreadPool::submit(lane_t lane, bool is_fork, F&& f, Args&&... args)
 {
     using return_type = std::invoke_result_t<F, Args...>;
 
@@ -71,22 +205,296 @@ decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args)
     );
 
     std::future<return_type> res = task.get_future();
+    push(std::packaged_task<void()>(std::move(task)), lane, is_fork);
+    return res;
+}
+
+// add new work item to the pool
+template<class F, class... Args>
+decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args)
+{
+    return submit(current_lane, false, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+decltype(auto) ThreadPool::enqueue(lane_t lane, F&& f, Args&&... args)
+{
+    return submit(lane, false, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+decltype(auto) ThreadPool::fork(F&& f, Args&&... args)
+{
+    return submit(current_lane, true, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+decltype(auto) ThreadPool::fork(lane_t lane, F&& f, Args&&... args)
+{
+    return submit(lane, true, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class P>
+void ThreadPool::wait_until(P&& done) {
+    while(!done()) {
+        std::packaged_task<void()> task;
+        size_t lane_index;
+
+        // runs inline on the waiting thread, so it does not take up another slot of the lane
+        if(pop_own_fork(task, lane_index)) {
+            num_helped++;
+            run(task, lane_index);
+            continue;
+        }
+
+        // Remaining subtasks are already running elsewhere, and nothing else can fork on behalf of this thread
+        // while it waits, so only a finished task can make progress.
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        num_waiters++;
+        condition_waiters.wait(lock, [&done] { return done(); });
+        num_waiters--;
+    }
+}
+
+inline void ThreadPool::push(std::packaged_task<void()>&& task, lane_t lane, bool is_fork) {
+    if(queues.empty()) {
+        return ;
+    }
+
+    const size_t queue_index = (current_pool == this) ? current_queue :
+                               next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    worker_queue_t& queue = *queues[queue_index];
+    const size_t lane_index = size_t(lane);
+
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+        std::unique_lock<std::mutex> lock(queue.mutex);
 
         // don't allow enqueueing after stopping the pool
-        if(!stop) {
-            tasks.emplace(std::move(task));
+        if(stop) {
+            return ;
+        }
+
+        if(is_fork) {
+            queue.forks[lane_index].push_back(fork_t{std::move(task), std::this_thread::get_id()});
+        } else {
+            queue.tasks[lane_index].push_back(std::move(task));
         }
+
+        lanes[lane_index].num_queued++;
+        num_queued++;
     }
-    condition.notify_one();
-    return res;
+
+    wake_one();
+}
+
+inline void ThreadPool::wake_one() {
+    wake_seq++;
+
+    if(num_sleeping != 0) {
+        // ensures that a worker about to sleep has either seen the change or is already waiting
+        { std::unique_lock<std::mutex> lock(sleep_mutex); }
+        condition.notify_one();
+    }
+}
+
+inline bool ThreadPool::try_acquire(size_t lane_index) {
+    lane_state_t& lane = lanes[lane_index];
+
+    if(lane.max_concurrency == 0) {
+        lane.num_running++;
+        return true;
+    }
+
+    size_t num_running = lane.num_running;
+
+    while(num_running < lane.max_concurrency) {
+        if(lane.num_running.compare_exchange_weak(num_running, num_running + 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline void ThreadPool::release(size_t lane_index) {
+    lane_state_t& lane = lanes[lane_index];
+    lane.num_running--;
+
+    if(lane.max_concurrency != 0 && lane.num_queued != 0) {
+        // a worker might have skipped the lane while it was at capacity
+        wake_one();
+    }
+}
+
+inline void ThreadPool::on_taken(std::unique_lock<std::mutex>& queue_lock, size_t lane_index) {
+    lanes[lane_index].num_queued--;
+
+    if(--num_queued == 0) {
+        queue_lock.unlock();
+        { std::unique_lock<std::mutex> lock(sleep_mutex); }
+        condition_producers.notify_all(); // notify shutdown that the queue is empty
+    }
+}
+
+inline bool ThreadPool::take(worker_queue_t& queue, size_t lane_index, std::packaged_task<void()>& task,
+                             bool own_queue) {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    auto& forks = queue.forks[lane_index];
+    auto& tasks = queue.tasks[lane_index];
+
+    if(!forks.empty()) {
+        if(own_queue) {
+            task = std::move(forks.back().task);
+            forks.pop_back();
+        } else {
+            task = std::move(forks.front().task);
+            forks.pop_front();
+        }
+    } else if(!tasks.empty()) {
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    } else {
+        return false;
+    }
+
+    on_taken(lock, lane_index);
+    return true;
+}
+
+inline bool ThreadPool::take_own_fork(worker_queue_t& queue, std::packaged_task<void()>& task, size_t& lane_index) {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    const auto owner = std::this_thread::get_id();
+
+    for(size_t i = 0; i < NUM_LANES; i++) {
+        auto& forks = queue.forks[i];
+
+        for(auto it = forks.rbegin(); it != forks.rend(); ++it) {
+            if(it->owner == owner) {
+                task = std::move(it->task);
+                forks.erase(std::next(it).base());
+                lane_index = i;
+                on_taken(lock, lane_index);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+inline bool ThreadPool::pop(std::packaged_task<void()>& task, size_t& lane_index) {
+    if(num_queued == 0) {
+        return false;
+    }
+
+    const size_t own_index = current_queue;
+
+    for(size_t lane: lane_order) {
+        if(lanes[lane].num_queued == 0 || !try_acquire(lane)) {
+            continue;
+        }
+
+        lane_index = lane;
+
+        if(take(*queues[own_index], lane, task, true)) {
+            return true;
+        }
+
+        for(size_t i = 1; i < queues.size(); i++) {
+            if(take(*queues[(own_index + i) % queues.size()], lane, task, false)) {
+                num_stolen++;
+                return true;
+            }
+        }
+
+        release(lane);
+    }
+
+    return false;
+}
+
+inline bool ThreadPool::pop_own_fork(std::packaged_task<void()>& task, size_t& lane_index) {
+    if(num_queued == 0) {
+        return false;
+    }
+
+    // forks of a worker land in its own queue, while those of outside threads are spread across the queues
+    if(current_pool == this) {
+        return take_own_fork(*queues[current_queue], task, lane_index);
+    }
+
+    for(auto& queue: queues) {
+        if(take_own_fork(*queue, task, lane_index)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline void ThreadPool::run(std::packaged_task<void()>& task, size_t lane_index) {
+    const lane_t parent_lane = current_lane;
+    current_lane = lane_t(lane_index);
+    task();
+    current_lane = parent_lane;
+
+    lanes[lane_index].num_executed++;
+    num_executed++;
+
+    if(num_waiters != 0) {
+        // the task might have been the last one that a waiting thread depends on
+        { std::unique_lock<std::mutex> lock(sleep_mutex); }
+        condition_waiters.notify_all();
+    }
+}
+
+inline void ThreadPool::work(size_t queue_index) {
+    current_pool = this;
+    current_queue = queue_index;
+
+    for(;;) {
+        const uint64_t seen_wake_seq = wake_seq;
+        std::packaged_task<void()> task;
+        size_t lane_index;
+
+        if(pop(task, lane_index)) {
+            run(task, lane_index);
+            release(lane_index);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        num_sleeping++;
+        condition.wait(lock, [this, seen_wake_seq] { return stop || wake_seq != seen_wake_seq; });
+        num_sleeping--;
+
+        if(stop) {
+            return;
+        }
+    }
+}
+
+inline ThreadPool::stats_t ThreadPool::get_stats() const {
+    stats_t stats;
+    stats.num_threads = workers.size();
+    stats.num_queued = num_queued;
+    stats.num_executed = num_executed;
+    stats.num_stolen = num_stolen;
+    stats.num_helped = num_helped;
+
+    for(size_t i = 0; i < NUM_LANES; i++) {
+        stats.lanes[i].num_queued = lanes[i].num_queued;
+        stats.lanes[i].num_running = lanes[i].num_running;
+        stats.lanes[i].num_executed = lanes[i].num_executed;
+    }
+
+    return stats;
 }
 
 inline void ThreadPool::shutdown() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        condition_producers.wait(lock, [this] { return tasks.empty(); });
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        condition_producers.wait(lock, [this] { return num_queued == 0; });
         stop = true;
     }
     condition.notify_all();
@@ -284,6 +284,12 @@ struct Topster {
                std::tie(j[0]->scores[0], j[0]->scores[1], j[0]->scores[2], j[0]->key);
     }
 
+    // Smallest KV retained so far once the topster is full, since anything smaller would be rejected by `add()`.
+    // Grouping topsters aggregate every KV, so they never have a threshold.
+    const KV* get_threshold() const {
+        return (!distinct && size >= MAX_SIZE) ? kvs[0] : nullptr;
+    }
+
     // topster must be sorted before iterated upon to remove dead array entries
     void sort() {
         if(!distinct) {
@@ -285,3 +285,32 @@ adi_tree_t::~adi_tree_t() {
 const adi_node_t* adi_tree_t::get_root() {
     return root;
 }
+
+void adi_tree_t::save(index_image_writer_t& writer) const {
+    writer.write_value<uint64_t>(id_keys.size());
+
+    for(const auto& id_key: id_keys) {
+        writer.write_value<uint32_t>(id_key.first);
+        writer.write_string(id_key.second);
+    }
+}
+
+bool adi_tree_t::load(index_image_reader_t& reader) {
+    uint64_t num_keys;
+    if(!reader.read_value(num_keys)) {
+        return false;
+    }
+
+    std::string key;
+
+    for(uint64_t i = 0; i < num_keys; i++) {
+        uint32_t id;
+        if(!reader.read_value(id) || !reader.read_string(key)) {
+            return false;
+        }
+
+        index(id, key);
+    }
+
+    return true;
+}
@@ -1,5 +1,17 @@
 #include "array_utils.h"
 #include <memory.h>
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SSE41_TARGET __attribute__((target("sse4.1")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define ARRAY_UTILS_HAS_SIMD 1
+#elif defined(__aarch64__)
+#include <sse2neon.h>
+#define SSE41_TARGET
+#define ARRAY_UTILS_HAS_SIMD 1
+#endif
 
 size_t ArrayUtils::and_scalar(const uint32_t *A, const size_t lenA,
                               const uint32_t *B, const size_t lenB, uint32_t **results) {
@@ -149,4 +161,542 @@ size_t ArrayUtils::exclude_scalar(const uint32_t *A, const size_t lenA,
   delete[] results;
 
   return res_index;
-}
\ No newline at end of file
+}
+
+// Size ratio beyond which galloping through the larger list beats a linear (vectorized) merge. For unions, a merge
+// this lopsided is dominated by copying the larger list, so we stick to the scalar version.
+static constexpr size_t GALLOP_SIZE_RATIO = 128;
+
+// Vector kernels write a full register width at the output cursor, so the output buffer is padded by that amount
+static constexpr size_t SIMD_OUT_PADDING = 8;
+
+enum class simd_level_t {
+    scalar,
+    sse41,
+    avx2
+};
+
+static simd_level_t get_simd_level() {
+    static const simd_level_t level = []() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return simd_level_t::avx2;
+        }
+        if(__builtin_cpu_supports("sse4.1")) {
+            return simd_level_t::sse41;
+        }
+        return simd_level_t::scalar;
+#elif defined(__aarch64__)
+        return simd_level_t::sse41;
+#else
+        return simd_level_t::scalar;
+#endif
+    }();
+
+    return level;
+}
+
+// Returns position of first element >= target in `arr`, starting the exponential search from `pos`
+static inline size_t gallop_to(const uint32_t* arr, size_t pos, const size_t len, const uint32_t target) {
+    if(pos >= len || arr[pos] >= target) {
+        return pos;
+    }
+
+    size_t lo = pos;
+    size_t step = 1;
+    size_t hi = pos + step;
+
+    while(hi < len && arr[hi] < target) {
+        lo = hi;
+        step <<= 1;
+        hi = pos + step;
+    }
+
+    // arr[lo] < target and arr[hi] >= target (or hi is beyond the end)
+    return std::lower_bound(arr + lo + 1, arr + std::min(hi + 1, len), target) - arr;
+}
+
+static size_t and_galloping(const uint32_t* small, const size_t len_small,
+                            const uint32_t* large, const size_t len_large, uint32_t* out) {
+    size_t count = 0;
+    size_t pos = 0;
+
+    for(size_t i = 0; i < len_small; i++) {
+        pos = gallop_to(large, pos, len_large, small[i]);
+        if(pos == len_large) {
+            break;
+        }
+
+        if(large[pos] == small[i]) {
+            out[count++] = small[i];
+            pos++;
+        }
+    }
+
+    return count;
+}
+
+static size_t exclude_galloping(const uint32_t* A, const size_t lenA,
+                                const uint32_t* B, const size_t lenB, uint32_t* out) {
+    size_t count = 0;
+    size_t pos = 0;
+
+    for(size_t i = 0; i < lenA; i++) {
+        pos = gallop_to(B, pos, lenB, A[i]);
+        if(pos < lenB && B[pos] == A[i]) {
+            pos++;
+            continue;
+        }
+
+        out[count++] = A[i];
+    }
+
+    return count;
+}
+
+static inline size_t and_tail(const uint32_t* A, size_t i, const size_t lenA,
+                              const uint32_t* B, size_t j, const size_t lenB, uint32_t* out, size_t count) {
+    while(i < lenA && j < lenB) {
+        if(A[i] < B[j]) {
+            i++;
+        } else if(A[i] > B[j]) {
+            j++;
+        } else {
+            out[count++] = A[i];
+            i++;
+            j++;
+        }
+    }
+
+    return count;
+}
+
+// `block_mask` marks elements of the 4/8-wide block starting at `block_start` that were already found in B
+static inline size_t exclude_tail(const uint32_t* A, size_t i, const size_t lenA,
+                                  const uint32_t* B, size_t j, const size_t lenB,
+                                  const size_t block_start, const size_t block_end, uint32_t block_mask,
+                                  uint32_t* out, size_t count) {
+    while(i < lenA) {
+        if(i < block_end && ((block_mask >> (i - block_start)) & 1)) {
+            i++;
+            continue;
+        }
+
+        while(j < lenB && B[j] < A[i]) {
+            j++;
+        }
+
+        if(j < lenB && B[j] == A[i]) {
+            i++;
+            j++;
+            continue;
+        }
+
+        out[count++] = A[i++];
+    }
+
+    return count;
+}
+
+#ifdef ARRAY_UTILS_HAS_SIMD
+
+// Shuffle masks that move the 32-bit lanes selected by a 4-bit mask to the front of the register
+struct sse_pack_table_t {
+    alignas(16) uint8_t masks[16][16];
+
+    constexpr sse_pack_table_t(): masks() {
+        for(size_t m = 0; m < 16; m++) {
+            size_t pos = 0;
+            for(size_t lane = 0; lane < 4; lane++) {
+                if(m & (1 << lane)) {
+                    for(size_t b = 0; b < 4; b++) {
+                        masks[m][pos*4 + b] = uint8_t(lane*4 + b);
+                    }
+                    pos++;
+                }
+            }
+
+            for(; pos < 4; pos++) {
+                for(size_t b = 0; b < 4; b++) {
+                    masks[m][pos*4 + b] = 0x80;
+                }
+            }
+        }
+    }
+};
+
+static constexpr sse_pack_table_t sse_pack_table;
+
+SSE41_TARGET static inline __m128i sse_pack(const __m128i v, const uint32_t mask) {
+    return _mm_shuffle_epi8(v, _mm_load_si128((const __m128i*) sse_pack_table.masks[mask]));
+}
+
+// Mask of lanes of `a` that are present anywhere in `b`
+SSE41_TARGET static inline uint32_t sse_match_mask(const __m128i a, const __m128i b) {
+    const __m128i cmp0 = _mm_cmpeq_epi32(a, b);
+    const __m128i cmp1 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1)));
+    const __m128i cmp2 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m128i cmp3 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3)));
+    const __m128i cmp = _mm_or_si128(_mm_or_si128(cmp0, cmp1), _mm_or_si128(cmp2, cmp3));
+    return _mm_movemask_ps(_mm_castsi128_ps(cmp));
+}
+
+SSE41_TARGET static size_t and_sse41(const uint32_t* A, const size_t lenA,
+                                     const uint32_t* B, const size_t lenB, uint32_t* out) {
+    size_t i = 0, j = 0, count = 0;
+    const size_t vlenA = lenA & ~size_t(3);
+    const size_t vlenB = lenB & ~size_t(3);
+
+    while(i < vlenA && j < vlenB) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(A + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(B + j));
+        const uint32_t mask = sse_match_mask(a, b);
+
+        _mm_storeu_si128((__m128i*)(out + count), sse_pack(a, mask));
+        count += __builtin_popcount(mask);
+
+        const uint32_t a_max = A[i + 3];
+        const uint32_t b_max = B[j + 3];
+        i += (a_max <= b_max) ? 4 : 0;
+        j += (b_max <= a_max) ? 4 : 0;
+    }
+
+    return and_tail(A, i, lenA, B, j, lenB, out, count);
+}
+
+SSE41_TARGET static size_t exclude_sse41(const uint32_t* A, const size_t lenA,
+                                         const uint32_t* B, const size_t lenB, uint32_t* out) {
+    size_t i = 0, j = 0, count = 0;
+    const size_t vlenA = lenA & ~size_t(3);
+    const size_t vlenB = lenB & ~size_t(3);
+
+    // lanes of the current block of A seen in B so far: a block can only be emitted once B has moved past it
+    uint32_t block_mask = 0;
+
+    while(i < vlenA && j < vlenB) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(A + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(B + j));
+        block_mask |= sse_match_mask(a, b);
+
+        const uint32_t a_max = A[i + 3];
+        const uint32_t b_max = B[j + 3];
+
+        if(a_max <= b_max) {
+            const uint32_t keep_mask = ~block_mask & 0xF;
+            _mm_storeu_si128((__m128i*)(out + count), sse_pack(a, keep_mask));
+            count += __builtin_popcount(keep_mask);
+            block_mask = 0;
+            i += 4;
+        }
+
+        j += (b_max <= a_max) ? 4 : 0;
+    }
+
+    return exclude_tail(A, i, lenA, B, j, lenB, i, i + 4, block_mask, out, count);
+}
+
+// Bitonic-style merge of two sorted 4-lane registers: `vec_min` gets the lowest 4 values and `vec_max` the highest
+SSE41_TARGET static inline void sse_merge(const __m128i in1, const __m128i in2, __m128i& vec_min, __m128i& vec_max) {
+    __m128i tmp = _mm_min_epu32(in1, in2);
+    vec_max = _mm_max_epu32(in1, in2);
+    tmp = _mm_alignr_epi8(tmp, tmp, 4);
+    vec_min = _mm_min_epu32(tmp, vec_max);
+    vec_max = _mm_max_epu32(tmp, vec_max);
+    tmp = _mm_alignr_epi8(vec_min, vec_min, 4);
+    vec_min = _mm_min_epu32(tmp, vec_max);
+    vec_max = _mm_max_epu32(tmp, vec_max);
+    tmp = _mm_alignr_epi8(vec_min, vec_min, 4);
+    vec_min = _mm_min_epu32(tmp, vec_max);
+    vec_max = _mm_max_epu32(tmp, vec_max);
+    vec_min = _mm_alignr_epi8(vec_min, vec_min, 4);
+}
+
+// Stores values of sorted `vec` that don't repeat the previous value (last lane of `prev` for the first lane)
+SSE41_TARGET static inline size_t sse_store_unique(const __m128i prev, const __m128i vec, const bool first,
+                                                   uint32_t* out) {
+    const __m128i shifted = _mm_alignr_epi8(vec, prev, 12);
+    uint32_t dup_mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(shifted, vec)));
+    if(first) {
+        dup_mask &= ~1u;
+    }
+
+    const uint32_t keep_mask = ~dup_mask & 0xF;
+    _mm_storeu_si128((__m128i*)out, sse_pack(vec, keep_mask));
+    return __builtin_popcount(keep_mask);
+}
+
+static inline size_t or_tail(const uint32_t* A, size_t i, const size_t lenA,
+                             const uint32_t* B, size_t j, const size_t lenB, uint32_t* out, size_t count) {
+    while(i < lenA || j < lenB) {
+        uint32_t val;
+        if(j == lenB || (i < lenA && A[i] < B[j])) {
+            val = A[i++];
+        } else {
+            val = B[j++];
+        }
+
+        if(count == 0 || out[count-1] != val) {
+            out[count++] = val;
+        }
+    }
+
+    return count;
+}
+
+SSE41_TARGET static size_t or_sse41(const uint32_t* A, const size_t lenA,
+                                    const uint32_t* B, const size_t lenB, uint32_t* out) {
+    if(lenA < 4 || lenB < 4) {
+        return or_tail(A, 0, lenA, B, 0, lenB, out, 0);
+    }
+
+    const size_t vlenA = lenA & ~size_t(3);
+    const size_t vlenB = lenB & ~size_t(3);
+
+    __m128i vec_min, vec_max;
+    sse_merge(_mm_loadu_si128((const __m128i*) A), _mm_loadu_si128((const __m128i*) B), vec_min, vec_max);
+
+    size_t i = 4, j = 4;
+    size_t count = sse_store_unique(vec_min, vec_min, true, out);
+    __m128i last_store = vec_min;
+
+    if(i < vlenA && j < vlenB) {
+        __m128i v;
+        uint32_t curA = A[i];
+        uint32_t curB = B[j];
+
+        while(true) {
+            if(curA <= curB) {
+                v = _mm_loadu_si128((const __m128i*)(A + i));
+                i += 4;
+                if(i == vlenA) {
+                    break;
+                }
+                curA = A[i];
+            } else {
+                v = _mm_loadu_si128((const __m128i*)(B + j));
+                j += 4;
+                if(j == vlenB) {
+                    break;
+                }
+                curB = B[j];
+            }
+
+            sse_merge(v, vec_max, vec_min, vec_max);
+            count += sse_store_unique(last_store, vec_min, false, out + count);
+            last_store = vec_min;
+        }
+
+        sse_merge(v, vec_max, vec_min, vec_max);
+        count += sse_store_unique(last_store, vec_min, false, out + count);
+        last_store = vec_min;
+    }
+
+    // merge the values still held in `vec_max` and the sub-register tail of the exhausted list with the rest
+    uint32_t leftover[8];
+    _mm_storeu_si128((__m128i*) leftover, vec_max);
+    size_t leftover_len = 4;
+
+    if(i == vlenA) {
+        for(; i < lenA; i++) {
+            leftover[leftover_len++] = A[i];
+        }
+        std::sort(leftover, leftover + leftover_len);
+        return or_tail(leftover, 0, leftover_len, B, j, lenB, out, count);
+    }
+
+    for(; j < lenB; j++) {
+        leftover[leftover_len++] = B[j];
+    }
+    std::sort(leftover, leftover + leftover_len);
+    return or_tail(A, i, lenA, leftover, 0, leftover_len, out, count);
+}
+
+#endif
+
+#if defined(__x86_64__)
+
+// Lane permutations that move the 32-bit lanes selected by an 8-bit mask to the front of the register
+struct avx_pack_table_t {
+    alignas(32) uint32_t perms[256][8];
+
+    constexpr avx_pack_table_t(): perms() {
+        for(size_t m = 0; m < 256; m++) {
+            size_t pos = 0;
+            for(size_t lane = 0; lane < 8; lane++) {
+                if(m & (1 << lane)) {
+                    perms[m][pos++] = lane;
+                }
+            }
+
+            for(; pos < 8; pos++) {
+                perms[m][pos] = 0;
+            }
+        }
+    }
+};
+
+static constexpr avx_pack_table_t avx_pack_table;
+
+AVX2_TARGET static inline __m256i avx_pack(const __m256i v, const uint32_t mask) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_load_si256((const __m256i*) avx_pack_table.perms[mask]));
+}
+
+AVX2_TARGET static inline uint32_t avx_match_mask(const __m256i a, const __m256i b) {
+    // rotations within 128-bit lanes, then the same on the lane-swapped register cover all 8x8 pairs
+    const __m256i b_swapped = _mm256_permute2x128_si256(b, b, 1);
+
+    __m256i cmp = _mm256_cmpeq_epi32(a, b);
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1))));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3))));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, b_swapped));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b_swapped, _MM_SHUFFLE(0, 3, 2, 1))));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b_swapped, _MM_SHUFFLE(1, 0, 3, 2))));
+    cmp = _mm256_or_si256(cmp, _mm256_cmpeq_epi32(a, _mm256_shuffle_epi32(b_swapped, _MM_SHUFFLE(2, 1, 0, 3))));
+
+    return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+}
+
+AVX2_TARGET static size_t and_avx2(const uint32_t* A, const size_t lenA,
+                                   const uint32_t* B, const size_t lenB, uint32_t* out) {
+    size_t i = 0, j = 0, count = 0;
+    const size_t vlenA = lenA & ~size_t(7);
+    const size_t vlenB = lenB & ~size_t(7);
+
+    while(i < vlenA && j < vlenB) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(A + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(B + j));
+        const uint32_t mask = avx_match_mask(a, b);
+
+        _mm256_storeu_si256((__m256i*)(out + count), avx_pack(a, mask));
+        count += __builtin_popcount(mask);
+
+        const uint32_t a_max = A[i + 7];
+        const uint32_t b_max = B[j + 7];
+        i += (a_max <= b_max) ? 8 : 0;
+        j += (b_max <= a_max) ? 8 : 0;
+    }
+
+    return and_tail(A, i, lenA, B, j, lenB, out, count);
+}
+
+AVX2_TARGET static size_t exclude_avx2(const uint32_t* A, const size_t lenA,
+                                       const uint32_t* B, const size_t lenB, uint32_t* out) {
+    size_t i = 0, j = 0, count = 0;
+    const size_t vlenA = lenA & ~size_t(7);
+    const size_t vlenB = lenB & ~size_t(7);
+    uint32_t block_mask = 0;
+
+    while(i < vlenA && j < vlenB) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(A + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(B + j));
+        block_mask |= avx_match_mask(a, b);
+
+        const uint32_t a_max = A[i + 7];
+        const uint32_t b_max = B[j + 7];
+
+        if(a_max <= b_max) {
+            const uint32_t keep_mask = ~block_mask & 0xFF;
+            _mm256_storeu_si256((__m256i*)(out + count), avx_pack(a, keep_mask));
+            count += __builtin_popcount(keep_mask);
+            block_mask = 0;
+            i += 8;
+        }
+
+        j += (b_max <= a_max) ? 8 : 0;
+    }
+
+    return exclude_tail(A, i, lenA, B, j, lenB, i, i + 8, block_mask, out, count);
+}
+
+#endif
+
+size_t ArrayUtils::and_simd(const uint32_t *A, const size_t lenA,
+                            const uint32_t *B, const size_t lenB, uint32_t **results) {
+  if (lenA == 0 || lenB == 0) {
+    return 0;
+  }
+
+  *results = new uint32_t[std::min(lenA, lenB) + SIMD_OUT_PADDING];
+  uint32_t* out = *results;
+
+  if(lenB / lenA >= GALLOP_SIZE_RATIO) {
+    return and_galloping(A, lenA, B, lenB, out);
+  }
+
+  if(lenA / lenB >= GALLOP_SIZE_RATIO) {
+    return and_galloping(B, lenB, A, lenA, out);
+  }
+
+  switch(get_simd_level()) {
+#if defined(__x86_64__)
+    case simd_level_t::avx2:
+      return and_avx2(A, lenA, B, lenB, out);
+#endif
+#ifdef ARRAY_UTILS_HAS_SIMD
+    case simd_level_t::sse41:
+      return and_sse41(A, lenA, B, lenB, out);
+#endif
+    default:
+      return and_tail(A, 0, lenA, B, 0, lenB, out, 0);
+  }
+}
+
+size_t ArrayUtils::or_simd(const uint32_t *A, const size_t lenA,
+                           const uint32_t *B, const size_t lenB, uint32_t **out) {
+  if(A == nullptr || B == nullptr || get_simd_level() == simd_level_t::scalar ||
+     lenA / std::max<size_t>(lenB, 1) >= GALLOP_SIZE_RATIO || lenB / std::max<size_t>(lenA, 1) >= GALLOP_SIZE_RATIO) {
+    return or_scalar(A, lenA, B, lenB, out);
+  }
+
+  uint32_t* results = new uint32_t[lenA + lenB + SIMD_OUT_PADDING];
+  size_t res_index = 0;
+
+#ifdef ARRAY_UTILS_HAS_SIMD
+  res_index = or_sse41(A, lenA, B, lenB, results);
+#endif
+
+  // shrink fit
+  *out = new uint32_t[res_index];
+  memcpy(*out, results, res_index * sizeof(uint32_t));
+  delete[] results;
+
+  return res_index;
+}
+
+size_t ArrayUtils::exclude_simd(const uint32_t *A, const size_t lenA,
+                                const uint32_t *B, const size_t lenB, uint32_t **out) {
+  if(A == nullptr || lenB == 0 || B == nullptr) {
+    return exclude_scalar(A, lenA, B, lenB, out);
+  }
+
+  uint32_t* results = new uint32_t[lenA + SIMD_OUT_PADDING];
+  size_t res_index;
+
+  if(lenA == 0 || lenB / lenA >= GALLOP_SIZE_RATIO) {
+    res_index = exclude_galloping(A, lenA, B, lenB, results);
+  } else {
+    switch(get_simd_level()) {
+#if defined(__x86_64__)
+      case simd_level_t::avx2:
+        res_index = exclude_avx2(A, lenA, B, lenB, results);
+        break;
+#endif
+#ifdef ARRAY_UTILS_HAS_SIMD
+      case simd_level_t::sse41:
+        res_index = exclude_sse41(A, lenA, B, lenB, results);
+        break;
+#endif
+      default:
+        res_index = exclude_tail(A, 0, lenA, B, 0, lenB, 0, 0, 0, results, 0);
+    }
+  }
+
+  // shrink fit
+  *out = new uint32_t[res_index];
+  memcpy(*out, results, res_index * sizeof(uint32_t));
+  delete[] results;
+
+  return res_index;
+}
@@ -2,8 +2,10 @@
 
 #if defined(__x86_64__)
 #include <emmintrin.h>
+#define ART_SIMD_NODE16
 #elif defined(__aarch64__)
 #include <sse2neon.h>
+#define ART_SIMD_NODE16
 #endif
 
 #include <string.h>
@@ -20,6 +22,8 @@
 #include <stdint.h>
 #include <posting.h>
 #include "art.h"
+#include "art_arena.h"
+#include "levenshtein_dfa.h"
 #include "logger.h"
 
 /**
@@ -41,8 +45,8 @@
 
 enum recurse_progress { RECURSE, ABORT, ITERATE };
 
-static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *n, int depth, const unsigned char *term,
-                              const int term_len, const int* irow, const int* jrow, const int min_cost,
+static void art_fuzzy_recurse(unsigned char c, const art_node *n, int depth, const unsigned char *term,
+                              const int term_len, levenshtein_dfa_t& dfa, uint32_t state, const int min_cost,
                               const int max_cost, const bool prefix, std::vector<const art_node *> &results);
 
 void art_int_fuzzy_recurse(art_node *n, int depth, const unsigned char* int_str, int int_str_len,
@@ -100,33 +104,42 @@ bool compare_art_node_score_pq(const art_node* a, const art_node* b) {
     return !compare_art_node_score(a, b);
 }
 
-/**
- * Allocates a node of the given type,
- * initializes to zero and sets the type.
- */
-static art_node* alloc_node(uint8_t type) {
-    art_node* n;
+static inline size_t node_size(uint8_t type) {
     switch (type) {
         case NODE4:
-            n = (art_node *) calloc(1, sizeof(art_node4));
-            break;
+            return sizeof(art_node4);
         case NODE16:
-            n = (art_node *) calloc(1, sizeof(art_node16));
-            break;
+            return sizeof(art_node16);
         case NODE48:
-            n = (art_node *) calloc(1, sizeof(art_node48));
-            break;
+            return sizeof(art_node48);
         case NODE256:
-            n = (art_node *) calloc(1, sizeof(art_node256));
-            break;
+            return sizeof(art_node256);
         default:
             abort();
     }
+}
+
+/**
+ * Allocates a node of the given type,
+ * initializes to zero and sets the type.
+ */
+static art_node* alloc_node(art_arena_t* arena, uint8_t type) {
+    const size_t size = node_size(type);
+    art_node* n = (art_node *) arena->allocate(size);
+    memset(n, 0, size);
     n->type = type;
     n->max_score = 0;
     return n;
 }
 
+static inline void free_node(art_arena_t* arena, art_node* n) {
+    arena->deallocate(n, node_size(n->type));
+}
+
+static inline void free_leaf(art_arena_t* arena, art_leaf* l) {
+    arena->deallocate(l, sizeof(art_leaf) + l->key_len);
+}
+
 /**
  * Initializes an ART tree
  * @return 0 on success.
@@ -134,11 +147,13 @@ static art_node* alloc_node(uint8_t type) {
 int art_tree_init(art_tree *t) {
     t->root = NULL;
     t->size = 0;
+    t->generation = 0;
+    t->arena = new art_arena_t(sizeof(art_node256));
     return 0;
 }
 
 // Recursively destroys the tree
-static void destroy_node(art_node *n) {
+static void destroy_node(art_arena_t* arena, art_node *n) {
     // Break if null
     if (!n) return;
 
@@ -146,7 +161,7 @@ static void destroy_node(art_node *n) {
     if (IS_LEAF(n)) {
         art_leaf *leaf = (art_leaf *) LEAF_RAW(n);
         posting_t::destroy_list(leaf->values);
-        free(leaf);
+        free_leaf(arena, leaf);
         return;
     }
 
@@ -162,21 +177,21 @@ static void destroy_node(art_node *n) {
         case NODE4:
             p.p1 = (art_node4*)n;
             for (i=0;i<n->num_children;i++) {
-                destroy_node(p.p1->children[i]);
+                destroy_node(arena, p.p1->children[i]);
             }
             break;
 
         case NODE16:
             p.p2 = (art_node16*)n;
             for (i=0;i<n->num_children;i++) {
-                destroy_node(p.p2->children[i]);
+                destroy_node(arena, p.p2->children[i]);
             }
             break;
 
         case NODE48:
             p.p3 = (art_node48*)n;
             for (i=0;i<48;i++) {
-                destroy_node(p.p3->children[i]);
+                destroy_node(arena, p.p3->children[i]);
             }
             break;
 
@@ -184,7 +199,7 @@ static void destroy_node(art_node *n) {
             p.p4 = (art_node256*)n;
             for (i=0;i<256;i++) {
                 if (p.p4->children[i])
-                    destroy_node(p.p4->children[i]);
+                    destroy_node(arena, p.p4->children[i]);
             }
             break;
 
@@ -193,7 +208,7 @@ static void destroy_node(art_node *n) {
     }
 
     // Free ourself on the way up
-    free(n);
+    free_node(arena, n);
 }
 
 /**
@@ -201,7 +216,9 @@ static void destroy_node(art_node *n) {
  * @return 0 on success.
  */
 int art_tree_destroy(art_tree *t) {
-    destroy_node(t->root);
+    destroy_node(t->arena, t->root);
+    delete t->arena;
+    t->arena = NULL;
     return 0;
 }
 
@@ -217,8 +234,42 @@ void compare_and_match_leaf(const unsigned char *int_str, int int_str_len, const
 
 #endif
 
+// bit `i` is set when the i-th key of the node equals `c`
+static inline unsigned node16_equal_keys(const art_node16 *n, unsigned char c) {
+    const unsigned mask = (1U << n->n.num_children) - 1;
+
+#ifdef ART_SIMD_NODE16
+    // Compare the key to all 16 stored keys
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(c), _mm_loadu_si128((const __m128i*)n->keys));
+    return _mm_movemask_epi8(cmp) & mask;
+#else
+    unsigned bitfield = 0;
+    for (int i = 0; i < n->n.num_children; i++) {
+        bitfield |= unsigned(n->keys[i] == c) << i;
+    }
+    return bitfield & mask;
+#endif
+}
+
+// bit `i` is set when the i-th key of the node is greater than `c`, both compared as signed bytes
+static inline unsigned node16_greater_keys(const art_node16 *n, unsigned char c) {
+    const unsigned mask = (1U << n->n.num_children) - 1;
+
+#ifdef ART_SIMD_NODE16
+    __m128i cmp = _mm_cmplt_epi8(_mm_set1_epi8(c), _mm_loadu_si128((const __m128i*)n->keys));
+    return _mm_movemask_epi8(cmp) & mask;
+#else
+    unsigned bitfield = 0;
+    for (int i = 0; i < n->n.num_children; i++) {
+        bitfield |= unsigned((signed char) c < (signed char) n->keys[i]) << i;
+    }
+    return bitfield & mask;
+#endif
+}
+
 static art_node** find_child(art_node *n, unsigned char c) {
-    int i, mask, bitfield;
+    int i;
+    unsigned bitfield;
     union {
         art_node4 *p1;
         art_node16 *p2;
@@ -234,28 +285,20 @@ static art_node** find_child(art_node *n, unsigned char c) {
             }
             break;
 
-            {
-                __m128i cmp;
-                case NODE16:
-                    p.p2 = (art_node16*)n;
-
-                // Compare the key to all 16 stored keys
-                cmp = _mm_cmpeq_epi8(_mm_set1_epi8(c),
-                                     _mm_loadu_si128((__m128i*)p.p2->keys));
-
-                // Use a mask to ignore children that don't exist
-                mask = (1 << n->num_children) - 1;
-                bitfield = _mm_movemask_epi8(cmp) & mask;
-
-                /*
-                 * If we have a match (any bit set) then we can
-                 * return the pointer match using ctz to get
-                 * the index.
-                 */
-                if (bitfield)
-                    return &p.p2->children[__builtin_ctz(bitfield)];
-                break;
-            }
+        case NODE16:
+            p.p2 = (art_node16*)n;
+
+            // Compare the key to all the stored keys
+            bitfield = node16_equal_keys(p.p2, c);
+
+            /*
+             * If we have a match (any bit set) then we can
+             * return the pointer match using ctz to get
+             * the index.
+             */
+            if (bitfield)
+                return &p.p2->children[__builtin_ctz(bitfield)];
+            break;
 
         case NODE48:
             p.p3 = (art_node48*)n;
@@ -429,8 +472,8 @@ static void add_document_to_leaf(art_document *document, art_leaf *leaf) {
     }
 }
 
-static art_leaf* make_leaf(const unsigned char *key, uint32_t key_len, art_document *document) {
-    art_leaf *l = (art_leaf *) malloc(sizeof(art_leaf) + key_len);
+static art_leaf* make_leaf(art_arena_t* arena, const unsigned char *key, uint32_t key_len, art_document *document) {
+    art_leaf *l = (art_leaf *) arena->allocate(sizeof(art_leaf) + key_len);
     l->key_len = key_len;
     l->max_score = document->score;
 
@@ -476,7 +519,7 @@ static void add_child256(art_node256 *n, art_node **ref, unsigned char c, void *
     n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
 }
 
-static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *child) {
+static void add_child48(art_arena_t* arena, art_node48 *n, art_node **ref, unsigned char c, void *child) {
     if (n->n.num_children < 48) {
         int pos = 0;
         while (n->children[pos]) pos++;
@@ -485,7 +528,7 @@ static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *ch
         n->n.num_children++;
         n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
     } else {
-        art_node256 *new_n = (art_node256*)alloc_node(NODE256);
+        art_node256 *new_n = (art_node256*)alloc_node(arena, NODE256);
         for (int i=0;i<256;i++) {
             if (n->keys[i]) {
                 new_n->children[i] = n->children[n->keys[i] - 1];
@@ -493,22 +536,15 @@ static void add_child48(art_node48 *n, art_node **ref, unsigned char c, void *ch
         }
         copy_header((art_node*)new_n, (art_node*)n);
         *ref = (art_node*)new_n;
-        free(n);
+        free_node(arena, (art_node*) n);
         add_child256(new_n, ref, c, child);
     }
 }
 
-static void add_child16(art_node16 *n, art_node **ref, unsigned char c, void *child) {
+static void add_child16(art_arena_t* arena, art_node16 *n, art_node **ref, unsigned char c, void *child) {
     if (n->n.num_children < 16) {
-        __m128i cmp;
-
-        // Compare the key to all 16 stored keys
-        cmp = _mm_cmplt_epi8(_mm_set1_epi8(c),
-                             _mm_loadu_si128((__m128i*)n->keys));
-
-        // Use a mask to ignore children that don't exist
-        unsigned mask = (1 << n->n.num_children) - 1;
-        unsigned bitfield = _mm_movemask_epi8(cmp) & mask;
+        // Compare the key to all the stored keys
+        unsigned bitfield = node16_greater_keys(n, c);
 
         // Check if less than any
         unsigned idx;
@@ -527,7 +563,7 @@ static void add_child16(art_node16 *n, art_node **ref, unsigned char c, void *ch
         n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
 
     } else {
-        art_node48 *new_n = (art_node48*)alloc_node(NODE48);
+        art_node48 *new_n = (art_node48*)alloc_node(arena, NODE48);
 
         // Copy the child pointers and populate the key map
         memcpy(new_n->children, n->children,
@@ -537,12 +573,12 @@ static void add_child16(art_node16 *n, art_node **ref, unsigned char c, void *ch
         }
         copy_header((art_node*)new_n, (art_node*)n);
         *ref = (art_node*)new_n;
-        free(n);
-        add_child48(new_n, ref, c, child);
+        free_node(arena, (art_node*) n);
+        add_child48(arena, new_n, ref, c, child);
     }
 }
 
-static void add_child4(art_node4 *n, art_node **ref, unsigned char c, void *child) {
+static void add_child4(art_arena_t* arena, art_node4 *n, art_node **ref, unsigned char c, void *child) {
     if (n->n.num_children < 4) {
         int idx;
         for (idx=0; idx < n->n.num_children; idx++) {
@@ -560,7 +596,7 @@ static void add_child4(art_node4 *n, art_node **ref, unsigned char c, void *chil
         n->n.max_score = MAX(n->n.max_score, ((art_leaf *) LEAF_RAW(child))->max_score);
 
     } else {
-        art_node16 *new_n = (art_node16*)alloc_node(NODE16);
+        art_node16 *new_n = (art_node16*)alloc_node(arena, NODE16);
 
         // Copy the child pointers and the key map
         memcpy(new_n->children, n->children,
@@ -569,19 +605,19 @@ static void add_child4(art_node4 *n, art_node **ref, unsigned char c, void *chil
                 sizeof(unsigned char)*n->n.num_children);
         copy_header((art_node*)new_n, (art_node*)n);
         *ref = (art_node*)new_n;
-        free(n);
-        add_child16(new_n, ref, c, child);
+        free_node(arena, (art_node*) n);
+        add_child16(arena, new_n, ref, c, child);
     }
 }
 
-static void add_child(art_node *n, art_node **ref, unsigned char c, void *child) {
+static void add_child(art_arena_t* arena, art_node *n, art_node **ref, unsigned char c, void *child) {
     switch (n->type) {
         case NODE4:
-            return add_child4((art_node4*)n, ref, c, child);
+            return add_child4(arena, (art_node4*)n, ref, c, child);
         case NODE16:
-            return add_child16((art_node16*)n, ref, c, child);
+            return add_child16(arena, (art_node16*)n, ref, c, child);
         case NODE48:
-            return add_child48((art_node48*)n, ref, c, child);
+            return add_child48(arena, (art_node48*)n, ref, c, child);
         case NODE256:
             return add_child256((art_node256*)n, ref, c, child);
         default:
@@ -613,12 +649,12 @@ static int prefix_mismatch(const art_node *n, const unsigned char *key, int key_
     return idx;
 }
 
-static void* recursive_insert(art_node* n, art_node** ref, const unsigned char* key, uint32_t key_len,
+static void* recursive_insert(art_arena_t* arena, art_node* n, art_node** ref, const unsigned char* key, uint32_t key_len,
                               const int64_t docs_max_score, std::vector<art_document>& documents, int depth,
                               std::list<art_node*>& path, int* old) {
     // If we are at a NULL node, inject a leaf
     if (!n) {
-        art_leaf* new_leaf = make_leaf(key, key_len, &documents[0]);
+        art_leaf* new_leaf = make_leaf(arena, key, key_len, &documents[0]);
         for(size_t i = 1; i < documents.size(); i++) {
             add_document_to_leaf(&documents[i], new_leaf);
         }
@@ -641,10 +677,10 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
         }
 
         // New value, we must split the leaf into a node4
-        art_node4 *new_n = (art_node4*)alloc_node(NODE4);
+        art_node4 *new_n = (art_node4*)alloc_node(arena, NODE4);
 
         // Create a new leaf
-        art_leaf *l2 = make_leaf(key, key_len, &documents[0]);
+        art_leaf *l2 = make_leaf(arena, key, key_len, &documents[0]);
 
         uint32_t longest_prefix = longest_common_prefix(l, l2, depth);
         new_n->n.partial_len = longest_prefix;
@@ -656,8 +692,8 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
 
         // Add the leafs to the new node4
         *ref = (art_node*)new_n;
-        add_child4(new_n, ref, l->key[depth+longest_prefix], SET_LEAF(l));
-        add_child4(new_n, ref, l2->key[depth+longest_prefix], SET_LEAF(l2));
+        add_child4(arena, new_n, ref, l->key[depth+longest_prefix], SET_LEAF(l));
+        add_child4(arena, new_n, ref, l2->key[depth+longest_prefix], SET_LEAF(l2));
         return NULL;
     }
 
@@ -675,32 +711,32 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
         }
 
         // Create a new node
-        art_node4 *new_n = (art_node4*)alloc_node(NODE4);
+        art_node4 *new_n = (art_node4*)alloc_node(arena, NODE4);
         *ref = (art_node*)new_n;
         new_n->n.partial_len = prefix_diff;
         memcpy(new_n->n.partial, n->partial, min(MAX_PREFIX_LEN, prefix_diff));
 
         // Adjust the prefix of the old node
         if (n->partial_len <= MAX_PREFIX_LEN) {
-            add_child4(new_n, ref, n->partial[prefix_diff], n);
+            add_child4(arena, new_n, ref, n->partial[prefix_diff], n);
             n->partial_len -= (prefix_diff+1);
             memmove(n->partial, n->partial+prefix_diff+1,
                     min(MAX_PREFIX_LEN, n->partial_len));
         } else {
             n->partial_len -= (prefix_diff+1);
             art_leaf *l = minimum(n);
-            add_child4(new_n, ref, l->key[depth+prefix_diff], n);
+            add_child4(arena, new_n, ref, l->key[depth+prefix_diff], n);
             memcpy(n->partial, l->key+depth+prefix_diff+1,
                    min(MAX_PREFIX_LEN, n->partial_len));
         }
 
         // Insert the new leaf
-        art_leaf *l = make_leaf(key, key_len, &documents[0]);
+        art_leaf *l = make_leaf(arena, key, key_len, &documents[0]);
         for(size_t i = 1; i < documents.size(); i++) {
             add_document_to_leaf(&documents[i], l);
         }
 
-        add_child4(new_n, ref, key[depth+prefix_diff], SET_LEAF(l));
+        add_child4(arena, new_n, ref, key[depth+prefix_diff], SET_LEAF(l));
         path.push_back(*ref);
         return NULL;
     }
@@ -710,16 +746,16 @@ static void* recursive_insert(art_node* n, art_node** ref, const unsigned char*
     // Find a child to recurse to
     art_node **child = find_child(n, key[depth]);
     if (child) {
-        return recursive_insert(*child, child, key, key_len, docs_max_score, documents, depth + 1, path, old);
+        return recursive_insert(arena, *child, child, key, key_len, docs_max_score, documents, depth + 1, path, old);
     }
 
     // No child, node goes within us
-    art_leaf *l = make_leaf(key, key_len, &documents[0]);
+    art_leaf *l = make_leaf(arena, key, key_len, &documents[0]);
     for(size_t i = 1; i < documents.size(); i++) {
         add_document_to_leaf(&documents[i], l);
     }
 
-    add_child(n, ref, key[depth], SET_LEAF(l));
+    add_child(arena, n, ref, key[depth], SET_LEAF(l));
     path.push_back(*ref);
     return NULL;
 }
@@ -744,8 +780,11 @@ void* art_inserts(art_tree *t, const unsigned char *key, int key_len, const int6
 
     std::list<art_node*> path;
     bool frequency_based_ordering = (docs_max_score == USE_FREQUENCY_SCORE);
-    void *old = recursive_insert(t->root, &t->root, key, key_len, docs_max_score, documents, 0, path, &old_val);
-    if (!old_val) t->size++;
+    void *old = recursive_insert(t->arena, t->root, &t->root, key, key_len, docs_max_score, documents, 0, path, &old_val);
+    if (!old_val) {
+        t->size++;
+        t->generation++;
+    }
 
     if(frequency_based_ordering) {
         for(art_node* n: path) {
@@ -756,14 +795,14 @@ void* art_inserts(art_tree *t, const unsigned char *key, int key_len, const int6
     return old;
 }
 
-static void remove_child256(art_node256 *n, art_node **ref, unsigned char c) {
+static void remove_child256(art_arena_t* arena, art_node256 *n, art_node **ref, unsigned char c) {
     n->children[c] = NULL;
     n->n.num_children--;
 
     // Resize to a node48 on underflow, not immediately to prevent
     // trashing if we sit on the 48/49 boundary
     if (n->n.num_children == 37) {
-        art_node48 *new_n = (art_node48*)alloc_node(NODE48);
+        art_node48 *new_n = (art_node48*)alloc_node(arena, NODE48);
         *ref = (art_node*)new_n;
         copy_header((art_node*)new_n, (art_node*)n);
 
@@ -775,18 +814,18 @@ static void remove_child256(art_node256 *n, art_node **ref, unsigned char c) {
                 pos++;
             }
         }
-        free(n);
+        free_node(arena, (art_node*) n);
     }
 }
 
-static void remove_child48(art_node48 *n, art_node **ref, unsigned char c) {
+static void remove_child48(art_arena_t* arena, art_node48 *n, art_node **ref, unsigned char c) {
     int pos = n->keys[c];
     n->keys[c] = 0;
     n->children[pos-1] = NULL;
     n->n.num_children--;
 
     if (n->n.num_children == 12) {
-        art_node16 *new_n = (art_node16*)alloc_node(NODE16);
+        art_node16 *new_n = (art_node16*)alloc_node(arena, NODE16);
         *ref = (art_node*)new_n;
         copy_header((art_node*)new_n, (art_node*)n);
 
@@ -799,27 +838,27 @@ static void remove_child48(art_node48 *n, art_node **ref, unsigned char c) {
                 child++;
             }
         }
-        free(n);
+        free_node(arena, (art_node*) n);
     }
 }
 
-static void remove_child16(art_node16 *n, art_node **ref, art_node **l) {
+static void remove_child16(art_arena_t* arena, art_node16 *n, art_node **ref, art_node **l) {
     int pos = l - n->children;
     memmove(n->keys+pos, n->keys+pos+1, n->n.num_children - 1 - pos);
     memmove(n->children+pos, n->children+pos+1, (n->n.num_children - 1 - pos)*sizeof(void*));
     n->n.num_children--;
 
     if (n->n.num_children == 3) {
-        art_node4 *new_n = (art_node4*)alloc_node(NODE4);
+        art_node4 *new_n = (art_node4*)alloc_node(arena, NODE4);
         *ref = (art_node*)new_n;
         copy_header((art_node*)new_n, (art_node*)n);
         memcpy(new_n->keys, n->keys, 4);
         memcpy(new_n->children, n->children, 4*sizeof(void*));
-        free(n);
+        free_node(arena, (art_node*) n);
     }
 }
 
-static void remove_child4(art_node4 *n, art_node **ref, art_node **l) {
+static void remove_child4(art_arena_t* arena, art_node4 *n, art_node **ref, art_node **l) {
     int pos = l - n->children;
     memmove(n->keys+pos, n->keys+pos+1, n->n.num_children - 1 - pos);
     memmove(n->children+pos, n->children+pos+1, (n->n.num_children - 1 - pos)*sizeof(void*));
@@ -846,26 +885,27 @@ static void remove_child4(art_node4 *n, art_node **ref, art_node **l) {
             child->partial_len += n->n.partial_len + 1;
         }
         *ref = child;
-        free(n);
+        free_node(arena, (art_node*) n);
     }
 }
 
-static void remove_child(art_node *n, art_node **ref, unsigned char c, art_node **l) {
+static void remove_child(art_arena_t* arena, art_node *n, art_node **ref, unsigned char c, art_node **l) {
     switch (n->type) {
         case NODE4:
-            return remove_child4((art_node4*)n, ref, l);
+            return remove_child4(arena, (art_node4*)n, ref, l);
         case NODE16:
-            return remove_child16((art_node16*)n, ref, l);
+            return remove_child16(arena, (art_node16*)n, ref, l);
         case NODE48:
-            return remove_child48((art_node48*)n, ref, c);
+            return remove_child48(arena, (art_node48*)n, ref, c);
         case NODE256:
-            return remove_child256((art_node256*)n, ref, c);
+            return remove_child256(arena, (art_node256*)n, ref, c);
         default:
             abort();
     }
 }
 
-static art_leaf* recursive_delete(art_node *n, art_node **ref, const unsigned char *key, int key_len, int depth) {
+static art_leaf* recursive_delete(art_arena_t* arena, art_node *n, art_node **ref, const unsigned char *key, int key_len,
+                                  int depth) {
     // Search terminated
     if (!n) return NULL;
 
@@ -901,14 +941,14 @@ static art_leaf* recursive_delete(art_node *n, art_node **ref, const unsigned ch
     if (IS_LEAF(*child)) {
         art_leaf *l = (art_leaf *) LEAF_RAW(*child);
         if (!leaf_matches(l, key, key_len, depth)) {
-            remove_child(n, ref, key[depth], child);
+            remove_child(arena, n, ref, key[depth], child);
             return l;
         }
         return NULL;
 
         // Recurse
     } else {
-        return recursive_delete(*child, child, key, key_len, depth+1);
+        return recursive_delete(arena, *child, child, key, key_len, depth+1);
     }
 }
 
@@ -921,11 +961,12 @@ static art_leaf* recursive_delete(art_node *n, art_node **ref, const unsigned ch
  * the value pointer is returned.
  */
 void* art_delete(art_tree *t, const unsigned char *key, int key_len) {
-    art_leaf *l = recursive_delete(t->root, &t->root, key, key_len, 0);
+    art_leaf *l = recursive_delete(t->arena, t->root, &t->root, key, key_len, 0);
     if (l) {
         t->size--;
+        t->generation++;
         void *old = l->values;
-        free(l);
+        free_leaf(t->arena, l);
         return old;
     }
     return NULL;
@@ -941,7 +982,7 @@ void* art_delete(art_tree *t, const unsigned char *key, int key_len) {
 }*/
 
 int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_results,
-                  const uint32_t* filter_ids, size_t filter_ids_length,
+                  const uint32_t* filter_ids, size_t filter_ids_length, filter_iterator_t* filter_iterator,
                   const std::set<std::string>& exclude_leaves, const art_leaf* exact_leaf,
                   std::vector<art_leaf *>& results) {
 
@@ -973,7 +1014,7 @@ int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_r
             art_leaf *l = (art_leaf *) LEAF_RAW(n);
             //LOG(INFO) << "END LEAF SCORE: " << l->max_score;
 
-            if(filter_ids_length == 0) {
+            if(filter_ids_length == 0 && filter_iterator == nullptr) {
                 std::string tok(reinterpret_cast<char*>(l->key), l->key_len - 1);
                 if(exclude_leaves.count(tok) != 0 || l == exact_leaf) {
                     continue;
@@ -981,7 +1022,9 @@ int art_topk_iter(const art_node *root, token_ordering token_order, size_t max_r
                 results.push_back(l);
             } else {
                 // we will push leaf only if filter matches with leaf IDs
-                bool found_atleast_one = posting_t::contains_atleast_one(l->values, filter_ids, filter_ids_length);
+                bool found_atleast_one = (filter_iterator != nullptr) ?
+                                         posting_t::contains_atleast_one(l->values, filter_iterator) :
+                                         posting_t::contains_atleast_one(l->values, filter_ids, filter_ids_length);
                 if(found_atleast_one) {
                     std::string tok(reinterpret_cast<char*>(l->key), l->key_len - 1);
                     if(exclude_leaves.count(tok) != 0 || l == exact_leaf) {
@@ -1209,37 +1252,8 @@ void print_row(const int* row, const int row_len) {
     printf("\n");
 }
 
-static inline void copyIntArray2(const int *src, int *dest, const int len) {
-    for(int t=0; t<len; t++) {
-        dest[t] = src[t];
-    }
-}
-
-static inline void levenshtein_dist(const int depth, const unsigned char p, const unsigned char c,
-                                    const unsigned char* term, const int term_len,
-                                    const int* irow, const int* jrow, int* krow) {
-    krow[0] = jrow[0] + 1;
-
-    // Calculate levenshtein distance incrementally (term => b, column => j, c => a[i], p => a[i-1], irow => d[i-1]):
-    // https://en.wikipedia.org/wiki/Damerau%E2%80%93Levenshtein_distance#Optimal_string_alignment_distance
-
-    for(int column=1; column<=term_len; column++) {
-        int cost = (c == term[column-1]) ? 0 : 1;  // column-1 used because of zero-based char array
-
-        int delete_cost = jrow[column] + 1;
-        int insert_cost = krow[column - 1] + 1;
-        int substitution_cost = jrow[column - 1] + cost;
-
-        krow[column] = min(min(insert_cost, delete_cost), substitution_cost);
-
-        if(depth > 1 && column > 1 && c == term[column-1-1] && p == term[column-1]) {
-            krow[column] = std::min(krow[column], irow[column-2] + 1);
-        }
-    }
-}
-
-static inline void art_fuzzy_children(unsigned char p, const art_node *n, int depth, const unsigned char *term, const int term_len,
-                                      const int* irow, const int* jrow, const int min_cost, const int max_cost,
+static inline void art_fuzzy_children(const art_node *n, int depth, const unsigned char *term, const int term_len,
+                                      levenshtein_dfa_t& dfa, uint32_t state, const int min_cost, const int max_cost,
                                       const bool prefix, std::vector<const art_node *> &results) {
     char child_char;
     art_node* child;
@@ -1251,7 +1265,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = ((art_node4*)n)->keys[i];
                 printf("4!child_char: %c, %d, depth: %d\n", child_char, child_char, depth);
                 child = ((art_node4*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(child_char, child, depth, term, term_len, dfa, state, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE16:
@@ -1260,7 +1274,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = ((art_node16*)n)->keys[i];
                 printf("16!child_char: %c, depth: %d\n", child_char, depth);
                 child = ((art_node16*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(child_char, child, depth, term, term_len, dfa, state, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE48:
@@ -1271,7 +1285,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child = ((art_node48*)n)->children[ix - 1];
                 child_char = (char)i;
                 printf("48!child_char: %c, depth: %d, ix: %d\n", child_char, depth, ix);
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(child_char, child, depth, term, term_len, dfa, state, min_cost, max_cost, prefix, results);
             }
             break;
         case NODE256:
@@ -1281,7 +1295,7 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
                 child_char = (char) i;
                 printf("256!child_char: %c, depth: %d\n", child_char, depth);
                 child = ((art_node256*)n)->children[i];
-                art_fuzzy_recurse(p, child_char, child, depth, term, term_len, irow, jrow, min_cost, max_cost, prefix, results);
+                art_fuzzy_recurse(child_char, child, depth, term, term_len, dfa, state, min_cost, max_cost, prefix, results);
             }
             break;
         default:
@@ -1289,16 +1303,9 @@ static inline void art_fuzzy_children(unsigned char p, const art_node *n, int de
     }
 }
 
-static inline void rotate(int &i, int &j, int &k) {
-    int old_i = i;
-    i = j;
-    j = k;
-    k = old_i;
-}
-
 // -1: return without adding, 0 : continue iteration, 1: return after adding
 static inline int fuzzy_search_state(const bool prefix, int key_index, bool last_key_char,
-                                     int term_len, const int* cost_row, int min_cost, int max_cost) {
+                                     int term_len, const uint8_t* cost_row, int min_cost, int max_cost) {
 
     // a) iter_len < term_len: "pltninum" (term) on "pst" (key)
     // b) term_len < iter_len: "pst" (term) on "pltninum" (key)
@@ -1342,22 +1349,12 @@ static inline int fuzzy_search_state(const bool prefix, int key_index, bool last
     return (cost > bounded_cost) ? -1 : 0;
 }
 
-static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *n, int depth, const unsigned char *term,
-                              const int term_len, const int* irow, const int* jrow, const int min_cost,
+static void art_fuzzy_recurse(unsigned char c, const art_node *n, int depth, const unsigned char *term,
+                              const int term_len, levenshtein_dfa_t& dfa, uint32_t state, const int min_cost,
                               const int max_cost, const bool prefix, std::vector<const art_node *> &results) {
 
     if (!n) return ;
 
-    const int columns = term_len+1;
-    int i=0, j=1, k=2;
-    int row0[columns];
-    int row1[columns];
-    int row2[columns];
-    int* rows[3] = {row0, row1, row2};
-
-    copyIntArray2(irow, rows[i], columns);
-    copyIntArray2(jrow, rows[j], columns);
-
     if(depth == -1) {
         // root node
         depth = 0;
@@ -1366,12 +1363,13 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
         bool last_key_char = (c == '\0');
 
         if(!prefix || !last_key_char) {
-            levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-            rotate(i, j, k);
-            p = c;
+            state = dfa.next(state, c);
+            if(dfa.is_dead(state)) {
+                return;
+            }
         }
 
-        int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, dfa.cost_row(state), min_cost, max_cost);
         if(1 == action) {
             results.push_back(n);
             return;
@@ -1399,7 +1397,7 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
 
         if(depth >= iter_len) {
             // when a preceding partial node completely contains the whole leaf (e.g. "[raspberr]y" on "raspberries")
-            int action = fuzzy_search_state(prefix, depth, true, term_len, rows[j], min_cost, max_cost);
+            int action = fuzzy_search_state(prefix, depth, true, term_len, dfa.cost_row(state), min_cost, max_cost);
             if(action == 1) {
                 results.push_back(n);
             }
@@ -1413,16 +1411,15 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
             bool last_key_char = (c == '\0');
 
             if(!prefix || !last_key_char) {
-                levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-
+                state = dfa.next(state, c);
                 printf("leaf char: %c\n", l->key[depth]);
-                printf("cost: %d, depth: %d, term_len: %d\n", temp_cost, depth, term_len);
 
-                rotate(i, j, k);
-                p = c;
+                if(dfa.is_dead(state)) {
+                    return;
+                }
             }
 
-            int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, rows[j], min_cost, max_cost);
+            int action = fuzzy_search_state(prefix, depth, last_key_char, term_len, dfa.cost_row(state), min_cost, max_cost);
             if(action == 1) {
                 results.push_back(n);
                 return;
@@ -1446,11 +1443,12 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
     for (int idx = 0; idx < partial_len; idx++) {
         c = n->partial[idx];
 
-        levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-        rotate(i, j, k);
-        p = c;
+        state = dfa.next(state, c);
+        if(dfa.is_dead(state)) {
+            return;
+        }
 
-        int action = fuzzy_search_state(prefix, depth, false, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, false, term_len, dfa.cost_row(state), min_cost, max_cost);
         if(action == 1) {
             results.push_back(n);
             return;
@@ -1466,11 +1464,12 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
     // Some intermediate path may have been left out if partial_len is truncated: progress the levenshtein matrix
     while(partial_len < n->partial_len && depth < term_len) {
         c = term[depth];
-        levenshtein_dist(depth, p, c, term, term_len, rows[i], rows[j], rows[k]);
-        rotate(i, j, k);
-        p = c;
+        state = dfa.next(state, c);
+        if(dfa.is_dead(state)) {
+            return;
+        }
 
-        int action = fuzzy_search_state(prefix, depth, false, term_len, rows[j], min_cost, max_cost);
+        int action = fuzzy_search_state(prefix, depth, false, term_len, dfa.cost_row(state), min_cost, max_cost);
         if(action == 1) {
             results.push_back(n);
             return;
@@ -1484,7 +1483,7 @@ static void art_fuzzy_recurse(unsigned char p, unsigned char c, const art_node *
         partial_len++;
     }
 
-    art_fuzzy_children(c, n, depth, term, term_len, rows[i], rows[j], min_cost, max_cost, prefix, results);
+    art_fuzzy_children(n, depth, term, term_len, dfa, state, min_cost, max_cost, prefix, results);
 }
 
 /**
@@ -1496,28 +1495,48 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
                      std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves) {
 
     std::vector<const art_node*> nodes;
-    int irow[term_len + 1];
-    int jrow[term_len + 1];
-    for (int i = 0; i <= term_len; i++){
-        irow[i] = jrow[i] = i;
-    }
+    art_fuzzy_nodes(t, term, term_len, min_cost, max_cost, prefix, nodes);
+
+    return art_fuzzy_search_nodes(t, nodes, term, term_len, min_cost, max_words, token_order, prefix,
+                                  filter_ids, filter_ids_length, nullptr, results, exclude_leaves);
+}
+
+void art_fuzzy_nodes(art_tree *t, const unsigned char *term, const int term_len, const int min_cost, const int max_cost,
+                     const bool prefix, std::vector<const art_node *> &nodes) {
+
+    // compiled lazily for this term, and shared by the whole traversal
+    levenshtein_dfa_t dfa(term, term_len, max_cost);
 
     //auto begin = std::chrono::high_resolution_clock::now();
 
     if(IS_LEAF(t->root)) {
         art_leaf *l = (art_leaf *) LEAF_RAW(t->root);
-        art_fuzzy_recurse(0, l->key[0], t->root, 0, term, term_len, irow, jrow, min_cost, max_cost, prefix, nodes);
+        art_fuzzy_recurse(l->key[0], t->root, 0, term, term_len, dfa, levenshtein_dfa_t::INITIAL_STATE,
+                          min_cost, max_cost, prefix, nodes);
     } else {
         if(t->root == nullptr) {
-            return 0;
+            return ;
         }
 
         // send depth as -1 to indicate that this is a root node
-        art_fuzzy_recurse(0, 0, t->root, -1, term, term_len, irow, jrow, min_cost, max_cost, prefix, nodes);
+        art_fuzzy_recurse(0, t->root, -1, term, term_len, dfa, levenshtein_dfa_t::INITIAL_STATE,
+                          min_cost, max_cost, prefix, nodes);
     }
 
     //long long int time_micro = microseconds(std::chrono::high_resolution_clock::now() - begin).count();
     //!LOG(INFO) << "Time taken for fuzz: " << time_micro << "us, size of nodes: " << nodes.size();
+}
+
+int art_fuzzy_search_nodes(art_tree *t, const std::vector<const art_node *> &nodes, const unsigned char *term,
+                           const int term_len, const int min_cost, const int max_words,
+                           const token_ordering token_order, const bool prefix,
+                           const uint32_t *filter_ids, size_t filter_ids_length,
+                           filter_iterator_t* filter_iterator,
+                           std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves) {
+
+    if(t->root == nullptr) {
+        return 0;
+    }
 
     //auto begin = std::chrono::high_resolution_clock::now();
 
@@ -1525,8 +1544,14 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
     art_leaf* exact_leaf = (art_leaf *) art_search(t, term, key_len);
     //LOG(INFO) << "exact_leaf: " << exact_leaf << ", term: " << term << ", term_len: " << term_len;
 
+    if(exact_leaf != nullptr && filter_iterator != nullptr &&
+       !posting_t::contains_atleast_one(exact_leaf->values, filter_iterator)) {
+        exact_leaf = nullptr;
+    }
+
     for(auto node: nodes) {
-        art_topk_iter(node, token_order, max_words, filter_ids, filter_ids_length, exclude_leaves, exact_leaf, results);
+        art_topk_iter(node, token_order, max_words, filter_ids, filter_ids_length, filter_iterator,
+                      exclude_leaves, exact_leaf, results);
     }
 
     if(token_order == FREQUENCY) {
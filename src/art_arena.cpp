@@ -0,0 +1,70 @@
+#include "art_arena.h"
+#include <algorithm>
+#include <cstdlib>
+
+art_arena_t::art_arena_t(size_t max_pooled_size): max_pooled_size(max_pooled_size),
+                                                  pools((max_pooled_size + CHUNK_ALIGN - 1) / CHUNK_ALIGN + 1) {
+
+}
+
+art_arena_t::~art_arena_t() {
+    for(void* slab: slabs) {
+        ::free(slab);
+    }
+
+    slabs.clear();
+}
+
+void art_arena_t::add_slab(pool_t& pool, const size_t chunk_size) {
+    const size_t max_slab_chunks = std::max(MIN_SLAB_CHUNKS, MAX_SLAB_BYTES / chunk_size);
+    pool.slab_chunks = (pool.slab_chunks == 0) ? MIN_SLAB_CHUNKS : std::min(pool.slab_chunks * 2, max_slab_chunks);
+
+    // malloc() aligns to at least 16 bytes, and chunk sizes are multiples of 16 bytes
+    char* slab = (char*) malloc(pool.slab_chunks * chunk_size);
+    slabs.push_back(slab);
+
+    pool.next_chunk = slab;
+    pool.num_remaining = pool.slab_chunks;
+}
+
+void* art_arena_t::allocate(const size_t size) {
+    if(size > max_pooled_size) {
+        return malloc(size);
+    }
+
+    const size_t size_class = std::max<size_t>(1, (size + CHUNK_ALIGN - 1) / CHUNK_ALIGN);
+    pool_t& pool = pools[size_class];
+
+    if(pool.free_chunks != nullptr) {
+        void* chunk = pool.free_chunks;
+        pool.free_chunks = *(void**) chunk;
+        return chunk;
+    }
+
+    if(pool.num_remaining == 0) {
+        add_slab(pool, size_class * CHUNK_ALIGN);
+    }
+
+    void* chunk = pool.next_chunk;
+    pool.next_chunk += size_class * CHUNK_ALIGN;
+    pool.num_remaining--;
+
+    return chunk;
+}
+
+void art_arena_t::deallocate(void* chunk, const size_t size) {
+    if(chunk == nullptr) {
+        return ;
+    }
+
+    if(size > max_pooled_size) {
+        ::free(chunk);
+        return ;
+    }
+
+    const size_t size_class = std::max<size_t>(1, (size + CHUNK_ALIGN - 1) / CHUNK_ALIGN);
+    pool_t& pool = pools[size_class];
+
+    *(void**) chunk = pool.free_chunks;
+    pool.free_chunks = chunk;
+}
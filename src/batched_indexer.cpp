@@ -129,7 +129,7 @@ void BatchedIndexer::run() {
         std::deque<uint64_t>& queue = queues[i];
         await_t& queue_mutex = qmutuxes[i];
 
-        thread_pool->enqueue([&queue, &queue_mutex, this, i]() {
+        thread_pool->enqueue(ThreadPool::lane_t::WRITE, [&queue, &queue_mutex, this, i]() {
             while(!quit) {
                 std::unique_lock<std::mutex> qlk(queue_mutex.mcv);
                 queue_mutex.cv.wait(qlk, [&] { return quit || !queue.empty(); });
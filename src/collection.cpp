@@ -42,14 +42,15 @@ Collection::Collection(const std::string& name, const uint32_t collection_id, co
                        const uint32_t next_seq_id, Store *store, const std::vector<field> &fields,
                        const std::string& default_sorting_field,
                        const float max_memory_ratio, const std::string& fallback_field_type,
-                       const std::vector<std::string>& symbols_to_index, const std::vector<std::string>& token_separators):
+                       const std::vector<std::string>& symbols_to_index, const std::vector<std::string>& token_separators,
+                       const document_format_t document_format):
         name(name), collection_id(collection_id), created_at(created_at),
         next_seq_id(next_seq_id), store(store),
         fields(fields), default_sorting_field(default_sorting_field),
         max_memory_ratio(max_memory_ratio),
         fallback_field_type(fallback_field_type), dynamic_fields({}),
         symbols_to_index(to_char_array(symbols_to_index)), token_separators(to_char_array(token_separators)),
-        index(init_index()) {
+        document_format(document_format), index(init_index()) {
 
     this->num_documents = 0;
 }
@@ -149,6 +150,7 @@ nlohmann::json Collection::get_summary_json() const {
     json_response["created_at"] = created_at.load();
     json_response["token_separators"] = nlohmann::json::array();
     json_response["symbols_to_index"] = nlohmann::json::array();
+    json_response[COLLECTION_DOCUMENT_FORMAT] = DocumentCodec::format_name(document_format);
 
     for(auto c: symbols_to_index) {
         json_response["symbols_to_index"].push_back(std::string(1, c));
@@ -168,7 +170,7 @@ nlohmann::json Collection::get_summary_json() const {
         field_json[fields::optional] = coll_field.optional;
         field_json[fields::index] = coll_field.index;
         field_json[fields::sort] = coll_field.sort;
-        field_json[fields::infix] = coll_field.infix;
+        field_json[fields::infix] = coll_field.infix_json();
         field_json[fields::locale] = coll_field.locale;
 
         fields_arr.push_back(field_json);
@@ -204,7 +206,8 @@ Option<nlohmann::json> Collection::add(const std::string & json_str,
 
 nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohmann::json& document,
                                     const index_operation_t& operation, const std::string& id,
-                                    const DIRTY_VALUES& dirty_values, const bool& write_docs, const bool& write_id) {
+                                    const DIRTY_VALUES& dirty_values, const bool& write_docs, const bool& write_id,
+                                    size_t apply_batch_size) {
     //LOG(INFO) << "Memory ratio. Max = " << max_memory_ratio << ", Used = " << SystemMetrics::used_memory_ratio();
     std::vector<index_record> index_records;
 
@@ -281,7 +284,7 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
         do_batched_index:
 
         if((i+1) % index_batch_size == 0 || i == json_lines.size()-1 || repeated_doc) {
-            batch_index(index_records, json_lines, num_indexed, write_docs, write_id);
+            batch_index(index_records, json_lines, num_indexed, write_docs, write_id, apply_batch_size);
 
             // to return the document for the single doc add cases
             if(index_records.size() == 1) {
@@ -305,9 +308,10 @@ bool Collection::is_exceeding_memory_threshold() const {
 }
 
 void Collection::batch_index(std::vector<index_record>& index_records, std::vector<std::string>& json_out,
-                             size_t &num_indexed, const bool& write_docs, const bool& write_id) {
+                             size_t &num_indexed, const bool& write_docs, const bool& write_id,
+                             size_t apply_batch_size) {
 
-    batch_index_in_memory(index_records);
+    batch_index_in_memory(index_records, apply_batch_size);
 
     // store only documents that were indexed in-memory successfully
     for(auto& index_record: index_records) {
@@ -315,8 +319,8 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
 
         if(index_record.indexed.ok()) {
             if(index_record.is_update) {
-                const std::string& serialized_json = index_record.new_doc.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
-                bool write_ok = store->insert(get_seq_id_key(index_record.seq_id), serialized_json);
+                const std::string& serialized_doc = serialize_document(index_record.new_doc);
+                bool write_ok = store->insert(get_seq_id_key(index_record.seq_id), serialized_doc);
 
                 if(!write_ok) {
                     // we will attempt to reindex the old doc on a best-effort basis
@@ -331,12 +335,11 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
 
             } else {
                 const std::string& seq_id_str = std::to_string(index_record.seq_id);
-                const std::string& serialized_json = index_record.doc.dump(-1, ' ', false,
-                                                                           nlohmann::detail::error_handler_t::ignore);
+                const std::string& serialized_doc = serialize_document(index_record.doc);
 
                 rocksdb::WriteBatch batch;
                 batch.Put(get_doc_id_key(index_record.doc["id"]), seq_id_str);
-                batch.Put(get_seq_id_key(index_record.seq_id), serialized_json);
+                batch.Put(get_seq_id_key(index_record.seq_id), serialized_doc);
                 bool write_ok = store->batch_write(batch);
 
                 if(!write_ok) {
@@ -397,15 +400,49 @@ Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t
     return Option<>(200);
 }
 
-size_t Collection::batch_index_in_memory(std::vector<index_record>& index_records) {
-    std::unique_lock lock(mutex);
-    size_t num_indexed = Index::batch_memory_index(index, index_records, default_sorting_field,
-                                                   search_schema, fallback_field_type,
-                                                   token_separators, symbols_to_index, true);
-    num_documents += num_indexed;
+size_t Collection::batch_index_in_memory(std::vector<index_record>& index_records, size_t apply_batch_size) {
+    // Validation and tokenization don't modify the index, so searches are blocked only while the results are applied.
+    // Writes to a collection are serialized upstream, so the schema can't change in between.
+    {
+        std::shared_lock lock(mutex);
+        Index::batch_preprocess(index, index_records, default_sorting_field, search_schema, fallback_field_type,
+                                token_separators, symbols_to_index, true);
+    }
+
+    // Applying a large batch in one go would stall searches for the whole batch, so the exclusive lock is released
+    // between slices of the batch to let waiting searches through. Such a search sees the batch partly applied: the
+    // documents of the slices applied so far are found, while the rest of the batch isn't visible yet.
+    size_t num_indexed = 0;
+    std::vector<index_record> apply_batch;
+    apply_batch_size = std::max<size_t>(1, apply_batch_size);
+
+    for(size_t start = 0; start < index_records.size(); start += apply_batch_size) {
+        const size_t end = std::min(start + apply_batch_size, index_records.size());
+
+        apply_batch.assign(std::make_move_iterator(index_records.begin() + start),
+                           std::make_move_iterator(index_records.begin() + end));
+
+        {
+            std::unique_lock lock(mutex);
+            size_t num_applied = Index::batch_apply_preprocessed(index, apply_batch, search_schema);
+            num_documents += num_applied;
+            num_indexed += num_applied;
+        }
+
+        std::move(apply_batch.begin(), apply_batch.end(), index_records.begin() + start);
+
+        if(apply_slice_hook) {
+            apply_slice_hook(end);
+        }
+    }
+
     return num_indexed;
 }
 
+void Collection::_set_apply_slice_hook(const std::function<void(size_t)>& hook) {
+    apply_slice_hook = hook;
+}
+
 void Collection::prune_document(nlohmann::json &document, const spp::sparse_hash_set<std::string>& include_fields,
                                 const spp::sparse_hash_set<std::string>& exclude_fields) {
     auto it = document.begin();
@@ -758,7 +795,10 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
                                   const size_t max_extra_suffix,
                                   const size_t facet_query_num_typos,
                                   const size_t filter_curated_hits_option,
-                                  const bool prioritize_token_position) const {
+                                  const bool prioritize_token_position,
+                                  const bool max_score_pruning,
+                                  const size_t facet_sample_percent,
+                                  const size_t facet_sample_threshold) const {
 
     std::shared_lock lock(mutex);
 
@@ -781,6 +821,10 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
                                       std::to_string(GROUP_LIMIT_MAX) + ".");
     }
 
+    if(facet_sample_percent == 0 || facet_sample_percent > 100) {
+        return Option<nlohmann::json>(400, "Value of `facet_sample_percent` must be between 1 and 100.");
+    }
+
     if(!search_fields.empty() && search_fields.size() != num_typos.size()) {
         if(num_typos.size() != 1) {
             return Option<nlohmann::json>(400, "Number of weights in `num_typos` does not match "
@@ -875,12 +919,40 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
     }
 
     // validate facet fields
-    for(const std::string & field_name: facet_fields) {
+    for(const std::string & facet_field: facet_fields) {
+        // numeric range facets are in the `field(0-10,10-50,50-)` format
+        const size_t paren_index = facet_field.find('(');
+        const bool is_range_facet = (paren_index != std::string::npos && facet_field.back() == ')');
+        std::string field_name = is_range_facet ? facet_field.substr(0, paren_index) : facet_field;
+        StringUtils::trim(field_name);
+
         if(search_schema.count(field_name) == 0 || !search_schema.at(field_name).facet) {
             std::string error = "Could not find a facet field named `" + field_name + "` in the schema.";
             return Option<nlohmann::json>(404, error);
         }
-        facets.emplace_back(field_name);
+
+        if(!is_range_facet) {
+            facets.emplace_back(field_name);
+            continue;
+        }
+
+        const field& range_field = search_schema.at(field_name);
+
+        // ranges are counted off the sort index of the field
+        if(!(range_field.is_integer() || range_field.is_float()) || range_field.is_array() || !range_field.sort) {
+            std::string error = "Range facet field `" + field_name + "` must be a sortable, non-array numerical field.";
+            return Option<nlohmann::json>(400, error);
+        }
+
+        std::vector<facet_range_t> ranges;
+        const std::string ranges_str = facet_field.substr(paren_index + 1, facet_field.size() - paren_index - 2);
+        auto parse_ranges_op = parse_facet_ranges(ranges_str, range_field, ranges);
+
+        if(!parse_ranges_op.ok()) {
+            return Option<nlohmann::json>(parse_ranges_op.code(), parse_ranges_op.error());
+        }
+
+        facets.emplace_back(field_name, ranges);
     }
 
     // parse facet query
@@ -1104,12 +1176,13 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
                                                  per_page, page, token_order, prefixes,
                                                  drop_tokens_threshold, typo_tokens_threshold,
                                                  group_by_fields, group_limit, default_sorting_field,
-                                                 prioritize_exact_match, prioritize_token_position,
+                                                 prioritize_exact_match, prioritize_token_position, max_score_pruning,
                                                  exhaustive_search, 4,
                                                  search_stop_millis,
                                                  min_len_1typo, min_len_2typo, max_candidates, infixes,
                                                  max_extra_prefix, max_extra_suffix, facet_query_num_typos,
-                                                 filter_curated_hits, split_join_tokens);
+                                                 filter_curated_hits, split_join_tokens,
+                                                 facet_sample_percent, facet_sample_threshold);
 
     index->run_search(search_params);
 
@@ -1135,7 +1208,8 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
 
         total_found = search_params->groups_processed.size() + override_result_kvs.size();
     } else {
-        total_found = search_params->all_result_ids_len;
+        // with `max_score_pruning`, matches in the skipped blocks are only counted by estimate
+        total_found = search_params->all_result_ids_len + search_params->num_pruned_ids;
     }
 
     if(match_score_index >= 0 && sort_fields_std[match_score_index].text_match_buckets > 1) {
@@ -1246,6 +1320,12 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
 
     result["found"] = total_found;
 
+    // whenever `max_score_pruning` is asked for, the response says whether `found` counts every match or includes an
+    // estimate for the blocks that were skipped
+    if(max_score_pruning) {
+        result["found_is_estimate"] = (search_params->num_pruned_ids != 0);
+    }
+
     if(exclude_fields.count("out_of") == 0) {
         result["out_of"] = num_documents.load();
     }
@@ -1258,6 +1338,15 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
         index_symbols[uint8_t(c)] = 1;
     }
 
+    // when only some fields are returned, only those and the highlighted fields have to be decoded
+    spp::sparse_hash_set<std::string> hydration_fields;
+    if(!include_fields.empty()) {
+        hydration_fields = include_fields;
+        for(const auto& highlight_item: highlight_items) {
+            hydration_fields.insert(highlight_item.name);
+        }
+    }
+
     // construct results array
     for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
         const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
@@ -1273,7 +1362,9 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
             const std::string& seq_id_key = get_seq_id_key((uint32_t) field_order_kv->key);
 
             nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
+            const Option<bool> & document_op = hydration_fields.empty() ?
+                                               get_document_from_store(seq_id_key, document) :
+                                               get_document_from_store(seq_id_key, document, hydration_fields);
 
             if(!document_op.ok()) {
                 LOG(ERROR) << "Document fetch error. " << document_op.error();
@@ -1381,21 +1472,21 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
         facet_result["field_name"] = a_facet.field_name;
         facet_result["counts"] = nlohmann::json::array();
 
-        std::vector<std::pair<int64_t, facet_count_t>> facet_hash_counts;
-        for (const auto & kv : a_facet.result_map) {
-            facet_hash_counts.emplace_back(kv);
+        if(!a_facet.ranges.empty()) {
+            populate_range_facet(a_facet, facet_result);
+            result["facet_counts"].push_back(facet_result);
+            continue;
         }
 
-        auto the_field = search_schema.at(a_facet.field_name);
+        // keep only top K facets: only these are hydrated from the store
+        std::vector<std::pair<uint64_t, facet_count_t>> facet_hash_counts;
+        select_top_facet_counts(a_facet, max_facet_values, facet_hash_counts);
 
-        // keep only top K facets
-        auto max_facets = std::min(max_facet_values, facet_hash_counts.size());
-        std::nth_element(facet_hash_counts.begin(), facet_hash_counts.begin() + max_facets,
-                         facet_hash_counts.end(), Collection::facet_count_compare);
+        auto the_field = search_schema.at(a_facet.field_name);
 
         std::vector<facet_value_t> facet_values;
 
-        for(size_t fi = 0; fi < max_facets; fi++) {
+        for(size_t fi = 0; fi < facet_hash_counts.size(); fi++) {
             // remap facet value hash with actual string
             auto & kv = facet_hash_counts[fi];
             auto & facet_count = kv.second;
@@ -1403,7 +1494,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
             // fetch actual facet value from representative doc id
             const std::string& seq_id_key = get_seq_id_key((uint32_t) facet_count.doc_id);
             nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
+            const Option<bool> & document_op = get_document_from_store(seq_id_key, document, {a_facet.field_name});
 
             if(!document_op.ok()) {
                 LOG(ERROR) << "Facet fetch error. " << document_op.error();
@@ -1519,16 +1610,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query, const s
             facet_result["counts"].push_back(facet_value_count);
         }
 
-        // add facet value stats
-        facet_result["stats"] = nlohmann::json::object();
-        if(a_facet.stats.fvcount != 0) {
-            facet_result["stats"]["min"] = a_facet.stats.fvmin;
-            facet_result["stats"]["max"] = a_facet.stats.fvmax;
-            facet_result["stats"]["sum"] = a_facet.stats.fvsum;
-            facet_result["stats"]["avg"] = (a_facet.stats.fvsum / a_facet.stats.fvcount);
-        }
-
-        facet_result["stats"]["total_values"] = facet_hash_counts.size();
+        populate_facet_stats(a_facet, a_facet.result_map.size(), facet_result);
         result["facet_counts"].push_back(facet_result);
     }
 
@@ -2238,10 +2320,9 @@ Option<nlohmann::json> Collection::get(const std::string & id) const {
     }
 
     nlohmann::json document;
-    try {
-        document = nlohmann::json::parse(parsed_document);
-    } catch(...) {
-        return Option<nlohmann::json>(500, "Error while parsing stored document.");
+    auto decode_op = DocumentCodec::decode(parsed_document, document);
+    if(!decode_op.ok()) {
+        return Option<nlohmann::json>(decode_op.code(), decode_op.error());
     }
 
     return Option<nlohmann::json>(document);
@@ -2290,10 +2371,9 @@ Option<std::string> Collection::remove(const std::string & id, const bool remove
     }
 
     nlohmann::json document;
-    try {
-        document = nlohmann::json::parse(parsed_document);
-    } catch(...) {
-        return Option<std::string>(500, "Error while parsing stored document.");
+    auto decode_op = DocumentCodec::decode(parsed_document, document);
+    if(!decode_op.ok()) {
+        return Option<std::string>(decode_op.code(), decode_op.error());
     }
 
     remove_document(document, seq_id, remove_from_store);
@@ -2314,10 +2394,9 @@ Option<bool> Collection::remove_if_found(uint32_t seq_id, const bool remove_from
     }
 
     nlohmann::json document;
-    try {
-        document = nlohmann::json::parse(parsed_document);
-    } catch(...) {
-        return Option<bool>(500, "Error while parsing stored document.");
+    auto decode_op = DocumentCodec::decode(parsed_document, document);
+    if(!decode_op.ok()) {
+        return Option<bool>(decode_op.code(), decode_op.error());
     }
 
     remove_document(document, seq_id, remove_from_store);
@@ -2469,9 +2548,7 @@ Option<bool> Collection::get_document_from_store(const uint32_t& seq_id, nlohman
         return Option<bool>(500, "Could not locate the JSON document for sequence ID: " + std::to_string(seq_id));
     }
 
-    try {
-        document = nlohmann::json::parse(json_doc_str);
-    } catch(...) {
+    if(!DocumentCodec::decode(json_doc_str, document).ok()) {
         return Option<bool>(500, "Error while parsing stored document with sequence ID: " + std::to_string(seq_id));
     }
 
@@ -2487,19 +2564,164 @@ Option<bool> Collection::get_document_from_store(const std::string &seq_id_key,
         return Option<bool>(500, "Could not locate the JSON document for sequence ID: " + seq_id);
     }
 
-    try {
-        document = nlohmann::json::parse(json_doc_str);
-    } catch(...) {
+    if(!DocumentCodec::decode(json_doc_str, document).ok()) {
+        return Option<bool>(500, "Error while parsing stored document with sequence ID: " + seq_id_key);
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> Collection::get_document_from_store(const std::string &seq_id_key, nlohmann::json & document,
+                                                 const spp::sparse_hash_set<std::string>& fields) const {
+    std::string doc_str;
+    StoreStatus doc_status = store->get(seq_id_key, doc_str);
+
+    if(doc_status != StoreStatus::FOUND) {
+        const std::string& seq_id = std::to_string(get_seq_id_from_key(seq_id_key));
+        return Option<bool>(500, "Could not locate the JSON document for sequence ID: " + seq_id);
+    }
+
+    if(!DocumentCodec::decode_fields(doc_str, fields, document).ok()) {
         return Option<bool>(500, "Error while parsing stored document with sequence ID: " + seq_id_key);
     }
 
     return Option<bool>(true);
 }
 
+document_format_t Collection::get_document_format() const {
+    std::shared_lock lock(mutex);
+    return document_format;
+}
+
+std::string Collection::serialize_document(const nlohmann::json& document) const {
+    std::string serialized;
+    DocumentCodec::encode(document, document_format, serialized);
+    return serialized;
+}
+
 const Index* Collection::_get_index() const {
     return index;
 }
 
+void Collection::select_top_facet_counts(const facet& a_facet, size_t k,
+                                         std::vector<std::pair<uint64_t, facet_count_t>>& top_facet_counts) {
+    top_facet_counts.clear();
+
+    if(k == 0) {
+        return ;
+    }
+
+    top_facet_counts.reserve(std::min(k, a_facet.result_map.size()));
+
+    // bounded heap whose front is the least frequent of the values selected so far
+    for(const auto& kv: a_facet.result_map) {
+        if(top_facet_counts.size() < k) {
+            top_facet_counts.emplace_back(kv);
+            std::push_heap(top_facet_counts.begin(), top_facet_counts.end(), Collection::facet_count_compare);
+            continue;
+        }
+
+        if(Collection::facet_count_compare(kv, top_facet_counts.front())) {
+            std::pop_heap(top_facet_counts.begin(), top_facet_counts.end(), Collection::facet_count_compare);
+            top_facet_counts.back() = kv;
+            std::push_heap(top_facet_counts.begin(), top_facet_counts.end(), Collection::facet_count_compare);
+        }
+    }
+
+    std::sort_heap(top_facet_counts.begin(), top_facet_counts.end(), Collection::facet_count_compare);
+}
+
+void Collection::populate_range_facet(const facet& a_facet, nlohmann::json& facet_result) {
+    size_t num_non_empty_ranges = 0;
+
+    // every range is returned in the requested order, so that they can be rendered as a histogram
+    for(size_t ri = 0; ri < a_facet.ranges.size(); ri++) {
+        nlohmann::json facet_value_count = nlohmann::json::object();
+        facet_value_count["value"] = a_facet.ranges[ri].label;
+        facet_value_count["highlighted"] = a_facet.ranges[ri].label;
+        facet_value_count["count"] = a_facet.range_counts[ri];
+        facet_result["counts"].push_back(facet_value_count);
+
+        num_non_empty_ranges += (a_facet.range_counts[ri] != 0);
+    }
+
+    populate_facet_stats(a_facet, num_non_empty_ranges, facet_result);
+}
+
+void Collection::populate_facet_stats(const facet& a_facet, size_t total_values, nlohmann::json& facet_result) {
+    // add facet value stats
+    facet_result["stats"] = nlohmann::json::object();
+    if(a_facet.stats.fvcount != 0) {
+        facet_result["stats"]["min"] = a_facet.stats.fvmin;
+        facet_result["stats"]["max"] = a_facet.stats.fvmax;
+        facet_result["stats"]["sum"] = a_facet.stats.fvsum;
+        facet_result["stats"]["avg"] = (a_facet.stats.fvsum / a_facet.stats.fvcount);
+    }
+
+    facet_result["stats"]["total_values"] = total_values;
+    facet_result["sampled"] = a_facet.sampled;
+}
+
+Option<bool> Collection::parse_facet_ranges(const std::string& ranges_str, const field& a_field,
+                                            std::vector<facet_range_t>& ranges) {
+    std::vector<std::string> range_strs;
+    StringUtils::split(ranges_str, range_strs, ",");
+
+    if(range_strs.empty()) {
+        return Option<bool>(400, "Facet field `" + a_field.name + "` must specify at least one range.");
+    }
+
+    for(const std::string& range_str: range_strs) {
+        // the separator is the first `-` that follows a number, or a leading `-` when the lower bound is left out
+        size_t separator_index = std::string::npos;
+
+        for(size_t i = 1; i < range_str.size(); i++) {
+            if(range_str[i] == '-' && (std::isdigit(range_str[i-1]) || range_str[i-1] == '.')) {
+                separator_index = i;
+                break;
+            }
+        }
+
+        if(separator_index == std::string::npos && !range_str.empty() && range_str[0] == '-') {
+            separator_index = 0;
+        }
+
+        if(separator_index == std::string::npos) {
+            return Option<bool>(400, "Facet range `" + range_str + "` must be in the `lower-upper` format.");
+        }
+
+        std::string bounds[2] = {range_str.substr(0, separator_index), range_str.substr(separator_index + 1)};
+        int64_t encoded_bounds[2] = {INT64_MIN, INT64_MAX};
+
+        for(size_t bi = 0; bi < 2; bi++) {
+            StringUtils::trim(bounds[bi]);
+
+            if(bounds[bi].empty()) {
+                continue;
+            }
+
+            if(a_field.is_float() && StringUtils::is_float(bounds[bi])) {
+                encoded_bounds[bi] = Index::float_to_in64_t(std::stof(bounds[bi]));
+            } else if(a_field.is_integer() && StringUtils::is_int64_t(bounds[bi])) {
+                encoded_bounds[bi] = std::stoll(bounds[bi]);
+            } else {
+                return Option<bool>(400, "Facet range `" + range_str + "` must have numerical bounds.");
+            }
+        }
+
+        if(encoded_bounds[0] >= encoded_bounds[1]) {
+            return Option<bool>(400, "Facet range `" + range_str + "` must have a lower bound that is less "
+                                     "than its upper bound.");
+        }
+
+        std::string label = range_str;
+        StringUtils::trim(label);
+        ranges.push_back(facet_range_t{label, encoded_bounds[0], encoded_bounds[1]});
+    }
+
+    return Option<bool>(true);
+}
+
 Option<bool> Collection::parse_pinned_hits(const std::string& pinned_hits_str,
                                            std::map<size_t, std::vector<std::string>>& pinned_hits) {
     if(!pinned_hits_str.empty()) {
@@ -2588,6 +2810,7 @@ Option<bool> Collection::persist_collection_meta() {
     collection_meta[COLLECTION_SEARCH_FIELDS_KEY] = fields_json;
     collection_meta[Collection::COLLECTION_DEFAULT_SORTING_FIELD_KEY] = default_sorting_field;
     collection_meta[Collection::COLLECTION_FALLBACK_FIELD_TYPE] = fallback_field_type;
+    collection_meta[Collection::COLLECTION_DOCUMENT_FORMAT] = DocumentCodec::format_name(document_format);
 
     bool persisted = store->insert(Collection::get_meta_key(name), collection_meta.dump());
     if(!persisted) {
@@ -2597,6 +2820,56 @@ Option<bool> Collection::persist_collection_meta() {
     return Option<bool>(true);
 }
 
+Option<bool> Collection::migrate_document_format() {
+    const std::string seq_id_prefix = get_seq_id_collection_prefix();
+    rocksdb::Iterator* iter = store->scan(seq_id_prefix);
+    std::unique_ptr<rocksdb::Iterator> iter_guard(iter);
+
+    const bool to_binary = (document_format == document_format_t::BINARY);
+    const size_t write_batch_size = 1000;
+
+    rocksdb::WriteBatch batch;
+    size_t num_batched = 0;
+    size_t num_migrated = 0;
+
+    while(iter->Valid() && iter->key().starts_with(seq_id_prefix)) {
+        const std::string& stored_doc = iter->value().ToString();
+
+        if(DocumentCodec::is_binary(stored_doc) != to_binary) {
+            nlohmann::json document;
+            auto decode_op = DocumentCodec::decode(stored_doc, document);
+            if(!decode_op.ok()) {
+                return decode_op;
+            }
+
+            batch.Put(iter->key(), serialize_document(document));
+            num_batched++;
+        }
+
+        if(num_batched == write_batch_size) {
+            if(!store->batch_write(batch)) {
+                return Option<bool>(500, "Could not write to on-disk storage.");
+            }
+
+            num_migrated += num_batched;
+            num_batched = 0;
+            batch.Clear();
+        }
+
+        iter->Next();
+    }
+
+    if(num_batched != 0 && !store->batch_write(batch)) {
+        return Option<bool>(500, "Could not write to on-disk storage.");
+    }
+
+    num_migrated += num_batched;
+    LOG(INFO) << "Migrated " << num_migrated << " documents of collection " << name << " to the "
+              << DocumentCodec::format_name(document_format) << " document format.";
+
+    return Option<bool>(true);
+}
+
 Option<bool> Collection::batch_alter_data(const std::unordered_map<std::string, field>& schema_additions,
                                           const std::unordered_map<std::string, field>& new_dynamic_fields,
                                           const std::vector<field>& del_fields,
@@ -2644,9 +2917,7 @@ Option<bool> Collection::batch_alter_data(const std::unordered_map<std::string,
 
         nlohmann::json document;
 
-        try {
-            document = nlohmann::json::parse(iter->value().ToString());
-        } catch(const std::exception& e) {
+        if(!DocumentCodec::decode(iter->value().ToString(), document).ok()) {
             return Option<bool>(false, "Bad JSON in document: " + document.dump(-1, ' ', false,
                                                                                 nlohmann::detail::error_handler_t::ignore));
         }
@@ -2721,6 +2992,37 @@ Option<bool> Collection::batch_alter_data(const std::unordered_map<std::string,
 Option<bool> Collection::alter(nlohmann::json& alter_payload) {
     std::unique_lock lock(mutex);
 
+    if(alter_payload.is_object() && alter_payload.contains(COLLECTION_DOCUMENT_FORMAT)) {
+        if(!alter_payload[COLLECTION_DOCUMENT_FORMAT].is_string()) {
+            return Option<bool>(400, std::string("`") + COLLECTION_DOCUMENT_FORMAT + "` should be a string.");
+        }
+
+        auto format_op = DocumentCodec::parse_format(alter_payload[COLLECTION_DOCUMENT_FORMAT].get<std::string>());
+        if(!format_op.ok()) {
+            return Option<bool>(format_op.code(), format_op.error());
+        }
+
+        alter_payload.erase(COLLECTION_DOCUMENT_FORMAT);
+
+        if(document_format != format_op.get()) {
+            document_format = format_op.get();
+
+            auto persist_op = persist_collection_meta();
+            if(!persist_op.ok()) {
+                return persist_op;
+            }
+
+            auto migrate_op = migrate_document_format();
+            if(!migrate_op.ok()) {
+                return migrate_op;
+            }
+        }
+
+        if(alter_payload.empty()) {
+            return Option<bool>(true);
+        }
+    }
+
     // Validate that all stored documents are compatible with the proposed schema changes.
     std::unordered_map<std::string, field> schema_additions;
     std::unordered_map<std::string, field> schema_reindex;
@@ -2931,9 +3233,7 @@ Option<bool> Collection::validate_alter_payload(nlohmann::json& schema_changes,
         const uint32_t seq_id = Collection::get_seq_id_from_key(iter->key().ToString());
         nlohmann::json document;
 
-        try {
-            document = nlohmann::json::parse(iter->value().ToString());
-        } catch(const std::exception& e) {
+        if(!DocumentCodec::decode(iter->value().ToString(), document).ok()) {
             return Option<bool>(false, "Bad JSON in document: " + document.dump(-1, ' ', false,
                                                                                 nlohmann::detail::error_handler_t::ignore));
         }
@@ -3152,6 +3452,10 @@ Index* Collection::init_index() {
 
     synonym_index = new SynonymIndex(store);
 
+    return create_index();
+}
+
+Index* Collection::create_index() const {
     return new Index(name+std::to_string(0),
                      collection_id,
                      store,
@@ -3161,6 +3465,67 @@ Index* Collection::init_index() {
                      symbols_to_index, token_separators);
 }
 
+uint64_t Collection::get_index_write_generation() const {
+    std::shared_lock lock(mutex);
+    return index->get_write_generation();
+}
+
+Option<bool> Collection::save_index_image(const std::string& image_path, uint64_t store_seq_number,
+                                          uint64_t write_generation) const {
+    std::shared_lock lock(mutex);
+
+    if(index->get_write_generation() != write_generation) {
+        return Option<bool>(409, "Collection has been written to since.");
+    }
+
+    index_image_writer_t writer(image_path);
+    if(!writer.ok()) {
+        return Option<bool>(500, "Could not open index image file for writing: " + image_path);
+    }
+
+    writer.write_value<uint64_t>(store_seq_number);
+    writer.write_value<uint32_t>(collection_id);
+    index->save_image(writer);
+
+    if(!writer.close()) {
+        return Option<bool>(500, "Error while writing index image file: " + image_path);
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> Collection::load_index_image(const std::string& image_path, uint64_t store_seq_number) {
+    std::unique_lock lock(mutex);
+
+    index_image_reader_t reader(image_path);
+    if(!reader.ok()) {
+        return Option<bool>(404, "Index image is missing or corrupt.");
+    }
+
+    uint64_t image_seq_number;
+    uint32_t image_collection_id;
+
+    if(!reader.read_value(image_seq_number) || !reader.read_value(image_collection_id)) {
+        return Option<bool>(500, "Index image is corrupt.");
+    }
+
+    if(image_seq_number != store_seq_number || image_collection_id != collection_id) {
+        return Option<bool>(409, "Index image is stale.");
+    }
+
+    auto load_op = index->load_image(reader);
+
+    if(!load_op.ok()) {
+        // discard whatever was partially restored
+        delete index;
+        index = create_index();
+        return load_op;
+    }
+
+    num_documents = index->num_seq_ids();
+    return Option<bool>(true);
+}
+
 DIRTY_VALUES Collection::parse_dirty_values_option(std::string& dirty_values) const {
     std::shared_lock lock(mutex);
 
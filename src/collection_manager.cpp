@@ -42,9 +42,12 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
             field_obj[fields::infix] = -1;
         }
 
+        const bool infix_fm = field::is_infix_fm(field_obj[fields::infix]);
+
         field f(field_obj[fields::name], field_obj[fields::type], field_obj[fields::facet],
                 field_obj[fields::optional], field_obj[fields::index], field_obj[fields::locale],
-                -1, field_obj[fields::infix]);
+                -1, infix_fm ? nlohmann::json(true) : field_obj[fields::infix]);
+        f.infix_fm = infix_fm;
 
         // value of `sort` depends on field type
         if(field_obj.count(fields::sort) == 0) {
@@ -80,6 +83,17 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
         token_separators = collection_meta[Collection::COLLECTION_SEPARATORS].get<std::vector<std::string>>();
     }
 
+    // collections created before the format could be chosen store their documents as JSON
+    document_format_t document_format = document_format_t::JSON;
+
+    if(collection_meta.count(Collection::COLLECTION_DOCUMENT_FORMAT) != 0) {
+        auto format_op = DocumentCodec::parse_format(
+            collection_meta[Collection::COLLECTION_DOCUMENT_FORMAT].get<std::string>());
+        if(format_op.ok()) {
+            document_format = format_op.get();
+        }
+    }
+
     LOG(INFO) << "Found collection " << this_collection_name << " with " << num_memory_shards << " memory shards.";
 
     Collection* collection = new Collection(this_collection_name,
@@ -92,7 +106,8 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
                                             max_memory_ratio,
                                             fallback_field_type,
                                             symbols_to_index,
-                                            token_separators);
+                                            token_separators,
+                                            document_format);
 
     return collection;
 }
@@ -127,10 +142,14 @@ void CollectionManager::init(Store *store, const float max_memory_ratio, const s
     init(store, thread_pool, max_memory_ratio, auth_key, quit, nullptr);
 }
 
-Option<bool> CollectionManager::load(const size_t collection_batch_size, const size_t document_batch_size) {
+Option<bool> CollectionManager::load(const size_t collection_batch_size, const size_t document_batch_size,
+                                     const std::string& index_image_dir) {
     // This function must be idempotent, i.e. when called multiple times, must produce the same state without leaks
     LOG(INFO) << "CollectionManager::load()";
 
+    // index images are usable only if the store has not changed since they were written
+    const uint64_t store_seq_number = store->get_latest_seq_number();
+
     Option<bool> auth_init_op = auth_manager.init(store, bootstrap_auth_key);
     if(!auth_init_op.ok()) {
         LOG(ERROR) << "Auth manager init failed, error=" << auth_init_op.error();
@@ -175,10 +194,12 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
 
         auto captured_store = store;
         loading_pool.enqueue([captured_store, num_collections, collection_meta, document_batch_size,
-                              &m_process, &cv_process, &num_processed, &next_coll_id_status, quit = quit]() {
+                              &m_process, &cv_process, &num_processed, &next_coll_id_status, quit = quit,
+                              &index_image_dir, store_seq_number]() {
 
             //auto begin = std::chrono::high_resolution_clock::now();
-            Option<bool> res = load_collection(collection_meta, document_batch_size, next_coll_id_status, *quit);
+            Option<bool> res = load_collection(collection_meta, document_batch_size, next_coll_id_status, *quit,
+                                               index_image_dir, store_seq_number);
             /*long long int timeMillis =
                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - begin).count();
             LOG(INFO) << "Time taken for indexing: " << timeMillis << "ms";*/
@@ -291,7 +312,8 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
                                                          const uint64_t created_at,
                                                          const std::string& fallback_field_type,
                                                          const std::vector<std::string>& symbols_to_index,
-                                                         const std::vector<std::string>& token_separators) {
+                                                         const std::vector<std::string>& token_separators,
+                                                         const std::string& document_format) {
 
     if(store->contains(Collection::get_meta_key(name))) {
         return Option<Collection*>(409, std::string("A collection with name `") + name + "` already exists.");
@@ -305,6 +327,11 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
         }
     }
 
+    auto document_format_op = DocumentCodec::parse_format(document_format);
+    if(!document_format_op.ok()) {
+        return Option<Collection*>(document_format_op.code(), document_format_op.error());
+    }
+
     nlohmann::json fields_json = nlohmann::json::array();;
 
     Option<bool> fields_json_op = field::fields_to_json_fields(fields, default_sorting_field, fields_json);
@@ -323,11 +350,13 @@ Option<Collection*> CollectionManager::create_collection(const std::string& name
     collection_meta[Collection::COLLECTION_FALLBACK_FIELD_TYPE] = fallback_field_type;
     collection_meta[Collection::COLLECTION_SYMBOLS_TO_INDEX] = symbols_to_index;
     collection_meta[Collection::COLLECTION_SEPARATORS] = token_separators;
+    collection_meta[Collection::COLLECTION_DOCUMENT_FORMAT] = document_format;
 
     Collection* new_collection = new Collection(name, next_collection_id, created_at, 0, store, fields,
                                                 default_sorting_field,
                                                 this->max_memory_ratio, fallback_field_type,
-                                                symbols_to_index, token_separators);
+                                                symbols_to_index, token_separators,
+                                                document_format_op.get());
     next_collection_id++;
 
     rocksdb::WriteBatch batch;
@@ -600,6 +629,8 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     const char *FACET_BY = "facet_by";
     const char *FACET_QUERY = "facet_query";
     const char *FACET_QUERY_NUM_TYPOS = "facet_query_num_typos";
+    const char *FACET_SAMPLE_PERCENT = "facet_sample_percent";
+    const char *FACET_SAMPLE_THRESHOLD = "facet_sample_threshold";
     const char *MAX_FACET_VALUES = "max_facet_values";
 
     const char *GROUP_BY = "group_by";
@@ -642,6 +673,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
 
     const char *SEARCH_CUTOFF_MS = "search_cutoff_ms";
     const char *EXHAUSTIVE_SEARCH = "exhaustive_search";
+    const char *MAX_SCORE_PRUNING = "max_score_pruning";
     const char *SPLIT_JOIN_TOKENS = "split_join_tokens";
 
     // enrich params with values from embedded params
@@ -694,6 +726,8 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     size_t max_facet_values = 10;
     std::string simple_facet_query;
     size_t facet_query_num_typos = 2;
+    size_t facet_sample_percent = 100;
+    size_t facet_sample_threshold = 0;
     size_t snippet_threshold = 30;
     size_t highlight_affix_num_tokens = 4;
     std::string highlight_full_fields;
@@ -712,6 +746,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     size_t filter_curated_hits_option = 2;
     std::string highlight_fields;
     bool exhaustive_search = false;
+    bool max_score_pruning = false;
     size_t search_cutoff_ms = 3600000;
     enable_t split_join_tokens = fallback;
     size_t max_candidates = 0;
@@ -736,6 +771,8 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {MAX_EXTRA_SUFFIX, &max_extra_suffix},
         {MAX_CANDIDATES, &max_candidates},
         {FACET_QUERY_NUM_TYPOS, &facet_query_num_typos},
+        {FACET_SAMPLE_PERCENT, &facet_sample_percent},
+        {FACET_SAMPLE_THRESHOLD, &facet_sample_threshold},
         {FILTER_CURATED_HITS, &filter_curated_hits_option},
     };
 
@@ -755,12 +792,12 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {PRIORITIZE_TOKEN_POSITION, &prioritize_token_position},
         {PRE_SEGMENTED_QUERY, &pre_segmented_query},
         {EXHAUSTIVE_SEARCH, &exhaustive_search},
+        {MAX_SCORE_PRUNING, &max_score_pruning},
         {ENABLE_OVERRIDES, &enable_overrides},
     };
 
     std::unordered_map<std::string, std::vector<std::string>*> str_list_values = {
         {QUERY_BY, &search_fields},
-        {FACET_BY, &facet_fields},
         {GROUP_BY, &group_by_fields},
         {INCLUDE_FIELDS, &include_fields_vec},
         {EXCLUDE_FIELDS, &exclude_fields_vec},
@@ -788,6 +825,11 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
             }
         }
 
+        else if(key == FACET_BY) {
+            // range facets hold comma separated ranges within parentheses
+            StringUtils::split_facet_fields(val, facet_fields);
+        }
+
         else if(key == SPLIT_JOIN_TOKENS) {
             if(val == "false") {
                 split_join_tokens = off;
@@ -919,7 +961,10 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
                                                           max_extra_suffix,
                                                           facet_query_num_typos,
                                                           filter_curated_hits_option,
-                                                          prioritize_token_position
+                                                          prioritize_token_position,
+                                                          max_score_pruning,
+                                                          facet_sample_percent,
+                                                          facet_sample_threshold
                                                         );
 
     uint64_t timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -969,6 +1014,7 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
     const char* SYMBOLS_TO_INDEX = "symbols_to_index";
     const char* TOKEN_SEPARATORS = "token_separators";
     const char* DEFAULT_SORTING_FIELD = "default_sorting_field";
+    const char* DOCUMENT_FORMAT = Collection::COLLECTION_DOCUMENT_FORMAT;
 
     // validate presence of mandatory fields
 
@@ -992,6 +1038,10 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
         req_json[TOKEN_SEPARATORS] = std::vector<std::string>();
     }
 
+    if(req_json.count(DOCUMENT_FORMAT) == 0) {
+        req_json[DOCUMENT_FORMAT] = DocumentCodec::JSON_FORMAT;
+    }
+
     if(req_json.count("fields") == 0) {
         return Option<Collection*>(400, "Parameter `fields` is required.");
     }
@@ -1009,6 +1059,10 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
         return Option<Collection*>(400, std::string("`") + NUM_MEMORY_SHARDS + "` should be a positive integer.");
     }
 
+    if(!req_json[DOCUMENT_FORMAT].is_string()) {
+        return Option<Collection*>(400, std::string("`") + DOCUMENT_FORMAT + "` should be a string.");
+    }
+
     if(!req_json[SYMBOLS_TO_INDEX].is_array()) {
         return Option<Collection*>(400, std::string("`") + SYMBOLS_TO_INDEX + "` should be an array of character symbols.");
     }
@@ -1057,13 +1111,16 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
                                                                 fields, default_sorting_field, created_at,
                                                                 fallback_field_type,
                                                                 req_json[SYMBOLS_TO_INDEX],
-                                                                req_json[TOKEN_SEPARATORS]);
+                                                                req_json[TOKEN_SEPARATORS],
+                                                                req_json[DOCUMENT_FORMAT]);
 }
 
 Option<bool> CollectionManager::load_collection(const nlohmann::json &collection_meta,
                                                 const size_t batch_size,
                                                 const StoreStatus& next_coll_id_status,
-                                                const std::atomic<bool>& quit) {
+                                                const std::atomic<bool>& quit,
+                                                const std::string& index_image_dir,
+                                                const uint64_t store_seq_number) {
 
     auto& cm = CollectionManager::get_instance();
 
@@ -1138,6 +1195,21 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
         collection->add_synonym(synonym);
     }
 
+    if(!index_image_dir.empty()) {
+        const std::string& image_path = get_index_image_path(index_image_dir, collection->get_collection_id());
+        auto image_op = collection->load_index_image(image_path, store_seq_number);
+
+        if(image_op.ok()) {
+            cm.add_to_collections(collection);
+            LOG(INFO) << "Restored " << collection->get_num_documents() << " documents into collection "
+                      << collection->get_name() << " from index image.";
+            return Option<bool>(true);
+        }
+
+        LOG(INFO) << "Could not restore collection " << collection->get_name() << " from index image: "
+                  << image_op.error() << " Indexing its documents.";
+    }
+
     // Fetch records from the store and re-create memory index
     const std::string seq_id_prefix = collection->get_seq_id_collection_prefix();
 
@@ -1158,10 +1230,9 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
 
         nlohmann::json document;
 
-        try {
-            document = nlohmann::json::parse(iter->value().ToString());
-        } catch(const std::exception& e) {
-            LOG(ERROR) << "JSON error: " << e.what();
+        auto decode_op = DocumentCodec::decode(iter->value().ToString(), document);
+        if(!decode_op.ok()) {
+            LOG(ERROR) << "Document decode error: " << decode_op.error();
             return Option<bool>(false, "Bad JSON.");
         }
 
@@ -1216,6 +1287,50 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
     return Option<bool>(true);
 }
 
+std::string CollectionManager::get_index_image_path(const std::string& index_image_dir, uint32_t collection_id) {
+    return index_image_dir + "/" + std::to_string(collection_id) + ".idx";
+}
+
+Option<bool> CollectionManager::save_index_images(const std::string& index_image_dir) const {
+    return save_index_images(index_image_dir, store->get_latest_seq_number(), get_index_write_generations());
+}
+
+std::map<uint32_t, uint64_t> CollectionManager::get_index_write_generations() const {
+    std::map<uint32_t, uint64_t> write_generations;
+
+    for(Collection* collection: get_collections()) {
+        write_generations.emplace(collection->get_collection_id(), collection->get_index_write_generation());
+    }
+
+    return write_generations;
+}
+
+Option<bool> CollectionManager::save_index_images(const std::string& index_image_dir, uint64_t store_seq_number,
+                                                  const std::map<uint32_t, uint64_t>& write_generations) const {
+    for(const auto& id_generation: write_generations) {
+        // holds off a drop of the collection while its image is written
+        auto collection = get_collection_with_id(id_generation.first);
+        if(collection == nullptr) {
+            continue;
+        }
+
+        const std::string& image_path = get_index_image_path(index_image_dir, id_generation.first);
+        auto save_op = collection->save_index_image(image_path, store_seq_number, id_generation.second);
+
+        if(save_op.code() == 409) {
+            LOG(INFO) << "Skipping index image of collection " << collection->get_name() << ": "
+                      << save_op.error();
+            continue;
+        }
+
+        if(!save_op.ok()) {
+            return save_op;
+        }
+    }
+
+    return Option<bool>(true);
+}
+
 spp::sparse_hash_map<std::string, nlohmann::json> CollectionManager::get_presets() const {
     std::shared_lock lock(mutex);
     return preset_configs;
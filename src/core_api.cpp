@@ -260,6 +260,28 @@ bool post_health(const std::shared_ptr<http_req>& req, const std::shared_ptr<htt
     return alive;
 }
 
+static void get_thread_pool_metrics(const ThreadPool* thread_pool, const std::string& prefix, nlohmann::json& result) {
+    if(thread_pool == nullptr) {
+        return ;
+    }
+
+    const ThreadPool::stats_t stats = thread_pool->get_stats();
+    result[prefix + "threads"] = std::to_string(stats.num_threads);
+    result[prefix + "queued_tasks"] = std::to_string(stats.num_queued);
+    result[prefix + "executed_tasks"] = std::to_string(stats.num_executed);
+    result[prefix + "stolen_tasks"] = std::to_string(stats.num_stolen);
+    result[prefix + "helped_tasks"] = std::to_string(stats.num_helped);
+
+    const char* lane_names[ThreadPool::NUM_LANES] = {"search", "write", "admin"};
+
+    for(size_t i = 0; i < ThreadPool::NUM_LANES; i++) {
+        const std::string lane_prefix = prefix + lane_names[i] + "_lane_";
+        result[lane_prefix + "queued_tasks"] = std::to_string(stats.lanes[i].num_queued);
+        result[lane_prefix + "running_tasks"] = std::to_string(stats.lanes[i].num_running);
+        result[lane_prefix + "executed_tasks"] = std::to_string(stats.lanes[i].num_executed);
+    }
+}
+
 bool get_metrics_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     nlohmann::json result;
 
@@ -269,6 +291,9 @@ bool get_metrics_json(const std::shared_ptr<http_req>& req, const std::shared_pt
     SystemMetrics sys_metrics;
     sys_metrics.get(data_dir_path, result);
 
+    get_thread_pool_metrics(collectionManager.get_thread_pool(), "typesense_app_thread_pool_", result);
+    get_thread_pool_metrics(server->get_thread_pool(), "typesense_server_thread_pool_", result);
+
     res->set_body(200, result.dump(2));
     return true;
 }
@@ -628,31 +653,54 @@ bool get_export_documents(const std::shared_ptr<http_req>& req, const std::share
         rocksdb::Iterator* it = export_state->it;
 
         if(it->Valid() && it->key().ToString().compare(0, seq_id_prefix.size(), seq_id_prefix) == 0) {
+            bool decoded = true;
+            std::string decode_error;
+
             if(export_state->include_fields.empty() && export_state->exclude_fields.empty()) {
-                res->body = it->value().ToString();
+                auto json_op = DocumentCodec::to_json_string(it->value().ToString(), res->body);
+                if(!json_op.ok()) {
+                    decoded = false;
+                    decode_error = json_op.error();
+                }
             } else {
-                nlohmann::json doc = nlohmann::json::parse(it->value().ToString());
-                nlohmann::json filtered_doc;
-                for(const auto& kv: doc.items()) {
-                    bool must_include = export_state->include_fields.empty() ||
-                                        (export_state->include_fields.count(kv.key()) != 0);
+                nlohmann::json doc;
+                auto decode_op = DocumentCodec::decode(it->value().ToString(), doc);
+
+                if(!decode_op.ok()) {
+                    decoded = false;
+                    decode_error = decode_op.error();
+                } else {
+                    nlohmann::json filtered_doc;
+                    for(const auto& kv: doc.items()) {
+                        bool must_include = export_state->include_fields.empty() ||
+                                            (export_state->include_fields.count(kv.key()) != 0);
 
-                    bool must_exclude = !export_state->exclude_fields.empty() &&
-                                        (export_state->exclude_fields.count(kv.key()) != 0);
+                        bool must_exclude = !export_state->exclude_fields.empty() &&
+                                            (export_state->exclude_fields.count(kv.key()) != 0);
 
-                    if(must_include && !must_exclude) {
-                        filtered_doc[kv.key()] = kv.value();
+                        if(must_include && !must_exclude) {
+                            filtered_doc[kv.key()] = kv.value();
+                        }
                     }
+
+                    res->body = filtered_doc.dump();
                 }
+            }
 
-                res->body = filtered_doc.dump();
+            if(!decoded) {
+                // skip the document, instead of sending the body of the previous chunk again
+                LOG(ERROR) << "Skipping export of document with key " << it->key().ToString()
+                           << ", error: " << decode_error;
+                res->body.clear();
             }
 
             it->Next();
 
             // append a new line character if there is going to be one more record to send
             if(it->Valid() && it->key().ToString().compare(0, seq_id_prefix.size(), seq_id_prefix) == 0) {
-                res->body += "\n";
+                if(!res->body.empty()) {
+                    res->body += "\n";
+                }
                 req->last_chunk_aggregate = false;
                 res->final = false;
             } else {
@@ -695,7 +743,7 @@ bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shar
     const char *RETURN_ID = "return_id";
 
     if(req->params.count(BATCH_SIZE) == 0) {
-        req->params[BATCH_SIZE] = "40";
+        req->params[BATCH_SIZE] = std::to_string(Collection::DEFAULT_APPLY_BATCH_SIZE);
     }
 
     if(req->params.count(ACTION) == 0) {
@@ -820,8 +868,10 @@ bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shar
         const auto& dirty_values = collection->parse_dirty_values_option(req->params[DIRTY_VALUES]);
         const bool& return_res = req->params[RETURN_RES] == "true";
         const bool& return_id = req->params[RETURN_ID] == "true";
+        // documents become visible to searches `batch_size` documents at a time, so a search that runs during an
+        // import can find some of the documents of a request but not the others
         nlohmann::json json_res = collection->add_many(json_lines, document, operation, "",
-                                                       dirty_values, return_res, return_id);
+                                                       dirty_values, return_res, return_id, IMPORT_BATCH_SIZE);
         //const std::string& import_summary_json = json_res->dump();
         //response_stream << import_summary_json << "\n";
 
@@ -0,0 +1,247 @@
+#include "document_codec.h"
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+Option<document_format_t> DocumentCodec::parse_format(const std::string& format_name) {
+    if(format_name == JSON_FORMAT) {
+        return Option<document_format_t>(document_format_t::JSON);
+    }
+
+    if(format_name == BINARY_FORMAT) {
+        return Option<document_format_t>(document_format_t::BINARY);
+    }
+
+    return Option<document_format_t>(400, std::string("Document format must be either `") + JSON_FORMAT +
+                                          "` or `" + BINARY_FORMAT + "`.");
+}
+
+const char* DocumentCodec::format_name(document_format_t format) {
+    return (format == document_format_t::BINARY) ? BINARY_FORMAT : JSON_FORMAT;
+}
+
+bool DocumentCodec::is_binary(const std::string& serialized) {
+    return !serialized.empty() && serialized[0] == BINARY_MARKER;
+}
+
+void DocumentCodec::encode(const nlohmann::json& document, document_format_t format, std::string& serialized) {
+    if(format == document_format_t::JSON || !document.is_object()) {
+        serialized = document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+        return ;
+    }
+
+    const uint32_t num_fields = document.size();
+    std::vector<entry_t> entries;
+    entries.reserve(num_fields);
+
+    std::vector<uint8_t> data;
+
+    // object keys are iterated in sorted order, so the table can be binary searched
+    for(auto it = document.begin(); it != document.end(); ++it) {
+        entry_t entry{};
+        entry.name_offset = data.size();
+        entry.name_len = it.key().size();
+        data.insert(data.end(), it.key().begin(), it.key().end());
+
+        entry.value_offset = data.size();
+        nlohmann::json::to_msgpack(it.value(), data);
+        entry.value_len = data.size() - entry.value_offset;
+
+        entries.push_back(entry);
+    }
+
+    serialized.clear();
+    serialized.reserve(HEADER_SIZE + num_fields * sizeof(entry_t) + data.size());
+
+    serialized.push_back(BINARY_MARKER);
+    serialized.push_back(char(BINARY_VERSION));
+    serialized.append(reinterpret_cast<const char*>(&num_fields), sizeof(num_fields));
+
+    for(const auto& entry: entries) {
+        serialized.append(reinterpret_cast<const char*>(&entry.name_offset), sizeof(uint32_t));
+        serialized.append(reinterpret_cast<const char*>(&entry.name_len), sizeof(uint32_t));
+        serialized.append(reinterpret_cast<const char*>(&entry.value_offset), sizeof(uint32_t));
+        serialized.append(reinterpret_cast<const char*>(&entry.value_len), sizeof(uint32_t));
+    }
+
+    serialized.append(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+bool DocumentCodec::read_header(const std::string& serialized, uint32_t& num_fields) {
+    if(serialized.size() < HEADER_SIZE || uint8_t(serialized[1]) != BINARY_VERSION) {
+        return false;
+    }
+
+    memcpy(&num_fields, serialized.data() + 2, sizeof(num_fields));
+    return serialized.size() >= HEADER_SIZE + uint64_t(num_fields) * sizeof(entry_t);
+}
+
+DocumentCodec::entry_t DocumentCodec::read_entry(const std::string& serialized, uint32_t index) {
+    const char* entry_ptr = serialized.data() + HEADER_SIZE + size_t(index) * sizeof(entry_t);
+
+    entry_t entry{};
+    memcpy(&entry.name_offset, entry_ptr, sizeof(uint32_t));
+    memcpy(&entry.name_len, entry_ptr + 4, sizeof(uint32_t));
+    memcpy(&entry.value_offset, entry_ptr + 8, sizeof(uint32_t));
+    memcpy(&entry.value_len, entry_ptr + 12, sizeof(uint32_t));
+    return entry;
+}
+
+bool DocumentCodec::is_valid_entry(const std::string& serialized, uint32_t num_fields, const entry_t& entry) {
+    const uint64_t data_size = serialized.size() - HEADER_SIZE - uint64_t(num_fields) * sizeof(entry_t);
+    return uint64_t(entry.name_offset) + entry.name_len <= data_size &&
+           uint64_t(entry.value_offset) + entry.value_len <= data_size;
+}
+
+Option<bool> DocumentCodec::decode_value(const std::string& serialized, uint32_t num_fields, const entry_t& entry,
+                                         nlohmann::json& value) {
+    const auto data = reinterpret_cast<const uint8_t*>(serialized.data()) + HEADER_SIZE +
+                      size_t(num_fields) * sizeof(entry_t);
+
+    try {
+        value = nlohmann::json::from_msgpack(data + entry.value_offset, data + entry.value_offset + entry.value_len);
+    } catch(...) {
+        return Option<bool>(500, "Error while decoding stored document.");
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> DocumentCodec::decode(const std::string& serialized, nlohmann::json& document) {
+    if(!is_binary(serialized)) {
+        try {
+            document = nlohmann::json::parse(serialized);
+        } catch(...) {
+            return Option<bool>(500, "Error while parsing stored document.");
+        }
+
+        return Option<bool>(true);
+    }
+
+    uint32_t num_fields;
+    if(!read_header(serialized, num_fields)) {
+        return Option<bool>(500, "Error while decoding stored document.");
+    }
+
+    const char* data = serialized.data() + HEADER_SIZE + size_t(num_fields) * sizeof(entry_t);
+    document = nlohmann::json::object();
+
+    for(uint32_t i = 0; i < num_fields; i++) {
+        const entry_t entry = read_entry(serialized, i);
+        if(!is_valid_entry(serialized, num_fields, entry)) {
+            return Option<bool>(500, "Error while decoding stored document.");
+        }
+
+        auto decode_op = decode_value(serialized, num_fields, entry,
+                                      document[std::string(data + entry.name_offset, entry.name_len)]);
+        if(!decode_op.ok()) {
+            return decode_op;
+        }
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> DocumentCodec::decode_fields(const std::string& serialized,
+                                          const spp::sparse_hash_set<std::string>& fields,
+                                          nlohmann::json& document) {
+    if(!is_binary(serialized)) {
+        auto decode_op = decode(serialized, document);
+        if(!decode_op.ok()) {
+            return decode_op;
+        }
+
+        for(auto it = document.begin(); it != document.end(); ) {
+            if(fields.count(it.key()) == 0) {
+                it = document.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        return Option<bool>(true);
+    }
+
+    document = nlohmann::json::object();
+
+    for(const auto& field_name: fields) {
+        nlohmann::json value;
+        auto decode_op = decode_field(serialized, field_name, value);
+
+        if(!decode_op.ok()) {
+            return decode_op;
+        }
+
+        if(decode_op.get()) {
+            document[field_name] = std::move(value);
+        }
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> DocumentCodec::decode_field(const std::string& serialized, const std::string& field_name,
+                                         nlohmann::json& value) {
+    if(!is_binary(serialized)) {
+        nlohmann::json document;
+        auto decode_op = decode(serialized, document);
+        if(!decode_op.ok()) {
+            return decode_op;
+        }
+
+        auto it = document.find(field_name);
+        if(it == document.end()) {
+            return Option<bool>(false);
+        }
+
+        value = std::move(*it);
+        return Option<bool>(true);
+    }
+
+    uint32_t num_fields;
+    if(!read_header(serialized, num_fields)) {
+        return Option<bool>(500, "Error while decoding stored document.");
+    }
+
+    const char* data = serialized.data() + HEADER_SIZE + size_t(num_fields) * sizeof(entry_t);
+    uint32_t low = 0, high = num_fields;
+
+    while(low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        const entry_t entry = read_entry(serialized, mid);
+
+        if(!is_valid_entry(serialized, num_fields, entry)) {
+            return Option<bool>(500, "Error while decoding stored document.");
+        }
+
+        const int cmp = std::string_view(data + entry.name_offset, entry.name_len).compare(field_name);
+
+        if(cmp == 0) {
+            return decode_value(serialized, num_fields, entry, value);
+        }
+
+        if(cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return Option<bool>(false);
+}
+
+Option<bool> DocumentCodec::to_json_string(const std::string& serialized, std::string& json_str) {
+    if(!is_binary(serialized)) {
+        json_str = serialized;
+        return Option<bool>(true);
+    }
+
+    nlohmann::json document;
+    auto decode_op = decode(serialized, document);
+    if(!decode_op.ok()) {
+        return decode_op;
+    }
+
+    json_str = document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+    return Option<bool>(true);
+}
@@ -0,0 +1,223 @@
+#include "facet_index.h"
+
+uint32_t facet_index_t::acquire_ordinal(uint64_t hash) {
+    const auto ordinal_it = hash_ordinals.find(hash);
+
+    if(ordinal_it != hash_ordinals.end()) {
+        ordinal_refs[ordinal_it->second]++;
+        return ordinal_it->second;
+    }
+
+    uint32_t ordinal;
+
+    if(!free_ordinals.empty()) {
+        ordinal = free_ordinals.back();
+        free_ordinals.pop_back();
+        ordinal_hashes[ordinal] = hash;
+        ordinal_refs[ordinal] = 1;
+    } else {
+        ordinal = ordinal_hashes.size();
+        ordinal_hashes.push_back(hash);
+        ordinal_refs.push_back(1);
+    }
+
+    hash_ordinals.emplace(hash, ordinal);
+    return ordinal;
+}
+
+void facet_index_t::release_ordinal(uint32_t ordinal) {
+    if(--ordinal_refs[ordinal] != 0) {
+        return ;
+    }
+
+    hash_ordinals.erase(ordinal_hashes[ordinal]);
+    free_ordinals.push_back(ordinal);
+}
+
+void facet_index_t::upsert(uint32_t seq_id, const uint64_t* hashes, uint32_t num_hashes) {
+    erase(seq_id);
+
+    if(num_hashes == 0) {
+        return ;
+    }
+
+    if(!multi_valued) {
+        if(seq_id >= doc_ordinals.size()) {
+            doc_ordinals.resize(seq_id + 1, EMPTY);
+        }
+
+        doc_ordinals[seq_id] = acquire_ordinal(hashes[0]);
+        num_docs++;
+        return ;
+    }
+
+    if(seq_id >= doc_lengths.size()) {
+        doc_offsets.resize(seq_id + 1, 0);
+        doc_lengths.resize(seq_id + 1, 0);
+    }
+
+    doc_offsets[seq_id] = values.size();
+    doc_lengths[seq_id] = num_hashes;
+
+    for(uint32_t i = 0; i < num_hashes; i++) {
+        values.push_back(acquire_ordinal(hashes[i]));
+    }
+
+    num_docs++;
+}
+
+void facet_index_t::erase(uint32_t seq_id) {
+    if(!multi_valued) {
+        if(seq_id >= doc_ordinals.size() || doc_ordinals[seq_id] == EMPTY) {
+            return ;
+        }
+
+        release_ordinal(doc_ordinals[seq_id]);
+        doc_ordinals[seq_id] = EMPTY;
+        num_docs--;
+        return ;
+    }
+
+    if(seq_id >= doc_lengths.size() || doc_lengths[seq_id] == 0) {
+        return ;
+    }
+
+    const uint32_t offset = doc_offsets[seq_id];
+    const uint32_t length = doc_lengths[seq_id];
+
+    for(uint32_t i = offset; i < offset + length; i++) {
+        release_ordinal(values[i]);
+    }
+
+    doc_offsets[seq_id] = 0;
+    doc_lengths[seq_id] = 0;
+    num_garbage_values += length;
+    num_docs--;
+
+    if(num_garbage_values > values.size() / 2) {
+        compact();
+    }
+}
+
+void facet_index_t::compact() {
+    std::vector<uint32_t> compacted_values;
+    compacted_values.reserve(values.size() - num_garbage_values);
+
+    for(size_t seq_id = 0; seq_id < doc_lengths.size(); seq_id++) {
+        const uint32_t offset = doc_offsets[seq_id];
+        const uint32_t length = doc_lengths[seq_id];
+
+        doc_offsets[seq_id] = compacted_values.size();
+        compacted_values.insert(compacted_values.end(), values.begin() + offset, values.begin() + offset + length);
+    }
+
+    values = std::move(compacted_values);
+    num_garbage_values = 0;
+}
+
+size_t facet_index_t::num_distinct_values() const {
+    return hash_ordinals.size();
+}
+
+size_t facet_index_t::size() const {
+    return num_docs;
+}
+
+void facet_index_t::save(index_image_writer_t& writer) const {
+    writer.write_value<uint8_t>(multi_valued);
+
+    writer.write_value<uint32_t>(ordinal_hashes.size());
+    writer.write(ordinal_hashes.data(), sizeof(uint64_t) * ordinal_hashes.size());
+
+    if(!multi_valued) {
+        writer.write_ids(doc_ordinals.data(), doc_ordinals.size());
+        return ;
+    }
+
+    // values are written out compacted, in the order of the documents
+    std::vector<uint32_t> compacted_values;
+    compacted_values.reserve(values.size() - num_garbage_values);
+
+    for(size_t seq_id = 0; seq_id < doc_lengths.size(); seq_id++) {
+        const auto values_begin = values.begin() + doc_offsets[seq_id];
+        compacted_values.insert(compacted_values.end(), values_begin, values_begin + doc_lengths[seq_id]);
+    }
+
+    writer.write_ids(doc_lengths.data(), doc_lengths.size());
+    writer.write_ids(compacted_values.data(), compacted_values.size());
+}
+
+bool facet_index_t::load(index_image_reader_t& reader) {
+    uint8_t image_multi_valued;
+    uint32_t num_image_ordinals;
+
+    if(!reader.read_value(image_multi_valued) || bool(image_multi_valued) != multi_valued ||
+       !reader.read_value(num_image_ordinals)) {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < num_image_ordinals; i++) {
+        uint64_t hash;
+        if(!reader.read_value(hash)) {
+            return false;
+        }
+
+        ordinal_hashes.push_back(hash);
+    }
+
+    ordinal_refs.resize(num_image_ordinals, 0);
+
+    if(!multi_valued) {
+        if(!reader.read_ids(doc_ordinals)) {
+            return false;
+        }
+
+        for(uint32_t ordinal: doc_ordinals) {
+            if(ordinal == EMPTY) {
+                continue;
+            }
+
+            if(ordinal >= num_image_ordinals) {
+                return false;
+            }
+
+            ordinal_refs[ordinal]++;
+            num_docs++;
+        }
+    } else {
+        if(!reader.read_ids(doc_lengths) || !reader.read_ids(values)) {
+            return false;
+        }
+
+        doc_offsets.resize(doc_lengths.size(), 0);
+        uint64_t offset = 0;
+
+        for(size_t seq_id = 0; seq_id < doc_lengths.size(); seq_id++) {
+            doc_offsets[seq_id] = offset;
+            offset += doc_lengths[seq_id];
+            num_docs += (doc_lengths[seq_id] != 0);
+        }
+
+        if(offset != values.size()) {
+            return false;
+        }
+
+        for(uint32_t ordinal: values) {
+            if(ordinal >= num_image_ordinals) {
+                return false;
+            }
+
+            ordinal_refs[ordinal]++;
+        }
+    }
+
+    for(uint32_t ordinal = 0; ordinal < num_image_ordinals; ordinal++) {
+        if(ordinal_refs[ordinal] == 0) {
+            free_ordinals.push_back(ordinal);
+        } else {
+            hash_ordinals.emplace(ordinal_hashes[ordinal], ordinal);
+        }
+    }
+
+    return true;
+}
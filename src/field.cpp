@@ -412,9 +412,11 @@ Option<bool> field::json_field_to_field(nlohmann::json& field_json, std::vector<
                                  field_json[fields::name].get<std::string>() + std::string("` should be a boolean."));
     }
 
-    if(field_json.count(fields::infix) != 0 && !field_json.at(fields::infix).is_boolean()) {
+    if(field_json.count(fields::infix) != 0 && !field_json.at(fields::infix).is_boolean() &&
+       !field::is_infix_fm(field_json.at(fields::infix))) {
         return Option<bool>(400, std::string("The `infix` property of the field `") +
-                                 field_json[fields::name].get<std::string>() + std::string("` should be a boolean."));
+                                 field_json[fields::name].get<std::string>() +
+                                 std::string("` should be a boolean or `") + fields::infix_fm + "`.");
     }
 
     if(field_json.count(fields::locale) != 0){
@@ -467,9 +469,12 @@ Option<bool> field::json_field_to_field(nlohmann::json& field_json, std::vector<
             return Option<bool>(400, "Field `.*` must be an index field.");
         }
 
+        const bool infix_fm = field::is_infix_fm(field_json[fields::infix]);
+
         field fallback_field(field_json["name"], field_json["type"], field_json["facet"],
                              field_json["optional"], field_json[fields::index], field_json[fields::locale],
-                             field_json[fields::sort], field_json[fields::infix]);
+                             field_json[fields::sort], infix_fm ? nlohmann::json(true) : field_json[fields::infix]);
+        fallback_field.infix_fm = infix_fm;
 
         if(fallback_field.has_valid_type()) {
             fallback_field_type = fallback_field.type;
@@ -514,11 +519,15 @@ Option<bool> field::json_field_to_field(nlohmann::json& field_json, std::vector<
         field_json[fields::optional] = is_dynamic;
     }
 
+    const bool infix_fm = field::is_infix_fm(field_json[fields::infix]);
+
     the_fields.emplace_back(
             field(field_json[fields::name], field_json[fields::type], field_json[fields::facet],
                   field_json[fields::optional], field_json[fields::index], field_json[fields::locale],
-                  field_json[fields::sort], field_json[fields::infix])
+                  field_json[fields::sort], infix_fm ? nlohmann::json(true) : field_json[fields::infix])
     );
 
+    the_fields.back().infix_fm = infix_fm;
+
     return Option<bool>(true);
 }
@@ -0,0 +1,430 @@
+#include "filter_iterator.h"
+#include <algorithm>
+#include "ids_t.h"
+#include "posting.h"
+
+size_t filter_iterator_t::uncompress(uint32_t** out) {
+    std::vector<uint32_t> ids;
+    ids.reserve(estimated_size());
+
+    while(valid()) {
+        ids.push_back(id());
+        next();
+    }
+
+    if(ids.empty()) {
+        *out = nullptr;
+        return 0;
+    }
+
+    *out = new uint32_t[ids.size()];
+    std::copy(ids.begin(), ids.end(), *out);
+    return ids.size();
+}
+
+/* array_filter_iterator_t */
+
+array_filter_iterator_t::array_filter_iterator_t(uint32_t* ids, size_t ids_length):
+        ids(ids), ids_length(ids_length) {
+
+}
+
+array_filter_iterator_t::~array_filter_iterator_t() {
+    delete [] ids;
+}
+
+bool array_filter_iterator_t::valid() const {
+    return index < ids_length;
+}
+
+uint32_t array_filter_iterator_t::id() const {
+    return ids[index];
+}
+
+void array_filter_iterator_t::next() {
+    index++;
+}
+
+void array_filter_iterator_t::skip_to(uint32_t id) {
+    if(index < ids_length && ids[index] < id) {
+        index = std::lower_bound(ids + index, ids + ids_length, id) - ids;
+    }
+}
+
+void array_filter_iterator_t::reset() {
+    index = 0;
+}
+
+size_t array_filter_iterator_t::estimated_size() const {
+    return ids_length;
+}
+
+/* ids_filter_iterator_t */
+
+ids_filter_iterator_t::ids_filter_iterator_t(const void* obj): obj(obj) {
+    if(IS_COMPACT_IDS(obj)) {
+        compact_id_list_t* list = COMPACT_IDS_PTR(obj);
+        compact_ids = list->ids;
+        compact_ids_length = list->length;
+    } else {
+        id_list_t* list = (id_list_t*)(obj);
+        it = new id_list_t::iterator_t(list->new_iterator());
+    }
+}
+
+ids_filter_iterator_t::~ids_filter_iterator_t() {
+    delete it;
+}
+
+bool ids_filter_iterator_t::valid() const {
+    if(it == nullptr) {
+        return compact_index < compact_ids_length;
+    }
+
+    return it->valid();
+}
+
+uint32_t ids_filter_iterator_t::id() const {
+    if(it == nullptr) {
+        return compact_ids[compact_index];
+    }
+
+    return it->id();
+}
+
+void ids_filter_iterator_t::next() {
+    if(it == nullptr) {
+        compact_index++;
+    } else {
+        it->next();
+    }
+}
+
+void ids_filter_iterator_t::skip_to(uint32_t id) {
+    if(it == nullptr) {
+        if(compact_index < compact_ids_length && compact_ids[compact_index] < id) {
+            compact_index = std::lower_bound(compact_ids + compact_index, compact_ids + compact_ids_length, id) -
+                            compact_ids;
+        }
+    } else if(it->valid()) {
+        it->skip_to(id);
+    }
+}
+
+void ids_filter_iterator_t::reset() {
+    if(it == nullptr) {
+        compact_index = 0;
+    } else {
+        delete it;
+        it = new id_list_t::iterator_t(((id_list_t*)(obj))->new_iterator());
+    }
+}
+
+size_t ids_filter_iterator_t::estimated_size() const {
+    return ids_t::num_ids(obj);
+}
+
+/* posting_filter_iterator_t */
+
+posting_filter_iterator_t::posting_filter_iterator_t(const std::vector<void*>& raw_posting_lists) {
+    posting_t::to_expanded_plists(raw_posting_lists, plists, expanded_plists);
+
+    // smallest list drives the intersection
+    std::sort(plists.begin(), plists.end(), [](posting_list_t* a, posting_list_t* b) {
+        return a->num_ids() < b->num_ids();
+    });
+
+    reset();
+}
+
+posting_filter_iterator_t::~posting_filter_iterator_t() {
+    its.clear();
+
+    for(posting_list_t* expanded_plist: expanded_plists) {
+        delete expanded_plist;
+    }
+}
+
+void posting_filter_iterator_t::align() {
+    is_valid = false;
+
+    if(its.empty() || !its[0].valid()) {
+        return ;
+    }
+
+    while(true) {
+        const uint32_t target = its[0].id();
+        bool matched = true;
+
+        for(size_t i = 1; i < its.size(); i++) {
+            its[i].skip_to(target);
+
+            if(!its[i].valid()) {
+                return ;
+            }
+
+            if(its[i].id() != target) {
+                matched = false;
+                its[0].skip_to(its[i].id());
+                break;
+            }
+        }
+
+        if(!its[0].valid()) {
+            return ;
+        }
+
+        if(matched) {
+            is_valid = true;
+            return ;
+        }
+    }
+}
+
+bool posting_filter_iterator_t::valid() const {
+    return is_valid;
+}
+
+uint32_t posting_filter_iterator_t::id() const {
+    return its[0].id();
+}
+
+void posting_filter_iterator_t::next() {
+    its[0].next();
+    align();
+}
+
+void posting_filter_iterator_t::skip_to(uint32_t id) {
+    if(!is_valid || its[0].id() >= id) {
+        return ;
+    }
+
+    its[0].skip_to(id);
+    align();
+}
+
+void posting_filter_iterator_t::reset() {
+    its.clear();
+    its.reserve(plists.size());
+
+    for(posting_list_t* plist: plists) {
+        its.push_back(plist->new_iterator());
+    }
+
+    align();
+}
+
+size_t posting_filter_iterator_t::estimated_size() const {
+    return plists.empty() ? 0 : plists[0]->num_ids();
+}
+
+/* and_filter_iterator_t */
+
+and_filter_iterator_t::and_filter_iterator_t(const std::vector<filter_iterator_t*>& children): children(children) {
+    // most selective child drives the intersection
+    std::sort(this->children.begin(), this->children.end(), [](filter_iterator_t* a, filter_iterator_t* b) {
+        return a->estimated_size() < b->estimated_size();
+    });
+
+    align();
+}
+
+and_filter_iterator_t::~and_filter_iterator_t() {
+    for(filter_iterator_t* child: children) {
+        delete child;
+    }
+}
+
+void and_filter_iterator_t::align() {
+    is_valid = false;
+
+    if(children.empty() || !children[0]->valid()) {
+        return ;
+    }
+
+    uint32_t target = children[0]->id();
+    size_t num_matched = 1;
+    size_t i = 1;
+
+    // leapfrog: every child is skipped to the largest ID seen so far until all of them agree
+    while(num_matched < children.size()) {
+        if(i == children.size()) {
+            i = 0;
+        }
+
+        children[i]->skip_to(target);
+
+        if(!children[i]->valid()) {
+            return ;
+        }
+
+        if(children[i]->id() == target) {
+            num_matched++;
+        } else {
+            target = children[i]->id();
+            num_matched = 1;
+        }
+
+        i++;
+    }
+
+    curr_id = target;
+    is_valid = true;
+}
+
+bool and_filter_iterator_t::valid() const {
+    return is_valid;
+}
+
+uint32_t and_filter_iterator_t::id() const {
+    return curr_id;
+}
+
+void and_filter_iterator_t::next() {
+    children[0]->next();
+    align();
+}
+
+void and_filter_iterator_t::skip_to(uint32_t id) {
+    if(!is_valid || curr_id >= id) {
+        return ;
+    }
+
+    children[0]->skip_to(id);
+    align();
+}
+
+void and_filter_iterator_t::reset() {
+    for(filter_iterator_t* child: children) {
+        child->reset();
+    }
+
+    align();
+}
+
+size_t and_filter_iterator_t::estimated_size() const {
+    return children.empty() ? 0 : children[0]->estimated_size();
+}
+
+/* or_filter_iterator_t */
+
+or_filter_iterator_t::or_filter_iterator_t(const std::vector<filter_iterator_t*>& children): children(children) {
+    find_smallest();
+}
+
+or_filter_iterator_t::~or_filter_iterator_t() {
+    for(filter_iterator_t* child: children) {
+        delete child;
+    }
+}
+
+void or_filter_iterator_t::find_smallest() {
+    is_valid = false;
+
+    for(filter_iterator_t* child: children) {
+        if(child->valid() && (!is_valid || child->id() < curr_id)) {
+            curr_id = child->id();
+            is_valid = true;
+        }
+    }
+}
+
+bool or_filter_iterator_t::valid() const {
+    return is_valid;
+}
+
+uint32_t or_filter_iterator_t::id() const {
+    return curr_id;
+}
+
+void or_filter_iterator_t::next() {
+    // children can overlap, so every child that is on the current ID has to move forward
+    for(filter_iterator_t* child: children) {
+        if(child->valid() && child->id() == curr_id) {
+            child->next();
+        }
+    }
+
+    find_smallest();
+}
+
+void or_filter_iterator_t::skip_to(uint32_t id) {
+    if(!is_valid || curr_id >= id) {
+        return ;
+    }
+
+    for(filter_iterator_t* child: children) {
+        child->skip_to(id);
+    }
+
+    find_smallest();
+}
+
+void or_filter_iterator_t::reset() {
+    for(filter_iterator_t* child: children) {
+        child->reset();
+    }
+
+    find_smallest();
+}
+
+size_t or_filter_iterator_t::estimated_size() const {
+    size_t size = 0;
+    for(filter_iterator_t* child: children) {
+        size += child->estimated_size();
+    }
+
+    return size;
+}
+
+/* not_filter_iterator_t */
+
+not_filter_iterator_t::not_filter_iterator_t(filter_iterator_t* universe, filter_iterator_t* child):
+        universe(universe), child(child) {
+    skip_excluded();
+}
+
+not_filter_iterator_t::~not_filter_iterator_t() {
+    delete universe;
+    delete child;
+}
+
+void not_filter_iterator_t::skip_excluded() {
+    while(universe->valid()) {
+        child->skip_to(universe->id());
+
+        if(!child->valid() || child->id() != universe->id()) {
+            return ;
+        }
+
+        universe->next();
+    }
+}
+
+bool not_filter_iterator_t::valid() const {
+    return universe->valid();
+}
+
+uint32_t not_filter_iterator_t::id() const {
+    return universe->id();
+}
+
+void not_filter_iterator_t::next() {
+    universe->next();
+    skip_excluded();
+}
+
+void not_filter_iterator_t::skip_to(uint32_t id) {
+    universe->skip_to(id);
+    skip_excluded();
+}
+
+void not_filter_iterator_t::reset() {
+    universe->reset();
+    child->reset();
+    skip_excluded();
+}
+
+size_t not_filter_iterator_t::estimated_size() const {
+    return universe->estimated_size();
+}
@@ -529,6 +529,18 @@ bool HttpServer::is_write_request(const std::string& root_resource, const std::s
     return false;
 }
 
+ThreadPool::lane_t HttpServer::get_request_lane(const std::string& root_resource, const std::string& http_method) {
+    if(is_write_request(root_resource, http_method)) {
+        return ThreadPool::lane_t::WRITE;
+    }
+
+    if(root_resource == "collections" || root_resource == "multi_search") {
+        return ThreadPool::lane_t::SEARCH;
+    }
+
+    return ThreadPool::lane_t::ADMIN;
+}
+
 int HttpServer::async_req_cb(void *ctx, h2o_iovec_t chunk, int is_end_stream) {
     // NOTE: this callback is triggered multiple times by HTTP 2 but only once by HTTP 1
     // This quirk is because of the underlying buffer/window sizes. We will have to deal with both cases.
@@ -674,8 +686,10 @@ int HttpServer::process_request(const std::shared_ptr<http_req>& request, const
     auto thread_pool = use_meta_thread_pool ? handler->http_server->get_meta_thread_pool() :
                        handler->http_server->get_thread_pool();
 
+    const ThreadPool::lane_t lane = get_request_lane(root_resource, rpath->http_method);
+
     // LOG(INFO) << "Before enqueue res: " << response
-    thread_pool->enqueue([rpath, message_dispatcher, request, response]() {
+    thread_pool->enqueue(lane, [rpath, message_dispatcher, request, response]() {
         // call the API handler
         //LOG(INFO) << "Wait for response " << response.get() << ", action: " << rpath->_get_action();
         (rpath->handler)(request, response);
@@ -710,7 +724,8 @@ void HttpServer::on_deferred_process_request(h2o_timer_t *entry) {
 
     if(found_rpath) {
         // must be called on a separate thread so as not to block http thread
-        server->thread_pool->enqueue([found_rpath, request, response]() {
+        // deferred requests are the remaining parts of a write that could not be finished in one go
+        server->thread_pool->enqueue(ThreadPool::lane_t::WRITE, [found_rpath, request, response]() {
             //LOG(INFO) << "Sleeping for 5s req count " << deferred_req_res->req.use_count();
             //std::this_thread::sleep_for(std::chrono::seconds(5));
             //LOG(INFO) << "on_deferred_process_request, calling handler, req use count " << request.use_count();
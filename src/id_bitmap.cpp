@@ -0,0 +1,359 @@
+#include "id_bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+/* container_t operations */
+
+bool id_bitmap_t::container_t::contains(uint16_t low) const {
+    if(is_bitset()) {
+        return (bitset[low >> 6] >> (low & 63)) & 1;
+    }
+
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void id_bitmap_t::container_t::add(uint16_t low) {
+    if(is_bitset()) {
+        uint64_t& word = bitset[low >> 6];
+        const uint64_t bit = uint64_t(1) << (low & 63);
+        cardinality += (word & bit) == 0;
+        word |= bit;
+        return ;
+    }
+
+    // fast path for ascending inserts
+    if(array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if(*it == low) {
+            return ;
+        }
+        array.insert(it, low);
+    }
+
+    cardinality++;
+
+    if(cardinality > ARRAY_CONTAINER_MAX) {
+        to_bitset();
+    }
+}
+
+void id_bitmap_t::container_t::add_many(const uint16_t* lows, size_t len) {
+    if(is_bitset()) {
+        // only the bits that flip add to the cardinality, so that small additions stay cheap on dense containers
+        for(size_t i = 0; i < len; i++) {
+            uint64_t& word = bitset[lows[i] >> 6];
+            const uint64_t bit = uint64_t(1) << (lows[i] & 63);
+            cardinality += (word & bit) == 0;
+            word |= bit;
+        }
+
+        return ;
+    }
+
+    if(array.empty() || array.back() < lows[0]) {
+        array.insert(array.end(), lows, lows + len);
+    } else {
+        std::vector<uint16_t> merged;
+        merged.reserve(array.size() + len);
+        std::set_union(array.begin(), array.end(), lows, lows + len, std::back_inserter(merged));
+        array = std::move(merged);
+    }
+
+    array.erase(std::unique(array.begin(), array.end()), array.end());
+    cardinality = array.size();
+    normalize();
+}
+
+void id_bitmap_t::container_t::to_bitset() {
+    bitset.assign(BITSET_WORDS, 0);
+    for(const uint16_t low: array) {
+        bitset[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+
+    std::vector<uint16_t>().swap(array);
+}
+
+void id_bitmap_t::container_t::to_array() {
+    std::vector<uint16_t> values;
+    values.reserve(cardinality);
+
+    for(uint32_t w = 0; w < BITSET_WORDS; w++) {
+        uint64_t word = bitset[w];
+        while(word != 0) {
+            values.push_back(uint16_t((w << 6) + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+
+    array = std::move(values);
+    std::vector<uint64_t>().swap(bitset);
+}
+
+void id_bitmap_t::container_t::normalize() {
+    if(is_bitset() && cardinality <= ARRAY_CONTAINER_MAX) {
+        to_array();
+    } else if(!is_bitset() && cardinality > ARRAY_CONTAINER_MAX) {
+        to_bitset();
+    }
+}
+
+void id_bitmap_t::container_t::and_with(const container_t& other) {
+    if(is_bitset() && other.is_bitset()) {
+        cardinality = 0;
+        for(uint32_t w = 0; w < BITSET_WORDS; w++) {
+            bitset[w] &= other.bitset[w];
+            cardinality += __builtin_popcountll(bitset[w]);
+        }
+    } else if(is_bitset()) {
+        // result can have at most as many values as the other array container
+        std::vector<uint16_t> values;
+        values.reserve(other.array.size());
+        for(const uint16_t low: other.array) {
+            if(contains(low)) {
+                values.push_back(low);
+            }
+        }
+
+        array = std::move(values);
+        std::vector<uint64_t>().swap(bitset);
+        cardinality = array.size();
+        return ;
+    } else if(other.is_bitset()) {
+        auto end = std::remove_if(array.begin(), array.end(), [&other](uint16_t low) {
+            return !other.contains(low);
+        });
+        array.erase(end, array.end());
+        cardinality = array.size();
+    } else {
+        std::vector<uint16_t> values;
+        values.reserve(std::min(array.size(), other.array.size()));
+        std::set_intersection(array.begin(), array.end(), other.array.begin(), other.array.end(),
+                              std::back_inserter(values));
+        array = std::move(values);
+        cardinality = array.size();
+    }
+
+    normalize();
+}
+
+void id_bitmap_t::container_t::or_with(const container_t& other) {
+    if(is_bitset() && other.is_bitset()) {
+        cardinality = 0;
+        for(uint32_t w = 0; w < BITSET_WORDS; w++) {
+            bitset[w] |= other.bitset[w];
+            cardinality += __builtin_popcountll(bitset[w]);
+        }
+    } else if(other.is_bitset()) {
+        std::vector<uint64_t> words = other.bitset;
+        for(const uint16_t low: array) {
+            words[low >> 6] |= uint64_t(1) << (low & 63);
+        }
+
+        bitset = std::move(words);
+        std::vector<uint16_t>().swap(array);
+
+        cardinality = 0;
+        for(const uint64_t word: bitset) {
+            cardinality += __builtin_popcountll(word);
+        }
+    } else if(!other.array.empty()) {
+        add_many(&other.array[0], other.array.size());
+    }
+}
+
+void id_bitmap_t::container_t::andnot_with(const container_t& other) {
+    if(is_bitset() && other.is_bitset()) {
+        cardinality = 0;
+        for(uint32_t w = 0; w < BITSET_WORDS; w++) {
+            bitset[w] &= ~other.bitset[w];
+            cardinality += __builtin_popcountll(bitset[w]);
+        }
+    } else if(is_bitset()) {
+        for(const uint16_t low: other.array) {
+            uint64_t& word = bitset[low >> 6];
+            const uint64_t bit = uint64_t(1) << (low & 63);
+            cardinality -= (word & bit) != 0;
+            word &= ~bit;
+        }
+    } else if(other.is_bitset()) {
+        auto end = std::remove_if(array.begin(), array.end(), [&other](uint16_t low) {
+            return other.contains(low);
+        });
+        array.erase(end, array.end());
+        cardinality = array.size();
+    } else {
+        std::vector<uint16_t> values;
+        values.reserve(array.size());
+        std::set_difference(array.begin(), array.end(), other.array.begin(), other.array.end(),
+                            std::back_inserter(values));
+        array = std::move(values);
+        cardinality = array.size();
+    }
+
+    normalize();
+}
+
+/* id_bitmap_t */
+
+id_bitmap_t::container_t& id_bitmap_t::get_or_create(uint16_t key) {
+    // fast path for ascending inserts
+    if(!containers.empty() && containers.back().key == key) {
+        return containers.back();
+    }
+
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const container_t& c, uint16_t k) { return c.key < k; });
+
+    if(it == containers.end() || it->key != key) {
+        it = containers.emplace(it);
+        it->key = key;
+    }
+
+    return *it;
+}
+
+const id_bitmap_t::container_t* id_bitmap_t::find(uint16_t key) const {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const container_t& c, uint16_t k) { return c.key < k; });
+
+    if(it == containers.end() || it->key != key) {
+        return nullptr;
+    }
+
+    return &(*it);
+}
+
+void id_bitmap_t::add(uint32_t id) {
+    get_or_create(id >> 16).add(uint16_t(id & 0xFFFF));
+}
+
+void id_bitmap_t::add_many(const uint32_t* ids, size_t len) {
+    std::vector<uint16_t> lows;
+    size_t i = 0;
+
+    while(i < len) {
+        const uint16_t key = ids[i] >> 16;
+        lows.clear();
+
+        while(i < len && (ids[i] >> 16) == key) {
+            lows.push_back(uint16_t(ids[i] & 0xFFFF));
+            i++;
+        }
+
+        get_or_create(key).add_many(&lows[0], lows.size());
+    }
+}
+
+bool id_bitmap_t::contains(uint32_t id) const {
+    const container_t* container = find(id >> 16);
+    return container != nullptr && container->contains(uint16_t(id & 0xFFFF));
+}
+
+size_t id_bitmap_t::cardinality() const {
+    size_t count = 0;
+    for(const auto& container: containers) {
+        count += container.cardinality;
+    }
+
+    return count;
+}
+
+bool id_bitmap_t::empty() const {
+    return containers.empty();
+}
+
+void id_bitmap_t::clear() {
+    containers.clear();
+}
+
+void id_bitmap_t::and_with(const id_bitmap_t& other) {
+    std::vector<container_t> result;
+
+    auto it1 = containers.begin();
+    auto it2 = other.containers.begin();
+
+    while(it1 != containers.end() && it2 != other.containers.end()) {
+        if(it1->key < it2->key) {
+            it1++;
+        } else if(it1->key > it2->key) {
+            it2++;
+        } else {
+            it1->and_with(*it2);
+            if(it1->cardinality != 0) {
+                result.push_back(std::move(*it1));
+            }
+            it1++;
+            it2++;
+        }
+    }
+
+    containers = std::move(result);
+}
+
+void id_bitmap_t::or_with(const id_bitmap_t& other) {
+    std::vector<container_t> result;
+    result.reserve(containers.size() + other.containers.size());
+
+    auto it1 = containers.begin();
+    auto it2 = other.containers.begin();
+
+    while(it1 != containers.end() || it2 != other.containers.end()) {
+        if(it2 == other.containers.end() || (it1 != containers.end() && it1->key < it2->key)) {
+            result.push_back(std::move(*it1));
+            it1++;
+        } else if(it1 == containers.end() || it1->key > it2->key) {
+            result.push_back(*it2);
+            it2++;
+        } else {
+            it1->or_with(*it2);
+            result.push_back(std::move(*it1));
+            it1++;
+            it2++;
+        }
+    }
+
+    containers = std::move(result);
+}
+
+void id_bitmap_t::andnot_with(const id_bitmap_t& other) {
+    std::vector<container_t> result;
+    result.reserve(containers.size());
+
+    auto it2 = other.containers.begin();
+
+    for(auto& container: containers) {
+        while(it2 != other.containers.end() && it2->key < container.key) {
+            it2++;
+        }
+
+        if(it2 != other.containers.end() && it2->key == container.key) {
+            container.andnot_with(*it2);
+        }
+
+        if(container.cardinality != 0) {
+            result.push_back(std::move(container));
+        }
+    }
+
+    containers = std::move(result);
+}
+
+size_t id_bitmap_t::uncompress(uint32_t** out) const {
+    const size_t len = cardinality();
+
+    if(len == 0) {
+        *out = nullptr;
+        return 0;
+    }
+
+    *out = new uint32_t[len];
+    uint32_t* dest = *out;
+
+    for_each([&dest](uint32_t id) {
+        *dest++ = id;
+    });
+
+    return len;
+}
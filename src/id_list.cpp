@@ -585,6 +585,19 @@ bool id_list_t::take_id(result_iter_state_t& istate, uint32_t id) {
     return true;
 }
 
+void id_list_t::uncompress(id_bitmap_t& bitmap) {
+    block_t* block = &root_block;
+    while(block != nullptr) {
+        if(block->size() != 0) {
+            uint32_t* ids = block->ids.uncompress();
+            bitmap.add_many(ids, block->size());
+            delete [] ids;
+        }
+
+        block = block->next;
+    }
+}
+
 uint32_t* id_list_t::uncompress() {
     uint32_t* arr = new uint32_t[ids_length];
     auto it = new_iterator();
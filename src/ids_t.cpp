@@ -370,6 +370,16 @@ uint32_t* ids_t::uncompress(void*& obj) {
     }
 }
 
+void ids_t::uncompress(void*& obj, id_bitmap_t& bitmap) {
+    if(IS_COMPACT_IDS(obj)) {
+        compact_id_list_t* list = COMPACT_IDS_PTR(obj);
+        bitmap.add_many(list->ids, list->length);
+    } else {
+        id_list_t* list = (id_list_t*)(obj);
+        list->uncompress(bitmap);
+    }
+}
+
 void ids_t::block_intersector_t::split_lists(size_t concurrency,
                                              std::vector<std::vector<id_list_t::iterator_t>>& partial_its_vec) {
     const size_t num_blocks = this->id_lists[0]->num_blocks();
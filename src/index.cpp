@@ -35,10 +35,10 @@
                                     break;\
                                 }
 
-spp::sparse_hash_map<uint32_t, int64_t> Index::text_match_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::seq_id_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::geo_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t> Index::str_sentinel_value;
+sort_column_t Index::text_match_sentinel_value;
+sort_column_t Index::seq_id_sentinel_value;
+sort_column_t Index::geo_sentinel_value;
+sort_column_t Index::str_sentinel_value;
 
 struct token_posting_t {
     uint32_t token_id;
@@ -56,7 +56,8 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
              const std::vector<char>& symbols_to_index, const std::vector<char>& token_separators):
         name(name), collection_id(collection_id), store(store), synonym_index(synonym_index), thread_pool(thread_pool),
         search_schema(search_schema),
-        seq_ids(new id_list_t(256)), symbols_to_index(symbols_to_index), token_separators(token_separators) {
+        seq_ids(new id_list_t(256)), symbols_to_index(symbols_to_index), token_separators(token_separators),
+        facet_cache(FACET_CACHE_SIZE) {
 
     for(const auto & fname_field: search_schema) {
         if(!fname_field.second.index) {
@@ -85,18 +86,14 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
                 adi_tree_t* tree = new adi_tree_t();
                 str_sort_index.emplace(fname_field.first, tree);
             } else if(fname_field.second.type != field_types::GEOPOINT_ARRAY) {
-                spp::sparse_hash_map<uint32_t, int64_t> * doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t>();
+                sort_column_t* doc_to_score = new sort_column_t();
                 sort_index.emplace(fname_field.first, doc_to_score);
             }
         }
 
         if(fname_field.second.facet) {
-            array_mapped_facet_t facet_array;
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                facet_array[i] = new facet_map_t();
-            }
-
-            facet_index_v3.emplace(fname_field.first, facet_array);
+            facet_index_t* facet_index = new facet_index_t(fname_field.second.is_array());
+            facet_index_v3.emplace(fname_field.first, facet_index);
         }
 
         // initialize for non-string facet fields
@@ -107,13 +104,7 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
         }
 
         if(fname_field.second.infix) {
-            array_mapped_infix_t infix_sets(ARRAY_INFIX_DIM);
-
-            for(auto& infix_set: infix_sets) {
-                infix_set = new tsl::htrie_set<char>();
-            }
-
-            infix_index.emplace(fname_field.second.name, infix_sets);
+            infix_index.emplace(fname_field.second.name, new infix_index_t(fname_field.second.infix_fm));
         }
     }
 
@@ -131,6 +122,13 @@ Index::~Index() {
 
     search_index.clear();
 
+    for(auto& kv: expansion_cache) {
+        delete kv.second;
+        kv.second = nullptr;
+    }
+
+    expansion_cache.clear();
+
     for(auto & name_index: geopoint_index) {
         delete name_index.second;
         name_index.second = nullptr;
@@ -164,10 +162,8 @@ Index::~Index() {
     sort_index.clear();
 
     for(auto& kv: infix_index) {
-        for(auto& infix_set: kv.second) {
-            delete infix_set;
-            infix_set = nullptr;
-        }
+        delete kv.second;
+        kv.second = nullptr;
     }
 
     infix_index.clear();
@@ -179,11 +175,9 @@ Index::~Index() {
 
     str_sort_index.clear();
 
-    for(auto& field_name_facet_map_array: facet_index_v3) {
-        for(auto& facet_map: field_name_facet_map_array.second) {
-            delete facet_map;
-            facet_map = nullptr;
-        }
+    for(auto& name_facet_index: facet_index_v3) {
+        delete name_facet_index.second;
+        name_facet_index.second = nullptr;
     }
 
     facet_index_v3.clear();
@@ -220,6 +214,17 @@ int64_t Index::float_to_in64_t(float f) {
     return i;
 }
 
+float Index::int64_t_to_float(int64_t n) {
+    int32_t i = n;
+    if(i < 0) {
+        i ^= INT32_MAX;
+    }
+
+    float f;
+    memcpy(&f, &i, sizeof f);
+    return f;
+}
+
 void Index::compute_token_offsets_facets(index_record& record,
                                           const std::unordered_map<std::string, field>& search_schema,
                                           const std::vector<char>& local_token_separators,
@@ -503,12 +508,7 @@ void Index::validate_and_preprocess(Index *index, std::vector<index_record>& ite
             if(index_rec.doc.count(default_sorting_field) == 0) {
                 auto default_sorting_field_it = index->sort_index.find(default_sorting_field);
                 if(default_sorting_field_it != index->sort_index.end()) {
-                    auto seq_id_it = default_sorting_field_it->second->find(index_rec.seq_id);
-                    if(seq_id_it != default_sorting_field_it->second->end()) {
-                        points = seq_id_it->second;
-                    } else {
-                        points = INT64_MIN;
-                    }
+                    points = default_sorting_field_it->second->get_or_default(index_rec.seq_id, INT64_MIN);
                 } else {
                     points = INT64_MIN;
                 }
@@ -533,15 +533,27 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
                                  const std::vector<char>& symbols_to_index,
                                  const bool do_validation) {
 
+    batch_preprocess(index, iter_batch, default_sorting_field, search_schema, fallback_field_type,
+                     token_separators, symbols_to_index, do_validation);
+
+    return batch_apply_preprocessed(index, iter_batch, search_schema);
+}
+
+void Index::batch_preprocess(Index *index, std::vector<index_record>& iter_batch,
+                             const std::string & default_sorting_field,
+                             const std::unordered_map<std::string, field> & search_schema,
+                             const std::string& fallback_field_type,
+                             const std::vector<char>& token_separators,
+                             const std::vector<char>& symbols_to_index,
+                             const bool do_validation) {
+
     const size_t concurrency = 4;
     const size_t num_threads = std::min(concurrency, iter_batch.size());
     const size_t window_size = (num_threads == 0) ? 0 :
                                (iter_batch.size() + num_threads - 1) / num_threads;  // rounds up
 
-    size_t num_indexed = 0;
     size_t num_processed = 0;
     std::mutex m_process;
-    std::condition_variable cv_process;
 
     size_t num_queued = 0;
     size_t batch_index = 0;
@@ -555,22 +567,29 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
 
         num_queued++;
 
-        index->thread_pool->enqueue([&, batch_index, batch_len]() {
+        index->thread_pool->fork(ThreadPool::lane_t::WRITE, [&, batch_index, batch_len]() {
             validate_and_preprocess(index, iter_batch, batch_index, batch_len, default_sorting_field, search_schema,
                                     fallback_field_type, token_separators, symbols_to_index, do_validation);
 
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
-            cv_process.notify_one();
         });
 
         batch_index += batch_len;
     }
 
-    {
+    index->thread_pool->wait_until([&]() {
         std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-    }
+        return num_processed == num_queued;
+    });
+}
+
+size_t Index::batch_apply_preprocessed(Index *index, std::vector<index_record>& iter_batch,
+                                       const std::unordered_map<std::string, field> & search_schema) {
+    size_t num_indexed = 0;
+    size_t num_processed = 0;
+    size_t num_queued = 0;
+    std::mutex m_process;
 
     std::unordered_set<std::string> found_fields;
 
@@ -593,8 +612,6 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
         }
     }
 
-    num_queued = num_processed = 0;
-
     for(const auto& field_name: found_fields) {
         //LOG(INFO) << "field name: " << field_name;
         if(field_name != "id" && search_schema.count(field_name) == 0) {
@@ -603,7 +620,7 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
 
         num_queued++;
 
-        index->thread_pool->enqueue([&]() {
+        index->thread_pool->fork(ThreadPool::lane_t::WRITE, [&]() {
             const field& f = (field_name == "id") ?
                              field("id", field_types::STRING, false) : search_schema.at(field_name);
             try {
@@ -617,14 +634,13 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
 
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
-            cv_process.notify_one();
         });
     }
 
-    {
+    index->thread_pool->wait_until([&]() {
         std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-    }
+        return num_processed == num_queued;
+    });
 
     return num_indexed;
 }
@@ -632,6 +648,9 @@ size_t Index::batch_memory_index(Index *index, std::vector<index_record>& iter_b
 void Index::index_field_in_memory(const field& afield, std::vector<index_record>& iter_batch) {
     // indexes a given field of all documents in the batch
 
+    write_generation++;
+    invalidate_facet_cache(afield.name);
+
     if(afield.name == "id") {
         for(const auto& record: iter_batch) {
             if(!record.indexed.ok()) {
@@ -681,15 +700,8 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             }
 
             if(afield.facet) {
-                facet_hash_values_t fhashvalues;
-                fhashvalues.length = field_index_it->second.facet_hashes.size();
-                fhashvalues.hashes = new uint64_t[field_index_it->second.facet_hashes.size()];
-
-                for(size_t i  = 0; i < field_index_it->second.facet_hashes.size(); i++) {
-                    fhashvalues.hashes[i] = field_index_it->second.facet_hashes[i];
-                }
-
-                facet_index_v3[afield.name][seq_id % ARRAY_FACET_DIM]->emplace(seq_id, std::move(fhashvalues));
+                const auto& facet_hashes = field_index_it->second.facet_hashes;
+                facet_index_v3.at(afield.name)->upsert(seq_id, facet_hashes.data(), facet_hashes.size());
             }
 
             if(record.points > max_score) {
@@ -700,13 +712,15 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                 token_to_doc_offsets[token_offsets.first].emplace_back(seq_id, record.points, token_offsets.second);
 
                 if(afield.infix) {
-                    auto strhash = StringUtils::hash_wy(token_offsets.first.c_str(), token_offsets.first.size());
-                    const auto& infix_sets = infix_index.at(afield.name);
-                    infix_sets[strhash % 4]->insert(token_offsets.first);
+                    infix_index.at(afield.name)->insert(token_offsets.first);
                 }
             }
         }
 
+        if(afield.infix) {
+            schedule_infix_rebuild(infix_index.at(afield.name));
+        }
+
         auto tree_it = search_index.find(afield.faceted_name());
         if(tree_it == search_index.end()) {
             return;
@@ -842,7 +856,7 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
         // add numerical values automatically into sort index if sorting is enabled
         if(afield.is_num_sortable() && afield.type != field_types::GEOPOINT_ARRAY) {
-            spp::sparse_hash_map<uint32_t, int64_t> *doc_to_score = sort_index.at(afield.name);
+            sort_column_t* doc_to_score = sort_index.at(afield.name);
 
             bool is_integer = afield.is_integer();
             bool is_float = afield.is_float();
@@ -862,16 +876,16 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                 }
 
                 if(is_integer) {
-                    doc_to_score->emplace(seq_id, document[afield.name].get<int64_t>());
+                    doc_to_score->upsert(seq_id, document[afield.name].get<int64_t>());
                 } else if(is_float) {
                     int64_t ifloat = float_to_in64_t(document[afield.name].get<float>());
-                    doc_to_score->emplace(seq_id, ifloat);
+                    doc_to_score->upsert(seq_id, ifloat);
                 } else if(is_bool) {
-                    doc_to_score->emplace(seq_id, (int64_t) document[afield.name].get<bool>());
+                    doc_to_score->upsert(seq_id, (int64_t) document[afield.name].get<bool>());
                 } else if(is_geopoint) {
                     const std::vector<double>& latlong = document[afield.name];
                     int64_t lat_lng = GeoPoint::pack_lat_lng(latlong[0], latlong[1]);
-                    doc_to_score->emplace(seq_id, lat_lng);
+                    doc_to_score->upsert(seq_id, lat_lng);
                 }
             }
         }
@@ -1061,6 +1075,35 @@ void Index::compute_facet_stats(facet &a_facet, uint64_t raw_value, const std::s
     }
 }
 
+void Index::do_flat_facet_counts(facet& a_facet, const facet_index_t* field_facet_index, const field& facet_field,
+                                 const bool should_compute_stats,
+                                 const uint32_t* result_ids, size_t results_size) const {
+    std::vector<facet_count_t> ordinal_counts(field_facet_index->num_ordinals());
+
+    for(size_t i = 0; i < results_size; i++) {
+        const uint32_t doc_seq_id = result_ids[i];
+        const uint32_t* ordinals;
+        const uint32_t num_ordinals = field_facet_index->get_ordinals(doc_seq_id, ordinals);
+
+        for(uint32_t j = 0; j < num_ordinals; j++) {
+            facet_count_t& facet_count = ordinal_counts[ordinals[j]];
+            facet_count.count++;
+            facet_count.doc_id = doc_seq_id;
+            facet_count.array_pos = j;
+
+            if(should_compute_stats) {
+                compute_facet_stats(a_facet, field_facet_index->get_hash(ordinals[j]), facet_field.type);
+            }
+        }
+    }
+
+    for(uint32_t ordinal = 0; ordinal < ordinal_counts.size(); ordinal++) {
+        if(ordinal_counts[ordinal].count != 0) {
+            a_facet.result_map.emplace(field_facet_index->get_hash(ordinal), ordinal_counts[ordinal]);
+        }
+    }
+}
+
 void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                       const std::vector<facet_info_t>& facet_infos,
                       const size_t group_limit, const std::vector<std::string>& group_by_fields,
@@ -1068,58 +1111,340 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
     // assumed that facet fields have already been validated upstream
     for(size_t findex=0; findex < facets.size(); findex++) {
-        auto& a_facet = facets[findex];
-        const auto& facet_field = facet_infos[findex].facet_field;
-        const bool use_facet_query = facet_infos[findex].use_facet_query;
-        const auto& fquery_hashes = facet_infos[findex].hashes;
-        const bool should_compute_stats = facet_infos[findex].should_compute_stats;
+        do_facet(facets[findex], facet_infos[findex], group_limit, group_by_fields, result_ids, results_size);
+    }
+}
 
-        const auto& field_facet_mapping_it = facet_index_v3.find(a_facet.field_name);
-        if(field_facet_mapping_it == facet_index_v3.end()) {
+void Index::do_range_facet(facet& a_facet, const uint32_t* result_ids, size_t results_size) const {
+    const auto sort_column_it = sort_index.find(a_facet.field_name);
+    if(sort_column_it == sort_index.end()) {
+        return ;
+    }
+
+    const sort_column_t* sort_column = sort_column_it->second;
+    const bool is_float = search_schema.at(a_facet.field_name).is_float();
+    auto& stats = a_facet.stats;
+
+    for(size_t i = 0; i < results_size; i++) {
+        int64_t value;
+        if(!sort_column->find(result_ids[i], value)) {
             continue;
         }
 
-        const auto& field_facet_mapping = field_facet_mapping_it->second;
+        const double stat_value = is_float ? double(int64_t_to_float(value)) : double(value);
+        stats.fvmin = std::min(stats.fvmin, stat_value);
+        stats.fvmax = std::max(stats.fvmax, stat_value);
+        stats.fvsum += stat_value;
+        stats.fvcount++;
 
-        for(size_t i = 0; i < results_size; i++) {
-            uint32_t doc_seq_id = result_ids[i];
-            const auto& facet_hashes_it = field_facet_mapping[doc_seq_id % ARRAY_FACET_DIM]->find(doc_seq_id);
+        // ranges can overlap, and there are only a handful of them
+        for(size_t ri = 0; ri < a_facet.ranges.size(); ri++) {
+            if(value >= a_facet.ranges[ri].lower && value < a_facet.ranges[ri].upper) {
+                a_facet.range_counts[ri]++;
+            }
+        }
+    }
+}
 
-            if(facet_hashes_it == field_facet_mapping[doc_seq_id % ARRAY_FACET_DIM]->end()) {
-                continue;
+void Index::do_facet(facet& a_facet, const facet_info_t& facet_info,
+                     const size_t group_limit, const std::vector<std::string>& group_by_fields,
+                     const uint32_t* result_ids, size_t results_size) const {
+    if(!a_facet.ranges.empty()) {
+        do_range_facet(a_facet, result_ids, results_size);
+        return ;
+    }
+
+    const auto& facet_field = facet_info.facet_field;
+    const bool use_facet_query = facet_info.use_facet_query;
+    const auto& fquery_hashes = facet_info.hashes;
+    const bool should_compute_stats = facet_info.should_compute_stats;
+
+    const auto& field_facet_index_it = facet_index_v3.find(a_facet.field_name);
+    if(field_facet_index_it == facet_index_v3.end()) {
+        return ;
+    }
+
+    const facet_index_t* field_facet_index = field_facet_index_it->second;
+
+    if(!group_limit && !use_facet_query &&
+       field_facet_index->num_ordinals() <= results_size * FLAT_FACET_COUNT_MAX_ORDINALS_PER_VALUE) {
+        do_flat_facet_counts(a_facet, field_facet_index, facet_field, should_compute_stats,
+                             result_ids, results_size);
+        return ;
+    }
+
+    for(size_t i = 0; i < results_size; i++) {
+        uint32_t doc_seq_id = result_ids[i];
+        const uint32_t* ordinals;
+        const uint32_t num_ordinals = field_facet_index->get_ordinals(doc_seq_id, ordinals);
+
+        if(num_ordinals == 0) {
+            continue;
+        }
+
+        const uint64_t distinct_id = group_limit ? get_distinct_id(group_by_fields, doc_seq_id) : 0;
+
+        for(size_t j = 0; j < num_ordinals; j++) {
+            auto fhash = field_facet_index->get_hash(ordinals[j]);
+
+            if(should_compute_stats) {
+                compute_facet_stats(a_facet, fhash, facet_field.type);
             }
 
-            const auto& facet_hashes = facet_hashes_it->second;
-            const uint64_t distinct_id = group_limit ? get_distinct_id(group_by_fields, doc_seq_id) : 0;
+            if(!use_facet_query || fquery_hashes.find(fhash) != fquery_hashes.end()) {
+                facet_count_t& facet_count = a_facet.result_map[fhash];
 
-            for(size_t j = 0; j < facet_hashes.size(); j++) {
-                auto fhash = facet_hashes.hashes[j];
+                //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
 
-                if(should_compute_stats) {
-                    compute_facet_stats(a_facet, fhash, facet_field.type);
+                facet_count.doc_id = doc_seq_id;
+                facet_count.array_pos = j;
+
+                if(group_limit) {
+                    a_facet.hash_groups[fhash].emplace(distinct_id);
+                } else {
+                    facet_count.count += 1;
+                }
+
+                if(use_facet_query) {
+                    a_facet.hash_tokens[fhash] = fquery_hashes.at(fhash);
                 }
+            }
+        }
+    }
+}
 
-                if(!use_facet_query || fquery_hashes.find(fhash) != fquery_hashes.end()) {
-                    facet_count_t& facet_count = a_facet.result_map[fhash];
+void Index::sample_result_ids(const uint32_t* result_ids, const size_t results_size, const size_t sample_percent,
+                              std::vector<uint32_t>& sampled_ids) {
+    sampled_ids.reserve(results_size * sample_percent / 100 + 1);
 
-                    //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
+    // a document is sampled based on a hash of its ID, so that the sample is stable across identical searches
+    for(size_t i = 0; i < results_size; i++) {
+        const uint64_t seq_id_hash = uint64_t(result_ids[i]) * 0x9E3779B97F4A7C15ULL;
+        if((seq_id_hash >> 32) % 100 < sample_percent) {
+            sampled_ids.push_back(result_ids[i]);
+        }
+    }
+}
 
-                    facet_count.doc_id = doc_seq_id;
-                    facet_count.array_pos = j;
+void Index::extrapolate_facet(facet& a_facet, const double scale) {
+    for(auto& facet_kv: a_facet.result_map) {
+        facet_kv.second.count = std::lround(facet_kv.second.count * scale);
+    }
 
-                    if(group_limit) {
-                        a_facet.hash_groups[fhash].emplace(distinct_id);
-                    } else {
-                        facet_count.count += 1;
-                    }
+    for(auto& range_count: a_facet.range_counts) {
+        range_count = std::lround(range_count * scale);
+    }
 
-                    if(use_facet_query) {
-                        a_facet.hash_tokens[fhash] = fquery_hashes.at(fhash);
-                    }
-                }
+    a_facet.stats.fvcount *= scale;
+    a_facet.stats.fvsum *= scale;
+    a_facet.sampled = true;
+}
+
+std::string Index::get_facet_cache_key(const std::vector<filter>& filters, const facet& a_facet) {
+    // strings are length prefixed, so that no two different sets of filters can end up with the same key
+    auto append = [](std::string& key, const std::string& str) {
+        key += std::to_string(str.size());
+        key += ':';
+        key += str;
+    };
+
+    // the order of the filters, and of the values within a filter, doesn't change the results
+    std::vector<std::string> filter_keys;
+
+    for(const auto& a_filter: filters) {
+        // one entry per value, or per (lower, upper) pair of a range, read the same way as in do_filtering
+        std::vector<std::string> value_keys;
+
+        for(size_t fi = 0; fi < a_filter.values.size(); fi++) {
+            // string filters carry a single comparator that applies to all of their values
+            const int comparator = a_filter.comparators.empty() ? -1 :
+                                   a_filter.comparators[std::min(fi, a_filter.comparators.size() - 1)];
+
+            std::string value_key;
+            append(value_key, std::to_string(comparator));
+            append(value_key, a_filter.values[fi]);
+
+            if(comparator == RANGE_INCLUSIVE && fi+1 < a_filter.values.size()) {
+                append(value_key, a_filter.values[fi+1]);
+                fi++;
+            }
+
+            value_keys.push_back(std::move(value_key));
+        }
+
+        std::sort(value_keys.begin(), value_keys.end());
+
+        std::string filter_key;
+        append(filter_key, a_filter.field_name);
+        for(const auto& value_key: value_keys) {
+            append(filter_key, value_key);
+        }
+
+        filter_keys.push_back(std::move(filter_key));
+    }
+
+    std::sort(filter_keys.begin(), filter_keys.end());
+
+    std::string cache_key;
+    append(cache_key, a_facet.field_name);
+
+    for(const auto& range: a_facet.ranges) {
+        append(cache_key, std::to_string(range.lower) + ".." + std::to_string(range.upper));
+    }
+
+    for(const auto& filter_key: filter_keys) {
+        append(cache_key, filter_key);
+    }
+
+    return cache_key;
+}
+
+uint64_t Index::get_facet_cache_generation(const std::vector<filter>& filters, const facet& a_facet) const {
+    std::unique_lock lock(m_facet_cache);
+
+    auto get_generation = [&](const std::string& field_name) -> uint64_t {
+        auto it = facet_field_generations.find(field_name);
+        return it == facet_field_generations.end() ? 0 : it->second;
+    };
+
+    // generations only ever grow, so the sum moves on as soon as any of them does
+    uint64_t generation = get_generation(a_facet.field_name);
+    for(const auto& a_filter: filters) {
+        generation += get_generation(a_filter.field_name);
+    }
+
+    return generation;
+}
+
+bool Index::get_cached_facet(const std::string& cache_key, const uint64_t generation, facet& a_facet) const {
+    const uint64_t cache_key_hash = StringUtils::hash_wy(cache_key.c_str(), cache_key.size());
+
+    std::unique_lock lock(m_facet_cache);
+
+    auto cache_it = facet_cache.find(cache_key_hash);
+    if(cache_it == facet_cache.end()) {
+        return false;
+    }
+
+    const cached_facet_t& cached_facet = cache_it.value();
+    if(cached_facet.key != cache_key || cached_facet.generation != generation) {
+        return false;
+    }
+
+    a_facet.result_map = cached_facet.result_map;
+    a_facet.range_counts = cached_facet.range_counts;
+    a_facet.stats = cached_facet.stats;
+    return true;
+}
+
+void Index::cache_facet(const std::string& cache_key, const uint64_t generation, const std::vector<filter>& filters,
+                        const facet& a_facet) const {
+    if(a_facet.result_map.size() > FACET_CACHE_MAX_VALUES) {
+        return ;
+    }
+
+    if(get_facet_cache_generation(filters, a_facet) != generation) {
+        return ;
+    }
+
+    const uint64_t cache_key_hash = StringUtils::hash_wy(cache_key.c_str(), cache_key.size());
+
+    std::unique_lock lock(m_facet_cache);
+    facet_cache.insert(cache_key_hash, cached_facet_t{cache_key, generation, a_facet.result_map,
+                                                      a_facet.range_counts, a_facet.stats});
+}
+
+void Index::invalidate_facet_cache(const std::string& field_name) {
+    // stale entries are skipped on lookup, and eventually evicted
+    std::unique_lock lock(m_facet_cache);
+    facet_field_generations[field_name]++;
+}
+
+void Index::fuzzy_search_field(const std::string& field_name, const std::string& token, const int cost,
+                               const bool prefix_search, const size_t max_words, const token_ordering token_order,
+                               const uint32_t* filter_ids, const size_t filter_ids_length,
+                               filter_iterator_t* filter_iterator,
+                               std::vector<art_leaf*>& leaves, const std::set<std::string>& exclude_leaves) const {
+    art_tree* t = search_index.at(field_name);
+    const size_t token_len = prefix_search ? token.length() : token.length() + 1;
+    const std::string cache_key = std::to_string(cost) + (prefix_search ? ":p:" : ":e:") + token;
+
+    std::vector<const art_node*> nodes;
+    bool found = false;
+
+    {
+        std::unique_lock lock(m_expansion_cache);
+        auto field_cache_it = expansion_cache.find(field_name);
+
+        if(field_cache_it != expansion_cache.end()) {
+            auto cache_it = field_cache_it->second->find(cache_key);
+            if(cache_it != field_cache_it->second->end() && cache_it.value().generation == t->generation) {
+                nodes = cache_it.value().nodes;
+                found = true;
             }
         }
     }
+
+    if(!found) {
+        art_fuzzy_nodes(t, (const unsigned char *) token.c_str(), token_len, cost, cost, prefix_search, nodes);
+
+        if(nodes.size() <= EXPANSION_CACHE_MAX_NODES) {
+            std::unique_lock lock(m_expansion_cache);
+            auto& field_cache = expansion_cache[field_name];
+            if(field_cache == nullptr) {
+                field_cache = new LRU::Cache<std::string, cached_expansion_t>(EXPANSION_CACHE_SIZE);
+            }
+
+            field_cache->insert(cache_key, cached_expansion_t{t->generation, nodes});
+        }
+    }
+
+    art_fuzzy_search_nodes(t, nodes, (const unsigned char *) token.c_str(), token_len, cost, max_words, token_order,
+                           prefix_search, filter_ids, filter_ids_length, filter_iterator, leaves, exclude_leaves);
+}
+
+void Index::clear_expansion_cache(const std::string& field_name) {
+    std::unique_lock lock(m_expansion_cache);
+    auto field_cache_it = expansion_cache.find(field_name);
+    if(field_cache_it != expansion_cache.end()) {
+        delete field_cache_it->second;
+        expansion_cache.erase(field_cache_it);
+    }
+}
+
+void Index::merge_facet(facet& acc_facet, facet& this_facet, const size_t group_limit) {
+    for(auto& facet_kv: this_facet.result_map) {
+        facet_count_t& acc_count = acc_facet.result_map[facet_kv.first];
+
+        if(group_limit) {
+            // we have to add all group sets
+            const auto& groups_it = this_facet.hash_groups.find(facet_kv.first);
+            if(groups_it != this_facet.hash_groups.end()) {
+                acc_facet.hash_groups[facet_kv.first].insert(groups_it->second.begin(), groups_it->second.end());
+            }
+        } else {
+            acc_count.count += facet_kv.second.count;
+        }
+
+        acc_count.doc_id = facet_kv.second.doc_id;
+        acc_count.array_pos = facet_kv.second.array_pos;
+
+        auto tokens_it = this_facet.hash_tokens.find(facet_kv.first);
+        if(tokens_it != this_facet.hash_tokens.end()) {
+            acc_facet.hash_tokens[facet_kv.first] = std::move(tokens_it->second);
+        }
+    }
+
+    for(size_t ri = 0; ri < this_facet.range_counts.size(); ri++) {
+        acc_facet.range_counts[ri] += this_facet.range_counts[ri];
+    }
+
+    if(this_facet.stats.fvcount != 0) {
+        acc_facet.stats.fvcount += this_facet.stats.fvcount;
+        acc_facet.stats.fvsum += this_facet.stats.fvsum;
+        acc_facet.stats.fvmax = std::max(acc_facet.stats.fvmax, this_facet.stats.fvmax);
+        acc_facet.stats.fvmin = std::min(acc_facet.stats.fvmin, this_facet.stats.fvmin);
+    }
 }
 
 void Index::aggregate_topster(Topster* agg_topster, Topster* index_topster) {
@@ -1147,7 +1472,7 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   tsl::htrie_map<char, token_leaf>& qtoken_set,
                                   Topster* topster,
                                   spp::sparse_hash_set<uint64_t>& groups_processed,
-                                  uint32_t*& all_result_ids, size_t& all_result_ids_len,
+                                  uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
                                   const size_t typo_tokens_threshold,
                                   const size_t group_limit,
                                   const std::vector<std::string>& group_by_fields,
@@ -1156,14 +1481,18 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   const std::vector<bool>& prefixes,
                                   bool prioritize_exact_match,
                                   const bool prioritize_token_position,
+                                  const bool max_score_pruning,
+                                  const bool skip_pruned_blocks,
                                   const bool exhaustive_search,
+                                  const size_t concurrency,
                                   const size_t max_candidates,
                                   int syn_orig_num_tokens,
                                   const int* sort_order,
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                                  std::array<sort_column_t*, 3>& field_values,
                                   const std::vector<size_t>& geopoint_indices,
                                   std::set<uint64>& query_hashes,
-                                  std::vector<uint32_t>& id_buff) const {
+                                  std::vector<uint32_t>& id_buff,
+                                  filter_iterator_t* filter_iterator) const {
 
     /*if(!token_candidates_vec.empty()) {
         LOG(INFO) << "Prefix candidates size: " << token_candidates_vec.back().candidates.size();
@@ -1178,7 +1507,7 @@ void Index::search_all_candidates(const size_t num_search_fields,
 
         find_across_fields(query_tokens, query_tokens.size()-1, num_typos, prefixes, the_fields, num_search_fields,
                            filter_ids, filter_ids_length, exclude_token_ids, exclude_token_ids_size,
-                           temp_ids);
+                           temp_ids, filter_iterator);
 
         //LOG(INFO) << "temp_ids found: " << temp_ids.size();
 
@@ -1281,11 +1610,12 @@ void Index::search_all_candidates(const size_t num_search_fields,
         search_across_fields(query_suggestion, num_typos, prefixes, the_fields, num_search_fields,
                              sort_fields, topster,groups_processed,
                              searched_queries, qtoken_set, group_limit, group_by_fields,
-                             prioritize_exact_match, prioritize_token_position,
+                             prioritize_exact_match, prioritize_token_position, max_score_pruning, skip_pruned_blocks,
+                             concurrency,
                              filter_ids, filter_ids_length, total_cost, syn_orig_num_tokens,
                              exclude_token_ids, exclude_token_ids_size,
                              sort_order, field_values, geopoint_indices,
-                             id_buff, all_result_ids, all_result_ids_len);
+                             id_buff, all_result_ids, all_result_ids_len, num_pruned_ids, filter_iterator);
 
         query_hashes.insert(qhash);
     }
@@ -1317,7 +1647,7 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
     long long int N = std::accumulate(token_candidates_vec.begin(), token_candidates_vec.end(), 1LL, product);
 
     int sort_order[3]; // 1 or -1 based on DESC or ASC respectively
-    std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values;
+    std::array<sort_column_t*, 3> field_values;
     std::vector<size_t> geopoint_indices;
 
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields, field_values);
@@ -1358,7 +1688,7 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
 
         // Prepare excluded document IDs that we can later remove from the result set
         uint32_t* excluded_result_ids = nullptr;
-        size_t excluded_result_ids_size = ArrayUtils::or_scalar(exclude_token_ids, exclude_token_ids_size,
+        size_t excluded_result_ids_size = ArrayUtils::or_simd(exclude_token_ids, exclude_token_ids_size,
                                                             &curated_ids[0], curated_ids.size(), &excluded_result_ids);
 
         std::vector<void*> posting_lists;
@@ -1421,8 +1751,8 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
                     id_buff.insert(id_buff.end(), result_id_vecs[i].begin(), result_id_vecs[i].end());
                 } else {
                     uint32_t* new_all_result_ids = nullptr;
-                    all_result_ids_len = ArrayUtils::or_scalar(*all_result_ids, all_result_ids_len, &result_id_vecs[i][0],
-                                                               result_id_vecs[i].size(), &new_all_result_ids);
+                    all_result_ids_len = ArrayUtils::or_simd(*all_result_ids, all_result_ids_len, &result_id_vecs[i][0],
+                                                             result_id_vecs[i].size(), &new_all_result_ids);
                     delete[] *all_result_ids;
                     *all_result_ids = new_all_result_ids;
                 }
@@ -1447,8 +1777,8 @@ void Index::search_candidates(const uint8_t & field_id, bool field_is_array,
             id_buff.erase(std::unique( id_buff.begin(), id_buff.end() ), id_buff.end());
 
             uint32_t* new_all_result_ids = nullptr;
-            all_result_ids_len = ArrayUtils::or_scalar(*all_result_ids, all_result_ids_len, &id_buff[0],
-                                                       id_buff.size(), &new_all_result_ids);
+            all_result_ids_len = ArrayUtils::or_simd(*all_result_ids, all_result_ids_len, &id_buff[0],
+                                                     id_buff.size(), &new_all_result_ids);
             delete[] *all_result_ids;
             *all_result_ids = new_all_result_ids;
             id_buff.clear();
@@ -1467,28 +1797,33 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                          const std::vector<filter>& filters,
                          const bool enable_short_circuit) const {
     //auto begin = std::chrono::high_resolution_clock::now();
+
+    // each clause is evaluated into a compressed bitmap and clauses are combined with word-level set operations,
+    // so that broad clauses and negations don't have to materialize millions of IDs
+    id_bitmap_t filter_bitmap;
+
     for(size_t i = 0; i < filters.size(); i++) {
         const filter & a_filter = filters[i];
 
+        id_bitmap_t result_ids;
+
         if(a_filter.field_name == "id") {
             // we handle `ids` separately
-            std::vector<uint32> result_ids;
+            std::vector<uint32> result_id_vec;
             for(const auto& id_str: a_filter.values) {
-                result_ids.push_back(std::stoul(id_str));
+                result_id_vec.push_back(std::stoul(id_str));
             }
 
-            std::sort(result_ids.begin(), result_ids.end());
+            std::sort(result_id_vec.begin(), result_id_vec.end());
+
+            if(!result_id_vec.empty()) {
+                result_ids.add_many(&result_id_vec[0], result_id_vec.size());
+            }
 
             if(i == 0) {
-                filter_ids = new uint32[result_ids.size()];
-                std::copy(result_ids.begin(), result_ids.end(), filter_ids);
-                filter_ids_length = result_ids.size();
+                filter_bitmap = std::move(result_ids);
             } else {
-                uint32_t* filtered_results = nullptr;
-                filter_ids_length = ArrayUtils::and_scalar(filter_ids, filter_ids_length, &result_ids[0],
-                                                           result_ids.size(), &filtered_results);
-                delete [] filter_ids;
-                filter_ids = filtered_results;
+                filter_bitmap.and_with(result_ids);
             }
 
             continue;
@@ -1504,9 +1839,6 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
 
         field f = search_schema.at(a_filter.field_name);
 
-        uint32_t* result_ids = nullptr;
-        size_t result_ids_len = 0;
-
         if(f.is_integer()) {
             auto num_tree = numerical_index.at(a_filter.field_name);
 
@@ -1517,10 +1849,10 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                 if(a_filter.comparators[fi] == RANGE_INCLUSIVE && fi+1 < a_filter.values.size()) {
                     const std::string& next_filter_value = a_filter.values[fi+1];
                     int64_t range_end_value = (int64_t) std::stol(next_filter_value);
-                    num_tree->range_inclusive_search(value, range_end_value, &result_ids, result_ids_len);
+                    num_tree->range_inclusive_search(value, range_end_value, result_ids);
                     fi++;
                 } else {
-                    num_tree->search(a_filter.comparators[fi], value, &result_ids, result_ids_len);
+                    num_tree->search(a_filter.comparators[fi], value, result_ids);
                 }
             }
 
@@ -1535,10 +1867,10 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                 if(a_filter.comparators[fi] == RANGE_INCLUSIVE && fi+1 < a_filter.values.size()) {
                     const std::string& next_filter_value = a_filter.values[fi+1];
                     int64_t range_end_value = float_to_in64_t((float) std::atof(next_filter_value.c_str()));
-                    num_tree->range_inclusive_search(float_int64, range_end_value, &result_ids, result_ids_len);
+                    num_tree->range_inclusive_search(float_int64, range_end_value, result_ids);
                     fi++;
                 } else {
-                    num_tree->search(a_filter.comparators[fi], float_int64, &result_ids, result_ids_len);
+                    num_tree->search(a_filter.comparators[fi], float_int64, result_ids);
                 }
             }
 
@@ -1549,30 +1881,16 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
             for(const std::string & filter_value: a_filter.values) {
                 int64_t bool_int64 = (filter_value == "1") ? 1 : 0;
                 if(a_filter.comparators[value_index] == NOT_EQUALS) {
-                    uint32_t* to_exclude_ids = nullptr;
-                    size_t to_exclude_ids_len = 0;
-                    num_tree->search(EQUALS, bool_int64, &to_exclude_ids, to_exclude_ids_len);
-
-                    auto all_ids = seq_ids->uncompress();
-                    auto all_ids_size = seq_ids->num_ids();
+                    id_bitmap_t to_exclude_ids;
+                    num_tree->search(EQUALS, bool_int64, to_exclude_ids);
 
-                    uint32_t* excluded_ids = nullptr;
-                    size_t excluded_ids_len = 0;
+                    id_bitmap_t excluded_ids;
+                    seq_ids->uncompress(excluded_ids);
+                    excluded_ids.andnot_with(to_exclude_ids);
 
-                    excluded_ids_len = ArrayUtils::exclude_scalar(all_ids, all_ids_size, to_exclude_ids,
-                                                                  to_exclude_ids_len, &excluded_ids);
-
-                    delete [] all_ids;
-                    delete [] to_exclude_ids;
-
-                    uint32_t *out = nullptr;
-                    result_ids_len = ArrayUtils::or_scalar(result_ids, result_ids_len,
-                                                           excluded_ids, excluded_ids_len, &out);
-                    delete [] result_ids;
-                    result_ids = out;
-                    delete [] excluded_ids;
+                    result_ids.or_with(excluded_ids);
                 } else {
-                    num_tree->search(a_filter.comparators[value_index], bool_int64, &result_ids, result_ids_len);
+                    num_tree->search(a_filter.comparators[value_index], bool_int64, result_ids);
                 }
 
                 value_index++;
@@ -1650,11 +1968,11 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                 std::vector<uint32_t> exact_geo_result_ids;
 
                 if(f.is_single_geopoint()) {
-                    spp::sparse_hash_map<uint32_t, int64_t>* sort_field_index = sort_index.at(f.name);
+                    sort_column_t* sort_field_index = sort_index.at(f.name);
 
                     for(auto result_id: geo_result_ids) {
                         // no need to check for existence of `result_id` because of indexer based pre-filtering above
-                        int64_t lat_lng = sort_field_index->at(result_id);
+                        int64_t lat_lng = sort_field_index->get_or_default(result_id, 0);
                         S2LatLng s2_lat_lng;
                         GeoPoint::unpack_lat_lng(lat_lng, s2_lat_lng);
                         if (query_region->Contains(s2_lat_lng.ToPoint())) {
@@ -1686,12 +2004,9 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                     }
                 }
 
-                uint32_t *out = nullptr;
-                result_ids_len = ArrayUtils::or_scalar(&exact_geo_result_ids[0], exact_geo_result_ids.size(),
-                                                       result_ids, result_ids_len, &out);
-
-                delete [] result_ids;
-                result_ids = out;
+                if(!exact_geo_result_ids.empty()) {
+                    result_ids.add_many(&exact_geo_result_ids[0], exact_geo_result_ids.size());
+                }
 
                 delete query_region;
             }
@@ -1699,8 +2014,7 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
         } else if(f.is_string()) {
             art_tree* t = search_index.at(a_filter.field_name);
 
-            uint32_t* ids = nullptr;
-            size_t ids_size = 0;
+            bool ids_initialized = false;
 
             for(const std::string & filter_value: a_filter.values) {
                 uint32_t* strt_ids = nullptr;
@@ -1759,61 +2073,36 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                 if(a_filter.comparators[0] == NOT_EQUALS) {
                     // exclude records from existing IDs (from previous filters or ALL records)
                     // upstream will guarantee that NOT_EQUALS is placed right at the end of filters list
-                    uint32_t* excluded_strt_ids = nullptr;
-                    size_t excluded_strt_size = 0;
-
-                    if(ids == nullptr) {
-                        if(filter_ids == nullptr) {
-                            ids = seq_ids->uncompress();
-                            ids_size = seq_ids->num_ids();
+                    if(!ids_initialized) {
+                        if(i == 0) {
+                            seq_ids->uncompress(result_ids);
                         } else {
-                            ids = filter_ids;
-                            ids_size = filter_ids_length;
+                            result_ids = filter_bitmap;
                         }
-                    }
-
-                    excluded_strt_size = ArrayUtils::exclude_scalar(ids, ids_size, strt_ids,
-                                                                    strt_ids_size, &excluded_strt_ids);
 
-                    if(filter_ids == nullptr) {
-                        // means we had to uncompress `seq_ids` so need to free that
-                        delete [] ids;
+                        ids_initialized = true;
                     }
 
-                    ids = excluded_strt_ids;
-                    ids_size = excluded_strt_size;
-                    delete[] strt_ids;
+                    id_bitmap_t strt_bitmap;
+                    strt_bitmap.add_many(strt_ids, strt_ids_size);
+                    result_ids.andnot_with(strt_bitmap);
                 } else {
                     // Otherwise, we just ensure that given record contains tokens in the filter query
-                    uint32_t* out = nullptr;
-                    ids_size = ArrayUtils::or_scalar(ids, ids_size, strt_ids, strt_ids_size, &out);
-                    delete[] strt_ids;
-                    delete[] ids;
-                    ids = out;
+                    result_ids.add_many(strt_ids, strt_ids_size);
                 }
-            }
 
-            result_ids = ids;
-            result_ids_len = ids_size;
+                delete[] strt_ids;
+            }
         }
 
         if(i == 0) {
-            filter_ids = result_ids;
-            filter_ids_length = result_ids_len;
+            filter_bitmap = std::move(result_ids);
         } else {
-            uint32_t* filtered_results = nullptr;
-            filter_ids_length = ArrayUtils::and_scalar(filter_ids, filter_ids_length, result_ids,
-                                                       result_ids_len, &filtered_results);
-            delete [] result_ids;
-            delete [] filter_ids;
-            filter_ids = filtered_results;
+            filter_bitmap.and_with(result_ids);
         }
     }
 
-    if(filter_ids_length == 0) {
-        delete [] filter_ids;
-        filter_ids = nullptr;
-    }
+    filter_ids_length = filter_bitmap.uncompress(&filter_ids);
 
     /*long long int timeMillis =
             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - begin).count();
@@ -1822,6 +2111,143 @@ void Index::do_filtering(uint32_t*& filter_ids, uint32_t& filter_ids_length,
 }
 
 
+filter_iterator_t* Index::build_filter_iterator(const std::vector<filter>& filters) const {
+    // clauses that can't be walked in place are evaluated eagerly into a sorted array
+    auto materialize = [this](const filter& a_filter) -> filter_iterator_t* {
+        uint32_t* ids = nullptr;
+        uint32_t ids_length = 0;
+        do_filtering(ids, ids_length, {a_filter}, false);
+        return new array_filter_iterator_t(ids, ids_length);
+    };
+
+    std::vector<filter_iterator_t*> clause_its;
+
+    for(const filter& a_filter: filters) {
+        if(a_filter.field_name == "id") {
+            clause_its.push_back(materialize(a_filter));
+            continue;
+        }
+
+        bool has_search_index = search_index.count(a_filter.field_name) != 0 ||
+                                numerical_index.count(a_filter.field_name) != 0 ||
+                                geopoint_index.count(a_filter.field_name) != 0;
+
+        if(!has_search_index) {
+            continue;
+        }
+
+        field f = search_schema.at(a_filter.field_name);
+
+        if(f.is_geopoint() || (f.is_string() && a_filter.comparators[0] == EQUALS)) {
+            clause_its.push_back(materialize(a_filter));
+        } else if(f.is_string() && a_filter.comparators[0] == NOT_EQUALS) {
+            // only the (usually few) exact matches are materialized, the rest is walked off `seq_ids`
+            filter equals_filter = a_filter;
+            equals_filter.comparators.assign(a_filter.comparators.size(), EQUALS);
+            clause_its.push_back(new not_filter_iterator_t(new ids_filter_iterator_t(seq_ids),
+                                                           materialize(equals_filter)));
+        } else if(f.is_string()) {
+            art_tree* t = search_index.at(a_filter.field_name);
+            std::vector<filter_iterator_t*> value_its;
+
+            for(const std::string& filter_value: a_filter.values) {
+                std::vector<void*> posting_lists;
+
+                // tokens of a filter value are treated as ANDs, e.g. country: South Africa
+                Tokenizer tokenizer(filter_value, true, false, f.locale, symbols_to_index, token_separators);
+
+                std::string str_token;
+                size_t token_index = 0;
+                size_t num_tokens = 0;
+
+                while(tokenizer.next(str_token, token_index)) {
+                    num_tokens++;
+
+                    art_leaf* leaf = (art_leaf *) art_search(t, (const unsigned char*) str_token.c_str(),
+                                                             str_token.length()+1);
+                    if(leaf != nullptr) {
+                        posting_lists.push_back(leaf->values);
+                    }
+                }
+
+                if(posting_lists.empty() || posting_lists.size() != num_tokens) {
+                    continue;
+                }
+
+                value_its.push_back(new posting_filter_iterator_t(posting_lists));
+            }
+
+            clause_its.push_back(new or_filter_iterator_t(value_its));
+        } else {
+            auto num_tree = numerical_index.at(a_filter.field_name);
+
+            std::vector<void*> id_lists;
+            std::vector<filter_iterator_t*> value_its;
+
+            for(size_t fi = 0; fi < a_filter.values.size(); fi++) {
+                const std::string& filter_value = a_filter.values[fi];
+                const bool is_range = (a_filter.comparators[fi] == RANGE_INCLUSIVE && fi+1 < a_filter.values.size());
+                int64_t value, range_end_value = 0;
+
+                if(f.is_integer()) {
+                    value = (int64_t) std::stol(filter_value);
+                    range_end_value = is_range ? (int64_t) std::stol(a_filter.values[fi+1]) : 0;
+                } else if(f.is_float()) {
+                    value = float_to_in64_t((float) std::atof(filter_value.c_str()));
+                    range_end_value = is_range ? float_to_in64_t((float) std::atof(a_filter.values[fi+1].c_str())) : 0;
+                } else {
+                    value = (filter_value == "1") ? 1 : 0;
+                }
+
+                if(f.is_bool() && a_filter.comparators[fi] == NOT_EQUALS) {
+                    std::vector<void*> excluded_id_lists;
+                    num_tree->search(EQUALS, value, excluded_id_lists);
+
+                    std::vector<filter_iterator_t*> excluded_its;
+                    for(void* excluded_id_list: excluded_id_lists) {
+                        excluded_its.push_back(new ids_filter_iterator_t(excluded_id_list));
+                    }
+
+                    value_its.push_back(new not_filter_iterator_t(new ids_filter_iterator_t(seq_ids),
+                                                                  new or_filter_iterator_t(excluded_its)));
+                } else if(is_range) {
+                    num_tree->range_inclusive_search(value, range_end_value, id_lists);
+                    fi++;
+                } else {
+                    num_tree->search(a_filter.comparators[fi], value, id_lists);
+                }
+            }
+
+            if(id_lists.size() > LAZY_FILTER_MAX_ID_LISTS) {
+                // OR-ing many lists lazily is slower than merging them into a bitmap once
+                for(filter_iterator_t* value_it: value_its) {
+                    delete value_it;
+                }
+
+                clause_its.push_back(materialize(a_filter));
+                continue;
+            }
+
+            for(void* id_list: id_lists) {
+                value_its.push_back(new ids_filter_iterator_t(id_list));
+            }
+
+            if(value_its.size() == 1) {
+                clause_its.push_back(value_its[0]);
+            } else {
+                clause_its.push_back(new or_filter_iterator_t(value_its));
+            }
+        }
+    }
+
+    if(clause_its.size() == 1) {
+        return clause_its[0];
+    }
+
+    // an empty AND matches nothing, just like `do_filtering` with no usable clause
+    return new and_filter_iterator_t(clause_its);
+}
+
 void Index::do_filtering_with_lock(uint32_t*& filter_ids, uint32_t& filter_ids_length,
                                    const std::vector<filter>& filters) const {
     std::shared_lock lock(mutex);
@@ -1837,7 +2263,7 @@ void Index::run_search(search_args* search_params) {
            search_params->topster, search_params->curated_topster,
            search_params->per_page, search_params->page, search_params->token_order,
            search_params->prefixes, search_params->drop_tokens_threshold,
-           search_params->all_result_ids_len, search_params->groups_processed,
+           search_params->all_result_ids_len, search_params->num_pruned_ids, search_params->groups_processed,
            search_params->searched_queries,
            search_params->qtoken_set,
            search_params->raw_result_kvs, search_params->override_result_kvs,
@@ -1846,6 +2272,7 @@ void Index::run_search(search_args* search_params) {
            search_params->default_sorting_field,
            search_params->prioritize_exact_match,
            search_params->prioritize_token_position,
+           search_params->max_score_pruning,
            search_params->exhaustive_search,
            search_params->concurrency,
            search_params->search_cutoff_ms,
@@ -1857,7 +2284,9 @@ void Index::run_search(search_args* search_params) {
            search_params->max_extra_suffix,
            search_params->facet_query_num_typos,
            search_params->filter_curated_hits,
-           search_params->split_join_tokens);
+           search_params->split_join_tokens,
+           search_params->facet_sample_percent,
+           search_params->facet_sample_threshold);
 }
 
 void Index::collate_included_ids(const std::vector<token_t>& q_included_tokens,
@@ -2182,80 +2611,55 @@ bool Index::check_for_overrides(const token_ordering& token_order, const string&
     return false;
 }
 
+void Index::schedule_infix_rebuild(infix_index_t* field_infix_index) const {
+    std::shared_ptr<infix_rebuild_t> infix_rebuild = field_infix_index->begin_rebuild();
+
+    if(infix_rebuild == nullptr) {
+        return ;
+    }
+
+    // The rebuild owns its snapshot, and is picked up by the next write to the infix index once it completes. It
+    // runs on the lowest priority lane, within the cap of concurrent writes, so that it never delays searches.
+    thread_pool->enqueue(ThreadPool::lane_t::WRITE, [infix_rebuild]() {
+        infix_index_t::run_rebuild(*infix_rebuild);
+    });
+}
+
 void Index::search_infix(const std::string& query, const std::string& field_name,
                          std::vector<uint32_t>& ids, const size_t max_extra_prefix, const size_t max_extra_suffix) const {
 
-    auto infix_maps_it = infix_index.find(field_name);
+    auto infix_index_it = infix_index.find(field_name);
 
-    if(infix_maps_it == infix_index.end()) {
+    if(infix_index_it == infix_index.end()) {
         return ;
     }
 
-    auto infix_sets = infix_maps_it->second;
-    std::vector<art_leaf*> leaves;
-
-    size_t num_processed = 0;
-    std::mutex m_process;
-    std::condition_variable cv_process;
+    std::vector<std::string> tokens;
+    infix_index_it->second->search(query, max_extra_prefix, max_extra_suffix, tokens);
 
     auto search_tree = search_index.at(field_name);
+    std::vector<void*> token_values;
 
-    const auto parent_search_begin = search_begin;
-    const auto parent_search_stop_ms = search_stop_ms;
-    auto parent_search_cutoff = search_cutoff;
-
-    for(auto infix_set: infix_sets) {
-        thread_pool->enqueue([infix_set, &leaves, search_tree, &query, max_extra_prefix, max_extra_suffix,
-                              &num_processed, &m_process, &cv_process,
-                              &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff]() {
+    for(size_t i = 0; i < tokens.size(); i++) {
+        const std::string& token = tokens[i];
+        art_leaf* l = (art_leaf *) art_search(search_tree, (const unsigned char *) token.c_str(), token.size()+1);
 
-            search_begin = parent_search_begin;
-            search_cutoff = parent_search_cutoff;
-            auto op_search_stop_ms = parent_search_stop_ms/2;
-
-            std::vector<art_leaf*> this_leaves;
-            std::string key_buffer;
-            size_t num_iterated = 0;
-
-            for(auto it = infix_set->begin(); it != infix_set->end(); it++) {
-                it.key(key_buffer);
-                num_iterated++;
-
-                auto start_index = key_buffer.find(query);
-                if(start_index != std::string::npos && start_index <= max_extra_prefix &&
-                   (key_buffer.size() - (start_index + query.size())) <= max_extra_suffix) {
-                    art_leaf* l = (art_leaf *) art_search(search_tree,
-                                                          (const unsigned char *) key_buffer.c_str(),
-                                                          key_buffer.size()+1);
-                    if(l != nullptr) {
-                        this_leaves.push_back(l);
-                    }
-                }
+        if(l != nullptr) {
+            token_values.push_back(l->values);
+        }
 
-                // check for search cutoff but only once every 2^10 docs to reduce overhead
-                if(((num_iterated + 1) % (1 << 12)) == 0) {
-                    if (std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::high_resolution_clock::now() - search_begin).count() > op_search_stop_ms) {
-                        search_cutoff = true;
-                        break;
-                    }
-                }
+        // check for search cutoff but only once every 2^12 tokens to reduce overhead
+        if(((i + 1) % (1 << 12)) == 0) {
+            if (std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::high_resolution_clock::now() - search_begin).count() > search_stop_ms) {
+                search_cutoff = true;
+                break;
             }
-
-            std::unique_lock<std::mutex> lock(m_process);
-            leaves.insert(leaves.end(), this_leaves.begin(), this_leaves.end());
-            num_processed++;
-            parent_search_cutoff = parent_search_cutoff || search_cutoff;
-            cv_process.notify_one();
-        });
+        }
     }
 
-    std::unique_lock<std::mutex> lock_process(m_process);
-    cv_process.wait(lock_process, [&](){ return num_processed == infix_sets.size(); });
-    search_cutoff = parent_search_cutoff;
-
-    for(auto leaf: leaves) {
-        posting_t::merge({leaf->values}, ids);
+    for(auto values: token_values) {
+        posting_t::merge({values}, ids);
     }
 }
 
@@ -2266,7 +2670,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                    const std::vector<uint32_t>& num_typos, Topster* topster, Topster* curated_topster,
                    const size_t per_page,
                    const size_t page, const token_ordering token_order, const std::vector<bool>& prefixes,
-                   const size_t drop_tokens_threshold, size_t& all_result_ids_len,
+                   const size_t drop_tokens_threshold, size_t& all_result_ids_len, size_t& num_pruned_ids,
                    spp::sparse_hash_set<uint64_t>& groups_processed,
                    std::vector<std::vector<art_leaf*>>& searched_queries,
                    tsl::htrie_map<char, token_leaf>& qtoken_set,
@@ -2274,22 +2678,56 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                    const size_t typo_tokens_threshold, const size_t group_limit,
                    const std::vector<std::string>& group_by_fields,
                    const string& default_sorting_field, bool prioritize_exact_match,
-                   const bool prioritize_token_position, bool exhaustive_search,
+                   const bool prioritize_token_position, const bool max_score_pruning, bool exhaustive_search,
                    size_t concurrency, size_t search_cutoff_ms, size_t min_len_1typo, size_t min_len_2typo,
                    size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                    const size_t max_extra_suffix, const size_t facet_query_num_typos,
-                   const bool filter_curated_hits, const enable_t split_join_tokens) const {
+                   const bool filter_curated_hits, const enable_t split_join_tokens,
+                   const size_t facet_sample_percent, const size_t facet_sample_threshold) const {
+
+    // Blocks skipped under `max_score_pruning` never reach the result IDs that facets are counted from, so they are
+    // only skipped when no facets are asked for. Documents are still individually exempted from scoring.
+    const bool skip_pruned_blocks = max_score_pruning && facets.empty();
 
     // process the filters
 
     uint32_t* filter_ids = nullptr;
     uint32_t filter_ids_length = 0;
 
+    // when set, filters are intersected lazily with the text matches instead of being materialized
+    filter_iterator_t* filter_iterator = nullptr;
+
     std::shared_lock lock(mutex);
 
-    do_filtering(filter_ids, filter_ids_length, filters, true);
+    // read before anything is computed, so that counts computed before a write to their fields are never cached
+    std::vector<uint64_t> facet_cache_generations(facets.size());
+    for(size_t fi = 0; fi < facets.size(); fi++) {
+        facet_cache_generations[fi] = get_facet_cache_generation(filters, facets[fi]);
+    }
+
+    const bool is_text_query = !field_query_tokens.empty() && !(!field_query_tokens[0].q_include_tokens.empty() &&
+                                                                field_query_tokens[0].q_include_tokens[0].value == "*");
 
-    if(!filters.empty() && filter_ids_length == 0) {
+    // phrases, infixes and filtered curation need the filter IDs upfront
+    const bool filter_lazily = !filters.empty() && is_text_query && field_query_tokens[0].q_phrases.empty() &&
+                               !(filter_curated_hits && !included_ids.empty()) &&
+                               std::all_of(infixes.begin(), infixes.end(), [](enable_t infix) { return infix == off; });
+
+    if(filter_lazily) {
+        filter_iterator = build_filter_iterator(filters);
+
+        if(filter_iterator->estimated_size() < LAZY_FILTER_MIN_IDS) {
+            // cheap enough to materialize, which allows the filter to be pushed down into the trie traversal
+            filter_ids_length = filter_iterator->uncompress(&filter_ids);
+            delete filter_iterator;
+            filter_iterator = nullptr;
+        }
+    } else {
+        do_filtering(filter_ids, filter_ids_length, filters, true);
+    }
+
+    if(!filters.empty() && filter_ids_length == 0 && (filter_iterator == nullptr || !filter_iterator->valid())) {
+        delete filter_iterator;
         return ;
     }
 
@@ -2322,15 +2760,15 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
     handle_exclusion(num_search_fields, field_query_tokens, the_fields, exclude_token_ids, exclude_token_ids_size);
 
     int sort_order[3]; // 1 or -1 based on DESC or ASC respectively
-    std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values;
+    std::array<sort_column_t*, 3> field_values;
     std::vector<size_t> geopoint_indices;
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields_std, field_values);
 
     // Prepare excluded document IDs that we can later remove from the result set
     uint32_t* excluded_result_ids = nullptr;
-    size_t excluded_result_ids_size = ArrayUtils::or_scalar(exclude_token_ids, exclude_token_ids_size,
-                                                            &curated_ids_sorted[0], curated_ids_sorted.size(),
-                                                            &excluded_result_ids);
+    size_t excluded_result_ids_size = ArrayUtils::or_simd(exclude_token_ids, exclude_token_ids_size,
+                                                          &curated_ids_sorted[0], curated_ids_sorted.size(),
+                                                          &excluded_result_ids);
 
     auto is_wildcard_query = !field_query_tokens.empty() && !field_query_tokens[0].q_include_tokens.empty() &&
                              field_query_tokens[0].q_include_tokens[0].value == "*";
@@ -2390,11 +2828,11 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         fuzzy_search_fields(the_fields, field_query_tokens[0].q_include_tokens, excluded_result_ids,
                             excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
                             sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
-                            prioritize_token_position, query_hashes, token_order, prefixes,
-                            typo_tokens_threshold, exhaustive_search,
+                            all_result_ids, all_result_ids_len, num_pruned_ids, group_limit, group_by_fields, prioritize_exact_match,
+                            prioritize_token_position, max_score_pruning, skip_pruned_blocks, query_hashes, token_order, prefixes,
+                            typo_tokens_threshold, exhaustive_search, concurrency,
                             max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order,
-                            field_values, geopoint_indices);
+                            field_values, geopoint_indices, filter_iterator);
 
         // try split/joining tokens if no results are found
         if(split_join_tokens == always || (all_result_ids_len == 0 && split_join_tokens == fallback)) {
@@ -2427,22 +2865,24 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 fuzzy_search_fields(the_fields, resolved_tokens, excluded_result_ids,
                                     excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
                                     sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                                    all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
-                                    prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold, exhaustive_search,
-                                    max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices);
+                                    all_result_ids, all_result_ids_len, num_pruned_ids, group_limit, group_by_fields, prioritize_exact_match,
+                                    prioritize_token_position, max_score_pruning, skip_pruned_blocks, query_hashes, token_order, prefixes, typo_tokens_threshold, exhaustive_search, concurrency,
+                                    max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices,
+                                    filter_iterator);
             }
         }
 
         // do synonym based searches
         do_synonym_search(the_fields, filters, included_ids_map, sort_fields_std, curated_topster, token_order,
-                          0, group_limit, group_by_fields, prioritize_exact_match, prioritize_token_position,
+                          0, group_limit, group_by_fields, prioritize_exact_match, prioritize_token_position, max_score_pruning,
+                          skip_pruned_blocks,
                           exhaustive_search, concurrency, prefixes,
                           min_len_1typo, min_len_2typo, max_candidates, curated_ids, curated_ids_sorted,
                           excluded_result_ids, excluded_result_ids_size, topster, q_pos_synonyms, syn_orig_num_tokens,
-                          groups_processed, searched_queries, all_result_ids, all_result_ids_len,
+                          groups_processed, searched_queries, all_result_ids, all_result_ids_len, num_pruned_ids,
                           filter_ids, filter_ids_length, query_hashes,
                           sort_order, field_values, geopoint_indices,
-                          qtoken_set);
+                          qtoken_set, filter_iterator);
 
         // gather up both original query and synonym queries and do drop tokens
 
@@ -2483,10 +2923,11 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                         fuzzy_search_fields(the_fields, truncated_tokens, excluded_result_ids,
                                             excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
                                             sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
-                                            prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
-                                            exhaustive_search, max_candidates, min_len_1typo,
-                                            min_len_2typo, -1, sort_order, field_values, geopoint_indices);
+                                            all_result_ids, all_result_ids_len, num_pruned_ids, group_limit, group_by_fields, prioritize_exact_match,
+                                            prioritize_token_position, max_score_pruning, skip_pruned_blocks, query_hashes, token_order, prefixes, typo_tokens_threshold,
+                                            exhaustive_search, concurrency, max_candidates, min_len_1typo,
+                                            min_len_2typo, -1, sort_order, field_values, geopoint_indices,
+                                            filter_iterator);
 
                     } else {
                         break;
@@ -2515,21 +2956,50 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
     delete [] excluded_result_ids;
 
     if(!facets.empty()) {
-        const size_t num_threads = std::min(concurrency, all_result_ids_len);
-        const size_t window_size = (num_threads == 0) ? 0 :
-                                   (all_result_ids_len + num_threads - 1) / num_threads;  // rounds up
-        size_t num_processed = 0;
-        std::mutex m_process;
-        std::condition_variable cv_process;
-
         std::vector<facet_info_t> facet_infos(facets.size());
         compute_facet_infos(facets, facet_query, facet_query_num_typos, all_result_ids, all_result_ids_len,
                             group_by_fields, max_candidates, facet_infos);
 
+        // Large result sets can be faceted over a sample of the results. Distinct counts of groups can't be
+        // extrapolated from a sample, so grouped results are always counted exhaustively.
+        const bool sample_facets = (facet_sample_percent < 100 && group_limit == 0 &&
+                                    all_result_ids_len > facet_sample_threshold);
+
+        uint32_t* facet_ids = all_result_ids;
+        size_t facet_ids_len = all_result_ids_len;
+        std::vector<uint32_t> sampled_ids;
+
+        if(sample_facets) {
+            sample_result_ids(all_result_ids, all_result_ids_len, facet_sample_percent, sampled_ids);
+            facet_ids = sampled_ids.data();
+            facet_ids_len = sampled_ids.size();
+        }
+
+        // wildcard searches without curation facet the same results for the same filters, until the next write
+        const bool cache_facets = (!is_text_query && included_ids.empty() && excluded_ids.empty() &&
+                                   group_limit == 0 && !sample_facets);
+        std::vector<std::string> facet_cache_keys(facets.size());
+        std::vector<bool> cached_facets(facets.size(), false);
+
+        for(size_t fi = 0; cache_facets && fi < facets.size(); fi++) {
+            if(!facet_infos[fi].use_facet_query) {
+                facet_cache_keys[fi] = get_facet_cache_key(filters, facets[fi]);
+                cached_facets[fi] = get_cached_facet(facet_cache_keys[fi], facet_cache_generations[fi], facets[fi]);
+            }
+        }
+
+        // small result sets are not worth splitting across threads
+        const size_t num_threads = std::min(concurrency,
+                                            (facet_ids_len + FACET_PARALLEL_MIN_IDS - 1) / FACET_PARALLEL_MIN_IDS);
+        const size_t window_size = (num_threads == 0) ? 0 :
+                                   (facet_ids_len + num_threads - 1) / num_threads;  // rounds up
+        size_t num_processed = 0;
+        std::mutex m_process;
+
         std::vector<std::vector<facet>> facet_batches(num_threads);
         for(size_t i = 0; i < num_threads; i++) {
             for(const auto& this_facet: facets) {
-                facet_batches[i].emplace_back(facet(this_facet.field_name));
+                facet_batches[i].emplace_back(facet(this_facet.field_name, this_facet.ranges));
             }
         }
 
@@ -2538,67 +3008,76 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
 
         //auto beginF = std::chrono::high_resolution_clock::now();
 
-        for(size_t thread_id = 0; thread_id < num_threads && result_index < all_result_ids_len; thread_id++) {
+        // every window of the results is counted separately for each facet field
+        for(size_t thread_id = 0; thread_id < num_threads && result_index < facet_ids_len; thread_id++) {
             size_t batch_res_len = window_size;
 
-            if(result_index + window_size > all_result_ids_len) {
-                batch_res_len = all_result_ids_len - result_index;
+            if(result_index + window_size > facet_ids_len) {
+                batch_res_len = facet_ids_len - result_index;
             }
 
-            uint32_t* batch_result_ids = all_result_ids + result_index;
-            num_queued++;
+            uint32_t* batch_result_ids = facet_ids + result_index;
 
-            thread_pool->enqueue([this, thread_id, &facet_batches, &facet_query, group_limit, group_by_fields,
-                                         batch_result_ids, batch_res_len, &facet_infos,
-                                         &num_processed, &m_process, &cv_process]() {
-                auto fq = facet_query;
-                do_facets(facet_batches[thread_id], fq, facet_infos, group_limit, group_by_fields,
-                          batch_result_ids, batch_res_len);
-                std::unique_lock<std::mutex> lock(m_process);
-                num_processed++;
-                cv_process.notify_one();
-            });
+            for(size_t fi = 0; fi < facets.size(); fi++) {
+                if(cached_facets[fi]) {
+                    continue;
+                }
+
+                num_queued++;
+
+                thread_pool->fork([this, thread_id, fi, &facet_batches, group_limit, &group_by_fields,
+                                   batch_result_ids, batch_res_len, &facet_infos,
+                                   &num_processed, &m_process]() {
+                    do_facet(facet_batches[thread_id][fi], facet_infos[fi], group_limit, group_by_fields,
+                             batch_result_ids, batch_res_len);
+                    std::unique_lock<std::mutex> lock(m_process);
+                    num_processed++;
+                });
+            }
 
             result_index += batch_res_len;
         }
 
-        std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-
-        for(auto& facet_batch: facet_batches) {
-            for(size_t fi = 0; fi < facet_batch.size(); fi++) {
-                auto& this_facet = facet_batch[fi];
-                auto& acc_facet = facets[fi];
-
-                for(auto & facet_kv: this_facet.result_map) {
-                    if(group_limit) {
-                        // we have to add all group sets
-                        acc_facet.hash_groups[facet_kv.first].insert(
-                            this_facet.hash_groups[facet_kv.first].begin(),
-                            this_facet.hash_groups[facet_kv.first].end()
-                        );
-                    } else {
-                        size_t count = 0;
-                        if(acc_facet.result_map.count(facet_kv.first) == 0) {
-                            // not found, so set it
-                            count = facet_kv.second.count;
-                        } else {
-                            count = acc_facet.result_map[facet_kv.first].count + facet_kv.second.count;
-                        }
-                        acc_facet.result_map[facet_kv.first].count = count;
-                    }
+        thread_pool->wait_until([&]() {
+            std::unique_lock<std::mutex> lock_process(m_process);
+            return num_processed == num_queued;
+        });
+
+        // partial counts of the windows are merged independently for each facet field
+        num_processed = 0;
+        num_queued = 0;
+
+        for(size_t fi = 0; fi < facets.size(); fi++) {
+            if(cached_facets[fi]) {
+                continue;
+            }
+
+            num_queued++;
 
-                    acc_facet.result_map[facet_kv.first].doc_id = facet_kv.second.doc_id;
-                    acc_facet.result_map[facet_kv.first].array_pos = facet_kv.second.array_pos;
-                    acc_facet.hash_tokens[facet_kv.first] = this_facet.hash_tokens[facet_kv.first];
+            thread_pool->fork([fi, &facets, &facet_batches, group_limit, sample_facets, all_result_ids_len,
+                               facet_ids_len, &num_processed, &m_process]() {
+                for(auto& facet_batch: facet_batches) {
+                    merge_facet(facets[fi], facet_batch[fi], group_limit);
                 }
 
-                if(this_facet.stats.fvcount != 0) {
-                    acc_facet.stats.fvcount += this_facet.stats.fvcount;
-                    acc_facet.stats.fvsum += this_facet.stats.fvsum;
-                    acc_facet.stats.fvmax = std::max(acc_facet.stats.fvmax, this_facet.stats.fvmax);
-                    acc_facet.stats.fvmin = std::min(acc_facet.stats.fvmin, this_facet.stats.fvmin);
+                if(sample_facets) {
+                    extrapolate_facet(facets[fi], double(all_result_ids_len) / std::max<size_t>(facet_ids_len, 1));
                 }
+
+                std::unique_lock<std::mutex> lock(m_process);
+                num_processed++;
+            });
+        }
+
+        thread_pool->wait_until([&]() {
+            std::unique_lock<std::mutex> lock_process(m_process);
+            return num_processed == num_queued;
+        });
+
+        // results of a search that was cut off are partial
+        for(size_t fi = 0; cache_facets && !search_cutoff && fi < facets.size(); fi++) {
+            if(!facet_infos[fi].use_facet_query && !cached_facets[fi]) {
+                cache_facet(facet_cache_keys[fi], facet_cache_generations[fi], filters, facets[fi]);
             }
         }
 
@@ -2615,6 +3094,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
     all_result_ids_len += curated_topster->size;
 
     delete [] filter_ids;
+    delete filter_iterator;
     delete [] all_result_ids;
 
     //LOG(INFO) << "all_result_ids_len " << all_result_ids_len << " for index " << name;
@@ -2639,7 +3119,7 @@ void Index::process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>
 
     if(filter_ids_length != 0 && filter_curated_hits) {
         uint32_t* included_ids_arr = nullptr;
-        size_t included_ids_len = ArrayUtils::and_scalar(&included_ids_vec[0], included_ids_vec.size(), filter_ids,
+        size_t included_ids_len = ArrayUtils::and_simd(&included_ids_vec[0], included_ids_vec.size(), filter_ids,
                                                         filter_ids_length, &included_ids_arr);
 
         included_ids_vec.clear();
@@ -2712,22 +3192,26 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                                 std::vector<std::vector<art_leaf*>> & searched_queries,
                                 tsl::htrie_map<char, token_leaf>& qtoken_set,
                                 Topster* topster, spp::sparse_hash_set<uint64_t>& groups_processed,
-                                uint32_t*& all_result_ids, size_t & all_result_ids_len,
+                                uint32_t*& all_result_ids, size_t & all_result_ids_len, size_t& num_pruned_ids,
                                 const size_t group_limit, const std::vector<std::string>& group_by_fields,
                                 bool prioritize_exact_match,
                                 const bool prioritize_token_position,
+                                const bool max_score_pruning,
+                                const bool skip_pruned_blocks,
                                 std::set<uint64>& query_hashes,
                                 const token_ordering token_order,
                                 const std::vector<bool>& prefixes,
                                 const size_t typo_tokens_threshold,
                                 const bool exhaustive_search,
+                                const size_t concurrency,
                                 const size_t max_candidates,
                                 size_t min_len_1typo,
                                 size_t min_len_2typo,
                                 int syn_orig_num_tokens,
                                 const int* sort_order,
-                                std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
-                                const std::vector<size_t>& geopoint_indices) const {
+                                std::array<sort_column_t*, 3>& field_values,
+                                const std::vector<size_t>& geopoint_indices,
+                                filter_iterator_t* filter_iterator) const {
 
     // NOTE: `query_tokens` preserve original tokens, while `search_tokens` could be a result of dropped tokens
 
@@ -2796,7 +3280,6 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                     auto& the_field = the_fields[field_id];
                     const bool field_prefix = (field_id < prefixes.size()) ? prefixes[field_id] : prefixes[0];;
                     const bool prefix_search = field_prefix && query_tokens[token_index].is_prefix_searched;
-                    const size_t token_len = prefix_search ? (int) token.length() : (int) token.length() + 1;
 
                     /*LOG(INFO) << "Searching for field: " << the_field.name << ", token:"
                               << token << " - cost: " << costs[token_index] << ", prefix_search: " << prefix_search;*/
@@ -2814,9 +3297,10 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                     }
 
                     size_t max_words = 100000;
-                    art_fuzzy_search(search_index.at(the_field.name), (const unsigned char *) token.c_str(), token_len,
-                                     costs[token_index], costs[token_index], max_words, token_order, prefix_search,
-                                     filter_ids, filter_ids_length, leaves, unique_tokens);
+                    // a lazy filter is checked while the leaves are picked, so that `max_words` only counts
+                    // the leaves with a filtered ID
+                    fuzzy_search_field(the_field.name, token, costs[token_index], prefix_search, max_words, token_order,
+                                       filter_ids, filter_ids_length, filter_iterator, leaves, unique_tokens);
 
                     /*auto timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
                                     std::chrono::high_resolution_clock::now() - begin).count();
@@ -2879,12 +3363,13 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
             search_all_candidates(num_search_fields, the_fields, filter_ids, filter_ids_length,
                                   exclude_token_ids, exclude_token_ids_size,
                                   sort_fields, token_candidates_vec, searched_queries, qtoken_set, topster,
-                                  groups_processed, all_result_ids, all_result_ids_len,
+                                  groups_processed, all_result_ids, all_result_ids_len, num_pruned_ids,
                                   typo_tokens_threshold, group_limit, group_by_fields, query_tokens,
-                                  num_typos, prefixes, prioritize_exact_match, prioritize_token_position,
-                                  exhaustive_search, max_candidates,
+                                  num_typos, prefixes, prioritize_exact_match, prioritize_token_position, max_score_pruning,
+                                  skip_pruned_blocks,
+                                  exhaustive_search, concurrency, max_candidates,
                                   syn_orig_num_tokens, sort_order, field_values, geopoint_indices,
-                                  query_hashes, id_buff);
+                                  query_hashes, id_buff, filter_iterator);
 
             if(id_buff.size() > 1) {
                 gfx::timsort(id_buff.begin(), id_buff.end());
@@ -2892,8 +3377,8 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
             }
 
             uint32_t* new_all_result_ids = nullptr;
-            all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, &id_buff[0],
-                                                       id_buff.size(), &new_all_result_ids);
+            all_result_ids_len = ArrayUtils::or_simd(all_result_ids, all_result_ids_len, &id_buff[0],
+                                                     id_buff.size(), &new_all_result_ids);
             delete[] all_result_ids;
             all_result_ids = new_all_result_ids;
         }
@@ -2917,7 +3402,8 @@ void Index::find_across_fields(const std::vector<token_t>& query_tokens,
                                const size_t num_search_fields,
                                const uint32_t* filter_ids, uint32_t filter_ids_length,
                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
-                               std::vector<uint32_t>& id_buff) const {
+                               std::vector<uint32_t>& id_buff,
+                               filter_iterator_t* filter_iterator) const {
 
     // one iterator for each token, each underlying iterator contains results of token across multiple fields
     std::vector<or_iterator_t> token_its;
@@ -2925,7 +3411,8 @@ void Index::find_across_fields(const std::vector<token_t>& query_tokens,
     // used to track plists that must be destructed once done
     std::vector<posting_list_t*> expanded_plists;
 
-    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length,
+                               filter_iterator);
 
     // for each token, find the posting lists across all query_by fields
     for(size_t ti = 0; ti < num_query_tokens; ti++) {
@@ -3010,14 +3497,18 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
                                  const std::vector<std::string>& group_by_fields,
                                  const bool prioritize_exact_match,
                                  const bool prioritize_token_position,
+                                 const bool max_score_pruning,
+                                 const bool skip_pruned_blocks,
+                                 const size_t concurrency,
                                  const uint32_t* filter_ids, uint32_t filter_ids_length,
                                  const uint32_t total_cost, const int syn_orig_num_tokens,
                                  const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                  const int* sort_order,
-                                 std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                                 std::array<sort_column_t*, 3>& field_values,
                                  const std::vector<size_t>& geopoint_indices,
                                  std::vector<uint32_t>& id_buff,
-                                 uint32_t*& all_result_ids, size_t& all_result_ids_len) const {
+                                 uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
+                                 filter_iterator_t* filter_iterator) const {
 
     std::vector<art_leaf*> query_suggestion;
 
@@ -3027,7 +3518,8 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     // used to track plists that must be destructed once done
     std::vector<posting_list_t*> expanded_plists;
 
-    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length,
+                               filter_iterator);
 
     // for each token, find the posting lists across all query_by fields
     for(size_t ti = 0; ti < query_tokens.size(); ti++) {
@@ -3079,20 +3571,99 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
             }
         }
 
-        if(its.empty()) {
-            // this token does not have any match across *any* field: probably a typo
-            LOG(INFO) << "No matching field found for token: " << token_str;
-            continue;
-        }
+        if(its.empty()) {
+            // this token does not have any match across *any* field: probably a typo
+            LOG(INFO) << "No matching field found for token: " << token_str;
+            continue;
+        }
+
+        or_iterator_t token_fields(its);
+        token_its.push_back(std::move(token_fields));
+    }
+
+    std::vector<uint32_t> result_ids;
+
+    size_t query_len = query_tokens.size();
+    if(syn_orig_num_tokens != -1) {
+        query_len = syn_orig_num_tokens;
+    }
+
+    // Disjoint ranges of IDs are scored in parallel. The first range writes to the actual outputs, while the others
+    // get their own topster, groups and IDs, which are merged back once the intersection is done.
+    const size_t num_ranges = std::max<size_t>(concurrency, 1);
+    std::vector<Topster*> range_topsters(num_ranges, nullptr);
+    std::vector<spp::sparse_hash_set<uint64_t>> range_groups_processed(num_ranges);
+    std::vector<std::vector<uint32_t>> range_result_ids(num_ranges);
+    std::vector<size_t> range_num_pruned_ids(num_ranges, 0);
+
+    or_iterator_t::intersect(token_its, istate, thread_pool, num_ranges, TEXT_MATCH_PARALLEL_MIN_BLOCKS,
+                             [&](uint32_t seq_id, std::vector<or_iterator_t>& its, size_t range_index) {
+        //LOG(INFO) << "seq_id: " << seq_id;
+        if(range_topsters[range_index] == nullptr) {
+            range_topsters[range_index] = (range_index == 0) ? topster :
+                                          new Topster(topster->MAX_SIZE, topster->distinct);
+        }
+
+        Topster* range_topster = range_topsters[range_index];
+        auto& range_groups = (range_index == 0) ? groups_processed : range_groups_processed[range_index];
+        auto& range_ids = (range_index == 0) ? result_ids : range_result_ids[range_index];
+
+        uint64_t distinct_id = seq_id;
+        if(group_limit != 0) {
+            distinct_id = get_distinct_id(group_by_fields, seq_id);
+            range_groups.emplace(distinct_id);
+        }
+
+        // the text match score is filled in later, since `max_field_match_score` does not affect the other scores
+        int64_t scores[3] = {0};
+        int64_t match_score_index = -1;
+
+        compute_sort_scores(sort_fields, sort_order, field_values, geopoint_indices, seq_id,
+                            0, scores, match_score_index);
+
+        const KV* threshold_kv = max_score_pruning ? range_topster->get_threshold() : nullptr;
+
+        if(skip_pruned_blocks && threshold_kv != nullptr && match_score_index == 0) {
+            // Text match is the primary sort key, so when no document up to the end of the current blocks can reach
+            // the threshold's text match, those blocks are skipped without being intersected. Their matches are not
+            // collected, so only an estimate of their number is kept for the found count.
+            uint32_t block_last_id;
+            size_t num_block_ids;
+            const uint64_t block_max_score = get_max_block_text_match_score(its, the_fields, query_len,
+                                                                            query_tokens.size(), total_cost,
+                                                                            syn_orig_num_tokens,
+                                                                            prioritize_exact_match,
+                                                                            prioritize_token_position,
+                                                                            block_last_id, num_block_ids);
+
+            if(int64_t(block_max_score) < threshold_kv->scores[0]) {
+                range_num_pruned_ids[range_index] += num_block_ids;
+                for(auto& token_fields_iter: its) {
+                    token_fields_iter.skip_to(block_last_id + 1);
+                }
+
+                return ;
+            }
+        }
+
+        if(threshold_kv != nullptr) {
+            // skip scoring a document that can't make it to the topster even with the best possible text match
+            KV bound_kv(0, searched_queries.size(), 0, seq_id, distinct_id, match_score_index, scores);
 
-        or_iterator_t token_fields(its);
-        token_its.push_back(std::move(token_fields));
-    }
+            if(match_score_index != -1) {
+                bound_kv.scores[match_score_index] = get_max_text_match_score(seq_id, its, the_fields, query_len,
+                                                                              query_tokens.size(), total_cost,
+                                                                              syn_orig_num_tokens,
+                                                                              prioritize_exact_match,
+                                                                              prioritize_token_position);
+            }
 
-    std::vector<uint32_t> result_ids;
+            if(Topster::is_smaller(&bound_kv, threshold_kv)) {
+                range_ids.push_back(seq_id);
+                return ;
+            }
+        }
 
-    or_iterator_t::intersect(token_its, istate, [&](uint32_t seq_id, const std::vector<or_iterator_t>& its) {
-        //LOG(INFO) << "seq_id: " << seq_id;
         // Convert [token -> fields] orientation to [field -> tokens] orientation
         std::vector<std::vector<posting_list_t::iterator_t>> field_to_tokens(num_search_fields);
 
@@ -3138,23 +3709,6 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
             }
         }
 
-        uint64_t distinct_id = seq_id;
-        if(group_limit != 0) {
-            distinct_id = get_distinct_id(group_by_fields, seq_id);
-            groups_processed.emplace(distinct_id);
-        }
-
-        int64_t scores[3] = {0};
-        int64_t match_score_index = -1;
-
-        compute_sort_scores(sort_fields, sort_order, field_values, geopoint_indices, seq_id,
-                            max_field_match_score, scores, match_score_index);
-
-        size_t query_len = query_tokens.size();
-        if(syn_orig_num_tokens != -1) {
-            query_len = syn_orig_num_tokens;
-        }
-
         // NOTE: `query_len` is total tokens matched across fields.
         // Within a field, only a subset can match
 
@@ -3173,10 +3727,24 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
         if(match_score_index != -1) {
             kv.scores[match_score_index] = aggregated_score;
         }
-        topster->add(&kv);
-        result_ids.push_back(seq_id);
+        range_topster->add(&kv);
+        range_ids.push_back(seq_id);
     });
 
+    for(size_t range_index = 1; range_index < num_ranges; range_index++) {
+        if(range_topsters[range_index] != nullptr) {
+            aggregate_topster(topster, range_topsters[range_index]);
+            delete range_topsters[range_index];
+        }
+
+        groups_processed.insert(range_groups_processed[range_index].begin(), range_groups_processed[range_index].end());
+        result_ids.insert(result_ids.end(), range_result_ids[range_index].begin(), range_result_ids[range_index].end());
+    }
+
+    for(const size_t range_pruned_ids: range_num_pruned_ids) {
+        num_pruned_ids += range_pruned_ids;
+    }
+
     id_buff.insert(id_buff.end(), result_ids.begin(), result_ids.end());
 
     if(id_buff.size() > 100000) {
@@ -3185,8 +3753,8 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
         id_buff.erase(std::unique( id_buff.begin(), id_buff.end() ), id_buff.end());
 
         uint32_t* new_all_result_ids = nullptr;
-        all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, &id_buff[0],
-                                                   id_buff.size(), &new_all_result_ids);
+        all_result_ids_len = ArrayUtils::or_simd(all_result_ids, all_result_ids_len, &id_buff[0],
+                                                 id_buff.size(), &new_all_result_ids);
         delete[] all_result_ids;
         all_result_ids = new_all_result_ids;
         id_buff.clear();
@@ -3204,8 +3772,124 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     }
 }
 
+uint64_t Index::get_max_text_match_score(const uint32_t seq_id, const std::vector<or_iterator_t>& its,
+                                         const std::vector<search_field_t>& the_fields, const size_t query_len,
+                                         const size_t num_query_tokens, const uint32_t total_cost,
+                                         const int syn_orig_num_tokens, const bool prioritize_exact_match,
+                                         const bool prioritize_token_position) const {
+    size_t field_num_tokens[FIELD_LIMIT_NUM] = {0};
+    bool field_maybe_verbatim[FIELD_LIMIT_NUM] = {false};
+
+    for(const or_iterator_t& token_fields_iters: its) {
+        for(const posting_list_t::iterator_t& field_iter: token_fields_iters.get_its()) {
+            if(field_iter.valid() && field_iter.id() == seq_id) {
+                const uint32_t fi = field_iter.get_field_id();
+                field_num_tokens[fi]++;
+                field_maybe_verbatim[fi] = posting_list_t::maybe_single_token_verbatim_match(field_iter);
+            }
+        }
+    }
+
+    return get_text_match_bound(field_num_tokens, field_maybe_verbatim, false, the_fields, query_len,
+                                num_query_tokens, total_cost, syn_orig_num_tokens, prioritize_exact_match,
+                                prioritize_token_position);
+}
+
+uint64_t Index::get_max_block_text_match_score(const std::vector<or_iterator_t>& its,
+                                               const std::vector<search_field_t>& the_fields, const size_t query_len,
+                                               const size_t num_query_tokens, const uint32_t total_cost,
+                                               const int syn_orig_num_tokens, const bool prioritize_exact_match,
+                                               const bool prioritize_token_position,
+                                               uint32_t& block_last_id, size_t& num_block_ids) const {
+    // Every ID up to the end of the earliest ending current block can only be found in the current blocks of the
+    // iterators, so a field can match at most as many tokens as it has iterators for.
+
+    size_t field_num_tokens[FIELD_LIMIT_NUM] = {0};
+    bool field_maybe_verbatim[FIELD_LIMIT_NUM] = {false};
+
+    block_last_id = UINT32_MAX;
+    num_block_ids = 0;
+
+    for(const or_iterator_t& token_fields_iters: its) {
+        for(const posting_list_t::iterator_t& field_iter: token_fields_iters.get_its()) {
+            if(!field_iter.valid()) {
+                continue;
+            }
+
+            const uint32_t fi = field_iter.get_field_id();
+            field_num_tokens[fi]++;
+            field_maybe_verbatim[fi] = field_maybe_verbatim[fi] ||
+                                       posting_list_t::maybe_single_token_verbatim_match(field_iter);
+
+            if(field_iter.last_block_id() < block_last_id) {
+                block_last_id = field_iter.last_block_id();
+                num_block_ids = field_iter.num_block_ids_left();
+            }
+        }
+    }
+
+    return get_text_match_bound(field_num_tokens, field_maybe_verbatim, true, the_fields, query_len,
+                                num_query_tokens, total_cost, syn_orig_num_tokens, prioritize_exact_match,
+                                prioritize_token_position);
+}
+
+uint64_t Index::get_text_match_bound(const size_t* field_num_tokens, const bool* field_maybe_verbatim,
+                                     const bool fewer_tokens_possible,
+                                     const std::vector<search_field_t>& the_fields, const size_t query_len,
+                                     const size_t num_query_tokens, const uint32_t total_cost,
+                                     const int syn_orig_num_tokens, const bool prioritize_exact_match,
+                                     const bool prioritize_token_position) {
+    // Mirrors the scoring of `score_results2()` and `search_across_fields()`, but takes the best possible value
+    // for every component that depends on offsets: all tokens within the field match as a verbatim phrase at the
+    // start of the field. Only the verbatim flag of single-token matches is narrowed down per block.
+
+    const bool single_exact_query_token = (total_cost == 0 && num_query_tokens == 1);
+    const uint64_t max_offset_score = prioritize_token_position ? 255 : 0;
+
+    // when no field has a positive score, the weight of the first field is used
+    uint64_t max_field_score = the_fields[0].weight;
+
+    for(size_t fi = 0; fi < the_fields.size() && fi < FIELD_LIMIT_NUM; fi++) {
+        if(field_num_tokens[fi] == 0) {
+            continue;
+        }
+
+        // when the field might hold only some of the tokens, every smaller number of tokens is considered too
+        const size_t min_num_tokens = fewer_tokens_possible ? 1 : field_num_tokens[fi];
+
+        for(size_t num_tokens = min_num_tokens; num_tokens <= field_num_tokens[fi]; num_tokens++) {
+            uint64_t match_score;
+
+            if(num_tokens == 1) {
+                const uint8_t is_verbatim_match = uint8_t(prioritize_exact_match && single_exact_query_token &&
+                                                          field_maybe_verbatim[fi]);
+                size_t words_present = (num_query_tokens == 1 && syn_orig_num_tokens != -1) ? syn_orig_num_tokens : 1;
+                size_t distance = (num_query_tokens == 1 && syn_orig_num_tokens != -1) ? syn_orig_num_tokens-1 : 0;
+                size_t max_offset = prioritize_token_position ? 0 : 255;
+                match_score = Match(words_present, distance, max_offset, is_verbatim_match)
+                              .get_match_score(total_cost, words_present);
+            } else {
+                uint64_t num_words = num_tokens;
+                if(syn_orig_num_tokens != -1 && num_query_tokens == num_tokens) {
+                    num_words = syn_orig_num_tokens;
+                }
+
+                match_score = (num_words << 40) | (num_words << 32) | (uint64_t(255 - total_cost) << 24) |
+                              (uint64_t(100) << 16) | (uint64_t(1) << 8) | max_offset_score;
+            }
+
+            const uint64_t field_score = (match_score << 8) | uint64_t(the_fields[fi].weight);
+            if(field_score > max_field_score) {
+                max_field_score = field_score;
+            }
+        }
+    }
+
+    return (uint64_t(query_len) << 56) | max_field_score;
+}
+
 void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                                std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                                std::array<sort_column_t*, 3> field_values,
                                 const std::vector<size_t>& geopoint_indices,
                                 uint32_t seq_id, int64_t max_field_match_score,
                                 int64_t* scores, int64_t& match_score_index) const {
@@ -3213,17 +3897,16 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
     int64_t geopoint_distances[3];
 
     for(auto& i: geopoint_indices) {
-        spp::sparse_hash_map<uint32_t, int64_t>* geopoints = field_values[i];
+        sort_column_t* geopoints = field_values[i];
         int64_t dist = INT32_MAX;
 
         S2LatLng reference_lat_lng;
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
+            int64_t packed_latlng;
 
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->find(seq_id, packed_latlng)) {
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -3287,8 +3970,7 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
                 }
             }
         } else {
-            auto it = field_values[0]->find(seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            scores[0] = field_values[0]->get_or_default(seq_id, default_score);
 
             if(scores[0] == INT64_MIN && sort_fields[0].missing_values == sort_by::missing_values_t::first) {
                 // By default, missing numerical value are always going to be sorted to be at the end
@@ -3326,8 +4008,7 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
                 }
             }
         } else {
-            auto it = field_values[1]->find(seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            scores[1] = field_values[1]->get_or_default(seq_id, default_score);
             if(scores[1] == INT64_MIN && sort_fields[1].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[1] == -1);
                 scores[1] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -3361,8 +4042,7 @@ void Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const i
                 }
             }
         } else {
-            auto it = field_values[2]->find(seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            scores[2] = field_values[2]->get_or_default(seq_id, default_score);
             if(scores[2] == INT64_MIN && sort_fields[2].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[2] == -1);
                 scores[2] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -3427,8 +4107,8 @@ void Index::do_phrase_search(const size_t num_search_fields, const std::vector<s
                 field_phrase_match_ids = this_phrase_ids;
             } else {
                 uint32_t* phrase_ids_merged = nullptr;
-                field_phrase_match_ids_size = ArrayUtils::and_scalar(this_phrase_ids, this_phrase_ids_size, field_phrase_match_ids,
-                                                                     field_phrase_match_ids_size, &phrase_ids_merged);
+                field_phrase_match_ids_size = ArrayUtils::and_simd(this_phrase_ids, this_phrase_ids_size, field_phrase_match_ids,
+                                                                   field_phrase_match_ids_size, &phrase_ids_merged);
                 delete [] field_phrase_match_ids;
                 delete [] this_phrase_ids;
                 field_phrase_match_ids = phrase_ids_merged;
@@ -3445,8 +4125,8 @@ void Index::do_phrase_search(const size_t num_search_fields, const std::vector<s
             phrase_match_ids_size = field_phrase_match_ids_size;
         } else {
             uint32_t* phrase_ids_merged = nullptr;
-            phrase_match_ids_size = ArrayUtils::or_scalar(phrase_match_ids, phrase_match_ids_size, field_phrase_match_ids,
-                                                          field_phrase_match_ids_size, &phrase_ids_merged);
+            phrase_match_ids_size = ArrayUtils::or_simd(phrase_match_ids, phrase_match_ids_size, field_phrase_match_ids,
+                                                        field_phrase_match_ids_size, &phrase_ids_merged);
 
             delete [] phrase_match_ids;
             delete [] field_phrase_match_ids;
@@ -3460,8 +4140,8 @@ void Index::do_phrase_search(const size_t num_search_fields, const std::vector<s
         filter_ids_length = phrase_match_ids_size;
     } else {
         uint32_t* filter_ids_merged = nullptr;
-        filter_ids_length = ArrayUtils::and_scalar(filter_ids, filter_ids_length, phrase_match_ids,
-                                                   phrase_match_ids_size, &filter_ids_merged);
+        filter_ids_length = ArrayUtils::and_simd(filter_ids, filter_ids_length, phrase_match_ids,
+                                                 phrase_match_ids_size, &filter_ids_merged);
 
         delete [] filter_ids;
         filter_ids = filter_ids_merged;
@@ -3483,6 +4163,8 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
                               const size_t typo_tokens_threshold, const size_t group_limit,
                               const std::vector<std::string>& group_by_fields, bool prioritize_exact_match,
                               const bool prioritize_token_position,
+                              const bool max_score_pruning,
+                              const bool skip_pruned_blocks,
                               const bool exhaustive_search, const size_t concurrency,
                               const std::vector<bool>& prefixes,
                               size_t min_len_1typo,
@@ -3494,23 +4176,25 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
                               int syn_orig_num_tokens,
                               spp::sparse_hash_set<uint64_t>& groups_processed,
                               std::vector<std::vector<art_leaf*>>& searched_queries,
-                              uint32_t*& all_result_ids, size_t& all_result_ids_len,
+                              uint32_t*& all_result_ids, size_t& all_result_ids_len, size_t& num_pruned_ids,
                               const uint32_t* filter_ids, const uint32_t filter_ids_length,
                               std::set<uint64>& query_hashes,
                               const int* sort_order,
-                              std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                              std::array<sort_column_t*, 3>& field_values,
                               const std::vector<size_t>& geopoint_indices,
-                              tsl::htrie_map<char, token_leaf>& qtoken_set) const {
+                              tsl::htrie_map<char, token_leaf>& qtoken_set,
+                              filter_iterator_t* filter_iterator) const {
 
     for(const auto& syn_tokens: q_pos_synonyms) {
         query_hashes.clear();
         fuzzy_search_fields(the_fields, syn_tokens, exclude_token_ids,
                             exclude_token_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
                             sort_fields_std, {0}, searched_queries, qtoken_set, actual_topster, groups_processed,
-                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
-                            prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
-                            exhaustive_search, max_candidates, min_len_1typo,
-                            min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices);
+                            all_result_ids, all_result_ids_len, num_pruned_ids, group_limit, group_by_fields, prioritize_exact_match,
+                            prioritize_token_position, max_score_pruning, skip_pruned_blocks, query_hashes, token_order, prefixes, typo_tokens_threshold,
+                            exhaustive_search, concurrency, max_candidates, min_len_1typo,
+                            min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices,
+                            filter_iterator);
     }
 
     collate_included_ids({}, included_ids_map, curated_topster, searched_queries);
@@ -3525,7 +4209,7 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
                             const std::vector<token_t>& query_tokens, Topster* actual_topster,
                             const uint32_t *filter_ids, size_t filter_ids_length,
                             const int sort_order[3],
-                            std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                            std::array<sort_column_t*, 3> field_values,
                             const std::vector<size_t>& geopoint_indices,
                             const std::vector<uint32_t>& curated_ids_sorted,
                             uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -3547,8 +4231,8 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
                 size_t raw_infix_ids_length = 0;
 
                 if(curated_ids_sorted.size() != 0) {
-                    raw_infix_ids_length = ArrayUtils::exclude_scalar(&infix_ids[0], infix_ids.size(), &curated_ids_sorted[0],
-                                                                      curated_ids_sorted.size(), &raw_infix_ids);
+                    raw_infix_ids_length = ArrayUtils::exclude_simd(&infix_ids[0], infix_ids.size(), &curated_ids_sorted[0],
+                                                                    curated_ids_sorted.size(), &raw_infix_ids);
                     infix_ids.clear();
                 } else {
                     raw_infix_ids = &infix_ids[0];
@@ -3557,8 +4241,8 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
 
                 if(filter_ids_length != 0) {
                     uint32_t *filtered_raw_infix_ids = nullptr;
-                    raw_infix_ids_length = ArrayUtils::and_scalar(filter_ids, filter_ids_length, raw_infix_ids,
-                                                                  raw_infix_ids_length, &filtered_raw_infix_ids);
+                    raw_infix_ids_length = ArrayUtils::and_simd(filter_ids, filter_ids_length, raw_infix_ids,
+                                                                raw_infix_ids_length, &filtered_raw_infix_ids);
                     if(raw_infix_ids != &infix_ids[0]) {
                         delete [] raw_infix_ids;
                     }
@@ -3596,8 +4280,8 @@ void Index::do_infix_search(const size_t num_search_fields, const std::vector<se
                 }
 
                 uint32_t* new_all_result_ids = nullptr;
-                all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, raw_infix_ids,
-                                                           raw_infix_ids_length, &new_all_result_ids);
+                all_result_ids_len = ArrayUtils::or_simd(all_result_ids, all_result_ids_len, raw_infix_ids,
+                                                         raw_infix_ids_length, &new_all_result_ids);
                 delete[] all_result_ids;
                 all_result_ids = new_all_result_ids;
 
@@ -3639,9 +4323,9 @@ void Index::handle_exclusion(const size_t num_search_fields, std::vector<query_t
 
             if(posting_lists.size() == 1) {
                 uint32_t *exclude_token_ids_merged = nullptr;
-                exclude_token_ids_size = ArrayUtils::or_scalar(exclude_token_ids, exclude_token_ids_size,
-                                                               &contains_ids[0], contains_ids.size(),
-                                                               &exclude_token_ids_merged);
+                exclude_token_ids_size = ArrayUtils::or_simd(exclude_token_ids, exclude_token_ids_size,
+                                                             &contains_ids[0], contains_ids.size(),
+                                                             &exclude_token_ids_merged);
                 delete [] exclude_token_ids;
                 exclude_token_ids = exclude_token_ids_merged;
             } else {
@@ -3652,9 +4336,9 @@ void Index::handle_exclusion(const size_t num_search_fields, std::vector<query_t
                                               phrase_ids, phrase_ids_size);
 
                 uint32_t *exclude_token_ids_merged = nullptr;
-                exclude_token_ids_size = ArrayUtils::or_scalar(exclude_token_ids, exclude_token_ids_size,
-                                                               phrase_ids, phrase_ids_size,
-                                                               &exclude_token_ids_merged);
+                exclude_token_ids_size = ArrayUtils::or_simd(exclude_token_ids, exclude_token_ids_size,
+                                                             phrase_ids, phrase_ids_size,
+                                                             &exclude_token_ids_merged);
                 delete [] phrase_ids;
                 delete [] exclude_token_ids;
                 exclude_token_ids = exclude_token_ids_merged;
@@ -3753,8 +4437,11 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                 for(size_t i = 0; i < field_result_ids_len; i++) {
                     uint32_t seq_id = field_result_ids[i];
 
-                    const auto doc_fvalues_it = field_facet_mapping_it->second[seq_id % ARRAY_FACET_DIM]->find(seq_id);
-                    if(doc_fvalues_it == field_facet_mapping_it->second[seq_id % ARRAY_FACET_DIM]->end()) {
+                    const facet_index_t* field_facet_index = field_facet_mapping_it->second;
+                    const uint32_t* doc_ordinals;
+                    const uint32_t num_doc_ordinals = field_facet_index->get_ordinals(seq_id, doc_ordinals);
+
+                    if(num_doc_ordinals == 0) {
                         continue;
                     }
 
@@ -3778,8 +4465,8 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                         posting_t::get_matching_array_indices(posting_lists, seq_id, array_indices);
 
                         for(size_t array_index: array_indices) {
-                            if(array_index < doc_fvalues_it->second.length) {
-                                uint64_t hash = doc_fvalues_it->second.hashes[array_index];
+                            if(array_index < num_doc_ordinals) {
+                                uint64_t hash = field_facet_index->get_hash(doc_ordinals[array_index]);
 
                                 /*LOG(INFO) << "seq_id: " << seq_id << ", hash: " << hash << ", array index: "
                                           << array_index;*/
@@ -3790,7 +4477,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                             }
                         }
                     } else {
-                        uint64_t hash = doc_fvalues_it->second.hashes[0];
+                        uint64_t hash = field_facet_index->get_hash(doc_ordinals[0]);
                         if(facet_infos[findex].hashes.count(hash) == 0) {
                             facet_infos[findex].hashes.emplace(hash, searched_tokens);
                         }
@@ -3816,8 +4503,8 @@ void Index::curate_filtered_ids(const std::vector<filter>& filters, const std::s
 
     if(!curated_ids.empty()) {
         uint32_t *excluded_result_ids = nullptr;
-        filter_ids_length = ArrayUtils::exclude_scalar(filter_ids, filter_ids_length, &curated_ids_sorted[0],
-                                                       curated_ids_sorted.size(), &excluded_result_ids);
+        filter_ids_length = ArrayUtils::exclude_simd(filter_ids, filter_ids_length, &curated_ids_sorted[0],
+                                                     curated_ids_sorted.size(), &excluded_result_ids);
         delete [] filter_ids;
         filter_ids = excluded_result_ids;
     }
@@ -3825,8 +4512,8 @@ void Index::curate_filtered_ids(const std::vector<filter>& filters, const std::s
     // Exclude document IDs associated with excluded tokens from the result set
     if(exclude_token_ids_size != 0) {
         uint32_t *excluded_result_ids = nullptr;
-        filter_ids_length = ArrayUtils::exclude_scalar(filter_ids, filter_ids_length, exclude_token_ids,
-                                                       exclude_token_ids_size, &excluded_result_ids);
+        filter_ids_length = ArrayUtils::exclude_simd(filter_ids, filter_ids_length, exclude_token_ids,
+                                                     exclude_token_ids_size, &excluded_result_ids);
         delete[] filter_ids;
         filter_ids = excluded_result_ids;
     }
@@ -3843,17 +4530,26 @@ void Index::search_wildcard(const std::vector<filter>& filters,
                             uint32_t*& all_result_ids, size_t& all_result_ids_len, const uint32_t* filter_ids,
                             uint32_t filter_ids_length, const size_t concurrency,
                             const int* sort_order,
-                            std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
+                            std::array<sort_column_t*, 3>& field_values,
                             const std::vector<size_t>& geopoint_indices) const {
 
     uint32_t token_bits = 0;
-    const bool check_for_circuit_break = (filter_ids_length > 1000000);
+
+    // when the top hits can be picked off the sort field in order, only they need to be scored
+    std::vector<uint32_t> sorted_ids;
+    const bool use_sorted_ids = get_sorted_wildcard_ids(sort_fields, group_limit, topster->MAX_SIZE,
+                                                        filter_ids, filter_ids_length, sorted_ids);
+
+    const uint32_t* score_ids = use_sorted_ids ? sorted_ids.data() : filter_ids;
+    const size_t score_ids_length = use_sorted_ids ? sorted_ids.size() : filter_ids_length;
+
+    const bool check_for_circuit_break = (score_ids_length > 1000000);
 
     //auto beginF = std::chrono::high_resolution_clock::now();
 
-    const size_t num_threads = std::min<size_t>(concurrency, filter_ids_length);
+    const size_t num_threads = std::min<size_t>(concurrency, score_ids_length);
     const size_t window_size = (num_threads == 0) ? 0 :
-                               (filter_ids_length + num_threads - 1) / num_threads;  // rounds up
+                               (score_ids_length + num_threads - 1) / num_threads;  // rounds up
 
     spp::sparse_hash_set<uint64_t> tgroups_processed[num_threads];
     Topster* topsters[num_threads];
@@ -3861,7 +4557,6 @@ void Index::search_wildcard(const std::vector<filter>& filters,
 
     size_t num_processed = 0;
     std::mutex m_process;
-    std::condition_variable cv_process;
 
     size_t num_queued = 0;
     size_t filter_index = 0;
@@ -3870,27 +4565,27 @@ void Index::search_wildcard(const std::vector<filter>& filters,
     const auto parent_search_stop_ms = search_stop_ms;
     auto parent_search_cutoff = search_cutoff;
 
-    for(size_t thread_id = 0; thread_id < num_threads && filter_index < filter_ids_length; thread_id++) {
+    for(size_t thread_id = 0; thread_id < num_threads && filter_index < score_ids_length; thread_id++) {
         size_t batch_res_len = window_size;
 
-        if(filter_index + window_size > filter_ids_length) {
-            batch_res_len = filter_ids_length - filter_index;
+        if(filter_index + window_size > score_ids_length) {
+            batch_res_len = score_ids_length - filter_index;
         }
 
-        const uint32_t* batch_result_ids = filter_ids + filter_index;
+        const uint32_t* batch_result_ids = score_ids + filter_index;
         num_queued++;
 
         searched_queries.push_back({});
 
         topsters[thread_id] = new Topster(topster->MAX_SIZE, topster->distinct);
 
-        thread_pool->enqueue([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
-                             thread_id, &sort_fields, &searched_queries, &field_id,
-                             &group_limit, &group_by_fields, &topsters, &tgroups_processed,
-                             &sort_order, field_values, &geopoint_indices, &plists,
-                             check_for_circuit_break,
-                             batch_result_ids, batch_res_len,
-                             &num_processed, &m_process, &cv_process]() {
+        thread_pool->fork([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                          thread_id, &sort_fields, &searched_queries, &field_id,
+                          &group_limit, &group_by_fields, &topsters, &tgroups_processed,
+                          &sort_order, field_values, &geopoint_indices, &plists,
+                          check_for_circuit_break,
+                          batch_result_ids, batch_res_len,
+                          &num_processed, &m_process]() {
 
             search_begin = parent_search_begin;
             search_stop_ms = parent_search_stop_ms;
@@ -3927,14 +4622,15 @@ void Index::search_wildcard(const std::vector<filter>& filters,
             std::unique_lock<std::mutex> lock(m_process);
             num_processed++;
             parent_search_cutoff = parent_search_cutoff || search_cutoff;
-            cv_process.notify_one();
         });
 
         filter_index += batch_res_len;
     }
 
-    std::unique_lock<std::mutex> lock_process(m_process);
-    cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+    thread_pool->wait_until([&]() {
+        std::unique_lock<std::mutex> lock_process(m_process);
+        return num_processed == num_queued;
+    });
 
     search_cutoff = parent_search_cutoff;
 
@@ -3951,15 +4647,62 @@ void Index::search_wildcard(const std::vector<filter>& filters,
     collate_included_ids({}, included_ids_map, curated_topster, searched_queries);
 
     uint32_t* new_all_result_ids = nullptr;
-    all_result_ids_len = ArrayUtils::or_scalar(all_result_ids, all_result_ids_len, filter_ids,
-                                               filter_ids_length, &new_all_result_ids);
+    all_result_ids_len = ArrayUtils::or_simd(all_result_ids, all_result_ids_len, filter_ids,
+                                             filter_ids_length, &new_all_result_ids);
     delete [] all_result_ids;
     all_result_ids = new_all_result_ids;
 }
 
+bool Index::get_sorted_wildcard_ids(const std::vector<sort_by>& sort_fields, size_t group_limit, size_t top_k,
+                                    const uint32_t* filter_ids, uint32_t filter_ids_length,
+                                    std::vector<uint32_t>& top_ids) const {
+    // Ties on the first sort field are always collected fully, so any secondary sort field can still be applied
+    // on the candidates. Grouping needs `top_k` groups rather than documents, so it's not supported.
+    if(sort_fields.empty() || group_limit != 0 || filter_ids_length < SORTED_WILDCARD_MIN_IDS ||
+       sort_fields[0].missing_values == sort_by::missing_values_t::first) {
+        return false;
+    }
+
+    const auto field_it = search_schema.find(sort_fields[0].name);
+    if(field_it == search_schema.end() || !field_it->second.is_num_sortable()) {
+        return false;
+    }
+
+    const std::string& type = field_it->second.type;
+    if(type != field_types::INT32 && type != field_types::INT64 && type != field_types::FLOAT &&
+       type != field_types::BOOL) {
+        return false;
+    }
+
+    const auto num_tree_it = numerical_index.find(sort_fields[0].name);
+    if(num_tree_it == numerical_index.end()) {
+        return false;
+    }
+
+    // documents with the field are assumed to be spread evenly across the filter, so roughly
+    // `top_k * num_docs / filter_ids_length` of them have to be walked to find `top_k` matches
+    const size_t num_docs = seq_ids->num_ids();
+    const size_t expected_visits = (top_k * num_docs) / filter_ids_length;
+    if(expected_visits * 4 > filter_ids_length) {
+        return false;
+    }
+
+    const bool ascending = (sort_fields[0].order == sort_field_const::asc);
+    const bool walked = num_tree_it->second->ordered_search(ascending, filter_ids, filter_ids_length,
+                                                            top_k, filter_ids_length, top_ids);
+
+    // documents without the field (or too few matches) still have to be scored exhaustively
+    if(!walked || top_ids.size() < top_k) {
+        top_ids.clear();
+        return false;
+    }
+
+    return true;
+}
+
 void Index::populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                   const std::vector<sort_by>& sort_fields_std,
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values) const {
+                                  std::array<sort_column_t*, 3>& field_values) const {
     for (size_t i = 0; i < sort_fields_std.size(); i++) {
         sort_order[i] = 1;
         if (sort_fields_std[i].order == sort_field_const::asc) {
@@ -4103,14 +4846,11 @@ void Index::search_field(const uint8_t & field_id,
             if(token_cost_cache.count(token_cost_hash) != 0) {
                 leaves = token_cost_cache[token_cost_hash];
             } else {
-                const size_t token_len = prefix_search ? (int) token.length() : (int) token.length() + 1;
-
                 //auto begin = std::chrono::high_resolution_clock::now();
 
                 // need less candidates for filtered searches since we already only pick tokens with results
-                art_fuzzy_search(search_index.at(field_name), (const unsigned char *) token.c_str(), token_len,
-                                 costs[token_index], costs[token_index], max_candidates, token_order, prefix_search,
-                                 filter_ids, filter_ids_length, leaves, unique_tokens);
+                fuzzy_search_field(field_name, token, costs[token_index], prefix_search, max_candidates, token_order,
+                                   filter_ids, filter_ids_length, nullptr, leaves, unique_tokens);
 
                 /*auto timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
                                 std::chrono::high_resolution_clock::now() - begin).count();
@@ -4153,8 +4893,8 @@ void Index::search_field(const uint8_t & field_id,
             }
 
             uint32_t* new_all_result_ids = nullptr;
-            all_result_ids_len = ArrayUtils::or_scalar(*all_result_ids, all_result_ids_len, &id_buff[0],
-                                                       id_buff.size(), &new_all_result_ids);
+            all_result_ids_len = ArrayUtils::or_simd(*all_result_ids, all_result_ids_len, &id_buff[0],
+                                                     id_buff.size(), &new_all_result_ids);
             delete[] *all_result_ids;
             *all_result_ids = new_all_result_ids;
         }
@@ -4312,7 +5052,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
                           const std::vector<art_leaf *> &query_suggestion,
                           spp::sparse_hash_set<uint64_t>& groups_processed,
                           const uint32_t seq_id, const int sort_order[3],
-                          std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3> field_values,
+                          std::array<sort_column_t*, 3> field_values,
                           const std::vector<size_t>& geopoint_indices,
                           const size_t group_limit, const std::vector<std::string>& group_by_fields,
                           const uint32_t token_bits,
@@ -4324,17 +5064,16 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
     int64_t geopoint_distances[3];
 
     for(auto& i: geopoint_indices) {
-        spp::sparse_hash_map<uint32_t, int64_t>* geopoints = field_values[i];
+        sort_column_t* geopoints = field_values[i];
         int64_t dist = INT32_MAX;
 
         S2LatLng reference_lat_lng;
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
+            int64_t packed_latlng;
 
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->find(seq_id, packed_latlng)) {
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -4455,8 +5194,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[0] == &str_sentinel_value) {
             scores[0] = str_sort_index.at(sort_fields[0].name)->rank(seq_id);
         } else {
-            auto it = field_values[0]->find(seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            scores[0] = field_values[0]->get_or_default(seq_id, default_score);
         }
 
         if (sort_order[0] == -1) {
@@ -4475,8 +5213,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[1] == &str_sentinel_value) {
             scores[1] = str_sort_index.at(sort_fields[1].name)->rank(seq_id);
         } else {
-            auto it = field_values[1]->find(seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            scores[1] = field_values[1]->get_or_default(seq_id, default_score);
         }
 
         if (sort_order[1] == -1) {
@@ -4495,8 +5232,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[2] == &str_sentinel_value) {
             scores[2] = str_sort_index.at(sort_fields[2].name)->rank(seq_id);
         } else {
-            auto it = field_values[2]->find(seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            scores[2] = field_values[2]->get_or_default(seq_id, default_score);
         }
 
         if (sort_order[2] == -1) {
@@ -4526,22 +5262,17 @@ uint64_t Index::get_distinct_id(const std::vector<std::string>& group_by_fields,
 
     // calculate hash from group_by_fields
     for(const auto& field: group_by_fields) {
-        const auto& field_facet_mapping_it = facet_index_v3.find(field);
-        if(field_facet_mapping_it == facet_index_v3.end()) {
-            continue;
-        }
-
-        const auto& field_facet_mapping = field_facet_mapping_it->second;
-        const auto& facet_hashes_it = field_facet_mapping[seq_id % ARRAY_FACET_DIM]->find(seq_id);
-
-        if(facet_hashes_it == field_facet_mapping[seq_id % ARRAY_FACET_DIM]->end()) {
+        const auto& field_facet_index_it = facet_index_v3.find(field);
+        if(field_facet_index_it == facet_index_v3.end()) {
             continue;
         }
 
-        const auto& facet_hashes = facet_hashes_it->second;
+        const facet_index_t* field_facet_index = field_facet_index_it->second;
+        const uint32_t* ordinals;
+        const uint32_t num_ordinals = field_facet_index->get_ordinals(seq_id, ordinals);
 
-        for(size_t i = 0; i < facet_hashes.size(); i++) {
-            distinct_id = StringUtils::hash_combine(distinct_id, facet_hashes.hashes[i]);
+        for(size_t i = 0; i < num_ordinals; i++) {
+            distinct_id = StringUtils::hash_combine(distinct_id, field_facet_index->get_hash(ordinals[i]));
         }
     }
 
@@ -4628,6 +5359,9 @@ inline uint32_t Index::next_suggestion(const std::vector<token_candidates> &toke
 }
 
 void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const std::string& field_name) {
+    write_generation++;
+    invalidate_facet_cache(field_name);
+
     const auto& search_field_it = search_schema.find(field_name);
     if(search_field_it == search_schema.end()) {
         return;
@@ -4655,14 +5389,17 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
                 if (posting_t::num_ids(leaf->values) == 0) {
                     void* values = art_delete(search_index.at(field_name), key, key_len);
                     posting_t::destroy_list(values);
+
+                    // the token stays searchable by infix as long as some document still has it
+                    if(search_field.infix) {
+                        infix_index.at(search_field.name)->erase(token);
+                    }
                 }
             }
+        }
 
-            if(search_field.infix) {
-                auto strhash = StringUtils::hash_wy(key, token.size());
-                const auto& infix_sets = infix_index.at(search_field.name);
-                infix_sets[strhash % 4]->erase(token);
-            }
+        if(search_field.infix) {
+            schedule_infix_rebuild(infix_index.at(search_field.name));
         }
     } else if(search_field.is_int32()) {
         const std::vector<int32_t>& values = search_field.is_single_integer() ?
@@ -4738,10 +5475,7 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
     const auto& field_facets_it = facet_index_v3.find(field_name);
 
     if(field_facets_it != facet_index_v3.end()) {
-        const auto& fvalues_it = field_facets_it->second[seq_id % ARRAY_FACET_DIM]->find(seq_id);
-        if(fvalues_it != field_facets_it->second[seq_id % ARRAY_FACET_DIM]->end()) {
-            field_facets_it->second[seq_id % ARRAY_FACET_DIM]->erase(fvalues_it);
-        }
+        field_facets_it->second->erase(seq_id);
     }
 
     // remove sort field
@@ -4812,11 +5546,21 @@ const spp::sparse_hash_map<std::string, num_tree_t*>& Index::_get_numerical_inde
     return numerical_index;
 }
 
-const spp::sparse_hash_map<std::string, array_mapped_infix_t>& Index::_get_infix_index() const {
+const spp::sparse_hash_map<std::string, infix_index_t*>& Index::_get_infix_index() const {
     return infix_index;
 };
 
 void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vector<field>& del_fields) {
+    write_generation++;
+
+    for(const auto& new_field: new_fields) {
+        invalidate_facet_cache(new_field.name);
+    }
+
+    for(const auto& del_field: del_fields) {
+        invalidate_facet_cache(del_field.name);
+    }
+
     std::unique_lock lock(mutex);
 
     for(const auto & new_field: new_fields) {
@@ -4828,7 +5572,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
 
         if(new_field.is_sortable()) {
             if(new_field.is_num_sortable()) {
-                spp::sparse_hash_map<uint32_t, int64_t> * doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t>();
+                sort_column_t* doc_to_score = new sort_column_t();
                 sort_index.emplace(new_field.name, doc_to_score);
             } else if(new_field.is_str_sortable()) {
                 str_sort_index.emplace(new_field.name, new adi_tree_t);
@@ -4854,12 +5598,8 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(new_field.is_facet()) {
-            array_mapped_facet_t facet_array;
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                facet_array[i] = new facet_map_t();
-            }
-
-            facet_index_v3.emplace(new_field.name, facet_array);
+            facet_index_t* facet_index = new facet_index_t(new_field.is_array());
+            facet_index_v3.emplace(new_field.name, facet_index);
 
             // initialize for non-string facet fields
             if(!new_field.is_string()) {
@@ -4870,12 +5610,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(new_field.infix) {
-            array_mapped_infix_t infix_sets(ARRAY_INFIX_DIM);
-            for(auto& infix_set: infix_sets) {
-                infix_set = new tsl::htrie_set<char>();
-            }
-
-            infix_index.emplace(new_field.name, infix_sets);
+            infix_index.emplace(new_field.name, new infix_index_t(new_field.infix_fm));
         }
     }
 
@@ -4891,6 +5626,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             art_tree_destroy(search_index[del_field.name]);
             delete search_index[del_field.name];
             search_index.erase(del_field.name);
+            clear_expansion_cache(del_field.name);
         } else if(del_field.is_geopoint()) {
             delete geopoint_index[del_field.name];
             geopoint_index.erase(del_field.name);
@@ -4919,26 +5655,19 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         if(del_field.is_facet()) {
-            auto& arr = facet_index_v3[del_field.name];
-            for(size_t i = 0; i < ARRAY_FACET_DIM; i++) {
-                delete arr[i];
-            }
-
+            delete facet_index_v3[del_field.name];
             facet_index_v3.erase(del_field.name);
 
             if(!del_field.is_string()) {
                 art_tree_destroy(search_index[del_field.faceted_name()]);
                 delete search_index[del_field.faceted_name()];
                 search_index.erase(del_field.faceted_name());
+                clear_expansion_cache(del_field.faceted_name());
             }
         }
 
         if(del_field.infix) {
-            auto& infix_set = infix_index[del_field.name];
-            for(size_t i = 0; i < infix_set.size(); i++) {
-                delete infix_set[i];
-            }
-
+            delete infix_index[del_field.name];
             infix_index.erase(del_field.name);
         }
     }
@@ -5389,6 +6118,332 @@ size_t Index::num_seq_ids() const {
     return seq_ids->num_ids();
 }
 
+void Index::save_image(index_image_writer_t& writer) const {
+    std::shared_lock lock(mutex);
+
+    // schema, so that an image is never loaded into an index whose structures don't match it
+    std::map<std::string, field> sorted_schema(search_schema.begin(), search_schema.end());
+    writer.write_value<uint32_t>(sorted_schema.size());
+
+    for(const auto& name_field: sorted_schema) {
+        const field& a_field = name_field.second;
+        writer.write_string(a_field.name);
+        writer.write_string(a_field.type);
+        writer.write_string(a_field.locale);
+        writer.write_value<uint8_t>(a_field.index);
+        writer.write_value<uint8_t>(a_field.facet);
+        writer.write_value<uint8_t>(a_field.sort);
+        writer.write_value<uint8_t>(a_field.infix);
+    }
+
+    uint32_t* ids = seq_ids->uncompress();
+    writer.write_ids(ids, seq_ids->num_ids());
+    delete [] ids;
+
+    std::vector<uint32_t> leaf_ids, offset_index, offsets;
+
+    writer.write_value<uint32_t>(search_index.size());
+    for(const auto& name_tree: search_index) {
+        art_tree* t = name_tree.second;
+        writer.write_string(name_tree.first);
+        writer.write_value<uint64_t>(art_size(t));
+
+        auto leaf_writer = [&](const unsigned char* key, uint32_t key_len, void* values) {
+            const art_leaf* leaf = (const art_leaf*) art_search(t, key, key_len);
+            posting_t::get_id_offsets(values, leaf_ids, offset_index, offsets);
+
+            writer.write_value<uint32_t>(key_len);
+            writer.write(key, key_len);
+            writer.write_value<int64_t>(leaf->max_score);
+            writer.write_ids(leaf_ids.data(), leaf_ids.size());
+            writer.write_ids(offset_index.data(), offset_index.size());
+            writer.write_ids(offsets.data(), offsets.size());
+        };
+
+        art_iter(t, [](void* data, const unsigned char* key, uint32_t key_len, void* values) {
+            (*static_cast<decltype(leaf_writer)*>(data))(key, key_len, values);
+            return 0;
+        }, &leaf_writer);
+    }
+
+    writer.write_value<uint32_t>(numerical_index.size());
+    for(const auto& name_tree: numerical_index) {
+        writer.write_string(name_tree.first);
+        name_tree.second->save(writer);
+    }
+
+    writer.write_value<uint32_t>(geopoint_index.size());
+    for(const auto& name_geo_index: geopoint_index) {
+        writer.write_string(name_geo_index.first);
+        writer.write_value<uint64_t>(name_geo_index.second->size());
+
+        for(const auto& cell_ids: *name_geo_index.second) {
+            writer.write_string(cell_ids.first);
+            writer.write_ids(cell_ids.second.data(), cell_ids.second.size());
+        }
+    }
+
+    writer.write_value<uint32_t>(geo_array_index.size());
+    for(const auto& name_geo_array: geo_array_index) {
+        writer.write_string(name_geo_array.first);
+        writer.write_value<uint64_t>(name_geo_array.second->size());
+
+        for(const auto& seq_id_latlongs: *name_geo_array.second) {
+            // first element holds the number of packed lat/longs that follow
+            const int64_t* packed_latlongs = seq_id_latlongs.second;
+            writer.write_value<uint32_t>(seq_id_latlongs.first);
+            writer.write(packed_latlongs, sizeof(int64_t) * (packed_latlongs[0] + 1));
+        }
+    }
+
+    writer.write_value<uint32_t>(facet_index_v3.size());
+    for(const auto& name_facet_index: facet_index_v3) {
+        writer.write_string(name_facet_index.first);
+        name_facet_index.second->save(writer);
+    }
+
+    writer.write_value<uint32_t>(sort_index.size());
+    for(const auto& name_column: sort_index) {
+        writer.write_string(name_column.first);
+        name_column.second->save(writer);
+    }
+
+    writer.write_value<uint32_t>(str_sort_index.size());
+    for(const auto& name_tree: str_sort_index) {
+        writer.write_string(name_tree.first);
+        name_tree.second->save(writer);
+    }
+
+    writer.write_value<uint32_t>(infix_index.size());
+    for(const auto& name_infix_index: infix_index) {
+        writer.write_string(name_infix_index.first);
+        name_infix_index.second->save(writer);
+    }
+}
+
+Option<bool> Index::load_image(index_image_reader_t& reader) {
+    std::unique_lock lock(mutex);
+
+    const Option<bool> bad_image(500, "Index image is corrupt.");
+
+    uint32_t num_fields;
+    if(!reader.read_value(num_fields)) {
+        return bad_image;
+    }
+
+    std::map<std::string, field> sorted_schema(search_schema.begin(), search_schema.end());
+    bool schema_matches = (num_fields == sorted_schema.size());
+    auto schema_it = sorted_schema.begin();
+
+    for(uint32_t i = 0; i < num_fields; i++) {
+        field a_field;
+        uint8_t index, facet, sort, infix;
+
+        if(!reader.read_string(a_field.name) || !reader.read_string(a_field.type) ||
+           !reader.read_string(a_field.locale) || !reader.read_value(index) || !reader.read_value(facet) ||
+           !reader.read_value(sort) || !reader.read_value(infix)) {
+            return bad_image;
+        }
+
+        if(!schema_matches) {
+            continue;
+        }
+
+        const field& the_field = schema_it->second;
+        schema_matches = (the_field.name == a_field.name && the_field.type == a_field.type &&
+                          the_field.locale == a_field.locale && the_field.index == bool(index) &&
+                          the_field.facet == bool(facet) && the_field.sort == bool(sort) &&
+                          the_field.infix == bool(infix));
+        schema_it++;
+    }
+
+    if(!schema_matches) {
+        return Option<bool>(400, "Index image was written for a different schema.");
+    }
+
+    const uint32_t* ids;
+    uint32_t num_ids;
+
+    if(!reader.read_ids(ids, num_ids)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_ids; i++) {
+        seq_ids->upsert(ids[i]);
+    }
+
+    std::string name;
+    uint32_t num_indices;
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    const uint32_t* offset_index;
+    const uint32_t* offsets;
+    uint32_t num_offset_index, num_offsets;
+    std::vector<unsigned char> key;
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        uint64_t num_leaves;
+        if(!reader.read_string(name) || !reader.read_value(num_leaves) || search_index.count(name) == 0) {
+            return bad_image;
+        }
+
+        art_tree* t = search_index.at(name);
+
+        for(uint64_t j = 0; j < num_leaves; j++) {
+            uint32_t key_len;
+            int64_t max_score;
+
+            if(!reader.read_value(key_len) || key_len == 0 || key_len > 64 * 1024) {
+                return bad_image;
+            }
+
+            key.resize(key_len);
+
+            // postings are decoded from the mapped image and copied into the tree
+            if(!reader.read(&key[0], key_len) || !reader.read_value(max_score) || !reader.read_ids(ids, num_ids) ||
+               !reader.read_ids(offset_index, num_offset_index) || !reader.read_ids(offsets, num_offsets) ||
+               num_ids == 0 || num_offset_index != num_ids) {
+                return bad_image;
+            }
+
+            std::vector<art_document> documents;
+            documents.reserve(num_ids);
+
+            for(size_t k = 0; k < num_ids; k++) {
+                const uint32_t start = offset_index[k];
+                const uint32_t end = (k + 1 < num_ids) ? offset_index[k + 1] : num_offsets;
+
+                if(start > end || end > num_offsets) {
+                    return bad_image;
+                }
+
+                documents.emplace_back(ids[k], max_score, std::vector<uint32_t>(offsets + start, offsets + end));
+            }
+
+            art_inserts(t, &key[0], key_len, max_score, documents);
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        if(!reader.read_string(name) || numerical_index.count(name) == 0 ||
+           !numerical_index.at(name)->load(reader)) {
+            return bad_image;
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        uint64_t num_cells;
+        if(!reader.read_string(name) || !reader.read_value(num_cells) || geopoint_index.count(name) == 0) {
+            return bad_image;
+        }
+
+        auto geo_index = geopoint_index.at(name);
+        std::string cell;
+
+        for(uint64_t j = 0; j < num_cells; j++) {
+            if(!reader.read_string(cell) || !reader.read_ids(ids, num_ids)) {
+                return bad_image;
+            }
+
+            (*geo_index)[cell] = std::vector<uint32_t>(ids, ids + num_ids);
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        uint64_t num_docs;
+        if(!reader.read_string(name) || !reader.read_value(num_docs) || geo_array_index.count(name) == 0) {
+            return bad_image;
+        }
+
+        auto geo_array_map = geo_array_index.at(name);
+
+        for(uint64_t j = 0; j < num_docs; j++) {
+            uint32_t seq_id;
+            int64_t num_latlongs;
+
+            if(!reader.read_value(seq_id) || !reader.read_value(num_latlongs) ||
+               num_latlongs < 0 || num_latlongs > 1024 * 1024) {
+                return bad_image;
+            }
+
+            int64_t* packed_latlongs = new int64_t[num_latlongs + 1];
+            packed_latlongs[0] = num_latlongs;
+            geo_array_map->emplace(seq_id, packed_latlongs);
+
+            if(!reader.read(packed_latlongs + 1, sizeof(int64_t) * num_latlongs)) {
+                return bad_image;
+            }
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        if(!reader.read_string(name) || facet_index_v3.count(name) == 0) {
+            return bad_image;
+        }
+
+        if(!facet_index_v3.at(name)->load(reader)) {
+            return bad_image;
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        if(!reader.read_string(name) || sort_index.count(name) == 0 || !sort_index.at(name)->load(reader)) {
+            return bad_image;
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        if(!reader.read_string(name) || str_sort_index.count(name) == 0 ||
+           !str_sort_index.at(name)->load(reader)) {
+            return bad_image;
+        }
+    }
+
+    if(!reader.read_value(num_indices)) {
+        return bad_image;
+    }
+
+    for(uint32_t i = 0; i < num_indices; i++) {
+        if(!reader.read_string(name) || infix_index.count(name) == 0 || !infix_index.at(name)->load(reader)) {
+            return bad_image;
+        }
+    }
+
+    if(!reader.at_end()) {
+        return bad_image;
+    }
+
+    num_documents = seq_ids->num_ids();
+    return Option<bool>(true);
+}
+
 void Index::resolve_space_as_typos(std::vector<std::string>& qtokens, const string& field_name,
                                    std::vector<std::vector<std::string>>& resolved_queries) const {
 
@@ -0,0 +1,193 @@
+#include "index_image.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "string_utils.h"
+
+index_image_writer_t::index_image_writer_t(const std::string& file_path):
+        out(file_path, std::ios::binary | std::ios::trunc) {
+    buffer.reserve(index_image::BLOCK_SIZE);
+}
+
+bool index_image_writer_t::ok() const {
+    return out.good();
+}
+
+void index_image_writer_t::flush_buffer() {
+    if(buffer.empty()) {
+        return ;
+    }
+
+    checksum = StringUtils::hash_combine(checksum, StringUtils::hash_wy(buffer.data(), buffer.size()));
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void index_image_writer_t::write(const void* data, size_t len) {
+    const char* bytes = static_cast<const char*>(data);
+    num_bytes += len;
+
+    // blocks are always filled up fully, so that the reader can checksum the same block boundaries
+    while(len != 0) {
+        const size_t num_copied = std::min(len, index_image::BLOCK_SIZE - buffer.size());
+        buffer.append(bytes, num_copied);
+        bytes += num_copied;
+        len -= num_copied;
+
+        if(buffer.size() == index_image::BLOCK_SIZE) {
+            flush_buffer();
+        }
+    }
+}
+
+void index_image_writer_t::write_string(const std::string& str) {
+    write_value<uint32_t>(str.size());
+    write(str.data(), str.size());
+}
+
+void index_image_writer_t::write_ids(const uint32_t* ids, uint32_t num_ids) {
+    static const char padding[sizeof(uint32_t)] = {};
+
+    write_value<uint32_t>(num_ids);
+    write(padding, (sizeof(uint32_t) - num_bytes % sizeof(uint32_t)) % sizeof(uint32_t));
+    write(ids, sizeof(uint32_t) * num_ids);
+}
+
+bool index_image_writer_t::close() {
+    flush_buffer();
+
+    out.write(reinterpret_cast<const char*>(&num_bytes), sizeof(num_bytes));
+    out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    out.write(reinterpret_cast<const char*>(&index_image::VERSION), sizeof(index_image::VERSION));
+    out.write(reinterpret_cast<const char*>(&index_image::MAGIC), sizeof(index_image::MAGIC));
+
+    out.flush();
+    const bool written = out.good();
+    out.close();
+
+    return written;
+}
+
+index_image_reader_t::index_image_reader_t(const std::string& file_path) {
+    valid = map(file_path) && verify();
+}
+
+index_image_reader_t::~index_image_reader_t() {
+    if(data != nullptr) {
+        munmap((void*) data, mapped_size);
+    }
+}
+
+bool index_image_reader_t::map(const std::string& file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if(fd == -1) {
+        return false;
+    }
+
+    struct stat file_stat{};
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size < int64_t(index_image::FOOTER_SIZE)) {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(mapped == MAP_FAILED) {
+        return false;
+    }
+
+    data = static_cast<const char*>(mapped);
+    mapped_size = file_stat.st_size;
+
+    // the image is consumed front to back, once
+    madvise(mapped, mapped_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool index_image_reader_t::verify() {
+    uint64_t expected_checksum;
+    uint32_t version, magic;
+
+    const char* footer = data + mapped_size - index_image::FOOTER_SIZE;
+    memcpy(&num_bytes, footer, sizeof(num_bytes));
+    memcpy(&expected_checksum, footer + 8, sizeof(expected_checksum));
+    memcpy(&version, footer + 16, sizeof(version));
+    memcpy(&magic, footer + 20, sizeof(magic));
+
+    if(magic != index_image::MAGIC || version != index_image::VERSION ||
+       num_bytes != mapped_size - index_image::FOOTER_SIZE) {
+        return false;
+    }
+
+    uint64_t checksum = 0;
+
+    for(uint64_t offset = 0; offset < num_bytes; offset += index_image::BLOCK_SIZE) {
+        const size_t block_size = std::min<uint64_t>(num_bytes - offset, index_image::BLOCK_SIZE);
+        checksum = StringUtils::hash_combine(checksum, StringUtils::hash_wy(data + offset, block_size));
+    }
+
+    return checksum == expected_checksum;
+}
+
+bool index_image_reader_t::ok() const {
+    return valid;
+}
+
+bool index_image_reader_t::read(void* dest, size_t len) {
+    if(!valid || len > num_bytes - num_read) {
+        valid = false;
+        return false;
+    }
+
+    memcpy(dest, data + num_read, len);
+    num_read += len;
+    return true;
+}
+
+bool index_image_reader_t::read_string(std::string& str) {
+    uint32_t len;
+    if(!read_value(len) || len > num_bytes - num_read) {
+        valid = false;
+        return false;
+    }
+
+    str.assign(data + num_read, len);
+    num_read += len;
+    return true;
+}
+
+bool index_image_reader_t::read_ids(std::vector<uint32_t>& ids) {
+    const uint32_t* ids_view;
+    uint32_t num_ids;
+
+    if(!read_ids(ids_view, num_ids)) {
+        return false;
+    }
+
+    ids.assign(ids_view, ids_view + num_ids);
+    return true;
+}
+
+bool index_image_reader_t::read_ids(const uint32_t*& ids, uint32_t& num_ids) {
+    if(!read_value(num_ids)) {
+        return false;
+    }
+
+    const uint64_t padding = (sizeof(uint32_t) - num_read % sizeof(uint32_t)) % sizeof(uint32_t);
+
+    if(padding + uint64_t(num_ids) * sizeof(uint32_t) > num_bytes - num_read) {
+        valid = false;
+        return false;
+    }
+
+    ids = reinterpret_cast<const uint32_t*>(data + num_read + padding);
+    num_read += padding + uint64_t(num_ids) * sizeof(uint32_t);
+    return true;
+}
+
+bool index_image_reader_t::at_end() const {
+    return num_read == num_bytes;
+}
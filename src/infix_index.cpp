@@ -0,0 +1,453 @@
+#include "infix_index.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+infix_suffix_array_t::infix_suffix_array_t(const std::vector<std::string>& tokens) {
+    size_t text_size = 0;
+    for(const std::string& token: tokens) {
+        text_size += token.size() + 1;
+    }
+
+    text.reserve(text_size);
+    token_offsets.reserve(tokens.size());
+    suffixes.reserve(text_size - tokens.size());
+
+    for(const std::string& token: tokens) {
+        token_offsets.push_back(text.size());
+
+        for(size_t i = 0; i < token.size(); i++) {
+            suffixes.push_back(text.size() + i);
+        }
+
+        text += token;
+        text += '\0';
+    }
+
+    // a pattern never spans tokens, so suffixes need to be ordered only up to the end of their token
+    const char* text_data = text.data();
+    std::sort(suffixes.begin(), suffixes.end(), [text_data](uint32_t a, uint32_t b) {
+        return strcmp(text_data + a, text_data + b) < 0;
+    });
+}
+
+std::string infix_suffix_array_t::get_token(uint32_t token_id) const {
+    return std::string(text.data() + token_offsets[token_id]);
+}
+
+int64_t infix_suffix_array_t::find(const std::string& token) const {
+    const char* text_data = text.data();
+    const auto token_it = std::lower_bound(token_offsets.begin(), token_offsets.end(), token,
+                                           [text_data](uint32_t offset, const std::string& token) {
+        return strcmp(text_data + offset, token.c_str()) < 0;
+    });
+
+    if(token_it == token_offsets.end() || strcmp(text_data + *token_it, token.c_str()) != 0) {
+        return -1;
+    }
+
+    return token_it - token_offsets.begin();
+}
+
+void infix_suffix_array_t::search(const std::string& pattern, std::vector<uint32_t>& token_ids) const {
+    const char* text_data = text.data();
+
+    const auto suffixes_begin = std::lower_bound(suffixes.begin(), suffixes.end(), pattern,
+                                                 [text_data](uint32_t suffix, const std::string& pattern) {
+        return strncmp(text_data + suffix, pattern.data(), pattern.size()) < 0;
+    });
+
+    const auto suffixes_end = std::upper_bound(suffixes_begin, suffixes.end(), pattern,
+                                               [text_data](const std::string& pattern, uint32_t suffix) {
+        return strncmp(text_data + suffix, pattern.data(), pattern.size()) > 0;
+    });
+
+    const size_t num_token_ids = token_ids.size();
+
+    for(auto suffix_it = suffixes_begin; suffix_it != suffixes_end; ++suffix_it) {
+        const auto offset_it = std::upper_bound(token_offsets.begin(), token_offsets.end(), *suffix_it);
+        token_ids.push_back(offset_it - token_offsets.begin() - 1);
+    }
+
+    std::sort(token_ids.begin() + num_token_ids, token_ids.end());
+    token_ids.erase(std::unique(token_ids.begin() + num_token_ids, token_ids.end()), token_ids.end());
+}
+
+void infix_index_t::get_gram_keys(const std::string& token, std::vector<uint32_t>& gram_keys) {
+    for(size_t i = 0; i + GRAM_SIZE <= token.size(); i++) {
+        gram_keys.push_back(gram_key(token.data() + i));
+    }
+
+    std::sort(gram_keys.begin(), gram_keys.end());
+    gram_keys.erase(std::unique(gram_keys.begin(), gram_keys.end()), gram_keys.end());
+}
+
+void infix_index_t::insert_id(std::vector<uint32_t>& ids, uint32_t id) {
+    // new ids are mostly larger than the existing ones, except for recycled ones
+    if(ids.empty() || ids.back() < id) {
+        ids.push_back(id);
+        return ;
+    }
+
+    const auto id_it = std::lower_bound(ids.begin(), ids.end(), id);
+    if(id_it == ids.end() || *id_it != id) {
+        ids.insert(id_it, id);
+    }
+}
+
+void infix_index_t::erase_id(std::vector<uint32_t>& ids, uint32_t id) {
+    const auto id_it = std::lower_bound(ids.begin(), ids.end(), id);
+    if(id_it != ids.end() && *id_it == id) {
+        ids.erase(id_it);
+    }
+}
+
+void infix_index_t::insert_delta(const std::string& token) {
+    uint32_t id;
+
+    if(!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+        id_tokens[id] = token;
+    } else {
+        id = id_tokens.size();
+        id_tokens.push_back(token);
+    }
+
+    token_ids.insert(token, id);
+
+    if(token.size() < GRAM_SIZE) {
+        insert_id(short_token_ids, id);
+        return ;
+    }
+
+    std::vector<uint32_t> gram_keys;
+    get_gram_keys(token, gram_keys);
+
+    for(uint32_t key: gram_keys) {
+        insert_id(gram_postings[key], id);
+    }
+}
+
+bool infix_index_t::erase_delta(const std::string& token) {
+    const auto token_it = token_ids.find(token);
+    if(token_it == token_ids.end()) {
+        return false;
+    }
+
+    const uint32_t id = token_it.value();
+    token_ids.erase(token_it);
+
+    if(token.size() < GRAM_SIZE) {
+        erase_id(short_token_ids, id);
+    } else {
+        std::vector<uint32_t> gram_keys;
+        get_gram_keys(token, gram_keys);
+
+        for(uint32_t key: gram_keys) {
+            auto postings_it = gram_postings.find(key);
+            if(postings_it == gram_postings.end()) {
+                continue;
+            }
+
+            erase_id(postings_it->second, id);
+
+            if(postings_it->second.empty()) {
+                gram_postings.erase(postings_it);
+            }
+        }
+    }
+
+    std::string().swap(id_tokens[id]);
+    free_ids.push_back(id);
+    return true;
+}
+
+void infix_index_t::clear_delta() {
+    token_ids.clear();
+    id_tokens.clear();
+    free_ids.clear();
+    gram_postings.clear();
+    short_token_ids.clear();
+}
+
+void infix_index_t::insert(const std::string& token) {
+    apply_rebuild();
+
+    if(token_ids.find(token) != token_ids.end()) {
+        return ;
+    }
+
+    const int64_t sealed_id = (sealed == nullptr) ? -1 : sealed->find(token);
+
+    if(sealed_id != -1 && sealed_live[sealed_id]) {
+        return ;
+    }
+
+    // only effective changes are logged, as they are replayed on top of the snapshot
+    if(rebuild != nullptr) {
+        rebuild_log.emplace_back(true, token);
+    }
+
+    if(sealed_id != -1) {
+        sealed_live[sealed_id] = true;
+        num_sealed_live++;
+        return ;
+    }
+
+    insert_delta(token);
+}
+
+void infix_index_t::erase(const std::string& token) {
+    apply_rebuild();
+
+    if(erase_delta(token)) {
+        if(rebuild != nullptr) {
+            rebuild_log.emplace_back(false, token);
+        }
+
+        return ;
+    }
+
+    const int64_t sealed_id = (sealed == nullptr) ? -1 : sealed->find(token);
+
+    if(sealed_id == -1 || !sealed_live[sealed_id]) {
+        return ;
+    }
+
+    if(rebuild != nullptr) {
+        rebuild_log.emplace_back(false, token);
+    }
+
+    sealed_live[sealed_id] = false;
+    num_sealed_live--;
+}
+
+void infix_index_t::find_candidates(const std::string& query, std::vector<uint32_t>& candidate_ids) const {
+    if(query.size() >= GRAM_SIZE) {
+        std::vector<uint32_t> gram_keys;
+        get_gram_keys(query, gram_keys);
+
+        std::vector<const std::vector<uint32_t>*> postings;
+
+        for(uint32_t key: gram_keys) {
+            const auto postings_it = gram_postings.find(key);
+            if(postings_it == gram_postings.end()) {
+                return ;
+            }
+
+            postings.push_back(&postings_it->second);
+        }
+
+        // intersect the shortest lists first, so that the intermediate results stay small
+        std::sort(postings.begin(), postings.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+            return a->size() < b->size();
+        });
+
+        candidate_ids = *postings[0];
+        std::vector<uint32_t> intersected_ids;
+
+        for(size_t i = 1; i < postings.size() && !candidate_ids.empty(); i++) {
+            intersected_ids.clear();
+            std::set_intersection(candidate_ids.begin(), candidate_ids.end(),
+                                  postings[i]->begin(), postings[i]->end(), std::back_inserter(intersected_ids));
+            candidate_ids.swap(intersected_ids);
+        }
+
+        return ;
+    }
+
+    // a shorter query is found within the trigrams of a token, or within a token that has no trigrams
+    char gram[GRAM_SIZE];
+
+    for(const auto& key_postings: gram_postings) {
+        gram[0] = char(key_postings.first >> 16);
+        gram[1] = char(key_postings.first >> 8);
+        gram[2] = char(key_postings.first);
+
+        if(std::search(gram, gram + GRAM_SIZE, query.begin(), query.end()) != gram + GRAM_SIZE) {
+            candidate_ids.insert(candidate_ids.end(), key_postings.second.begin(), key_postings.second.end());
+        }
+    }
+
+    candidate_ids.insert(candidate_ids.end(), short_token_ids.begin(), short_token_ids.end());
+
+    std::sort(candidate_ids.begin(), candidate_ids.end());
+    candidate_ids.erase(std::unique(candidate_ids.begin(), candidate_ids.end()), candidate_ids.end());
+}
+
+void infix_index_t::search(const std::string& query, size_t max_extra_prefix, size_t max_extra_suffix,
+                           std::vector<std::string>& tokens) const {
+    if(query.empty()) {
+        return ;
+    }
+
+    auto verify = [&query, max_extra_prefix, max_extra_suffix](const std::string& token) {
+        const size_t start_index = token.find(query);
+        return start_index != std::string::npos && start_index <= max_extra_prefix &&
+               (token.size() - (start_index + query.size())) <= max_extra_suffix;
+    };
+
+    std::vector<uint32_t> candidate_ids;
+    find_candidates(query, candidate_ids);
+
+    for(uint32_t id: candidate_ids) {
+        if(verify(id_tokens[id])) {
+            tokens.push_back(id_tokens[id]);
+        }
+    }
+
+    if(sealed == nullptr) {
+        return ;
+    }
+
+    std::vector<uint32_t> sealed_ids;
+    sealed->search(query, sealed_ids);
+
+    for(uint32_t sealed_id: sealed_ids) {
+        if(!sealed_live[sealed_id]) {
+            continue;
+        }
+
+        std::string token = sealed->get_token(sealed_id);
+
+        if(verify(token)) {
+            tokens.push_back(std::move(token));
+        }
+    }
+}
+
+size_t infix_index_t::size() const {
+    return token_ids.size() + num_sealed_live;
+}
+
+size_t infix_index_t::delta_size() const {
+    return token_ids.size();
+}
+
+void infix_index_t::get_tokens(std::vector<std::string>& tokens) const {
+    tokens.reserve(tokens.size() + size());
+
+    for(auto it = token_ids.begin(); it != token_ids.end(); ++it) {
+        tokens.push_back(it.key());
+    }
+
+    for(size_t sealed_id = 0; sealed_id < sealed_live.size(); sealed_id++) {
+        if(sealed_live[sealed_id]) {
+            tokens.push_back(sealed->get_token(sealed_id));
+        }
+    }
+}
+
+std::shared_ptr<infix_rebuild_t> infix_index_t::begin_rebuild(bool force) {
+    apply_rebuild();
+
+    if(!sealable || rebuild != nullptr) {
+        return nullptr;
+    }
+
+    // erased sealed tokens are dropped by a rebuild as well
+    const size_t num_changed = token_ids.size() + (sealed_live.size() - num_sealed_live);
+
+    if(!force && (num_changed < MIN_DELTA_TOKENS_TO_SEAL || num_changed < num_sealed_live / 8)) {
+        return nullptr;
+    }
+
+    rebuild = std::make_shared<infix_rebuild_t>();
+    rebuild->base = sealed;
+    rebuild->base_live = sealed_live;
+
+    for(auto it = token_ids.begin(); it != token_ids.end(); ++it) {
+        rebuild->delta_tokens.push_back(it.key());
+    }
+
+    rebuild_log.clear();
+    return rebuild;
+}
+
+void infix_index_t::run_rebuild(infix_rebuild_t& rebuild) {
+    std::vector<std::string> tokens = std::move(rebuild.delta_tokens);
+
+    for(size_t sealed_id = 0; sealed_id < rebuild.base_live.size(); sealed_id++) {
+        if(rebuild.base_live[sealed_id]) {
+            tokens.push_back(rebuild.base->get_token(sealed_id));
+        }
+    }
+
+    rebuild.base.reset();
+    rebuild.base_live.clear();
+
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    rebuild.sealed = std::make_shared<const infix_suffix_array_t>(tokens);
+    rebuild.done.store(true, std::memory_order_release);
+}
+
+void infix_index_t::apply_rebuild() {
+    if(rebuild == nullptr || !rebuild->done.load(std::memory_order_acquire)) {
+        return ;
+    }
+
+    sealed = rebuild->sealed;
+    sealed_live.assign(sealed->num_tokens(), true);
+    num_sealed_live = sealed->num_tokens();
+    rebuild.reset();
+
+    clear_delta();
+
+    std::vector<std::pair<bool, std::string>> changes;
+    changes.swap(rebuild_log);
+
+    for(const auto& change: changes) {
+        if(change.first) {
+            insert(change.second);
+        } else {
+            erase(change.second);
+        }
+    }
+}
+
+void infix_index_t::seal() {
+    std::shared_ptr<infix_rebuild_t> sealing = begin_rebuild(true);
+
+    if(sealing != nullptr) {
+        run_rebuild(*sealing);
+        apply_rebuild();
+    }
+}
+
+void infix_index_t::save(index_image_writer_t& writer) const {
+    // only the tokens are written: the ids, trigrams and suffixes are rebuilt on load
+    std::vector<std::string> tokens;
+    get_tokens(tokens);
+
+    writer.write_value<uint64_t>(tokens.size());
+
+    for(const std::string& token: tokens) {
+        writer.write_string(token);
+    }
+}
+
+bool infix_index_t::load(index_image_reader_t& reader) {
+    uint64_t num_tokens;
+    if(!reader.read_value(num_tokens)) {
+        return false;
+    }
+
+    std::string token;
+
+    for(uint64_t i = 0; i < num_tokens; i++) {
+        if(!reader.read_string(token)) {
+            return false;
+        }
+
+        insert(token);
+    }
+
+    if(sealable) {
+        seal();
+    }
+
+    return true;
+}
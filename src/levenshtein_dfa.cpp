@@ -0,0 +1,92 @@
+#include "levenshtein_dfa.h"
+#include <algorithm>
+
+levenshtein_dfa_t::levenshtein_dfa_t(const unsigned char* term, int term_len, int max_cost):
+        term_len(term_len), max_cost(max_cost), cost_cap(uint8_t(std::min(max_cost + 2, 255))) {
+
+    for(int i = 0; i < term_len; i++) {
+        if(char_classes[term[i]] == 0) {
+            char_classes[term[i]] = num_classes++;
+        }
+
+        term_classes.push_back(char_classes[term[i]]);
+    }
+
+    const size_t columns = term_len + 1;
+    state_size = 3 + columns * 2;
+
+    // nothing consumed yet: both rows are the costs of deleting the term's prefixes
+    std::string initial_state(state_size, '\0');
+    initial_state[0] = char(char_classes[0] & 0xff);
+    initial_state[1] = char(char_classes[0] >> 8);
+
+    for(size_t column = 0; column < columns; column++) {
+        initial_state[3 + column] = initial_state[3 + columns + column] = char(std::min<size_t>(column, cost_cap));
+    }
+
+    add_state(initial_state);
+}
+
+uint32_t levenshtein_dfa_t::add_state(const std::string& state) {
+    const auto state_it = state_ids.find(state);
+    if(state_it != state_ids.end()) {
+        return state_it->second;
+    }
+
+    const uint32_t state_id = state_ids.size();
+    state_ids.emplace(state, state_id);
+    states.insert(states.end(), state.begin(), state.end());
+    transitions.resize(transitions.size() + num_classes, UNKNOWN_STATE);
+
+    // costs never drop below the smaller of the cost row's minimum and the previous row's minimum + 1
+    const size_t columns = term_len + 1;
+    const auto* prev_row = reinterpret_cast<const uint8_t*>(state.data() + 3);
+    const auto* row = prev_row + columns;
+
+    const int min_cost = std::min(int(*std::min_element(row, row + columns)),
+                                  int(*std::min_element(prev_row, prev_row + columns)) + 1);
+
+    dead_states.push_back(min_cost > max_cost);
+    return state_id;
+}
+
+uint32_t levenshtein_dfa_t::compute_transition(uint32_t state, uint16_t char_class) {
+    const size_t columns = term_len + 1;
+
+    // copied, since adding the next state could reallocate `states`
+    const std::string current(reinterpret_cast<const char*>(&states[size_t(state) * state_size]), state_size);
+    const uint16_t prev_class = uint8_t(current[0]) | (uint16_t(uint8_t(current[1])) << 8);
+    const uint8_t num_consumed = current[2];
+    const auto* irow = reinterpret_cast<const uint8_t*>(current.data() + 3);
+    const auto* jrow = irow + columns;
+
+    std::string next(state_size, '\0');
+    next[0] = char(char_class & 0xff);
+    next[1] = char(char_class >> 8);
+    next[2] = char(std::min<uint8_t>(num_consumed + 1, 2));
+    std::copy(jrow, jrow + columns, next.begin() + 3);
+
+    auto* krow = reinterpret_cast<uint8_t*>(&next[3 + columns]);
+    krow[0] = std::min<int>(jrow[0] + 1, cost_cap);
+
+    // optimal string alignment distance, with characters compared by their class: as the tree's fuzzy search always
+    // did, transpositions are only considered from the third consumed character on
+    for(size_t column = 1; column < columns; column++) {
+        const int cost = (char_class != 0 && char_class == term_classes[column - 1]) ? 0 : 1;
+
+        int column_cost = std::min(std::min(jrow[column] + 1, krow[column - 1] + 1), jrow[column - 1] + cost);
+
+        if(num_consumed > 1 && column > 1 && char_class != 0 && char_class == term_classes[column - 2] &&
+           prev_class == term_classes[column - 1]) {
+            column_cost = std::min(column_cost, irow[column - 2] + 1);
+        }
+
+        krow[column] = std::min<int>(column_cost, cost_cap);
+    }
+
+    return add_state(next);
+}
+
+size_t levenshtein_dfa_t::num_states() const {
+    return state_ids.size();
+}
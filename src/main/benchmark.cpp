@@ -11,6 +11,7 @@
 #include "collection.h"
 #include "string_utils.h"
 #include "collection_manager.h"
+#include "array_utils.h"
 
 using namespace std;
 
@@ -189,12 +190,160 @@ void generate_word_freq() {
     outfile.close();
 }
 
+std::vector<uint32_t> get_sorted_ids(size_t num_ids, uint32_t max_id) {
+    std::vector<uint32_t> ids;
+    ids.reserve(num_ids);
+
+    // pick each id with probability of num_ids/max_id so that the ids remain unique and sorted
+    for(uint32_t id = 0; id < max_id && ids.size() < num_ids; id++) {
+        if(size_t(rand()) % max_id < num_ids) {
+            ids.push_back(id);
+        }
+    }
+
+    return ids;
+}
+
+template<class T>
+void benchmark_set_op(const std::string& name, T op, const std::vector<uint32_t>& A, const std::vector<uint32_t>& B,
+                      size_t num_runs) {
+    uint64_t results_total = 0; // to prevent no-op optimization!
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t i = 0; i < num_runs; i++) {
+        uint32_t* out = nullptr;
+        results_total += op(&A[0], A.size(), &B[0], B.size(), &out);
+        delete [] out;
+    }
+
+    long long int timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    std::cout << name << ": " << (timeMicros / num_runs) << "us per op, results total: " << results_total << std::endl;
+}
+
+void benchmark_array_utils() {
+    // {lenA, lenB} pairs: balanced lists of varying density and skewed lists
+    std::vector<std::pair<size_t, size_t>> list_sizes = {
+        {1000000, 1000000}, {1000000, 5000000}, {1000, 5000000}, {50000, 5000000}
+    };
+
+    const uint32_t max_id = 10000000;
+    const size_t num_runs = 20;
+
+    for(const auto& list_size: list_sizes) {
+        std::vector<uint32_t> A = get_sorted_ids(list_size.first, max_id);
+        std::vector<uint32_t> B = get_sorted_ids(list_size.second, max_id);
+
+        std::cout << "lenA: " << A.size() << ", lenB: " << B.size() << std::endl;
+
+        benchmark_set_op("and_scalar", ArrayUtils::and_scalar, A, B, num_runs);
+        benchmark_set_op("and_simd", ArrayUtils::and_simd, A, B, num_runs);
+        benchmark_set_op("or_scalar", ArrayUtils::or_scalar, A, B, num_runs);
+        benchmark_set_op("or_simd", ArrayUtils::or_simd, A, B, num_runs);
+        benchmark_set_op("exclude_scalar", ArrayUtils::exclude_scalar, B, A, num_runs);
+        benchmark_set_op("exclude_simd", ArrayUtils::exclude_simd, B, A, num_runs);
+    }
+}
+
+std::vector<std::string> get_random_words(size_t num_words) {
+    const std::string alphabet = "abcdefghilmnoprstu";
+    std::vector<std::string> words;
+    words.reserve(num_words);
+
+    for(size_t i = 0; i < num_words; i++) {
+        std::string word(3 + rand() % 10, 'a');
+        for(char& c: word) {
+            c = alphabet[rand() % alphabet.size()];
+        }
+        words.push_back(word);
+    }
+
+    return words;
+}
+
+void benchmark_art() {
+    const size_t num_words = 500000;
+    const size_t num_queries = 20000;
+
+    std::vector<std::string> words = get_random_words(num_words);
+
+    art_tree t;
+    art_tree_init(&t);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t i = 0; i < words.size(); i++) {
+        art_document doc(i, i, {0});
+        art_insert(&t, (const unsigned char*) words[i].c_str(), words[i].size() + 1, &doc);
+    }
+
+    long long int timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    std::cout << "insert: " << timeMillis << "ms for " << art_size(&t) << " keys" << std::endl;
+
+    uint64_t results_total = 0; // to prevent no-op optimization!
+    begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t i = 0; i < num_queries; i++) {
+        const std::string& word = words[rand() % words.size()];
+        results_total += art_search(&t, (const unsigned char*) word.c_str(), word.size() + 1) != nullptr;
+    }
+
+    long long int timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    std::cout << "search: " << (timeMicros * 1000 / num_queries) << "ns per op" << std::endl;
+
+    // typo and prefix expansions, i.e. art_fuzzy_recurse() followed by art_topk_iter()
+    for(int cost = 0; cost <= 2; cost++) {
+        begin = std::chrono::high_resolution_clock::now();
+
+        for(size_t i = 0; i < num_queries; i++) {
+            const std::string& word = words[rand() % words.size()];
+            const std::string prefix = word.substr(0, std::max<size_t>(3, word.size() / 2));
+
+            std::vector<art_leaf*> leaves;
+            art_fuzzy_search(&t, (const unsigned char*) prefix.c_str(), prefix.size(), cost, cost, 10, MAX_SCORE,
+                             true, nullptr, 0, leaves);
+            results_total += leaves.size();
+        }
+
+        timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+        std::cout << "fuzzy prefix search, cost " << cost << ": " << (timeMicros / num_queries) << "us per op"
+                  << std::endl;
+    }
+
+    // churn: delete and insert back a fraction of the keys
+    begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t round = 0; round < 5; round++) {
+        for(size_t i = round; i < words.size(); i += 10) {
+            void* values = art_delete(&t, (const unsigned char*) words[i].c_str(), words[i].size() + 1);
+            posting_t::destroy_list(values);
+        }
+
+        for(size_t i = round; i < words.size(); i += 10) {
+            art_document doc(i, i, {0});
+            art_insert(&t, (const unsigned char*) words[i].c_str(), words[i].size() + 1, &doc);
+        }
+    }
+
+    timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+    std::cout << "churn: " << timeMillis << "ms" << std::endl;
+    std::cout << "Results total: " << results_total << std::endl;
+
+    art_tree_destroy(&t);
+}
+
 int main(int argc, char* argv[]) {
     srand(time(NULL));
 //    system("rm -rf /tmp/typesense-data && mkdir -p /tmp/typesense-data");
 
 //    benchmark_hn_titles(argv[1]);
 //    benchmark_reactjs_pages(argv[1]);
+//    benchmark_array_utils();
+//    benchmark_art();
 
     generate_word_freq();
 
@@ -1,6 +1,7 @@
 #include "num_tree.h"
 #include "parasort.h"
 #include "timsort.hpp"
+#include <algorithm>
 
 void num_tree_t::insert(int64_t value, uint32_t id) {
     if (int64map.count(value) == 0) {
@@ -36,8 +37,8 @@ void num_tree_t::range_inclusive_search(int64_t start, int64_t end, uint32_t** i
     gfx::timsort(consolidated_ids.begin(), consolidated_ids.end());
 
     uint32_t *out = nullptr;
-    ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
-                                    *ids, ids_len, &out);
+    ids_len = ArrayUtils::or_simd(&consolidated_ids[0], consolidated_ids.size(),
+                                  *ids, ids_len, &out);
 
     delete [] *ids;
     *ids = out;
@@ -69,8 +70,8 @@ void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids
         if(it != int64map.end()) {
             uint32_t *out = nullptr;
             uint32_t* val_ids = ids_t::uncompress(it->second);
-            ids_len = ArrayUtils::or_scalar(val_ids, ids_t::num_ids(it->second),
-                                            *ids, ids_len, &out);
+            ids_len = ArrayUtils::or_simd(val_ids, ids_t::num_ids(it->second),
+                                          *ids, ids_len, &out);
             delete[] *ids;
             *ids = out;
             delete[] val_ids;
@@ -104,8 +105,8 @@ void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids
         consolidated_ids.erase(unique(consolidated_ids.begin(), consolidated_ids.end()), consolidated_ids.end());
 
         uint32_t *out = nullptr;
-        ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
-                                        *ids, ids_len, &out);
+        ids_len = ArrayUtils::or_simd(&consolidated_ids[0], consolidated_ids.size(),
+                                      *ids, ids_len, &out);
 
         delete [] *ids;
         *ids = out;
@@ -141,14 +142,144 @@ void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids
         consolidated_ids.erase(unique(consolidated_ids.begin(), consolidated_ids.end()), consolidated_ids.end());
 
         uint32_t *out = nullptr;
-        ids_len = ArrayUtils::or_scalar(&consolidated_ids[0], consolidated_ids.size(),
-                                        *ids, ids_len, &out);
+        ids_len = ArrayUtils::or_simd(&consolidated_ids[0], consolidated_ids.size(),
+                                      *ids, ids_len, &out);
 
         delete [] *ids;
         *ids = out;
     }
 }
 
+void num_tree_t::add_id_lists(const std::vector<void*>& id_lists, id_bitmap_t& ids) {
+    if(id_lists.empty()) {
+        return ;
+    }
+
+    if(id_lists.size() == 1) {
+        void* id_list = id_lists[0];
+        ids_t::uncompress(id_list, ids);
+        return ;
+    }
+
+    // a range over many values (e.g. one per document) would otherwise merge every short list into the containers
+    std::vector<uint32_t> consolidated_ids;
+    for(void* id_list: id_lists) {
+        uint32_t* values = ids_t::uncompress(id_list);
+        consolidated_ids.insert(consolidated_ids.end(), values, values + ids_t::num_ids(id_list));
+        delete [] values;
+    }
+
+    gfx::timsort(consolidated_ids.begin(), consolidated_ids.end());
+    consolidated_ids.erase(unique(consolidated_ids.begin(), consolidated_ids.end()), consolidated_ids.end());
+
+    ids.add_many(consolidated_ids.data(), consolidated_ids.size());
+}
+
+void num_tree_t::range_inclusive_search(int64_t start, int64_t end, id_bitmap_t& ids) {
+    std::vector<void*> id_lists;
+    range_inclusive_search(start, end, id_lists);
+    add_id_lists(id_lists, ids);
+}
+
+void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, id_bitmap_t& ids) {
+    std::vector<void*> id_lists;
+    search(comparator, value, id_lists);
+    add_id_lists(id_lists, ids);
+}
+
+void num_tree_t::range_inclusive_search(int64_t start, int64_t end, std::vector<void*>& id_lists) {
+    auto it_start = int64map.lower_bound(start);  // iter values will be >= start
+
+    while(it_start != int64map.end() && it_start->first <= end) {
+        id_lists.push_back(it_start->second);
+        it_start++;
+    }
+}
+
+void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, std::vector<void*>& id_lists) {
+    if(int64map.empty()) {
+        return ;
+    }
+
+    if(comparator == EQUALS) {
+        const auto& it = int64map.find(value);
+        if(it != int64map.end()) {
+            id_lists.push_back(it->second);
+        }
+    } else if(comparator == GREATER_THAN || comparator == GREATER_THAN_EQUALS) {
+        // iter entries will be >= value, or end() if all entries are before value
+        auto iter_ge_value = int64map.lower_bound(value);
+
+        if(iter_ge_value != int64map.end() && comparator == GREATER_THAN && iter_ge_value->first == value) {
+            iter_ge_value++;
+        }
+
+        while(iter_ge_value != int64map.end()) {
+            id_lists.push_back(iter_ge_value->second);
+            iter_ge_value++;
+        }
+    } else if(comparator == LESS_THAN || comparator == LESS_THAN_EQUALS) {
+        auto iter_ge_value = int64map.lower_bound(value);
+        auto it = int64map.begin();
+
+        while(it != iter_ge_value) {
+            id_lists.push_back(it->second);
+            it++;
+        }
+
+        // for LESS_THAN_EQUALS, check if last iter entry is equal to value
+        if(it != int64map.end() && comparator == LESS_THAN_EQUALS && it->first == value) {
+            id_lists.push_back(it->second);
+        }
+    }
+}
+
+bool num_tree_t::ordered_search(bool ascending, const uint32_t* filter_ids, size_t filter_ids_length,
+                                size_t min_ids, size_t max_ids_visited, std::vector<uint32_t>& ids) {
+    size_t num_ids_visited = 0;
+
+    auto collect = [&](int64_t value, void* id_list) -> bool {
+        if(value == INT64_MIN) {
+            // clashes with the sort sentinel of missing values, so it can't be ordered here
+            return true;
+        }
+
+        const uint32_t num_value_ids = ids_t::num_ids(id_list);
+        num_ids_visited += num_value_ids;
+
+        if(num_ids_visited > max_ids_visited) {
+            return false;
+        }
+
+        uint32_t* value_ids = ids_t::uncompress(id_list);
+
+        for(size_t i = 0; i < num_value_ids; i++) {
+            if(std::binary_search(filter_ids, filter_ids + filter_ids_length, value_ids[i])) {
+                ids.push_back(value_ids[i]);
+            }
+        }
+
+        delete [] value_ids;
+        return true;
+    };
+
+    if(ascending) {
+        for(auto it = int64map.begin(); it != int64map.end() && ids.size() < min_ids; it++) {
+            if(!collect(it->first, it->second)) {
+                return false;
+            }
+        }
+    } else {
+        for(auto it = int64map.rbegin(); it != int64map.rend() && ids.size() < min_ids; it++) {
+            if(!collect(it->first, it->second)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 void num_tree_t::remove(uint64_t value, uint32_t id) {
     if(int64map.count(value) != 0) {
         void* arr = int64map[value];
@@ -167,6 +298,47 @@ size_t num_tree_t::size() {
     return int64map.size();
 }
 
+void num_tree_t::save(index_image_writer_t& writer) const {
+    writer.write_value<uint64_t>(int64map.size());
+
+    for(const auto& kv: int64map) {
+        void* ids = kv.second;
+        uint32_t* values = ids_t::uncompress(ids);
+
+        writer.write_value<int64_t>(kv.first);
+        writer.write_ids(values, ids_t::num_ids(ids));
+
+        delete [] values;
+    }
+}
+
+bool num_tree_t::load(index_image_reader_t& reader) {
+    uint64_t num_values;
+    if(!reader.read_value(num_values)) {
+        return false;
+    }
+
+    for(uint64_t i = 0; i < num_values; i++) {
+        int64_t value;
+        const uint32_t* ids;
+        uint32_t num_ids;
+
+        if(!reader.read_value(value) || !reader.read_ids(ids, num_ids) || num_ids == 0) {
+            return false;
+        }
+
+        void* id_list = SET_COMPACT_IDS(compact_id_list_t::create(1, {ids[0]}));
+        for(size_t j = 1; j < num_ids; j++) {
+            ids_t::upsert(id_list, ids[j]);
+        }
+
+        // values are written in sorted order
+        int64map.emplace_hint(int64map.end(), value, id_list);
+    }
+
+    return true;
+}
+
 num_tree_t::~num_tree_t() {
     for(auto& kv: int64map) {
         ids_t::destroy_list(kv.second);
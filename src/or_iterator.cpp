@@ -1,4 +1,6 @@
 #include "or_iterator.h"
+#include "filter_iterator.h"
+#include <algorithm>
 
 
 bool or_iterator_t::at_end(const std::vector<or_iterator_t>& its) {
@@ -183,6 +185,22 @@ bool or_iterator_t::take_id(result_iter_state_t& istate, uint32_t id, bool& is_e
     }
 
     // decide if this result be matched with filter results
+    if(istate.filter_iterator != nullptr) {
+        if(!istate.filter_iterator->valid()) {
+            return false;
+        }
+
+        istate.filter_iterator->skip_to(id);
+
+        if(istate.filter_iterator->valid() && istate.filter_iterator->id() == id) {
+            // like `filter_ids_index` below, move past the matched id
+            istate.filter_iterator->next();
+            return true;
+        }
+
+        return false;
+    }
+
     if(istate.filter_ids_length != 0) {
         if(istate.filter_ids_index >= istate.filter_ids_length) {
             return false;
@@ -236,6 +254,62 @@ const std::vector<posting_list_t::iterator_t>& or_iterator_t::get_its() const {
     return its;
 }
 
+or_iterator_t or_iterator_t::range_iterator(uint32_t min_id, uint32_t max_id) const {
+    std::vector<posting_list_t::iterator_t> range_its;
+
+    for(const auto& it: its) {
+        auto range_it = it.range_iterator(min_id, max_id);
+        if(range_it.valid()) {
+            range_its.push_back(std::move(range_it));
+        }
+    }
+
+    return or_iterator_t(range_its);
+}
+
+void or_iterator_t::get_range_max_ids(const std::vector<or_iterator_t>& its, size_t num_ranges, size_t min_blocks,
+                                      std::vector<uint32_t>& range_max_ids) {
+    // every match must be present in the token with the fewest blocks, so it is the cheapest to split evenly
+    const std::map<last_id_t, posting_list_t::block_t*>* split_block_map = nullptr;
+    size_t min_token_blocks = SIZE_MAX;
+
+    for(const auto& token_it: its) {
+        const std::map<last_id_t, posting_list_t::block_t*>* largest_block_map = nullptr;
+        size_t token_blocks = 0;
+
+        for(const auto& it: token_it.its) {
+            const auto block_map = it.get_id_block_map();
+            token_blocks += block_map->size();
+
+            if(largest_block_map == nullptr || block_map->size() > largest_block_map->size()) {
+                largest_block_map = block_map;
+            }
+        }
+
+        if(token_blocks < min_token_blocks) {
+            min_token_blocks = token_blocks;
+            split_block_map = largest_block_map;
+        }
+    }
+
+    range_max_ids.clear();
+
+    if(split_block_map != nullptr && num_ranges > 1 && min_token_blocks >= min_blocks) {
+        const size_t num_blocks = split_block_map->size();
+        const size_t window_size = (num_blocks + num_ranges - 1) / num_ranges;  // rounds up
+        size_t blocks_traversed = 0;
+
+        for(const auto& last_id_block: *split_block_map) {
+            blocks_traversed++;
+            if(blocks_traversed % window_size == 0 && blocks_traversed != num_blocks) {
+                range_max_ids.push_back(last_id_block.first);
+            }
+        }
+    }
+
+    range_max_ids.push_back(UINT32_MAX);
+}
+
 or_iterator_t::~or_iterator_t() noexcept {
     for(auto& it: its) {
         it.reset_cache();
@@ -1,5 +1,6 @@
 #include "posting.h"
 #include "posting_list.h"
+#include "filter_iterator.h"
 
 int64_t compact_posting_list_t::upsert(const uint32_t id, const std::vector<uint32_t>& offsets) {
     return upsert(id, &offsets[0], offsets.size());
@@ -243,6 +244,26 @@ bool compact_posting_list_t::contains_atleast_one(const uint32_t* target_ids, si
     return false;
 }
 
+bool compact_posting_list_t::contains_atleast_one(filter_iterator_t* filter_iterator) {
+    size_t i = 0;
+    filter_iterator->reset();
+
+    while(i < length && filter_iterator->valid()) {
+        size_t num_existing_offsets = id_offsets[i];
+        uint32_t existing_id = id_offsets[i + num_existing_offsets + 1];
+
+        filter_iterator->skip_to(existing_id);
+
+        if(filter_iterator->valid() && filter_iterator->id() == existing_id) {
+            return true;
+        }
+
+        i += num_existing_offsets + 2;
+    }
+
+    return false;
+}
+
 /* posting operations */
 
 void posting_t::upsert(void*& obj, uint32_t id, const std::vector<uint32_t>& offsets) {
@@ -343,6 +364,55 @@ uint32_t posting_t::num_ids(const void* obj) {
     }
 }
 
+void posting_t::get_id_offsets(const void* obj, std::vector<uint32_t>& ids, std::vector<uint32_t>& offset_index,
+                               std::vector<uint32_t>& offsets) {
+    ids.clear();
+    offset_index.clear();
+    offsets.clear();
+
+    if(IS_COMPACT_POSTING(obj)) {
+        compact_posting_list_t* list = COMPACT_POSTING_PTR(obj);
+
+        size_t i = 0;
+        while(i < list->length) {
+            size_t num_offsets = list->id_offsets[i];
+            i++;
+
+            offset_index.push_back(offsets.size());
+            offsets.insert(offsets.end(), list->id_offsets + i, list->id_offsets + i + num_offsets);
+            ids.push_back(list->id_offsets[i + num_offsets]);
+
+            i += num_offsets + 1;
+        }
+
+        return ;
+    }
+
+    posting_list_t* list = (posting_list_t*)(obj);
+    posting_list_t::block_t* block = list->get_root();
+
+    while(block != nullptr) {
+        const uint32_t num_block_ids = block->ids.getLength();
+        const uint32_t base_offset = offsets.size();
+
+        uint32_t* block_ids = block->ids.uncompress();
+        uint32_t* block_offset_index = block->offset_index.uncompress();
+        uint32_t* block_offsets = block->offsets.uncompress();
+
+        ids.insert(ids.end(), block_ids, block_ids + num_block_ids);
+        for(uint32_t i = 0; i < num_block_ids; i++) {
+            offset_index.push_back(base_offset + block_offset_index[i]);
+        }
+        offsets.insert(offsets.end(), block_offsets, block_offsets + block->offsets.getLength());
+
+        delete [] block_ids;
+        delete [] block_offset_index;
+        delete [] block_offsets;
+
+        block = block->next;
+    }
+}
+
 uint32_t posting_t::first_id(const void* obj) {
     if(IS_COMPACT_POSTING(obj)) {
         compact_posting_list_t* list = COMPACT_POSTING_PTR(obj);
@@ -373,6 +443,16 @@ bool posting_t::contains_atleast_one(const void* obj, const uint32_t* target_ids
     }
 }
 
+bool posting_t::contains_atleast_one(const void* obj, filter_iterator_t* filter_iterator) {
+    if(IS_COMPACT_POSTING(obj)) {
+        compact_posting_list_t* list = COMPACT_POSTING_PTR(obj);
+        return list->contains_atleast_one(filter_iterator);
+    } else {
+        posting_list_t* list = (posting_list_t*)(obj);
+        return list->contains_atleast_one(filter_iterator);
+    }
+}
+
 void posting_t::merge(const std::vector<void*>& raw_posting_lists, std::vector<uint32_t>& result_ids) {
     // we will have to convert the compact posting list (if any) to full form
     std::vector<posting_list_t*> plists;
@@ -517,3 +597,55 @@ void posting_t::get_phrase_matches(const std::vector<void*>& raw_posting_lists,
         delete expanded_plist;
     }
 }
+
+void posting_t::block_intersector_t::split_lists(size_t concurrency,
+                                                 std::vector<std::vector<posting_list_t::iterator_t>>& partial_its_vec) {
+    const size_t num_blocks = this->plists[0]->num_blocks();
+    const size_t window_size = (num_blocks + concurrency - 1) / concurrency;  // rounds up
+
+    size_t blocks_traversed = 0;
+    posting_list_t::block_t* start_block = this->plists[0]->get_root();
+    posting_list_t::block_t* curr_block = start_block;
+
+    size_t window_index = 0;
+
+    while(curr_block != nullptr) {
+        blocks_traversed++;
+        if(blocks_traversed % window_size == 0 || blocks_traversed == num_blocks) {
+            // construct partial iterators and intersect within them
+
+            std::vector<posting_list_t::iterator_t>& partial_its = partial_its_vec[window_index];
+
+            for(size_t i = 0; i < this->plists.size(); i++) {
+                posting_list_t::block_t* p_start_block = nullptr;
+                posting_list_t::block_t* p_end_block = nullptr;
+
+                if(i == 0) {
+                    p_start_block = start_block;
+                    p_end_block = curr_block->next;
+                } else {
+                    auto start_block_first_id = start_block->ids.at(0);
+                    auto end_block_last_id = curr_block->ids.last();
+
+                    p_start_block = this->plists[i]->block_of(start_block_first_id);
+                    posting_list_t::block_t* last_block = this->plists[i]->block_of(end_block_last_id);
+
+                    if(p_start_block == nullptr) {
+                        // all IDs of this list precede the window, so nothing in the window can match
+                        partial_its.clear();
+                        break;
+                    }
+
+                    p_end_block = (last_block == nullptr) ? nullptr : last_block->next;
+                }
+
+                partial_its.emplace_back(&this->plists[i]->id_block_map, p_start_block, p_end_block);
+            }
+
+            start_block = curr_block->next;
+            window_index++;
+        }
+
+        curr_block = curr_block->next;
+    }
+}
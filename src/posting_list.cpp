@@ -2,10 +2,51 @@
 #include <bitset>
 #include "for.h"
 #include "array_utils.h"
+#include "filter_iterator.h"
+
+/* result_iter_state_t operations */
+
+result_iter_state_t::result_iter_state_t(const uint32_t* excluded_result_ids, size_t excluded_result_ids_size,
+                                         const uint32_t* filter_ids, size_t filter_ids_length,
+                                         filter_iterator_t* filter_iterator):
+        excluded_result_ids(excluded_result_ids), excluded_result_ids_size(excluded_result_ids_size),
+        filter_ids(filter_ids), filter_ids_length(filter_ids_length), filter_iterator(filter_iterator) {
+
+    if(filter_iterator != nullptr) {
+        filter_iterator->reset();
+    }
+}
+
+bool result_iter_state_t::is_filter_provided() const {
+    return filter_ids_length != 0 || filter_iterator != nullptr;
+}
+
+bool result_iter_state_t::is_filter_valid() const {
+    if(filter_iterator != nullptr) {
+        return filter_iterator->valid();
+    }
+
+    return filter_ids_index < filter_ids_length;
+}
+
+uint32_t result_iter_state_t::get_filter_id() const {
+    if(filter_iterator != nullptr) {
+        return filter_iterator->id();
+    }
+
+    return filter_ids[filter_ids_index];
+}
 
 /* block_t operations */
 
 uint32_t posting_list_t::block_t::upsert(const uint32_t id, const std::vector<uint32_t>& positions) {
+    // a verbatim match has the token at the first position followed by the last token marker (see
+    // `is_single_token_verbatim_match()`), for both singular and array fields
+    if(!maybe_verbatim && std::find(positions.begin(), positions.end(), 1) != positions.end() &&
+       std::find(positions.begin(), positions.end(), 0) != positions.end()) {
+        maybe_verbatim = true;
+    }
+
     if(id > ids.last() || ids.getLength() == 0) {
         // append to the end
         ids.append(id);
@@ -231,6 +272,8 @@ posting_list_t::~posting_list_t() {
 
 void posting_list_t::merge_adjacent_blocks(posting_list_t::block_t* block1, posting_list_t::block_t* block2,
                                            size_t num_block2_ids_to_move) {
+    block1->maybe_verbatim = block1->maybe_verbatim || block2->maybe_verbatim;
+
     // merge ids
     uint32_t* ids1 = block1->ids.uncompress();
     uint32_t* ids2 = block2->ids.uncompress();
@@ -377,6 +420,8 @@ void posting_list_t::split_block(posting_list_t::block_t* src_block, posting_lis
         return;
     }
 
+    dst_block->maybe_verbatim = src_block->maybe_verbatim;
+
     uint32_t* raw_ids = src_block->ids.uncompress();
     size_t ids_first_half_length = (src_block->size() / 2);
     size_t ids_second_half_length = (src_block->size() - ids_first_half_length);
@@ -764,6 +809,12 @@ bool posting_list_t::take_id(result_iter_state_t& istate, uint32_t id) {
     }
 
     // decide if this result be matched with filter results
+    if(istate.filter_iterator != nullptr) {
+        // ids are taken in ascending order, so the filter iterator only has to move forward
+        istate.filter_iterator->skip_to(id);
+        return istate.filter_iterator->valid() && istate.filter_iterator->id() == id;
+    }
+
     if(istate.filter_ids_length != 0) {
         return std::binary_search(istate.filter_ids, istate.filter_ids + istate.filter_ids_length, id);
     }
@@ -1043,6 +1094,28 @@ bool posting_list_t::contains_atleast_one(const uint32_t* target_ids, size_t tar
     return false;
 }
 
+bool posting_list_t::contains_atleast_one(filter_iterator_t* filter_iterator) {
+    posting_list_t::iterator_t it = new_iterator();
+    filter_iterator->reset();
+
+    while(it.valid() && filter_iterator->valid()) {
+        uint32_t id = it.id();
+
+        if(id == filter_iterator->id()) {
+            return true;
+        }
+
+        // advance smallest value
+        if(id > filter_iterator->id()) {
+            filter_iterator->skip_to(id);
+        } else {
+            it.skip_to(filter_iterator->id());
+        }
+    }
+
+    return false;
+}
+
 void posting_list_t::get_exact_matches(std::vector<iterator_t>& its, const bool field_is_array,
                                        const uint32_t* ids, const uint32_t num_ids,
                                        uint32_t*& exact_ids, size_t& num_exact_ids) {
@@ -1326,6 +1399,10 @@ bool posting_list_t::all_ended2(const std::vector<posting_list_t::iterator_t>& i
     return !its[0].valid() && !its[1].valid();
 }
 
+bool posting_list_t::maybe_single_token_verbatim_match(const posting_list_t::iterator_t& it) {
+    return it.block() != nullptr && it.block()->maybe_verbatim;
+}
+
 size_t posting_list_t::get_last_offset(const posting_list_t::iterator_t& it, bool field_is_array) {
     block_t* curr_block = it.block();
     uint32_t curr_index = it.index();
@@ -1423,6 +1500,10 @@ uint32_t posting_list_t::iterator_t::last_block_id() const {
     return ids[curr_block->size() - 1];
 }
 
+uint32_t posting_list_t::iterator_t::num_block_ids_left() const {
+    return curr_block->size() - curr_index;
+}
+
 uint32_t posting_list_t::iterator_t::id() const {
     return ids[curr_index];
 }
@@ -1446,6 +1527,7 @@ void posting_list_t::iterator_t::skip_to(uint32_t id) {
     }
 
     // identify the block where the id could exist and skip to that
+    block_t* const range_end_block = end_block;
     reset_cache();
 
     const auto it = id_block_map->lower_bound(id);
@@ -1453,7 +1535,13 @@ void posting_list_t::iterator_t::skip_to(uint32_t id) {
         return;
     }
 
+    if(range_end_block != nullptr && it->first >= range_end_block->ids.last()) {
+        // id lies beyond the blocks that this iterator was created for
+        return;
+    }
+
     curr_block = it->second;
+    end_block = range_end_block;
     curr_index = 0;
     ids = curr_block->ids.uncompress();
     offset_index = curr_block->offset_index.uncompress();
@@ -1545,3 +1633,21 @@ posting_list_t::iterator_t posting_list_t::iterator_t::clone() const {
 uint32_t posting_list_t::iterator_t::get_field_id() const {
     return field_id;
 }
+
+posting_list_t::iterator_t posting_list_t::iterator_t::range_iterator(uint32_t min_id, uint32_t max_id) const {
+    const auto start_it = id_block_map->lower_bound(min_id);
+    if(start_it == id_block_map->end() || min_id > max_id) {
+        return posting_list_t::iterator_t(id_block_map, nullptr, nullptr, true, field_id);
+    }
+
+    const auto end_it = id_block_map->lower_bound(max_id);
+    block_t* range_end_block = (end_it == id_block_map->end()) ? nullptr : end_it->second->next;
+
+    posting_list_t::iterator_t it(id_block_map, start_it->second, range_end_block, true, field_id);
+    it.skip_to(min_id);
+    return it;
+}
+
+const std::map<last_id_t, posting_list_t::block_t*>* posting_list_t::iterator_t::get_id_block_map() const {
+    return id_block_map;
+}
@@ -267,7 +267,7 @@ void ReplicationState::write_to_leader(const std::shared_ptr<http_req>& request,
     const std::string& scheme = std::string(raw_req->scheme->name.base, raw_req->scheme->name.len);
     const std::string url = get_node_url_path(leader_addr, path, scheme);
 
-    thread_pool->enqueue([request, response, server, path, url, this]() {
+    thread_pool->enqueue(ThreadPool::lane_t::WRITE, [request, response, server, path, url, this]() {
         pending_writes++;
 
         std::map<std::string, std::string> res_headers;
@@ -391,6 +391,29 @@ void* ReplicationState::save_snapshot(void* arg) {
         }
     }
 
+    // and the index images, which are optional: a snapshot without them is restored by re-indexing the documents
+    if(!sa->index_write_generations.empty()) {
+        create_directory(sa->index_image_path);
+        auto image_op = CollectionManager::get_instance().save_index_images(sa->index_image_path,
+                                                                            sa->store_seq_number,
+                                                                            sa->index_write_generations);
+
+        if(!image_op.ok()) {
+            LOG(ERROR) << "Failure during index image creation, msg:" << image_op.error();
+            delete_path(sa->index_image_path);
+        }
+    }
+
+    butil::FileEnumerator image_dir_enum(butil::FilePath(sa->index_image_path), false, butil::FileEnumerator::FILES);
+
+    for (butil::FilePath file = image_dir_enum.Next(); !file.empty(); file = image_dir_enum.Next()) {
+        std::string file_name = std::string(index_image_dir_name) + "/" + file.BaseName().value();
+        if (sa->writer->add_file(file_name) != 0) {
+            sa->done->status().set_error(EIO, "Fail to add file to writer.");
+            return nullptr;
+        }
+    }
+
     const std::string& temp_snapshot_dir = sa->writer->get_path();
 
     sa->done->Run();
@@ -434,6 +457,10 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     LOG(INFO) << "on_snapshot_save";
 
     std::string db_snapshot_path = writer->get_path() + "/" + db_snapshot_name;
+    std::string index_image_path = writer->get_path() + "/" + index_image_dir_name;
+
+    uint64_t store_seq_number = 0;
+    std::map<uint32_t, uint64_t> index_write_generations;
 
     {
         // grab batch indexer lock so that we can take a clean snapshot
@@ -455,6 +482,12 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
         if(!status.ok()) {
             LOG(ERROR) << "Failure during checkpoint creation, msg:" << status.ToString();
             done->status().set_error(EIO, "Checkpoint creation failure.");
+        } else {
+            // Writing the index images takes time in proportion to the size of the indices, so only the state that
+            // they must match is captured while writes are paused. The images are written once writes resume, and
+            // those of the collections written to by then are left out.
+            store_seq_number = store->get_latest_seq_number();
+            index_write_generations = CollectionManager::get_instance().get_index_write_generations();
         }
     }
 
@@ -463,7 +496,10 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     arg->writer = writer;
     arg->state_dir_path = raft_dir_path;
     arg->db_snapshot_path = db_snapshot_path;
+    arg->index_image_path = index_image_path;
     arg->done = done;
+    arg->store_seq_number = store_seq_number;
+    arg->index_write_generations = std::move(index_write_generations);
 
     if(!ext_snapshot_path.empty()) {
         arg->ext_snapshot_path = ext_snapshot_path;
@@ -475,11 +511,11 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     bthread_start_urgent(&tid, NULL, save_snapshot, arg);
 }
 
-int ReplicationState::init_db() {
+int ReplicationState::init_db(const std::string& index_image_dir) {
     LOG(INFO) << "Loading collections from disk...";
 
     Option<bool> init_op = CollectionManager::get_instance().load(
-        num_collections_parallel_load, num_documents_parallel_load
+        num_collections_parallel_load, num_documents_parallel_load, index_image_dir
     );
 
     if(init_op.ok()) {
@@ -512,7 +548,9 @@ int ReplicationState::on_snapshot_load(braft::SnapshotReader* reader) {
         return reload_store;
     }
 
-    bool init_db_status = init_db();
+    // the raft log entries after the snapshot are replayed once this returns, so only the state as of the
+    // snapshot has to be restored here
+    bool init_db_status = init_db(reader->get_path() + "/" + index_image_dir_name);
 
     return init_db_status;
 }
@@ -713,7 +751,7 @@ void ReplicationState::do_snapshot(const std::string& snapshot_path, const std::
                                    const std::shared_ptr<http_res>& res) {
     LOG(INFO) << "Triggerring an on demand snapshot...";
 
-    thread_pool->enqueue([&snapshot_path, req, res, this]() {
+    thread_pool->enqueue(ThreadPool::lane_t::ADMIN, [&snapshot_path, req, res, this]() {
         OnDemandSnapshotClosure* snapshot_closure = new OnDemandSnapshotClosure(this, req, res);
         ext_snapshot_path = snapshot_path;
         std::shared_lock lock(this->node_mutex);
@@ -0,0 +1,242 @@
+#include "sort_column.h"
+
+sort_column_t::~sort_column_t() {
+    clear();
+}
+
+void sort_column_t::chunk_t::make_dense() {
+    dense = new dense_chunk_t;
+
+    for(size_t i = 0; i < sparse_offsets.size(); i++) {
+        const uint32_t offset = sparse_offsets[i];
+        dense->present[offset >> 6] |= (uint64_t(1) << (offset & 63));
+        dense->values[offset] = sparse_values[i];
+    }
+
+    std::vector<uint16_t>().swap(sparse_offsets);
+    std::vector<int64_t>().swap(sparse_values);
+}
+
+void sort_column_t::chunk_t::make_sparse() {
+    sparse_offsets.reserve(num_present);
+    sparse_values.reserve(num_present);
+
+    for(uint32_t offset = 0; offset < CHUNK_SIZE; offset++) {
+        if(dense->contains(offset)) {
+            sparse_offsets.push_back(offset);
+            sparse_values.push_back(dense->values[offset]);
+        }
+    }
+
+    delete dense;
+    dense = nullptr;
+}
+
+void sort_column_t::upsert(uint32_t seq_id, int64_t value) {
+    const uint32_t chunk_index = (seq_id >> CHUNK_BITS);
+    const uint32_t offset = (seq_id & CHUNK_MASK);
+
+    if(chunk_index >= chunks.size()) {
+        chunks.resize(chunk_index + 1, nullptr);
+    }
+
+    chunk_t*& chunk = chunks[chunk_index];
+
+    if(chunk == nullptr) {
+        chunk = new chunk_t;
+    }
+
+    if(chunk->dense != nullptr) {
+        dense_chunk_t* dense = chunk->dense;
+
+        if(!dense->contains(offset)) {
+            dense->present[offset >> 6] |= (uint64_t(1) << (offset & 63));
+            chunk->num_present++;
+            num_values++;
+        }
+
+        dense->values[offset] = value;
+        return ;
+    }
+
+    auto it = std::lower_bound(chunk->sparse_offsets.begin(), chunk->sparse_offsets.end(), offset);
+    const size_t index = it - chunk->sparse_offsets.begin();
+
+    if(it != chunk->sparse_offsets.end() && *it == offset) {
+        chunk->sparse_values[index] = value;
+        return ;
+    }
+
+    chunk->sparse_offsets.insert(it, offset);
+    chunk->sparse_values.insert(chunk->sparse_values.begin() + index, value);
+    chunk->num_present++;
+    num_values++;
+
+    if(chunk->num_present > SPARSE_MAX_VALUES) {
+        chunk->make_dense();
+    }
+}
+
+void sort_column_t::erase(uint32_t seq_id) {
+    const uint32_t chunk_index = (seq_id >> CHUNK_BITS);
+    const uint32_t offset = (seq_id & CHUNK_MASK);
+
+    if(chunk_index >= chunks.size() || chunks[chunk_index] == nullptr) {
+        return ;
+    }
+
+    chunk_t*& chunk = chunks[chunk_index];
+
+    if(chunk->dense != nullptr) {
+        dense_chunk_t* dense = chunk->dense;
+
+        if(!dense->contains(offset)) {
+            return ;
+        }
+
+        dense->present[offset >> 6] &= ~(uint64_t(1) << (offset & 63));
+    } else {
+        auto it = std::lower_bound(chunk->sparse_offsets.begin(), chunk->sparse_offsets.end(), offset);
+        if(it == chunk->sparse_offsets.end() || *it != offset) {
+            return ;
+        }
+
+        chunk->sparse_values.erase(chunk->sparse_values.begin() + (it - chunk->sparse_offsets.begin()));
+        chunk->sparse_offsets.erase(it);
+    }
+
+    chunk->num_present--;
+    num_values--;
+
+    if(chunk->num_present == 0) {
+        delete chunk;
+        chunk = nullptr;
+    } else if(chunk->dense != nullptr && chunk->num_present <= SPARSE_MAX_VALUES / 2) {
+        chunk->make_sparse();
+    }
+}
+
+size_t sort_column_t::size() const {
+    return num_values;
+}
+
+size_t sort_column_t::chunk_bytes() const {
+    size_t num_bytes = 0;
+
+    for(const chunk_t* chunk: chunks) {
+        if(chunk == nullptr) {
+            continue;
+        }
+
+        num_bytes += sizeof(chunk_t) + (chunk->dense != nullptr ? sizeof(dense_chunk_t) : 0) +
+                     chunk->sparse_offsets.capacity() * sizeof(uint16_t) +
+                     chunk->sparse_values.capacity() * sizeof(int64_t);
+    }
+
+    return num_bytes;
+}
+
+bool sort_column_t::empty() const {
+    return num_values == 0;
+}
+
+void sort_column_t::clear() {
+    for(chunk_t* chunk: chunks) {
+        delete chunk;
+    }
+
+    chunks.clear();
+    num_values = 0;
+}
+
+void sort_column_t::save(index_image_writer_t& writer) const {
+    writer.write_value<uint32_t>(chunks.size());
+
+    uint32_t num_chunks = 0;
+    for(const chunk_t* chunk: chunks) {
+        num_chunks += (chunk != nullptr);
+    }
+
+    writer.write_value<uint32_t>(num_chunks);
+
+    for(uint32_t chunk_index = 0; chunk_index < chunks.size(); chunk_index++) {
+        const chunk_t* chunk = chunks[chunk_index];
+        if(chunk == nullptr) {
+            continue;
+        }
+
+        writer.write_value<uint32_t>(chunk_index);
+        writer.write_value<uint32_t>(chunk->num_present);
+
+        // the form is picked by the number of values alone, so that the reader can tell them apart
+        if(chunk->num_present > SPARSE_MAX_VALUES) {
+            writer.write(chunk->dense->present, sizeof(chunk->dense->present));
+            writer.write(chunk->dense->values, sizeof(chunk->dense->values));
+        } else if(chunk->dense != nullptr) {
+            for(uint32_t offset = 0; offset < CHUNK_SIZE; offset++) {
+                if(chunk->dense->contains(offset)) {
+                    writer.write_value<uint16_t>(offset);
+                }
+            }
+
+            for(uint32_t offset = 0; offset < CHUNK_SIZE; offset++) {
+                if(chunk->dense->contains(offset)) {
+                    writer.write_value<int64_t>(chunk->dense->values[offset]);
+                }
+            }
+        } else {
+            writer.write(chunk->sparse_offsets.data(), chunk->num_present * sizeof(uint16_t));
+            writer.write(chunk->sparse_values.data(), chunk->num_present * sizeof(int64_t));
+        }
+    }
+}
+
+bool sort_column_t::load(index_image_reader_t& reader) {
+    uint32_t num_slots, num_chunks;
+    if(!reader.read_value(num_slots) || !reader.read_value(num_chunks) || num_chunks > num_slots) {
+        return false;
+    }
+
+    chunks.resize(num_slots, nullptr);
+
+    for(uint32_t i = 0; i < num_chunks; i++) {
+        uint32_t chunk_index;
+        if(!reader.read_value(chunk_index) || chunk_index >= num_slots || chunks[chunk_index] != nullptr) {
+            return false;
+        }
+
+        chunk_t* chunk = new chunk_t;
+        chunks[chunk_index] = chunk;
+
+        if(!reader.read_value(chunk->num_present) || chunk->num_present == 0 || chunk->num_present > CHUNK_SIZE) {
+            return false;
+        }
+
+        if(chunk->num_present > SPARSE_MAX_VALUES) {
+            chunk->dense = new dense_chunk_t;
+            if(!reader.read(chunk->dense->present, sizeof(chunk->dense->present)) ||
+               !reader.read(chunk->dense->values, sizeof(chunk->dense->values))) {
+                return false;
+            }
+        } else {
+            chunk->sparse_offsets.resize(chunk->num_present);
+            chunk->sparse_values.resize(chunk->num_present);
+
+            if(!reader.read(chunk->sparse_offsets.data(), chunk->num_present * sizeof(uint16_t)) ||
+               !reader.read(chunk->sparse_values.data(), chunk->num_present * sizeof(int64_t))) {
+                return false;
+            }
+
+            for(uint32_t j = 0; j < chunk->num_present; j++) {
+                if(chunk->sparse_offsets[j] >= CHUNK_SIZE ||
+                   (j != 0 && chunk->sparse_offsets[j] <= chunk->sparse_offsets[j-1])) {
+                    return false;
+                }
+            }
+        }
+
+        num_values += chunk->num_present;
+    }
+
+    return true;
+}
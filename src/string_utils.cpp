@@ -184,6 +184,34 @@ void StringUtils::split_to_values(const std::string& vals_str, std::vector<std::
     }
 }
 
+void StringUtils::split_facet_fields(const std::string& facet_by_str, std::vector<std::string>& facet_fields) {
+    std::string buffer;
+    int depth = 0;
+
+    for(char c: facet_by_str) {
+        if(c == ',' && depth == 0) {
+            if(!StringUtils::trim(buffer).empty()) {
+                facet_fields.push_back(buffer);
+            }
+
+            buffer.clear();
+            continue;
+        }
+
+        if(c == '(') {
+            depth++;
+        } else if(c == ')' && depth > 0) {
+            depth--;
+        }
+
+        buffer += c;
+    }
+
+    if(!StringUtils::trim(buffer).empty()) {
+        facet_fields.push_back(buffer);
+    }
+}
+
 std::string StringUtils::float_to_str(float value) {
     std::ostringstream os;
     os << value;
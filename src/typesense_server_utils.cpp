@@ -94,6 +94,9 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
     options.add<uint32_t>("num-documents-parallel-load", '\0', "Number of documents per collection that are indexed in parallel during start up.", false, 1000);
 
     options.add<uint32_t>("thread-pool-size", '\0', "Number of threads used for handling concurrent requests.", false, 4);
+    options.add<uint32_t>("search-lane-concurrency", '\0', "Maximum number of threads that run search work at once (0 for no limit).", false, 0);
+    options.add<uint32_t>("write-lane-concurrency", '\0', "Maximum number of threads that run write and import work at once.", false, 0);
+    options.add<uint32_t>("admin-lane-concurrency", '\0', "Maximum number of threads that run administrative requests at once (0 for no limit).", false, 0);
 
     options.add<std::string>("log-dir", '\0', "Path to the log directory.", false, "");
 
@@ -405,6 +408,19 @@ int run_server(const Config & config, const std::string & version, void (*master
     ThreadPool app_thread_pool(num_threads);
     ThreadPool server_thread_pool(num_threads);
 
+    // by default, writes get at most half of the threads, so that a large import can't starve searches
+    const size_t write_lane_concurrency = config.get_write_lane_concurrency() == 0 ?
+                                          std::max<size_t>(1, num_threads / 2) : config.get_write_lane_concurrency();
+
+    for(ThreadPool* thread_pool: {&app_thread_pool, &server_thread_pool}) {
+        thread_pool->set_lane(ThreadPool::lane_t::ADMIN, config.get_admin_lane_concurrency(), 2);
+        thread_pool->set_lane(ThreadPool::lane_t::SEARCH, config.get_search_lane_concurrency(), 1);
+        thread_pool->set_lane(ThreadPool::lane_t::WRITE, write_lane_concurrency, 0);
+    }
+
+    LOG(INFO) << "Lane concurrency: search=" << config.get_search_lane_concurrency()
+              << ", write=" << write_lane_concurrency << ", admin=" << config.get_admin_lane_concurrency();
+
     // primary DB used for storing the documents: we will not use WAL since Raft provides that
     Store store(db_dir);
 
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "array_utils.h"
 #include "logger.h"
+#include <random>
+#include <set>
 
 TEST(SortedArrayTest, AndScalar) {
     const size_t size1 = 9;
@@ -172,4 +174,113 @@ TEST(SortedArrayTest, FilterArray) {
     delete[] arr2;
     delete[] arr1;
     delete[] results;
-}
\ No newline at end of file
+}
+
+static std::vector<uint32_t> random_sorted_ids(size_t size, uint32_t max_id, std::mt19937& gen) {
+    std::uniform_int_distribution<uint32_t> dist(0, max_id);
+    std::set<uint32_t> ids;
+    while(ids.size() < size) {
+        ids.insert(dist(gen));
+    }
+    return std::vector<uint32_t>(ids.begin(), ids.end());
+}
+
+TEST(SortedArrayTest, SimdVariantsMatchScalar) {
+    std::mt19937 gen(137723);
+
+    // balanced, skewed and sub-register sizes, with sparse and dense value ranges
+    std::vector<std::pair<size_t, size_t>> sizes = {
+        {0, 0}, {0, 10}, {1, 1}, {3, 5}, {4, 4}, {7, 9}, {8, 8}, {17, 33},
+        {100, 100}, {1000, 1000}, {1000, 3000}, {10, 5000}, {5000, 10}, {4999, 7}
+    };
+
+    for(const auto& size_pair: sizes) {
+        for(uint32_t max_id: {uint32_t(50), uint32_t(10000), uint32_t(UINT32_MAX)}) {
+            if(std::max(size_pair.first, size_pair.second) > max_id) {
+                continue;
+            }
+
+            std::vector<uint32_t> a = random_sorted_ids(size_pair.first, max_id, gen);
+            std::vector<uint32_t> b = random_sorted_ids(size_pair.second, max_id, gen);
+
+            uint32_t* scalar_out = nullptr;
+            uint32_t* simd_out = nullptr;
+
+            size_t scalar_len = ArrayUtils::and_scalar(a.data(), a.size(), b.data(), b.size(), &scalar_out);
+            size_t simd_len = ArrayUtils::and_simd(a.data(), a.size(), b.data(), b.size(), &simd_out);
+            ASSERT_EQ(scalar_len, simd_len);
+            for(size_t i = 0; i < scalar_len; i++) {
+                ASSERT_EQ(scalar_out[i], simd_out[i]);
+            }
+            delete [] scalar_out;
+            delete [] simd_out;
+            scalar_out = simd_out = nullptr;
+
+            scalar_len = ArrayUtils::or_scalar(a.data(), a.size(), b.data(), b.size(), &scalar_out);
+            simd_len = ArrayUtils::or_simd(a.data(), a.size(), b.data(), b.size(), &simd_out);
+            ASSERT_EQ(scalar_len, simd_len);
+            for(size_t i = 0; i < scalar_len; i++) {
+                ASSERT_EQ(scalar_out[i], simd_out[i]);
+            }
+            delete [] scalar_out;
+            delete [] simd_out;
+            scalar_out = simd_out = nullptr;
+
+            scalar_len = ArrayUtils::exclude_scalar(a.data(), a.size(), b.data(), b.size(), &scalar_out);
+            simd_len = ArrayUtils::exclude_simd(a.data(), a.size(), b.data(), b.size(), &simd_out);
+            ASSERT_EQ(scalar_len, simd_len);
+            for(size_t i = 0; i < scalar_len; i++) {
+                ASSERT_EQ(scalar_out[i], simd_out[i]);
+            }
+            delete [] scalar_out;
+            delete [] simd_out;
+        }
+    }
+}
+
+TEST(SortedArrayTest, OrSimdShouldRemoveDuplicatesWithinInputs) {
+    // num_tree_t consolidates IDs of multiple values, so a single input can contain duplicates
+    std::vector<uint32_t> a = {1, 1, 2, 3, 3, 3, 5, 8, 8, 9, 10, 10};
+    std::vector<uint32_t> b = {0, 1, 3, 4, 4, 8, 11, 11};
+
+    uint32_t* scalar_out = nullptr;
+    uint32_t* simd_out = nullptr;
+
+    size_t scalar_len = ArrayUtils::or_scalar(a.data(), a.size(), b.data(), b.size(), &scalar_out);
+    size_t simd_len = ArrayUtils::or_simd(a.data(), a.size(), b.data(), b.size(), &simd_out);
+
+    std::vector<uint32_t> expected = {0, 1, 2, 3, 4, 5, 8, 9, 10, 11};
+    ASSERT_EQ(expected.size(), scalar_len);
+    ASSERT_EQ(expected.size(), simd_len);
+
+    for(size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i], simd_out[i]);
+    }
+
+    delete [] scalar_out;
+    delete [] simd_out;
+}
+
+TEST(SortedArrayTest, SimdVariantsHandleNullInputs) {
+    std::vector<uint32_t> a = {1, 2, 3, 4, 5};
+    uint32_t* out = nullptr;
+
+    ASSERT_EQ(0, ArrayUtils::or_simd(nullptr, 0, nullptr, 0, &out));
+    ASSERT_EQ(nullptr, out);
+
+    ASSERT_EQ(5, ArrayUtils::or_simd(nullptr, 0, a.data(), a.size(), &out));
+    ASSERT_EQ(5, out[4]);
+    delete [] out;
+    out = nullptr;
+
+    ASSERT_EQ(0, ArrayUtils::exclude_simd(nullptr, 0, a.data(), a.size(), &out));
+    ASSERT_EQ(nullptr, out);
+
+    ASSERT_EQ(5, ArrayUtils::exclude_simd(a.data(), a.size(), nullptr, 0, &out));
+    ASSERT_EQ(1, out[0]);
+    delete [] out;
+    out = nullptr;
+
+    ASSERT_EQ(0, ArrayUtils::and_simd(a.data(), a.size(), nullptr, 0, &out));
+    ASSERT_EQ(nullptr, out);
+}
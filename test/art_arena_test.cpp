@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "art.h"
+#include "art_arena.h"
+#include "posting.h"
+
+TEST(ArtArenaTest, RecyclesFreedChunks) {
+    art_arena_t arena(2048);
+
+    std::vector<void*> chunks;
+    for(size_t i = 0; i < 1000; i++) {
+        void* chunk = arena.allocate(40);
+        memset(chunk, 0xff, 40);
+        chunks.push_back(chunk);
+    }
+
+    const size_t num_slabs = arena.num_slabs();
+    ASSERT_LT(0, num_slabs);
+
+    for(void* chunk: chunks) {
+        arena.deallocate(chunk, 40);
+    }
+
+    // chunks of the same size class are handed out again instead of growing the arena
+    for(size_t round = 0; round < 10; round++) {
+        for(size_t i = 0; i < chunks.size(); i++) {
+            chunks[i] = arena.allocate(33 + (i % 16));
+        }
+
+        for(size_t i = 0; i < chunks.size(); i++) {
+            arena.deallocate(chunks[i], 33 + (i % 16));
+        }
+    }
+
+    ASSERT_EQ(num_slabs, arena.num_slabs());
+
+    // larger chunks are not pooled
+    void* large_chunk = arena.allocate(4096);
+    memset(large_chunk, 0, 4096);
+    arena.deallocate(large_chunk, 4096);
+    ASSERT_EQ(num_slabs, arena.num_slabs());
+}
+
+TEST(ArtArenaTest, TreeChurn) {
+    art_tree t;
+    art_tree_init(&t);
+
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < 5000; i++) {
+        keys.push_back("key" + std::to_string(i * 7919 % 100003) + std::string(i % 40, 'x'));
+    }
+
+    for(size_t round = 0; round < 3; round++) {
+        for(size_t i = 0; i < keys.size(); i++) {
+            art_document doc(i, i, {0});
+            art_insert(&t, (const unsigned char*) keys[i].c_str(), keys[i].size() + 1, &doc);
+        }
+
+        ASSERT_EQ(keys.size(), art_size(&t));
+
+        // deleting every other key shrinks nodes back into smaller types
+        for(size_t i = 0; i < keys.size(); i += 2) {
+            void* values = art_delete(&t, (const unsigned char*) keys[i].c_str(), keys[i].size() + 1);
+            ASSERT_NE(nullptr, values);
+            posting_t::destroy_list(values);
+        }
+
+        for(size_t i = 0; i < keys.size(); i++) {
+            const bool found = art_search(&t, (const unsigned char*) keys[i].c_str(), keys[i].size() + 1) != nullptr;
+            ASSERT_EQ(i % 2 == 1, found);
+        }
+
+        for(size_t i = 1; i < keys.size(); i += 2) {
+            void* values = art_delete(&t, (const unsigned char*) keys[i].c_str(), keys[i].size() + 1);
+            ASSERT_NE(nullptr, values);
+            posting_t::destroy_list(values);
+        }
+
+        ASSERT_EQ(0, art_size(&t));
+    }
+
+    ASSERT_EQ(0, art_tree_destroy(&t));
+}
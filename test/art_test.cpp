@@ -7,6 +7,7 @@
 #include <art.h>
 #include <chrono>
 #include <posting.h>
+#include "filter_iterator.h"
 
 #define words_file_path std::string(std::string(ROOT_DIR)+"/build/test_resources/words.txt").c_str()
 #define uuid_file_path std::string(std::string(ROOT_DIR)+"/build/test_resources/uuid.txt").c_str()
@@ -1704,4 +1705,106 @@ TEST(ArtTest, test_encode_float_positive_negative) {
 
     res = art_tree_destroy(&t);
     ASSERT_TRUE(res == 0);
-}
\ No newline at end of file
+}
+
+TEST(ArtTest, test_art_fuzzy_search_nodes_lazy_filter) {
+    art_tree t;
+    art_tree_init(&t);
+
+    for(uint32_t i = 0; i < 50; i++) {
+        const std::string key = "apple" + std::to_string(i);
+        art_document doc = get_document(i);
+        art_insert(&t, (const unsigned char*) key.c_str(), key.size() + 1, &doc);
+    }
+
+    const int term_len = strlen("apple");
+    std::vector<const art_node*> nodes;
+    art_fuzzy_nodes(&t, (const unsigned char *) "apple", term_len, 0, 0, true, nodes);
+
+    // only the leaves with a filtered ID count towards `max_words`, however far down the ranking they are
+    std::vector<uint32_t> filter_ids = {3, 42, 47};
+    auto filter_ids_copy = new uint32_t[filter_ids.size()];
+    std::copy(filter_ids.begin(), filter_ids.end(), filter_ids_copy);
+    array_filter_iterator_t filter_iterator(filter_ids_copy, filter_ids.size());
+
+    std::vector<art_leaf*> leaves;
+    art_fuzzy_search_nodes(&t, nodes, (const unsigned char *) "apple", term_len, 0, 3, FREQUENCY, true,
+                           nullptr, 0, &filter_iterator, leaves);
+
+    std::vector<art_leaf*> array_leaves;
+    art_fuzzy_search_nodes(&t, nodes, (const unsigned char *) "apple", term_len, 0, 3, FREQUENCY, true,
+                           &filter_ids[0], filter_ids.size(), nullptr, array_leaves);
+
+    ASSERT_EQ(3, leaves.size());
+    ASSERT_EQ(array_leaves, leaves);
+
+    std::set<std::string> tokens;
+    for(auto leaf: leaves) {
+        tokens.emplace(reinterpret_cast<char*>(leaf->key), leaf->key_len - 1);
+    }
+
+    ASSERT_EQ(std::set<std::string>({"apple3", "apple42", "apple47"}), tokens);
+
+    // the exact match is dropped when none of its IDs are filtered
+    art_document doc = get_document(100);
+    art_insert(&t, (const unsigned char*) "apple", strlen("apple") + 1, &doc);
+
+    nodes.clear();
+    art_fuzzy_nodes(&t, (const unsigned char *) "apple", term_len + 1, 0, 0, false, nodes);
+
+    leaves.clear();
+    art_fuzzy_search_nodes(&t, nodes, (const unsigned char *) "apple", term_len + 1, 0, 10, FREQUENCY, false,
+                           nullptr, 0, &filter_iterator, leaves);
+    ASSERT_TRUE(leaves.empty());
+
+    int res = art_tree_destroy(&t);
+    ASSERT_TRUE(res == 0);
+}
+
+TEST(ArtTest, test_art_fuzzy_nodes_generation) {
+    art_tree t;
+    art_tree_init(&t);
+    ASSERT_EQ(0, t.generation);
+
+    const char* keys[] = {"apple", "apply", "applied", "ample", "maple"};
+    for(size_t i = 0; i < 5; i++) {
+        art_document doc = get_document(i);
+        art_insert(&t, (const unsigned char*) keys[i], strlen(keys[i]) + 1, &doc);
+    }
+
+    ASSERT_EQ(5, t.generation);
+
+    // adding a document to an existing key does not change the keys of the tree
+    art_document doc = get_document(10);
+    art_insert(&t, (const unsigned char*) "apple", strlen("apple") + 1, &doc);
+    ASSERT_EQ(5, t.generation);
+
+    // leaves picked from the collected nodes are the same as those of a direct fuzzy search
+    for(int cost = 0; cost <= 2; cost++) {
+        for(bool prefix: {false, true}) {
+            const int term_len = prefix ? strlen("appl") : strlen("appl") + 1;
+
+            std::vector<art_leaf*> leaves;
+            art_fuzzy_search(&t, (const unsigned char *) "appl", term_len, cost, cost, 10, FREQUENCY, prefix,
+                             nullptr, 0, leaves);
+
+            std::vector<const art_node*> nodes;
+            art_fuzzy_nodes(&t, (const unsigned char *) "appl", term_len, cost, cost, prefix, nodes);
+
+            std::vector<art_leaf*> node_leaves;
+            art_fuzzy_search_nodes(&t, nodes, (const unsigned char *) "appl", term_len, cost, 10, FREQUENCY, prefix,
+                                   nullptr, 0, nullptr, node_leaves);
+
+            ASSERT_EQ(leaves, node_leaves);
+        }
+    }
+
+    art_delete(&t, (const unsigned char*) "maple", strlen("maple") + 1);
+    ASSERT_EQ(6, t.generation);
+
+    art_delete(&t, (const unsigned char*) "missing", strlen("missing") + 1);
+    ASSERT_EQ(6, t.generation);
+
+    int res = art_tree_destroy(&t);
+    ASSERT_TRUE(res == 0);
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <map>
 #include <collection_manager.h>
 #include "collection.h"
 
@@ -73,7 +74,7 @@ TEST_F(CollectionFacetingTest, FacetCounts) {
     ASSERT_EQ(5, results["hits"].size());
 
     ASSERT_EQ(1, results["facet_counts"].size());
-    ASSERT_EQ(3, results["facet_counts"][0].size());
+    ASSERT_EQ(4, results["facet_counts"][0].size());
     ASSERT_EQ("tags", results["facet_counts"][0]["field_name"]);
     ASSERT_EQ(4, results["facet_counts"][0]["counts"].size());
     ASSERT_EQ(1, results["facet_counts"][0]["stats"].size());
@@ -938,3 +939,347 @@ TEST_F(CollectionFacetingTest, FacetArrayValuesShouldBeNormalized) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionFacetingTest, FacetCountsOverLargeResultSets) {
+    std::vector<field> fields = {field("category", field_types::STRING, true),
+                                 field("tags", field_types::STRING_ARRAY, true),
+                                 field("rank", field_types::INT32, true),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    // large enough for the results to be counted in several windows
+    const size_t num_docs = 10000;
+    std::vector<std::string> json_lines;
+
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["category"] = "cat" + std::to_string(i % 7);
+        doc["tags"] = {"t" + std::to_string(i % 3), "t" + std::to_string(3 + i % 5)};
+        doc["rank"] = int32_t(i % 4);
+        doc["points"] = int32_t(i);
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    ASSERT_TRUE(coll1->add_many(json_lines, document)["success"].get<bool>());
+
+    auto results = coll1->search("*", {}, "", {"category", "tags", "rank"}, {}, {0}, 10, 1, FREQUENCY,
+                                 {false}, Index::DROP_TOKENS_THRESHOLD,
+                                 spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 20).get();
+
+    ASSERT_EQ(num_docs, results["found"].get<size_t>());
+    ASSERT_EQ(3, results["facet_counts"].size());
+
+    std::vector<std::map<std::string, size_t>> value_counts(3);
+    for(size_t i = 0; i < 3; i++) {
+        for(const auto& count: results["facet_counts"][i]["counts"]) {
+            value_counts[i][count["value"].get<std::string>()] = count["count"].get<size_t>();
+        }
+    }
+
+    std::map<std::string, size_t> expected_categories = {{"cat0", 1429}, {"cat1", 1429}, {"cat2", 1429},
+                                                         {"cat3", 1429}, {"cat4", 1428}, {"cat5", 1428},
+                                                         {"cat6", 1428}};
+    std::map<std::string, size_t> expected_tags = {{"t0", 3334}, {"t1", 3333}, {"t2", 3333}, {"t3", 2000},
+                                                   {"t4", 2000}, {"t5", 2000}, {"t6", 2000}, {"t7", 2000}};
+    std::map<std::string, size_t> expected_ranks = {{"0", 2500}, {"1", 2500}, {"2", 2500}, {"3", 2500}};
+
+    ASSERT_EQ(expected_categories, value_counts[0]);
+    ASSERT_EQ(expected_tags, value_counts[1]);
+    ASSERT_EQ(expected_ranks, value_counts[2]);
+
+    ASSERT_EQ(4, results["facet_counts"][2]["stats"]["total_values"].get<size_t>());
+    ASSERT_FLOAT_EQ(1.5, results["facet_counts"][2]["stats"]["avg"].get<double>());
+    ASSERT_FLOAT_EQ(0, results["facet_counts"][2]["stats"]["min"].get<double>());
+    ASSERT_FLOAT_EQ(3, results["facet_counts"][2]["stats"]["max"].get<double>());
+
+    // when grouping, every rank occurs in all the categories
+    results = coll1->search("*", {}, "", {"rank"}, {}, {0}, 10, 1, FREQUENCY,
+                            {false}, Index::DROP_TOKENS_THRESHOLD,
+                            spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                            "", 10,
+                            {}, {}, {"category"}, 1).get();
+
+    ASSERT_EQ(4, results["facet_counts"][0]["counts"].size());
+    for(const auto& count: results["facet_counts"][0]["counts"]) {
+        ASSERT_EQ(7, count["count"].get<size_t>());
+    }
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, SampledFacetCounts) {
+    std::vector<field> fields = {field("category", field_types::STRING, true),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    const size_t num_docs = 10000;
+    std::vector<std::string> json_lines;
+
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["category"] = (i % 4 == 0) ? "shoes" : "shirts";
+        doc["points"] = int32_t(i);
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    ASSERT_TRUE(coll1->add_many(json_lines, document)["success"].get<bool>());
+
+    auto search = [&](size_t facet_sample_percent, size_t facet_sample_threshold) {
+        return coll1->search("*", {}, "", {"category"}, {}, {0}, 10, 1, FREQUENCY, {false},
+                             10, spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000*1000, 4,
+                             7, fallback, 4, {off}, INT16_MAX, INT16_MAX, 2, 2, false, false,
+                             facet_sample_percent, facet_sample_threshold);
+    };
+
+    // results beyond the threshold are sampled and their counts extrapolated
+    auto results = search(10, 1000).get();
+    ASSERT_EQ(num_docs, results["found"].get<size_t>());
+    ASSERT_TRUE(results["facet_counts"][0]["sampled"].get<bool>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+
+    ASSERT_EQ("shirts", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+    ASSERT_NEAR(7500, results["facet_counts"][0]["counts"][0]["count"].get<size_t>(), 750);
+    ASSERT_EQ("shoes", results["facet_counts"][0]["counts"][1]["value"].get<std::string>());
+    ASSERT_NEAR(2500, results["facet_counts"][0]["counts"][1]["count"].get<size_t>(), 500);
+
+    // the sample is deterministic
+    ASSERT_EQ(results["facet_counts"], search(10, 1000).get()["facet_counts"]);
+
+    // results within the threshold are counted exactly
+    results = search(10, num_docs).get();
+    ASSERT_FALSE(results["facet_counts"][0]["sampled"].get<bool>());
+    ASSERT_EQ(7500, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ(2500, results["facet_counts"][0]["counts"][1]["count"].get<size_t>());
+
+    results = search(100, 0).get();
+    ASSERT_FALSE(results["facet_counts"][0]["sampled"].get<bool>());
+    ASSERT_EQ(7500, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+
+    auto res_op = search(0, 0);
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Value of `facet_sample_percent` must be between 1 and 100.", res_op.error());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, CachedWildcardFacetCountsFollowWrites) {
+    std::vector<field> fields = {field("category", field_types::STRING, true),
+                                 field("brand", field_types::STRING, true),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    std::vector<std::vector<std::string>> records = {
+        {"shoes", "nike"}, {"shoes", "adidas"}, {"shoes", "nike"}, {"shirts", "nike"}, {"shirts", "puma"},
+    };
+
+    for(size_t i = 0; i < records.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["category"] = records[i][0];
+        doc["brand"] = records[i][1];
+        doc["points"] = int32_t(i);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto brand_counts = [&](const std::string& filter_query) {
+        auto results = coll1->search("*", {}, filter_query, {"brand"}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+        std::map<std::string, size_t> counts;
+        for(const auto& count: results["facet_counts"][0]["counts"]) {
+            counts[count["value"].get<std::string>()] = count["count"].get<size_t>();
+        }
+        return counts;
+    };
+
+    std::map<std::string, size_t> expected = {{"nike", 2}, {"adidas", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+
+    // filters are normalized, but different filters are never confused
+    ASSERT_EQ(brand_counts("category: shoes && points:>0"), brand_counts("points:>0 && category: shoes"));
+    expected = {{"nike", 1}, {"adidas", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes && points:>0"));
+
+    // the bounds of different ranges are not mixed up
+    expected = {{"nike", 3}, {"adidas", 1}, {"puma", 1}};
+    ASSERT_EQ(expected, brand_counts("points:[0..4,1..3]"));
+    expected = {{"nike", 2}, {"adidas", 1}, {"puma", 1}};
+    ASSERT_EQ(expected, brand_counts("points:[0..1,3..4]"));
+
+    // writes are reflected in subsequent searches
+    nlohmann::json doc;
+    doc["id"] = "5";
+    doc["category"] = "shoes";
+    doc["brand"] = "puma";
+    doc["points"] = 5;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    expected = {{"nike", 2}, {"adidas", 1}, {"puma", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+
+    ASSERT_TRUE(coll1->remove("0").ok());
+    expected = {{"nike", 1}, {"adidas", 1}, {"puma", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+
+    doc["brand"] = "adidas";
+    ASSERT_TRUE(coll1->add(doc.dump(), UPSERT).ok());
+    expected = {{"nike", 1}, {"adidas", 2}};
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+
+    // a partial update invalidates only the counts that facet or filter on the updated fields
+    expected = {{"nike", 1}, {"adidas", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes && points:>1"));
+
+    nlohmann::json partial_doc;
+    partial_doc["id"] = "2";
+    partial_doc["points"] = 0;
+    ASSERT_TRUE(coll1->add(partial_doc.dump(), UPDATE).ok());
+
+    expected = {{"adidas", 1}};
+    ASSERT_EQ(expected, brand_counts("category: shoes && points:>1"));
+    expected = {{"nike", 1}, {"adidas", 2}};
+    ASSERT_EQ(expected, brand_counts("category: shoes"));
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, NumericRangeFacets) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("price", field_types::INT32, true),
+                                 field("rating", field_types::FLOAT, true),
+                                 field("tags", field_types::INT32_ARRAY, true),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    std::vector<std::pair<int32_t, float>> records = {
+        {5, 1.5}, {10, 2.5}, {25, 3.5}, {49, 4.0}, {50, 4.5}, {120, 5.0},
+    };
+
+    for(size_t i = 0; i < records.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["price"] = records[i].first;
+        doc["rating"] = records[i].second;
+        doc["tags"] = {1, 2};
+        doc["points"] = 0;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto search = [&](const std::vector<std::string>& facet_fields) {
+        return coll1->search("*", {}, "", facet_fields, {}, {0}, 10, 1, FREQUENCY, {false});
+    };
+
+    // ranges are half-open and returned in the requested order, including the empty ones
+    auto results = search({"price(0-10,10-50, 50-, 200-300)"}).get();
+    ASSERT_EQ(1, results["facet_counts"].size());
+    ASSERT_EQ("price", results["facet_counts"][0]["field_name"].get<std::string>());
+    ASSERT_EQ(4, results["facet_counts"][0]["counts"].size());
+
+    std::vector<std::pair<std::string, size_t>> expected_counts = {{"0-10", 1}, {"10-50", 3}, {"50-", 2},
+                                                                   {"200-300", 0}};
+
+    for(size_t i = 0; i < expected_counts.size(); i++) {
+        ASSERT_EQ(expected_counts[i].first, results["facet_counts"][0]["counts"][i]["value"].get<std::string>());
+        ASSERT_EQ(expected_counts[i].second, results["facet_counts"][0]["counts"][i]["count"].get<size_t>());
+    }
+
+    ASSERT_FLOAT_EQ(5, results["facet_counts"][0]["stats"]["min"].get<double>());
+    ASSERT_FLOAT_EQ(120, results["facet_counts"][0]["stats"]["max"].get<double>());
+    ASSERT_FLOAT_EQ(259, results["facet_counts"][0]["stats"]["sum"].get<double>());
+    ASSERT_EQ(3, results["facet_counts"][0]["stats"]["total_values"].get<size_t>());
+
+    // open lower bound and float bounds, alongside a regular facet field
+    results = search({"rating(-3,3-4.5,4.5-)", "price"}).get();
+    ASSERT_EQ(2, results["facet_counts"].size());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][1]["count"].get<size_t>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][2]["count"].get<size_t>());
+    ASSERT_FLOAT_EQ(1.5, results["facet_counts"][0]["stats"]["min"].get<double>());
+    ASSERT_FLOAT_EQ(5.0, results["facet_counts"][0]["stats"]["max"].get<double>());
+    ASSERT_EQ(6, results["facet_counts"][1]["counts"].size());
+
+    // counts follow the filter
+    results = coll1->search("*", {}, "price:>=25", {"price(0-10,10-50,50-)"}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(0, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][1]["count"].get<size_t>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][2]["count"].get<size_t>());
+
+    auto res_op = search({"tags(0-10)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Range facet field `tags` must be a sortable, non-array numerical field.", res_op.error());
+
+    res_op = search({"price(0-10,abc)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet range `abc` must be in the `lower-upper` format.", res_op.error());
+
+    res_op = search({"price(a-10)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet range `a-10` must be in the `lower-upper` format.", res_op.error());
+
+    res_op = search({"price(1.5-10)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet range `1.5-10` must have numerical bounds.", res_op.error());
+
+    res_op = search({"price(10-5)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet range `10-5` must have a lower bound that is less than its upper bound.", res_op.error());
+
+    res_op = search({"title(0-10)"});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ(404, res_op.code());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, SelectTopFacetCounts) {
+    facet a_facet("brand");
+
+    for(uint64_t hash = 0; hash < 10000; hash++) {
+        facet_count_t facet_count;
+        facet_count.count = (hash % 100 == 0) ? uint32_t(hash / 100 + 1000) : uint32_t(hash % 7);
+        facet_count.doc_id = uint32_t(hash);
+        a_facet.result_map.emplace(hash, facet_count);
+    }
+
+    std::vector<std::pair<uint64_t, facet_count_t>> top_facet_counts;
+    Collection::select_top_facet_counts(a_facet, 3, top_facet_counts);
+
+    ASSERT_EQ(3, top_facet_counts.size());
+    ASSERT_EQ(9900, top_facet_counts[0].first);
+    ASSERT_EQ(1099, top_facet_counts[0].second.count);
+    ASSERT_EQ(9800, top_facet_counts[1].first);
+    ASSERT_EQ(9700, top_facet_counts[2].first);
+
+    // ties are broken on the hash, so the selection is deterministic
+    a_facet.result_map.clear();
+
+    for(uint64_t hash = 0; hash < 100; hash++) {
+        facet_count_t facet_count;
+        facet_count.count = 5;
+        a_facet.result_map.emplace(hash, facet_count);
+    }
+
+    Collection::select_top_facet_counts(a_facet, 2, top_facet_counts);
+    ASSERT_EQ(2, top_facet_counts.size());
+    ASSERT_EQ(99, top_facet_counts[0].first);
+    ASSERT_EQ(98, top_facet_counts[1].first);
+
+    Collection::select_top_facet_counts(a_facet, 1000, top_facet_counts);
+    ASSERT_EQ(100, top_facet_counts.size());
+
+    Collection::select_top_facet_counts(a_facet, 0, top_facet_counts);
+    ASSERT_TRUE(top_facet_counts.empty());
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <thread>
 #include <collection_manager.h>
 #include "collection.h"
 
@@ -355,9 +356,7 @@ TEST_F(CollectionInfixSearchTest, InfixDeleteAndUpdate) {
 
     coll1->remove("0");
 
-    for(size_t i = 0; i < coll1->_get_index()->_get_infix_index().at("title").size(); i++) {
-        ASSERT_EQ(0, coll1->_get_index()->_get_infix_index().at("title").at(i)->size());
-    }
+    ASSERT_EQ(0, coll1->_get_index()->_get_infix_index().at("title")->size());
 
     results = coll1->search("100037",
                         {"title"}, "", {}, {}, {0}, 3, 1, FREQUENCY, {true}, 5,
@@ -406,16 +405,12 @@ TEST_F(CollectionInfixSearchTest, InfixDeleteAndUpdate) {
     ASSERT_EQ(0, results["found"].get<size_t>());
     ASSERT_EQ(0, results["hits"].size());
 
-    std::string key = "yhd3342d78912";
-    auto strhash = StringUtils::hash_wy(key.c_str(), key.size());
-    const auto& infix_sets = coll1->_get_index()->_get_infix_index().at("title");
-    ASSERT_EQ(1, infix_sets[strhash % 4]->size());
+    std::vector<std::string> infix_tokens;
+    const infix_index_t* infix_index = coll1->_get_index()->_get_infix_index().at("title");
+    infix_index->search("3342", INT16_MAX, INT16_MAX, infix_tokens);
 
-    for(size_t i = 0; i < infix_sets.size(); i++) {
-        if(i != strhash % 4) {
-            ASSERT_EQ(0, infix_sets[i]->size());
-        }
-    }
+    ASSERT_EQ(1, infix_index->size());
+    ASSERT_EQ(std::vector<std::string>({"yhd3342d78912"}), infix_tokens);
 
     collectionManager.drop_collection("coll1");
 }
@@ -452,3 +447,71 @@ TEST_F(CollectionInfixSearchTest, MultiFielInfixSearch) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionInfixSearchTest, SealedInfixIndex) {
+    std::string coll_schema = R"(
+        {
+            "name": "coll1",
+            "fields": [
+              {"name": "mpn", "type": "string", "infix": "fm" },
+              {"name": "points", "type": "int32" }
+            ]
+        }
+    )";
+
+    nlohmann::json schema = nlohmann::json::parse(coll_schema);
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+    ASSERT_EQ("fm", coll1->get_summary_json()["fields"][0]["infix"].get<std::string>());
+
+    const infix_index_t* infix_index = coll1->_get_index()->_get_infix_index().at("mpn");
+    ASSERT_TRUE(infix_index->is_sealable());
+
+    const size_t num_docs = infix_index_t::MIN_DELTA_TOKENS_TO_SEAL * 2;
+    std::vector<std::string> json_lines;
+
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["mpn"] = "GH" + std::to_string(100000 + i) + "X";
+        doc["points"] = 0;
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json import_response;
+    ASSERT_TRUE(coll1->add_many(json_lines, import_response)["success"].get<bool>());
+
+    auto search = [&](const std::string& query) {
+        return coll1->search(query, {"mpn"}, "", {}, {}, {0}, 3, 1, FREQUENCY, {true}, 5,
+                             spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                             4, {always}).get();
+    };
+
+    ASSERT_EQ(10, search("10150").at("found").get<size_t>());
+
+    // the delta is sealed in the background, and picked up by a later write
+    for(size_t i = 0; i < 500 && infix_index->delta_size() >= infix_index_t::MIN_DELTA_TOKENS_TO_SEAL; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(num_docs + i);
+        doc["mpn"] = "ZZ" + std::to_string(i);
+        doc["points"] = 0;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    ASSERT_LT(infix_index->delta_size(), infix_index_t::MIN_DELTA_TOKENS_TO_SEAL);
+    ASSERT_EQ(10, search("10150").at("found").get<size_t>());
+    ASSERT_EQ(1, search("101999").at("found").get<size_t>());
+
+    ASSERT_TRUE(coll1->remove("1500").ok());
+    ASSERT_EQ(9, search("10150").at("found").get<size_t>());
+
+    collectionManager.drop_collection("coll1");
+
+    schema["fields"][0]["infix"] = "trigram";
+    auto create_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(create_op.ok());
+    ASSERT_EQ("The `infix` property of the field `mpn` should be a boolean or `fm`.", create_op.error());
+}
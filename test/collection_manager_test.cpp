@@ -323,6 +323,118 @@ TEST_F(CollectionManagerTest, RestoreRecordsOnRestart) {
     ASSERT_EQ(4, results["hits"].size());
 }
 
+TEST_F(CollectionManagerTest, RestoreFromIndexImage) {
+    std::ifstream infile(std::string(ROOT_DIR)+"test/multi_field_documents.jsonl");
+    std::string json_line;
+
+    while (std::getline(infile, json_line)) {
+        nlohmann::json doc = nlohmann::json::parse(json_line);
+        doc["release_year"] = 1990 + doc["points"].get<int>() % 30;
+        doc["location"] = {48.85 + doc["points"].get<int>() * 0.01, 2.34};
+        ASSERT_TRUE(collection1->add(doc.dump()).ok());
+    }
+
+    infile.close();
+    ASSERT_TRUE(collection1->remove("3").ok());
+
+    std::vector<std::string> query_fields = {"starring", "title"};
+    std::vector<std::string> facets = {"cast", "release_year"};
+
+    auto search = [&]() {
+        return collection1->search("will", query_fields, "points:>10 && location:(48.90, 2.34, 100 km)", facets,
+                                   sort_fields, {0}, 10, 1, FREQUENCY, {false}).get();
+    };
+
+    nlohmann::json results = search();
+    ASSERT_LT(0, results["found"].get<size_t>());
+
+    auto infix_results = collection1->search("arrell", {"starring"}, "", {}, sort_fields, {0}, 10, 1, FREQUENCY,
+                                             {false}, 0, spp::sparse_hash_set<std::string>(),
+                                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 40, {}, {}, {},
+                                             0, "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000*1000,
+                                             4, 7, fallback, 4, {always}).get();
+    ASSERT_LT(0, infix_results["found"].get<size_t>());
+
+    const std::string image_dir = "/tmp/typesense_test/coll_manager_test_images";
+    system(("rm -rf "+image_dir+" && mkdir -p "+image_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_index_images(image_dir).ok());
+
+    const std::string image_path = CollectionManager::get_index_image_path(image_dir, 0);
+
+    // restoring into a fresh collection does not need the stored documents
+    std::string meta_json;
+    ASSERT_EQ(StoreStatus::FOUND, store->get(Collection::get_meta_key("collection1"), meta_json));
+
+    Collection* restored = CollectionManager::init_collection(nlohmann::json::parse(meta_json),
+                                                              collection1->get_next_seq_id(), store, 1.0f);
+    ASSERT_TRUE(restored->load_index_image(image_path, store->get_latest_seq_number()).ok());
+    ASSERT_EQ(collection1->get_num_documents(), restored->get_num_documents());
+    delete restored;
+
+    // an image written at another sequence number is rejected and leaves the collection empty
+    restored = CollectionManager::init_collection(nlohmann::json::parse(meta_json),
+                                                  collection1->get_next_seq_id(), store, 1.0f);
+    auto stale_op = restored->load_index_image(image_path, store->get_latest_seq_number() + 1);
+    ASSERT_FALSE(stale_op.ok());
+    ASSERT_EQ(409, stale_op.code());
+    ASSERT_EQ(0, restored->get_num_documents());
+    delete restored;
+
+    // restart with the image
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/coll_manager_test_db");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    ASSERT_TRUE(collectionManager.load(8, 1000, image_dir).ok());
+
+    collection1 = collectionManager.get_collection("collection1").get();
+    ASSERT_EQ(16, collection1->get_num_documents());
+    ASSERT_EQ(results["found"], search()["found"]);
+    ASSERT_EQ(results["hits"], search()["hits"]);
+    ASSERT_EQ(results["facet_counts"], search()["facet_counts"]);
+
+    auto restored_infix_results = collection1->search("arrell", {"starring"}, "", {}, sort_fields, {0}, 10, 1,
+                                                      FREQUENCY, {false}, 0, spp::sparse_hash_set<std::string>(),
+                                                      spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 40,
+                                                      {}, {}, {}, 0, "<mark>", "</mark>", {}, 1000, true, false,
+                                                      true, "", false, 6000*1000, 4, 7, fallback, 4,
+                                                      {always}).get();
+    ASSERT_EQ(infix_results["found"], restored_infix_results["found"]);
+
+    // a corrupted image falls back to indexing the stored documents
+    std::fstream image_file(image_path, std::ios::in | std::ios::out | std::ios::binary);
+    image_file.seekp(64);
+    image_file.put(char(0xFF));
+    image_file.close();
+
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/coll_manager_test_db");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    ASSERT_TRUE(collectionManager.load(8, 1000, image_dir).ok());
+
+    collection1 = collectionManager.get_collection("collection1").get();
+    ASSERT_EQ(16, collection1->get_num_documents());
+    ASSERT_EQ(results["hits"], search()["hits"]);
+
+    // images are written as of the captured write generations, leaving out the collections written to since
+    const uint64_t store_seq_number = store->get_latest_seq_number();
+    auto write_generations = collectionManager.get_index_write_generations();
+    ASSERT_EQ(1, write_generations.size());
+
+    system(("rm -rf "+image_dir+" && mkdir -p "+image_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_index_images(image_dir, store_seq_number, write_generations).ok());
+    ASSERT_TRUE(std::ifstream(image_path).good());
+
+    ASSERT_TRUE(collection1->remove("4").ok());
+
+    system(("rm -rf "+image_dir+" && mkdir -p "+image_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_index_images(image_dir, store_seq_number, write_generations).ok());
+    ASSERT_FALSE(std::ifstream(image_path).good());
+}
+
 TEST_F(CollectionManagerTest, VerifyEmbeddedParametersOfScopedAPIKey) {
     std::vector<field> fields = {field("title", field_types::STRING, false, false, true, "", -1, 1),
                                  field("year", field_types::INT32, false),
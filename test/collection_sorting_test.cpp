@@ -1778,3 +1778,134 @@ TEST_F(CollectionSortingTest, IntegerFloatAndBoolShouldDefaultSortTrue) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionSortingTest, MaxScorePruningDoesNotChangeResults) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    // more documents than the topster can hold, so that the threshold kicks in
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i % 3 == 0) ? "the quick brown fox" : ((i % 3 == 1) ? "quick fox" : "fox quick brown");
+        doc["points"] = (i * 7919) % 1000;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<std::vector<sort_by>> sort_fields_list = {
+        {sort_by("_text_match", "DESC"), sort_by("points", "DESC")},
+        {sort_by("points", "DESC"), sort_by("_text_match", "DESC")},
+        {sort_by("points", "ASC")},
+    };
+
+    for(const auto& sort_fields_variant: sort_fields_list) {
+        for(const std::string& query: {"quick fox", "fox"}) {
+            nlohmann::json results[2];
+
+            for(size_t i = 0; i < 2; i++) {
+                results[i] = coll1->search(query, {"title"}, "", {}, sort_fields_variant, {2}, 10, 1, FREQUENCY, {true},
+                                           10, spp::sparse_hash_set<std::string>(),
+                                           spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                                           "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000*1000, 4,
+                                           7, fallback, 4, {off}, INT16_MAX, INT16_MAX, 2, 2, false,
+                                           (i == 1)).get();
+            }
+
+            ASSERT_EQ(1000, results[1]["found"].get<size_t>());
+            ASSERT_EQ(results[0]["found"].get<size_t>(), results[1]["found"].get<size_t>());
+            ASSERT_EQ(10, results[1]["hits"].size());
+
+            for(size_t j = 0; j < results[0]["hits"].size(); j++) {
+                ASSERT_EQ(results[0]["hits"][j]["document"]["id"], results[1]["hits"][j]["document"]["id"]);
+                ASSERT_EQ(results[0]["hits"][j]["text_match"], results[1]["hits"][j]["text_match"]);
+            }
+        }
+    }
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSortingTest, MaxScorePruningSkipsBlocks) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    // only the first documents can be verbatim matches, so the later blocks can't beat the top-K threshold
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i < 100) ? "fox" : "fox jumps over";
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<sort_by> sort_fields = {sort_by("_text_match", "DESC"), sort_by("points", "DESC")};
+    nlohmann::json results[2];
+
+    for(size_t i = 0; i < 2; i++) {
+        results[i] = coll1->search("fox", {"title"}, "", {}, sort_fields, {0}, 10, 1, FREQUENCY, {false},
+                                   10, spp::sparse_hash_set<std::string>(),
+                                   spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                                   "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000*1000, 4,
+                                   7, fallback, 4, {off}, INT16_MAX, INT16_MAX, 2, 2, false,
+                                   (i == 1)).get();
+    }
+
+    ASSERT_EQ(0, results[0].count("found_is_estimate"));
+    ASSERT_TRUE(results[1]["found_is_estimate"].get<bool>());
+
+    // a single token in a single field: the skipped blocks are counted exactly
+    ASSERT_EQ(1000, results[0]["found"].get<size_t>());
+    ASSERT_EQ(1000, results[1]["found"].get<size_t>());
+
+    ASSERT_EQ(10, results[1]["hits"].size());
+    for(size_t j = 0; j < results[0]["hits"].size(); j++) {
+        ASSERT_EQ(results[0]["hits"][j]["document"]["id"], results[1]["hits"][j]["document"]["id"]);
+    }
+
+    ASSERT_EQ("99", results[1]["hits"][0]["document"]["id"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSortingTest, MaxScorePruningKeepsFacetCountsExact) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("tag", field_types::STRING, true),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i < 100) ? "fox" : "fox jumps over";
+        doc["tag"] = (i < 100) ? "short" : "long";
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<sort_by> sort_fields = {sort_by("_text_match", "DESC"), sort_by("points", "DESC")};
+
+    // blocks are not skipped when facets are counted, so that the facet counts cover every match
+    auto results = coll1->search("fox", {"title"}, "", {"tag"}, sort_fields, {0}, 10, 1, FREQUENCY, {false},
+                                 10, spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000*1000, 4,
+                                 7, fallback, 4, {off}, INT16_MAX, INT16_MAX, 2, 2, false, true).get();
+
+    ASSERT_FALSE(results["found_is_estimate"].get<bool>());
+    ASSERT_EQ(1000, results["found"].get<size_t>());
+    ASSERT_EQ("99", results["hits"][0]["document"]["id"].get<std::string>());
+
+    ASSERT_EQ(1, results["facet_counts"].size());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ("long", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+    ASSERT_EQ(900, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ("short", results["facet_counts"][0]["counts"][1]["value"].get<std::string>());
+    ASSERT_EQ(100, results["facet_counts"][0]["counts"][1]["count"].get<size_t>());
+
+    collectionManager.drop_collection("coll1");
+}
@@ -723,3 +723,130 @@ TEST_F(CollectionSpecificMoreTest, OrderWithThreeSortFields) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionSpecificMoreTest, BinaryDocumentFormat) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("brand", field_types::STRING, true),
+                                 field("points", field_types::INT32, false),};
+
+    auto create_op = collectionManager.create_collection("coll1", 1, fields, "points", 0, "", {}, {}, "binary");
+    ASSERT_TRUE(create_op.ok());
+    Collection* coll1 = create_op.get();
+    ASSERT_EQ("binary", coll1->get_summary_json()["document_format"]);
+
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Running shoes " + std::to_string(i);
+        doc["brand"] = (i % 2 == 0) ? "Nike" : "Adidas";
+        doc["points"] = i;
+        doc["description"] = "not indexed";
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::string stored_doc;
+    ASSERT_EQ(StoreStatus::FOUND, store->get(coll1->get_seq_id_collection_prefix() + "_" +
+                                             StringUtils::serialize_uint32_t(0), stored_doc));
+    ASSERT_TRUE(DocumentCodec::is_binary(stored_doc));
+
+    auto results = coll1->search("shoes", {"title"}, "", {"brand"}, {}, {0}, 10, 1, FREQUENCY, {true}, 0,
+                                 {"title", "points"}).get();
+
+    ASSERT_EQ(10, results["found"].get<size_t>());
+    ASSERT_EQ(2, results["hits"][0]["document"].size());
+    ASSERT_EQ(9, results["hits"][0]["document"]["points"].get<int>());
+    ASSERT_EQ("Running <mark>shoes</mark> 9", results["hits"][0]["highlights"][0]["snippet"].get<std::string>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+
+    // update merges into the stored binary document
+    nlohmann::json update_doc;
+    update_doc["id"] = "3";
+    update_doc["points"] = 100;
+    ASSERT_TRUE(coll1->add(update_doc.dump(), UPDATE).ok());
+
+    auto doc_op = coll1->get("3");
+    ASSERT_TRUE(doc_op.ok());
+    ASSERT_EQ(100, doc_op.get()["points"].get<int>());
+    ASSERT_EQ("not indexed", doc_op.get()["description"].get<std::string>());
+
+    // switching the format migrates the stored documents
+    nlohmann::json alter_payload;
+    alter_payload["document_format"] = "json";
+    ASSERT_TRUE(coll1->alter(alter_payload).ok());
+
+    ASSERT_EQ(StoreStatus::FOUND, store->get(coll1->get_seq_id_collection_prefix() + "_" +
+                                             StringUtils::serialize_uint32_t(0), stored_doc));
+    ASSERT_FALSE(DocumentCodec::is_binary(stored_doc));
+    ASSERT_EQ(100, coll1->get("3").get()["points"].get<int>());
+
+    alter_payload["document_format"] = "xml";
+    ASSERT_FALSE(coll1->alter(alter_payload).ok());
+
+    // format survives a restart
+    alter_payload["document_format"] = "binary";
+    ASSERT_TRUE(coll1->alter(alter_payload).ok());
+
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_specific_more");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    collectionManager.load(8, 1000);
+
+    coll1 = collectionManager.get_collection("coll1").get();
+    ASSERT_EQ(document_format_t::BINARY, coll1->get_document_format());
+    ASSERT_EQ(10, coll1->get_num_documents());
+    ASSERT_EQ(100, coll1->get("3").get()["points"].get<int>());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSpecificMoreTest, SearchesProgressDuringLargeImports) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("tags", field_types::STRING_ARRAY, true),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    const size_t num_docs = 1000;
+    const size_t apply_batch_size = 100;
+
+    std::vector<std::string> json_lines;
+
+    for(size_t id = 0; id < num_docs; id++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(id);
+        doc["title"] = "the quick brown fox number " + std::to_string(id);
+        doc["tags"] = {"tag" + std::to_string(id % 10), "tag" + std::to_string(id % 7)};
+        doc["points"] = int32_t(id);
+        json_lines.push_back(doc.dump());
+    }
+
+    // searches from in between two slices of the batch, while the exclusive lock is released
+    std::vector<size_t> num_applied_docs;
+    std::vector<size_t> num_found_docs;
+
+    coll1->_set_apply_slice_hook([&](size_t num_applied) {
+        auto res_op = coll1->search("fox", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false});
+        num_applied_docs.push_back(num_applied);
+        num_found_docs.push_back(res_op.ok() ? res_op.get()["found"].get<size_t>() : 0);
+    });
+
+    nlohmann::json document;
+    auto res = coll1->add_many(json_lines, document, CREATE, "", DIRTY_VALUES::COERCE_OR_REJECT, false, false,
+                               apply_batch_size);
+    coll1->_set_apply_slice_hook(nullptr);
+
+    ASSERT_TRUE(res["success"].get<bool>());
+    ASSERT_EQ(num_docs, res["num_imported"].get<size_t>());
+
+    // every slice is visible as soon as it is applied, along with the slices before it, but not the ones after it
+    ASSERT_EQ(num_docs / apply_batch_size, num_found_docs.size());
+
+    for(size_t i = 0; i < num_found_docs.size(); i++) {
+        ASSERT_EQ((i + 1) * apply_batch_size, num_applied_docs[i]);
+        ASSERT_EQ((i + 1) * apply_batch_size, num_found_docs[i]);
+    }
+
+    collectionManager.drop_collection("coll1");
+}
@@ -2916,3 +2916,43 @@ TEST_F(CollectionSpecificTest, DontHighlightPunctuation) {
     collectionManager.drop_collection("coll1");
 }
 
+TEST_F(CollectionSpecificTest, CachedTokenExpansionsFollowWrites) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["title"] = "Strawberry jam";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    auto results = coll1->search("strawbery", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(1, results["hits"].size());
+
+    // the same expansions are served again, until a write adds or removes a token
+    results = coll1->search("strawbery", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(1, results["hits"].size());
+
+    doc["id"] = "1";
+    doc["title"] = "Strawberries and cream";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    results = coll1->search("strawbery", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(2, results["hits"].size());
+
+    ASSERT_TRUE(coll1->remove("0").ok());
+    ASSERT_TRUE(coll1->remove("1").ok());
+
+    results = coll1->search("strawbery", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(0, results["hits"].size());
+
+    doc["id"] = "2";
+    doc["title"] = "Strawberry tart";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    results = coll1->search("strawbery", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {true}, 1).get();
+    ASSERT_EQ(1, results["hits"].size());
+    ASSERT_EQ("2", results["hits"][0]["document"]["id"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "document_codec.h"
+
+TEST(DocumentCodecTest, BinaryRoundTrip) {
+    nlohmann::json document;
+    document["id"] = "124";
+    document["title"] = "The quick brown fox";
+    document["tags"] = {"alpha", "beta"};
+    document["points"] = -42;
+    document["big"] = int64_t(1) << 40;
+    document["price"] = 12.5;
+    document["in_stock"] = true;
+    document["location"] = {48.85, 2.35};
+    document["nested"] = {{"a", 1}, {"b", {1, 2, 3}}};
+    document["empty"] = nlohmann::json::object();
+    document["nothing"] = nullptr;
+
+    std::string serialized;
+    DocumentCodec::encode(document, document_format_t::BINARY, serialized);
+    ASSERT_TRUE(DocumentCodec::is_binary(serialized));
+
+    nlohmann::json decoded;
+    ASSERT_TRUE(DocumentCodec::decode(serialized, decoded).ok());
+    ASSERT_EQ(document, decoded);
+
+    std::string json_str;
+    ASSERT_TRUE(DocumentCodec::to_json_string(serialized, json_str).ok());
+    ASSERT_EQ(document, nlohmann::json::parse(json_str));
+
+    // an empty document
+    DocumentCodec::encode(nlohmann::json::object(), document_format_t::BINARY, serialized);
+    ASSERT_TRUE(DocumentCodec::decode(serialized, decoded).ok());
+    ASSERT_EQ(nlohmann::json::object(), decoded);
+}
+
+TEST(DocumentCodecTest, PartialDecode) {
+    nlohmann::json document;
+    document["id"] = "0";
+    document["title"] = "Hello";
+    document["points"] = 100;
+
+    for(auto format: {document_format_t::JSON, document_format_t::BINARY}) {
+        std::string serialized;
+        DocumentCodec::encode(document, format, serialized);
+        ASSERT_EQ(format == document_format_t::BINARY, DocumentCodec::is_binary(serialized));
+
+        nlohmann::json value;
+        auto field_op = DocumentCodec::decode_field(serialized, "points", value);
+        ASSERT_TRUE(field_op.ok());
+        ASSERT_TRUE(field_op.get());
+        ASSERT_EQ(100, value.get<int>());
+
+        field_op = DocumentCodec::decode_field(serialized, "missing", value);
+        ASSERT_TRUE(field_op.ok());
+        ASSERT_FALSE(field_op.get());
+
+        nlohmann::json partial;
+        ASSERT_TRUE(DocumentCodec::decode_fields(serialized, {"id", "title", "missing"}, partial).ok());
+        ASSERT_EQ(2, partial.size());
+        ASSERT_EQ("0", partial["id"]);
+        ASSERT_EQ("Hello", partial["title"]);
+    }
+}
+
+TEST(DocumentCodecTest, RejectsCorruptBinaryDocuments) {
+    nlohmann::json document;
+    document["id"] = "0";
+    document["title"] = "Hello";
+
+    std::string serialized;
+    DocumentCodec::encode(document, document_format_t::BINARY, serialized);
+
+    nlohmann::json decoded;
+    ASSERT_FALSE(DocumentCodec::decode(serialized.substr(0, serialized.size() - 3), decoded).ok());
+    ASSERT_FALSE(DocumentCodec::decode(serialized.substr(0, 4), decoded).ok());
+    ASSERT_FALSE(DocumentCodec::decode("{bad json", decoded).ok());
+
+    ASSERT_TRUE(DocumentCodec::parse_format("binary").ok());
+    ASSERT_TRUE(DocumentCodec::parse_format("json").ok());
+    ASSERT_FALSE(DocumentCodec::parse_format("xml").ok());
+}
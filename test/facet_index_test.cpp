@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "facet_index.h"
+
+namespace {
+    std::vector<uint64_t> get_hashes(const facet_index_t& facet_index, uint32_t seq_id) {
+        std::vector<uint64_t> hashes;
+        const uint32_t* ordinals;
+        const uint32_t num_ordinals = facet_index.get_ordinals(seq_id, ordinals);
+
+        for(uint32_t i = 0; i < num_ordinals; i++) {
+            hashes.push_back(facet_index.get_hash(ordinals[i]));
+        }
+
+        return hashes;
+    }
+}
+
+TEST(FacetIndexTest, SingleValuedUpsertAndErase) {
+    facet_index_t facet_index(false);
+
+    const uint64_t hash_a = 1000, hash_b = 2000;
+    facet_index.upsert(0, &hash_a, 1);
+    facet_index.upsert(5, &hash_b, 1);
+    facet_index.upsert(7, &hash_a, 1);
+
+    ASSERT_EQ(3, facet_index.size());
+    ASSERT_EQ(2, facet_index.num_distinct_values());
+    ASSERT_EQ(std::vector<uint64_t>({hash_a}), get_hashes(facet_index, 0));
+    ASSERT_EQ(std::vector<uint64_t>({hash_b}), get_hashes(facet_index, 5));
+    ASSERT_TRUE(get_hashes(facet_index, 3).empty());
+    ASSERT_TRUE(get_hashes(facet_index, 100).empty());
+
+    // the ordinal of a value is released only when its last document goes away
+    facet_index.upsert(0, &hash_b, 1);
+    ASSERT_EQ(2, facet_index.num_distinct_values());
+
+    facet_index.erase(7);
+    ASSERT_EQ(1, facet_index.num_distinct_values());
+    ASSERT_EQ(2, facet_index.size());
+
+    // released ordinals are recycled
+    const uint64_t hash_c = 3000;
+    facet_index.upsert(9, &hash_c, 1);
+    ASSERT_EQ(2, facet_index.num_ordinals());
+    ASSERT_EQ(std::vector<uint64_t>({hash_c}), get_hashes(facet_index, 9));
+
+    facet_index.erase(100);
+    ASSERT_EQ(3, facet_index.size());
+}
+
+TEST(FacetIndexTest, MultiValuedValuesAreCompacted) {
+    facet_index_t facet_index(true);
+
+    std::vector<uint64_t> hashes = {10, 20, 30};
+
+    for(uint32_t seq_id = 0; seq_id < 100; seq_id++) {
+        facet_index.upsert(seq_id, hashes.data(), hashes.size());
+    }
+
+    ASSERT_EQ(100, facet_index.size());
+    ASSERT_EQ(3, facet_index.num_distinct_values());
+
+    // updates leave garbage behind that is eventually compacted away, while preserving the order of values
+    std::vector<uint64_t> updated_hashes = {30, 40};
+
+    for(uint32_t seq_id = 0; seq_id < 100; seq_id += 2) {
+        facet_index.upsert(seq_id, updated_hashes.data(), updated_hashes.size());
+    }
+
+    for(uint32_t seq_id = 0; seq_id < 100; seq_id++) {
+        ASSERT_EQ(seq_id % 2 == 0 ? updated_hashes : hashes, get_hashes(facet_index, seq_id));
+    }
+
+    ASSERT_EQ(4, facet_index.num_distinct_values());
+
+    // empty values are not stored
+    facet_index.upsert(1, nullptr, 0);
+    ASSERT_TRUE(get_hashes(facet_index, 1).empty());
+    ASSERT_EQ(99, facet_index.size());
+}
+
+TEST(FacetIndexTest, SaveAndLoad) {
+    const std::string file_path = "/tmp/typesense_test/facet_index_test.idx";
+    system("mkdir -p /tmp/typesense_test");
+
+    facet_index_t single_index(false);
+    facet_index_t multi_index(true);
+
+    for(uint32_t seq_id = 0; seq_id < 50; seq_id++) {
+        std::vector<uint64_t> hashes = {seq_id % 5, 100 + seq_id % 3};
+        single_index.upsert(seq_id, hashes.data(), 1);
+        multi_index.upsert(seq_id, hashes.data(), hashes.size());
+    }
+
+    single_index.erase(10);
+    multi_index.erase(10);
+
+    index_image_writer_t writer(file_path);
+    single_index.save(writer);
+    multi_index.save(writer);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(file_path);
+    ASSERT_TRUE(reader.ok());
+
+    facet_index_t loaded_single_index(false);
+    facet_index_t loaded_multi_index(true);
+    ASSERT_TRUE(loaded_single_index.load(reader));
+    ASSERT_TRUE(loaded_multi_index.load(reader));
+    ASSERT_TRUE(reader.at_end());
+
+    ASSERT_EQ(single_index.size(), loaded_single_index.size());
+    ASSERT_EQ(multi_index.size(), loaded_multi_index.size());
+    ASSERT_EQ(single_index.num_distinct_values(), loaded_single_index.num_distinct_values());
+    ASSERT_EQ(multi_index.num_distinct_values(), loaded_multi_index.num_distinct_values());
+
+    for(uint32_t seq_id = 0; seq_id < 50; seq_id++) {
+        ASSERT_EQ(get_hashes(single_index, seq_id), get_hashes(loaded_single_index, seq_id));
+        ASSERT_EQ(get_hashes(multi_index, seq_id), get_hashes(loaded_multi_index, seq_id));
+    }
+
+    // a loaded index keeps on sharing ordinals with new documents
+    const uint64_t hash = 2;
+    loaded_single_index.upsert(60, &hash, 1);
+    ASSERT_EQ(single_index.num_distinct_values(), loaded_single_index.num_distinct_values());
+
+    // multi-valued layout can't be loaded as a single-valued one
+    index_image_writer_t mismatched_writer(file_path);
+    multi_index.save(mismatched_writer);
+    ASSERT_TRUE(mismatched_writer.close());
+
+    index_image_reader_t mismatched_reader(file_path);
+    facet_index_t mismatched_index(false);
+    ASSERT_FALSE(mismatched_index.load(mismatched_reader));
+
+    std::remove(file_path.c_str());
+}
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <filter_iterator.h>
+#include <or_iterator.h>
+#include <posting.h>
+#include "ids_t.h"
+
+static std::vector<uint32_t> collect(filter_iterator_t* it) {
+    std::vector<uint32_t> ids;
+    while(it->valid()) {
+        ids.push_back(it->id());
+        it->next();
+    }
+
+    return ids;
+}
+
+static uint32_t* to_array(const std::vector<uint32_t>& ids) {
+    uint32_t* arr = new uint32_t[ids.size()];
+    std::copy(ids.begin(), ids.end(), arr);
+    return arr;
+}
+
+TEST(FilterIteratorTest, LeavesWalkIdLists) {
+    void* compact_ids = SET_COMPACT_IDS(compact_id_list_t::create(1, std::vector<uint32_t>{3}));
+    void* full_ids = SET_COMPACT_IDS(compact_id_list_t::create(1, std::vector<uint32_t>{0}));
+
+    std::vector<uint32_t> compact_expected = {3, 5, 9};
+    for(auto id: compact_expected) {
+        ids_t::upsert(compact_ids, id);
+    }
+
+    std::vector<uint32_t> full_expected = {0};
+    for(uint32_t id = 3; id < 1000; id += 3) {
+        ids_t::upsert(full_ids, id);
+        full_expected.push_back(id);
+    }
+
+    ASSERT_TRUE(IS_COMPACT_IDS(compact_ids));
+    ASSERT_FALSE(IS_COMPACT_IDS(full_ids));
+
+    ids_filter_iterator_t compact_it(compact_ids);
+    ids_filter_iterator_t full_it(full_ids);
+    array_filter_iterator_t array_it(to_array(full_expected), full_expected.size());
+
+    ASSERT_EQ(3, compact_it.estimated_size());
+    ASSERT_EQ(full_expected.size(), full_it.estimated_size());
+
+    ASSERT_EQ(compact_expected, collect(&compact_it));
+    ASSERT_EQ(full_expected, collect(&full_it));
+    ASSERT_EQ(full_expected, collect(&array_it));
+
+    std::vector<filter_iterator_t*> its = {&compact_it, &full_it, &array_it};
+
+    for(auto it: its) {
+        it->reset();
+        it->skip_to(4);
+        ASSERT_TRUE(it->valid());
+        ASSERT_GE(it->id(), 4);
+
+        // skipping backwards must not move the iterator
+        uint32_t curr_id = it->id();
+        it->skip_to(0);
+        ASSERT_EQ(curr_id, it->id());
+
+        it->skip_to(1000);
+        ASSERT_FALSE(it->valid());
+    }
+
+    full_it.reset();
+    full_it.skip_to(500);
+    ASSERT_EQ(501, full_it.id());
+
+    ids_t::destroy_list(compact_ids);
+    ids_t::destroy_list(full_ids);
+}
+
+TEST(FilterIteratorTest, BooleanNodes) {
+    std::vector<uint32_t> a = {1, 2, 4, 6, 8, 10, 12};
+    std::vector<uint32_t> b = {2, 3, 6, 9, 12, 15};
+    std::vector<uint32_t> universe = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+
+    and_filter_iterator_t and_it({new array_filter_iterator_t(to_array(a), a.size()),
+                                  new array_filter_iterator_t(to_array(b), b.size())});
+    ASSERT_EQ(std::vector<uint32_t>({2, 6, 12}), collect(&and_it));
+
+    or_filter_iterator_t or_it({new array_filter_iterator_t(to_array(a), a.size()),
+                                new array_filter_iterator_t(to_array(b), b.size())});
+    ASSERT_EQ(std::vector<uint32_t>({1, 2, 3, 4, 6, 8, 9, 10, 12, 15}), collect(&or_it));
+
+    not_filter_iterator_t not_it(new array_filter_iterator_t(to_array(universe), universe.size()),
+                                 new array_filter_iterator_t(to_array(a), a.size()));
+    ASSERT_EQ(std::vector<uint32_t>({0, 3, 5, 7, 9, 11, 13}), collect(&not_it));
+
+    // empty nodes
+    and_filter_iterator_t empty_and_it({});
+    ASSERT_FALSE(empty_and_it.valid());
+
+    or_filter_iterator_t empty_or_it({});
+    ASSERT_FALSE(empty_or_it.valid());
+
+    // nested: (a AND b) OR NOT a
+    or_filter_iterator_t nested_it({
+        new and_filter_iterator_t({new array_filter_iterator_t(to_array(a), a.size()),
+                                   new array_filter_iterator_t(to_array(b), b.size())}),
+        new not_filter_iterator_t(new array_filter_iterator_t(to_array(universe), universe.size()),
+                                  new array_filter_iterator_t(to_array(a), a.size()))
+    });
+
+    ASSERT_EQ(std::vector<uint32_t>({0, 2, 3, 5, 6, 7, 9, 11, 12, 13}), collect(&nested_it));
+
+    nested_it.reset();
+    nested_it.skip_to(8);
+    ASSERT_EQ(9, nested_it.id());
+
+    uint32_t* ids = nullptr;
+    size_t ids_len = nested_it.uncompress(&ids);
+    ASSERT_EQ(std::vector<uint32_t>({9, 11, 12, 13}), std::vector<uint32_t>(ids, ids + ids_len));
+    delete [] ids;
+}
+
+TEST(FilterIteratorTest, PostingListsAreIntersected) {
+    std::vector<uint32_t> offsets = {0, 1, 3};
+    uint32_t first_ids[] = {0};
+    uint32_t offset_index[] = {0};
+
+    std::vector<void*> raw_posting_lists = {
+        SET_COMPACT_POSTING(compact_posting_list_t::create(1, first_ids, offset_index, 3, &offsets[0])),
+        SET_COMPACT_POSTING(compact_posting_list_t::create(1, first_ids, offset_index, 3, &offsets[0]))
+    };
+
+    // one compact and one full posting list
+    for(uint32_t id: {1, 5, 7, 10}) {
+        posting_t::upsert(raw_posting_lists[0], id, offsets);
+    }
+
+    for(uint32_t id = 1; id < 500; id++) {
+        posting_t::upsert(raw_posting_lists[1], id * 5, offsets);
+    }
+
+    posting_filter_iterator_t it(raw_posting_lists);
+    ASSERT_FALSE(IS_COMPACT_POSTING(raw_posting_lists[1]));
+    ASSERT_EQ(std::vector<uint32_t>({0, 5, 10}), collect(&it));
+
+    it.reset();
+    it.skip_to(6);
+    ASSERT_EQ(10, it.id());
+
+    ASSERT_TRUE(posting_t::contains_atleast_one(raw_posting_lists[0], &it));
+
+    std::vector<uint32_t> others = {2, 3, 4};
+    array_filter_iterator_t others_it(to_array(others), others.size());
+    ASSERT_FALSE(posting_t::contains_atleast_one(raw_posting_lists[0], &others_it));
+    ASSERT_FALSE(posting_t::contains_atleast_one(raw_posting_lists[1], &others_it));
+
+    for(auto& raw_posting_list: raw_posting_lists) {
+        posting_t::destroy_list(raw_posting_list);
+    }
+}
+
+TEST(FilterIteratorTest, IntersectionMatchesFilterIds) {
+    std::mt19937 gen(137723);
+    std::uniform_int_distribution<uint32_t> dist(0, 2000);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+
+    for(size_t run = 0; run < 20; run++) {
+        std::vector<posting_list_t*> plists;
+        std::vector<std::set<uint32_t>> plist_ids(3);
+
+        for(auto& ids: plist_ids) {
+            for(size_t i = 0; i < 600; i++) {
+                ids.insert(dist(gen));
+            }
+
+            plists.push_back(new posting_list_t(16));
+            for(auto id: ids) {
+                plists.back()->upsert(id, offsets);
+            }
+        }
+
+        std::set<uint32_t> filter_set;
+        for(size_t i = 0; i < 1000; i++) {
+            filter_set.insert(dist(gen));
+        }
+
+        std::vector<uint32_t> filter_vec(filter_set.begin(), filter_set.end());
+
+        auto intersect = [&](result_iter_state_t& istate) {
+            // {0, 1} OR-ed as first token, {2} as second token
+            std::vector<posting_list_t::iterator_t> its1, its2;
+            its1.push_back(plists[0]->new_iterator());
+            its1.push_back(plists[1]->new_iterator());
+            its2.push_back(plists[2]->new_iterator());
+
+            std::vector<or_iterator_t> or_its;
+            or_its.emplace_back(its1);
+            or_its.emplace_back(its2);
+
+            std::vector<uint32_t> results;
+            or_iterator_t::intersect(or_its, istate, [&results](uint32_t id, std::vector<or_iterator_t>& its) {
+                results.push_back(id);
+            });
+
+            return results;
+        };
+
+        result_iter_state_t array_istate(nullptr, 0, &filter_vec[0], filter_vec.size());
+        auto expected = intersect(array_istate);
+
+        void* filter_list = SET_COMPACT_IDS(compact_id_list_t::create(1, {filter_vec[0]}));
+        for(auto id: filter_vec) {
+            ids_t::upsert(filter_list, id);
+        }
+
+        auto lazy_filter = new ids_filter_iterator_t(filter_list);
+
+        // consumes the iterator fully before the state rewinds it
+        collect(lazy_filter);
+
+        result_iter_state_t lazy_istate(nullptr, 0, nullptr, 0, lazy_filter);
+        auto actual = intersect(lazy_istate);
+
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(expected, actual);
+
+        delete lazy_filter;
+        ids_t::destroy_list(filter_list);
+
+        for(auto plist: plists) {
+            delete plist;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include "id_bitmap.h"
+
+static std::vector<uint32_t> bitmap_ids(const id_bitmap_t& bitmap) {
+    uint32_t* ids = nullptr;
+    size_t ids_len = bitmap.uncompress(&ids);
+    std::vector<uint32_t> ids_vec(ids, ids + ids_len);
+    delete [] ids;
+    return ids_vec;
+}
+
+TEST(IdBitmapTest, AddAndContains) {
+    id_bitmap_t bitmap;
+    ASSERT_TRUE(bitmap.empty());
+
+    bitmap.add(10);
+    bitmap.add(5);
+    bitmap.add(70000);
+    bitmap.add(10);
+
+    ASSERT_EQ(3, bitmap.cardinality());
+    ASSERT_TRUE(bitmap.contains(5));
+    ASSERT_TRUE(bitmap.contains(10));
+    ASSERT_TRUE(bitmap.contains(70000));
+    ASSERT_FALSE(bitmap.contains(6));
+    ASSERT_FALSE(bitmap.contains(65536 + 10));
+
+    std::vector<uint32_t> expected = {5, 10, 70000};
+    ASSERT_EQ(expected, bitmap_ids(bitmap));
+
+    bitmap.clear();
+    ASSERT_TRUE(bitmap.empty());
+
+    uint32_t* ids = nullptr;
+    ASSERT_EQ(0, bitmap.uncompress(&ids));
+    ASSERT_EQ(nullptr, ids);
+}
+
+TEST(IdBitmapTest, DenseContainers) {
+    // crosses the array -> bitset threshold within a single container
+    std::vector<uint32_t> ids;
+    for(uint32_t i = 0; i < 10000; i++) {
+        ids.push_back(i * 2);
+    }
+
+    id_bitmap_t bitmap;
+    bitmap.add_many(&ids[0], ids.size());
+    ASSERT_EQ(10000, bitmap.cardinality());
+    ASSERT_TRUE(bitmap.contains(19998));
+    ASSERT_FALSE(bitmap.contains(19997));
+    ASSERT_EQ(ids, bitmap_ids(bitmap));
+
+    // removing most values turns the container back into an array
+    id_bitmap_t to_remove;
+    for(uint32_t i = 0; i < 9990; i++) {
+        to_remove.add(i * 2);
+    }
+
+    bitmap.andnot_with(to_remove);
+    ASSERT_EQ(10, bitmap.cardinality());
+    ASSERT_EQ(std::vector<uint32_t>(ids.end() - 10, ids.end()), bitmap_ids(bitmap));
+}
+
+TEST(IdBitmapTest, SetOperationsMatchSortedSets) {
+    std::mt19937 gen(42);
+
+    for(uint32_t max_id: {uint32_t(1000), uint32_t(200000), uint32_t(3000000)}) {
+        for(size_t num_ids: {size_t(0), size_t(10), size_t(5000), size_t(100000)}) {
+            std::uniform_int_distribution<uint32_t> dist(0, max_id);
+            std::set<uint32_t> set_a, set_b;
+
+            for(size_t i = 0; i < num_ids; i++) {
+                set_a.insert(dist(gen));
+                set_b.insert(dist(gen) / 2);
+            }
+
+            std::vector<uint32_t> a(set_a.begin(), set_a.end());
+            std::vector<uint32_t> b(set_b.begin(), set_b.end());
+
+            id_bitmap_t bitmap_a, bitmap_b;
+            bitmap_a.add_many(a.data(), a.size());
+            bitmap_b.add_many(b.data(), b.size());
+
+            ASSERT_EQ(a, bitmap_ids(bitmap_a));
+
+            std::vector<uint32_t> expected;
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            id_bitmap_t and_bitmap = bitmap_a;
+            and_bitmap.and_with(bitmap_b);
+            ASSERT_EQ(expected, bitmap_ids(and_bitmap));
+            ASSERT_EQ(expected.size(), and_bitmap.cardinality());
+
+            expected.clear();
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            id_bitmap_t or_bitmap = bitmap_a;
+            or_bitmap.or_with(bitmap_b);
+            ASSERT_EQ(expected, bitmap_ids(or_bitmap));
+            ASSERT_EQ(expected.size(), or_bitmap.cardinality());
+
+            expected.clear();
+            std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            id_bitmap_t andnot_bitmap = bitmap_a;
+            andnot_bitmap.andnot_with(bitmap_b);
+            ASSERT_EQ(expected, bitmap_ids(andnot_bitmap));
+            ASSERT_EQ(expected.size(), andnot_bitmap.cardinality());
+        }
+    }
+}
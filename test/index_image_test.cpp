@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "index_image.h"
+
+TEST(IndexImageTest, LoaderReadsAlignedIdViews) {
+    const std::string image_path = "/tmp/typesense_test_index_image.idx";
+    std::vector<uint32_t> ids = {1, 5, 9, 1000000};
+
+    index_image_writer_t writer(image_path);
+    for(size_t i = 0; i < 3; i++) {
+        // strings of odd lengths leave the following ID arrays unaligned, unless padded
+        writer.write_string(std::string(i * 2 + 1, 'a'));
+        writer.write_ids(ids.data(), ids.size() - i);
+    }
+
+    writer.write_ids(nullptr, 0);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(image_path);
+    ASSERT_TRUE(reader.ok());
+
+    for(size_t i = 0; i < 3; i++) {
+        std::string str;
+        ASSERT_TRUE(reader.read_string(str));
+        ASSERT_EQ(std::string(i * 2 + 1, 'a'), str);
+
+        const uint32_t* read_ids;
+        uint32_t num_read_ids;
+        ASSERT_TRUE(reader.read_ids(read_ids, num_read_ids));
+        ASSERT_EQ(0, uintptr_t(read_ids) % sizeof(uint32_t));
+        ASSERT_EQ(std::vector<uint32_t>(ids.begin(), ids.end() - i),
+                  std::vector<uint32_t>(read_ids, read_ids + num_read_ids));
+    }
+
+    std::vector<uint32_t> empty_ids;
+    ASSERT_TRUE(reader.read_ids(empty_ids));
+    ASSERT_TRUE(empty_ids.empty());
+    ASSERT_TRUE(reader.at_end());
+
+    // reading past the end fails and invalidates the reader
+    uint32_t value;
+    ASSERT_FALSE(reader.read_value(value));
+    ASSERT_FALSE(reader.ok());
+}
+
+TEST(IndexImageTest, RejectsTruncatedImages) {
+    const std::string image_path = "/tmp/typesense_test_index_image.idx";
+    std::vector<uint32_t> ids(100000, 7);
+
+    index_image_writer_t writer(image_path);
+    writer.write_ids(ids.data(), ids.size());
+    ASSERT_TRUE(writer.close());
+
+    ASSERT_TRUE(index_image_reader_t(image_path).ok());
+
+    std::ifstream in(image_path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    std::ofstream out(image_path, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() / 2);
+    out.close();
+
+    ASSERT_FALSE(index_image_reader_t(image_path).ok());
+    ASSERT_FALSE(index_image_reader_t("/tmp/typesense_test_missing_image.idx").ok());
+}
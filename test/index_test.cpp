@@ -128,3 +128,79 @@ TEST(IndexTest, GeoPointPackUnpack) {
         ASSERT_FLOAT_EQ(latlng.second, s2LatLng.lng().degrees());
     }
 }
+
+TEST(IndexTest, PreprocessingDoesNotModifyTheIndex) {
+    std::unordered_map<std::string, field> search_schema;
+    search_schema.emplace("title", field("title", field_types::STRING, false));
+    search_schema.emplace("points", field("points", field_types::INT32, false));
+
+    ThreadPool pool(4);
+    Index index("index", 1, nullptr, nullptr, &pool, search_schema, {}, {});
+
+    std::vector<index_record> records;
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "The quick brown fox " + std::to_string(i);
+        doc["points"] = i;
+        records.emplace_back(i, i, doc, CREATE, DIRTY_VALUES::REJECT);
+    }
+
+    Index::batch_preprocess(&index, records, "points", search_schema, "", {}, {}, true);
+
+    ASSERT_EQ(0, index.num_seq_ids());
+    ASSERT_EQ(0, art_size(index._get_search_index().at("title")));
+    ASSERT_EQ(0, index._get_numerical_index().at("points")->size());
+
+    for(const auto& record: records) {
+        ASSERT_TRUE(record.indexed.ok());
+        ASSERT_EQ(5, record.field_index.at("title").offsets.size());
+    }
+
+    ASSERT_EQ(10, Index::batch_apply_preprocessed(&index, records, search_schema));
+
+    ASSERT_EQ(10, index.num_seq_ids());
+    ASSERT_EQ(14, art_size(index._get_search_index().at("title")));
+    ASSERT_EQ(10, index._get_numerical_index().at("points")->size());
+}
+
+TEST(IndexTest, FacetCacheKeys) {
+    facet brand_facet("brand");
+
+    auto cache_key = [&](const std::vector<filter>& filters) {
+        return Index::get_facet_cache_key(filters, brand_facet);
+    };
+
+    // ranges are keyed as (lower, upper) pairs
+    ASSERT_NE(cache_key({{"price", {"10", "40", "20", "30"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE,
+                                                              RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}),
+              cache_key({{"price", {"10", "20", "30", "40"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE,
+                                                              RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}));
+
+    ASSERT_NE(cache_key({{"price", {"10", "20"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}),
+              cache_key({{"price", {"20", "10"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}));
+
+    ASSERT_EQ(cache_key({{"price", {"10", "20", "30", "40"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE,
+                                                              RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}),
+              cache_key({{"price", {"30", "40", "10", "20"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE,
+                                                              RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}));
+
+    ASSERT_NE(cache_key({{"price", {"10", "20"}, {RANGE_INCLUSIVE, RANGE_INCLUSIVE}}}),
+              cache_key({{"price", {"10", "20"}, {GREATER_THAN_EQUALS, LESS_THAN_EQUALS}}}));
+
+    // the single comparator of a string filter applies to all of its values
+    ASSERT_EQ(cache_key({{"brand", {"nike", "adidas"}, {EQUALS}}}),
+              cache_key({{"brand", {"adidas", "nike"}, {EQUALS}}}));
+
+    ASSERT_NE(cache_key({{"brand", {"nike", "adidas"}, {EQUALS}}}),
+              cache_key({{"brand", {"nike", "adidas"}, {CONTAINS}}}));
+
+    // values that would run together without the length prefixes stay apart
+    ASSERT_NE(cache_key({{"brand", {"a:1", "b"}, {EQUALS}}}), cache_key({{"brand", {"a", "1:b"}, {EQUALS}}}));
+    ASSERT_NE(cache_key({{"brand", {"nike"}, {EQUALS}}, {"price", {"10"}, {GREATER_THAN}}}),
+              cache_key({{"brand", {"nike", "price"}, {EQUALS}}, {"10", {"10"}, {GREATER_THAN}}}));
+
+    // neither is the order of the filters
+    ASSERT_EQ(cache_key({{"brand", {"nike"}, {EQUALS}}, {"price", {"10"}, {GREATER_THAN}}}),
+              cache_key({{"price", {"10"}, {GREATER_THAN}}, {"brand", {"nike"}, {EQUALS}}}));
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include "infix_index.h"
+
+namespace {
+    std::vector<std::string> search(const infix_index_t& infix_index, const std::string& query,
+                                    size_t max_extra_prefix = INT16_MAX, size_t max_extra_suffix = INT16_MAX) {
+        std::vector<std::string> tokens;
+        infix_index.search(query, max_extra_prefix, max_extra_suffix, tokens);
+        std::sort(tokens.begin(), tokens.end());
+        return tokens;
+    }
+}
+
+TEST(InfixIndexTest, SearchByTrigrams) {
+    infix_index_t infix_index;
+
+    for(const std::string& token: {"gh100037in8900x", "ghx100037in", "yhd3342d78912", "100037", "ab", "x"}) {
+        infix_index.insert(token);
+    }
+
+    infix_index.insert("ab");
+    ASSERT_EQ(6, infix_index.size());
+
+    ASSERT_EQ(std::vector<std::string>({"100037", "gh100037in8900x", "ghx100037in"}), search(infix_index, "100037"));
+    ASSERT_EQ(std::vector<std::string>({"gh100037in8900x", "ghx100037in"}), search(infix_index, "037in"));
+    ASSERT_EQ(std::vector<std::string>({"yhd3342d78912"}), search(infix_index, "3342d"));
+
+    // all the trigrams of the query must be present in the same token
+    ASSERT_TRUE(search(infix_index, "037d78").empty());
+    ASSERT_TRUE(search(infix_index, "zzz").empty());
+    ASSERT_TRUE(search(infix_index, "").empty());
+
+    // queries shorter than a trigram also match tokens shorter than a trigram
+    ASSERT_EQ(std::vector<std::string>({"gh100037in8900x", "ghx100037in", "x"}), search(infix_index, "x"));
+    ASSERT_EQ(std::vector<std::string>({"ab"}), search(infix_index, "ab"));
+    ASSERT_EQ(std::vector<std::string>({"gh100037in8900x", "ghx100037in"}), search(infix_index, "gh"));
+
+    // the position of the match within the token is bounded
+    ASSERT_EQ(std::vector<std::string>({"100037", "gh100037in8900x"}), search(infix_index, "100037", 2, INT16_MAX));
+    ASSERT_EQ(std::vector<std::string>({"100037", "ghx100037in"}), search(infix_index, "100037", INT16_MAX, 2));
+}
+
+TEST(InfixIndexTest, EraseAndRecycle) {
+    infix_index_t infix_index;
+
+    infix_index.insert("alpha");
+    infix_index.insert("alphabet");
+    infix_index.insert("al");
+
+    infix_index.erase("alpha");
+    infix_index.erase("al");
+    infix_index.erase("missing");
+
+    ASSERT_EQ(1, infix_index.size());
+    ASSERT_EQ(std::vector<std::string>({"alphabet"}), search(infix_index, "lph"));
+    ASSERT_EQ(std::vector<std::string>({"alphabet"}), search(infix_index, "al"));
+
+    // ids of erased tokens are recycled
+    infix_index.insert("zulu");
+    infix_index.insert("alpine");
+    ASSERT_EQ(std::vector<std::string>({"alphabet", "alpine"}), search(infix_index, "alp"));
+    ASSERT_EQ(std::vector<std::string>({"zulu"}), search(infix_index, "ul"));
+
+    infix_index.erase("alphabet");
+    infix_index.erase("alpine");
+    infix_index.erase("zulu");
+    ASSERT_EQ(0, infix_index.size());
+    ASSERT_TRUE(search(infix_index, "alp").empty());
+    ASSERT_TRUE(search(infix_index, "l").empty());
+}
+
+TEST(InfixIndexTest, SaveAndLoad) {
+    const std::string file_path = "/tmp/typesense_test/infix_index_test.idx";
+    system("mkdir -p /tmp/typesense_test");
+
+    infix_index_t infix_index;
+
+    for(size_t i = 0; i < 1000; i++) {
+        infix_index.insert("sku" + std::to_string(i * 7919));
+    }
+
+    infix_index.erase("sku0");
+
+    index_image_writer_t writer(file_path);
+    infix_index.save(writer);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(file_path);
+    ASSERT_TRUE(reader.ok());
+
+    infix_index_t loaded_infix_index;
+    ASSERT_TRUE(loaded_infix_index.load(reader));
+    ASSERT_TRUE(reader.at_end());
+
+    ASSERT_EQ(infix_index.size(), loaded_infix_index.size());
+
+    for(const std::string& query: {"791", "sku", "0", "583"}) {
+        ASSERT_EQ(search(infix_index, query), search(loaded_infix_index, query));
+    }
+
+    std::remove(file_path.c_str());
+}
+
+TEST(InfixIndexTest, SuffixArraySearch) {
+    std::vector<std::string> tokens = {"ab", "abcab", "bca", "gh100037in", "x"};
+    infix_suffix_array_t suffix_array(tokens);
+
+    ASSERT_EQ(5, suffix_array.num_tokens());
+    ASSERT_EQ("abcab", suffix_array.get_token(1));
+    ASSERT_EQ(3, suffix_array.find("gh100037in"));
+    ASSERT_EQ(-1, suffix_array.find("gh"));
+    ASSERT_EQ(-1, suffix_array.find("zzz"));
+
+    std::vector<uint32_t> token_ids;
+    suffix_array.search("ab", token_ids);
+    ASSERT_EQ(std::vector<uint32_t>({0, 1}), token_ids);
+
+    // patterns never match across tokens
+    token_ids.clear();
+    suffix_array.search("abbc", token_ids);
+    ASSERT_TRUE(token_ids.empty());
+
+    token_ids.clear();
+    suffix_array.search("bca", token_ids);
+    ASSERT_EQ(std::vector<uint32_t>({1, 2}), token_ids);
+
+    token_ids.clear();
+    suffix_array.search("0037i", token_ids);
+    ASSERT_EQ(std::vector<uint32_t>({3}), token_ids);
+}
+
+TEST(InfixIndexTest, SealedTokensAndDelta) {
+    infix_index_t infix_index(true);
+
+    for(const std::string& token: {"gh100037in8900x", "ghx100037in", "yhd3342d78912", "ab"}) {
+        infix_index.insert(token);
+    }
+
+    infix_index.seal();
+    ASSERT_EQ(4, infix_index.size());
+    ASSERT_EQ(0, infix_index.delta_size());
+
+    // new tokens are held in the delta, and erased sealed tokens are masked out
+    infix_index.insert("zz100037");
+    infix_index.insert("ab");
+    infix_index.erase("ghx100037in");
+    ASSERT_EQ(1, infix_index.delta_size());
+    ASSERT_EQ(4, infix_index.size());
+
+    ASSERT_EQ(std::vector<std::string>({"gh100037in8900x", "zz100037"}), search(infix_index, "100037"));
+    ASSERT_EQ(std::vector<std::string>({"ab"}), search(infix_index, "ab"));
+    ASSERT_EQ(std::vector<std::string>({"zz100037"}), search(infix_index, "100037", INT16_MAX, 2));
+
+    // an erased sealed token can come back
+    infix_index.insert("ghx100037in");
+    ASSERT_EQ(std::vector<std::string>({"gh100037in8900x", "ghx100037in", "zz100037"}), search(infix_index, "100037"));
+    ASSERT_EQ(1, infix_index.delta_size());
+
+    // a small delta is not worth a rebuild, unless forced
+    ASSERT_EQ(nullptr, infix_index.begin_rebuild());
+    ASSERT_EQ(nullptr, infix_index_t().begin_rebuild(true));
+}
+
+TEST(InfixIndexTest, ChangesDuringRebuildAreReplayed) {
+    infix_index_t infix_index(true);
+
+    for(size_t i = 0; i < infix_index_t::MIN_DELTA_TOKENS_TO_SEAL; i++) {
+        infix_index.insert("sku" + std::to_string(i));
+    }
+
+    auto rebuild = infix_index.begin_rebuild();
+    ASSERT_NE(nullptr, rebuild);
+
+    // only one rebuild runs at a time
+    ASSERT_EQ(nullptr, infix_index.begin_rebuild(true));
+
+    infix_index.erase("sku7");
+    infix_index.insert("new100");
+    infix_index.insert("sku7");
+    infix_index.erase("sku8");
+
+    infix_index_t::run_rebuild(*rebuild);
+
+    // the rebuild is applied by the next write
+    infix_index.insert("sku9");
+    ASSERT_EQ(1, infix_index.delta_size());
+    ASSERT_EQ(infix_index_t::MIN_DELTA_TOKENS_TO_SEAL, infix_index.size());
+
+    ASSERT_EQ(std::vector<std::string>({"sku7"}), search(infix_index, "sku7", 0, 0));
+    ASSERT_EQ(std::vector<std::string>({"sku9"}), search(infix_index, "sku9", 0, 0));
+    ASSERT_TRUE(search(infix_index, "sku8", 0, 0).empty());
+    ASSERT_EQ(std::vector<std::string>({"new100"}), search(infix_index, "w10"));
+}
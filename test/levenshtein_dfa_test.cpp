@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "levenshtein_dfa.h"
+
+namespace {
+    // optimal string alignment distances of `term`'s prefixes against `key`, computed directly: like the fuzzy search
+    // of the tree, transpositions are only considered from the third character of the key on
+    std::vector<int> osa_cost_row(const std::string& term, const std::string& key) {
+        const size_t columns = term.size() + 1;
+        std::vector<std::vector<int>> d(key.size() + 1, std::vector<int>(columns));
+
+        for(size_t j = 0; j < columns; j++) {
+            d[0][j] = j;
+        }
+
+        for(size_t i = 1; i <= key.size(); i++) {
+            d[i][0] = i;
+
+            for(size_t j = 1; j < columns; j++) {
+                const int cost = (key[i-1] == term[j-1]) ? 0 : 1;
+                d[i][j] = std::min(std::min(d[i-1][j] + 1, d[i][j-1] + 1), d[i-1][j-1] + cost);
+
+                if(i > 2 && j > 1 && key[i-1] == term[j-2] && key[i-2] == term[j-1]) {
+                    d[i][j] = std::min(d[i][j], d[i-2][j-2] + 1);
+                }
+            }
+        }
+
+        return d[key.size()];
+    }
+
+    uint32_t walk(levenshtein_dfa_t& dfa, const std::string& key) {
+        uint32_t state = levenshtein_dfa_t::INITIAL_STATE;
+        for(char c: key) {
+            state = dfa.next(state, c);
+        }
+
+        return state;
+    }
+}
+
+TEST(LevenshteinDFATest, CostsMatchDirectComputation) {
+    std::mt19937 rng(7);
+    const std::string alphabet = "abcst";
+
+    auto random_word = [&](size_t max_len) {
+        std::string word(rng() % (max_len + 1), 'a');
+        for(char& c: word) {
+            c = alphabet[rng() % alphabet.size()];
+        }
+        return word;
+    };
+
+    for(int max_cost = 0; max_cost <= 2; max_cost++) {
+        for(size_t t = 0; t < 50; t++) {
+            const std::string term = random_word(8);
+            levenshtein_dfa_t dfa((const unsigned char*) term.c_str(), term.size(), max_cost);
+
+            for(size_t k = 0; k < 200; k++) {
+                const std::string key = random_word(10);
+                const std::vector<int> expected = osa_cost_row(term, key);
+                const uint8_t* cost_row = dfa.cost_row(walk(dfa, key));
+
+                // costs are exact up to `max_cost + 1`, and stay beyond it otherwise
+                for(size_t column = 0; column <= term.size(); column++) {
+                    if(expected[column] <= max_cost + 1) {
+                        ASSERT_EQ(expected[column], cost_row[column]) << term << " " << key << " " << max_cost;
+                    } else {
+                        ASSERT_GT(cost_row[column], max_cost + 1) << term << " " << key << " " << max_cost;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(LevenshteinDFATest, TranspositionsAndDeadStates) {
+    const std::string term = "strawberry";
+    levenshtein_dfa_t dfa((const unsigned char*) term.c_str(), term.size(), 1);
+
+    ASSERT_EQ(0, dfa.cost_row(walk(dfa, "strawberry"))[term.size()]);
+    ASSERT_EQ(1, dfa.cost_row(walk(dfa, "strwaberry"))[term.size()]);
+    ASSERT_EQ(1, dfa.cost_row(walk(dfa, "strawbery"))[term.size()]);
+    ASSERT_FALSE(dfa.is_dead(walk(dfa, "strx")));
+
+    // no suffix can bring the cost back within 1
+    ASSERT_TRUE(dfa.is_dead(walk(dfa, "sxxa")));
+
+    // characters that don't occur in the term share their transitions
+    const size_t num_states = dfa.num_states();
+    walk(dfa, "strx");
+    walk(dfa, "strq");
+    ASSERT_EQ(num_states, dfa.num_states());
+}
@@ -72,3 +72,157 @@ TEST(NumTreeTest, EraseFullList) {
     tree.search(NUM_COMPARATOR::EQUALS, 0, &ids, ids_len);
     ASSERT_EQ(nullptr, ids);
 }
+
+TEST(NumTreeTest, SearchesIntoBitmap) {
+    num_tree_t tree;
+    tree.insert(-1200, 0);
+    tree.insert(-1750, 1);
+    tree.insert(0, 2);
+    tree.insert(100, 3);
+    tree.insert(2000, 4);
+
+    tree.insert(-1200, 5);
+    tree.insert(100, 6);
+
+    // stored as a full list
+    for(size_t i = 10; i < 210; i++) {
+        tree.insert(500, i);
+    }
+
+    id_bitmap_t ids;
+    tree.search(NUM_COMPARATOR::EQUALS, -1750, ids);
+    ASSERT_EQ(1, ids.cardinality());
+    ASSERT_TRUE(ids.contains(1));
+
+    ids.clear();
+    tree.search(NUM_COMPARATOR::GREATER_THAN_EQUALS, -1200, ids);
+    ASSERT_EQ(206, ids.cardinality());
+
+    ids.clear();
+    tree.search(NUM_COMPARATOR::GREATER_THAN, -1200, ids);
+    ASSERT_EQ(204, ids.cardinality());
+    ASSERT_FALSE(ids.contains(0));
+
+    ids.clear();
+    tree.search(NUM_COMPARATOR::LESS_THAN_EQUALS, 100, ids);
+    ASSERT_EQ(6, ids.cardinality());
+
+    ids.clear();
+    tree.search(NUM_COMPARATOR::LESS_THAN, 100, ids);
+    ASSERT_EQ(4, ids.cardinality());
+
+    ids.clear();
+    tree.range_inclusive_search(100, 500, ids);
+    ASSERT_EQ(202, ids.cardinality());
+    ASSERT_TRUE(ids.contains(3));
+    ASSERT_TRUE(ids.contains(209));
+    ASSERT_FALSE(ids.contains(4));
+}
+
+TEST(NumTreeTest, RangeSearchOverManySingleIdValues) {
+    num_tree_t tree;
+
+    // one value per document, with IDs that are not in the order of the values and span several containers
+    const uint32_t num_docs = 150000;
+    for(uint32_t i = 0; i < num_docs; i++) {
+        const uint32_t id = uint32_t((uint64_t(i) * 7919) % num_docs);
+        tree.insert(i, id);
+    }
+
+    id_bitmap_t ids;
+    tree.range_inclusive_search(1000, 120999, ids);
+    ASSERT_EQ(120000, ids.cardinality());
+
+    uint32_t* expected_ids = nullptr;
+    size_t expected_ids_len = 0;
+    tree.range_inclusive_search(1000, 120999, &expected_ids, expected_ids_len);
+
+    uint32_t* bitmap_ids = nullptr;
+    const size_t bitmap_ids_len = ids.uncompress(&bitmap_ids);
+
+    ASSERT_EQ(expected_ids_len, bitmap_ids_len);
+    ASSERT_TRUE(std::equal(expected_ids, expected_ids + expected_ids_len, bitmap_ids));
+
+    delete [] expected_ids;
+    delete [] bitmap_ids;
+
+    // IDs are added on top of the existing ones
+    tree.search(NUM_COMPARATOR::LESS_THAN, 1000, ids);
+    ASSERT_EQ(121000, ids.cardinality());
+    ASSERT_TRUE(ids.contains(0));
+}
+
+TEST(NumTreeTest, OrderedSearch) {
+    num_tree_t tree;
+    tree.insert(-1200, 0);
+    tree.insert(-1750, 1);
+    tree.insert(0, 2);
+    tree.insert(100, 3);
+    tree.insert(2000, 4);
+    tree.insert(INT64_MIN, 7);
+
+    tree.insert(-1200, 5);
+    tree.insert(100, 6);
+
+    std::vector<uint32_t> filter_ids = {0, 1, 2, 3, 5, 6, 7};
+    std::vector<uint32_t> ids;
+
+    ASSERT_TRUE(tree.ordered_search(true, &filter_ids[0], filter_ids.size(), 2, 100, ids));
+    ASSERT_EQ(std::vector<uint32_t>({1, 0, 5}), ids);  // ties on -1200 are not split
+
+    ids.clear();
+    ASSERT_TRUE(tree.ordered_search(false, &filter_ids[0], filter_ids.size(), 2, 100, ids));
+    ASSERT_EQ(std::vector<uint32_t>({3, 6}), ids);  // 4 is filtered out
+
+    // INT64_MIN is never collected
+    ids.clear();
+    ASSERT_TRUE(tree.ordered_search(true, &filter_ids[0], filter_ids.size(), 100, 100, ids));
+    ASSERT_EQ(6, ids.size());
+    ASSERT_EQ(ids.end(), std::find(ids.begin(), ids.end(), 7));
+
+    // visiting more than 3 IDs is not allowed
+    ids.clear();
+    ASSERT_FALSE(tree.ordered_search(false, &filter_ids[0], filter_ids.size(), 4, 3, ids));
+}
+
+TEST(NumTreeTest, SaveAndLoad) {
+    num_tree_t tree;
+
+    // large enough for some of the values to need a full ID list
+    for(uint32_t id = 0; id < 1000; id++) {
+        tree.insert(int64_t(id % 13) - 6, id);
+    }
+
+    tree.insert(INT64_MAX, 2000);
+    tree.insert(INT64_MIN, 2001);
+
+    const std::string image_path = "/tmp/typesense_test_num_tree.idx";
+
+    index_image_writer_t writer(image_path);
+    tree.save(writer);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(image_path);
+    ASSERT_TRUE(reader.ok());
+
+    num_tree_t loaded_tree;
+    ASSERT_TRUE(loaded_tree.load(reader));
+    ASSERT_TRUE(reader.at_end());
+    ASSERT_EQ(tree.size(), loaded_tree.size());
+
+    for(int64_t value: {int64_t(-6), int64_t(0), int64_t(6), INT64_MAX, INT64_MIN}) {
+        uint32_t* ids = nullptr;
+        size_t ids_len = 0;
+        tree.search(NUM_COMPARATOR::EQUALS, value, &ids, ids_len);
+
+        uint32_t* loaded_ids = nullptr;
+        size_t loaded_ids_len = 0;
+        loaded_tree.search(NUM_COMPARATOR::EQUALS, value, &loaded_ids, loaded_ids_len);
+
+        ASSERT_EQ(ids_len, loaded_ids_len);
+        ASSERT_TRUE(std::equal(ids, ids + ids_len, loaded_ids));
+
+        delete [] ids;
+        delete [] loaded_ids;
+    }
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <random>
+#include <set>
 #include <or_iterator.h>
 #include <posting_list.h>
 #include "logger.h"
@@ -256,3 +258,174 @@ TEST(OrIteratorTest, IntersectAndFilterTwoIts) {
     delete p1;
     delete p2;
 }
+
+TEST(OrIteratorTest, ParallelIntersectMatchesSequential) {
+    std::mt19937 gen(137723);
+    std::uniform_int_distribution<uint32_t> dist(0, 5000);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+    ThreadPool pool(4);
+
+    // two tokens, each present in two fields
+    std::vector<posting_list_t*> plists;
+    for(size_t i = 0; i < 4; i++) {
+        plists.push_back(new posting_list_t(4));
+        for(size_t j = 0; j < 2000; j++) {
+            plists.back()->upsert(dist(gen), offsets);
+        }
+    }
+
+    std::set<uint32_t> filter_set;
+    for(size_t i = 0; i < 2000; i++) {
+        filter_set.insert(dist(gen));
+    }
+
+    std::vector<uint32_t> filter_ids(filter_set.begin(), filter_set.end());
+    std::vector<uint32_t> excluded_ids = {filter_ids[10], filter_ids[500], filter_ids[1000]};
+
+    auto new_its = [&]() {
+        std::vector<or_iterator_t> or_its;
+        for(size_t i = 0; i < plists.size(); i += 2) {
+            std::vector<posting_list_t::iterator_t> its;
+            its.push_back(plists[i]->new_iterator(nullptr, nullptr, 0));
+            its.push_back(plists[i+1]->new_iterator(nullptr, nullptr, 1));
+            or_its.emplace_back(its);
+        }
+
+        return or_its;
+    };
+
+    for(bool filter: {false, true}) {
+        const uint32_t* filter_ids_ptr = filter ? &filter_ids[0] : nullptr;
+        const size_t filter_ids_length = filter ? filter_ids.size() : 0;
+
+        std::vector<uint32_t> expected;
+        auto or_its = new_its();
+        result_iter_state_t istate(&excluded_ids[0], excluded_ids.size(), filter_ids_ptr, filter_ids_length);
+        or_iterator_t::intersect(or_its, istate, [&expected](uint32_t id, std::vector<or_iterator_t>& its) {
+            expected.push_back(id);
+        });
+
+        std::vector<uint32_t> range_max_ids;
+        or_its = new_its();
+        or_iterator_t::get_range_max_ids(or_its, 4, 1, range_max_ids);
+        ASSERT_EQ(4, range_max_ids.size());
+        ASSERT_EQ(UINT32_MAX, range_max_ids.back());
+
+        std::vector<std::vector<uint32_t>> range_results(4);
+        result_iter_state_t parallel_istate(&excluded_ids[0], excluded_ids.size(), filter_ids_ptr, filter_ids_length);
+        or_iterator_t::intersect(or_its, parallel_istate, &pool, 4, 1,
+                                 [&](uint32_t id, std::vector<or_iterator_t>& its, size_t range_index) {
+            // every field iterator must point to the matched document or beyond it
+            for(const auto& it: its) {
+                ASSERT_GE(it.id(), id);
+            }
+
+            range_results[range_index].push_back(id);
+        });
+
+        std::vector<uint32_t> actual;
+        for(size_t i = 0; i < range_results.size(); i++) {
+            ASSERT_FALSE(range_results[i].empty());
+
+            // ranges are disjoint and ordered
+            if(i != 0) {
+                ASSERT_LT(range_results[i-1].back(), range_results[i].front());
+            }
+
+            actual.insert(actual.end(), range_results[i].begin(), range_results[i].end());
+        }
+
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(expected, actual);
+
+        // too few blocks to split
+        range_max_ids.clear();
+        or_iterator_t::get_range_max_ids(or_its, 4, 100000, range_max_ids);
+        ASSERT_EQ(std::vector<uint32_t>({UINT32_MAX}), range_max_ids);
+    }
+
+    pool.shutdown();
+
+    for(auto plist: plists) {
+        delete plist;
+    }
+}
+
+TEST(OrIteratorTest, IntersectResumesAfterSkips) {
+    std::mt19937 gen(4231);
+    std::uniform_int_distribution<uint32_t> dist(0, 3000);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+
+    // three tokens, each present in two fields
+    std::vector<posting_list_t*> plists;
+    for(size_t i = 0; i < 6; i++) {
+        plists.push_back(new posting_list_t(4));
+        for(size_t j = 0; j < 2000; j++) {
+            plists.back()->upsert(dist(gen), offsets);
+        }
+    }
+
+    std::vector<uint32_t> filter_ids;
+    for(uint32_t id = 0; id <= 3000; id += 2) {
+        filter_ids.push_back(id);
+    }
+
+    auto new_its = [&](size_t num_tokens) {
+        std::vector<or_iterator_t> or_its;
+        for(size_t i = 0; i < num_tokens * 2; i += 2) {
+            std::vector<posting_list_t::iterator_t> its;
+            its.push_back(plists[i]->new_iterator(nullptr, nullptr, 0));
+            its.push_back(plists[i+1]->new_iterator(nullptr, nullptr, 1));
+            or_its.emplace_back(its);
+        }
+
+        return or_its;
+    };
+
+    for(size_t num_tokens = 1; num_tokens <= 3; num_tokens++) {
+        for(bool filter: {false, true}) {
+            const uint32_t* filter_ids_ptr = filter ? &filter_ids[0] : nullptr;
+            const size_t filter_ids_length = filter ? filter_ids.size() : 0;
+
+            std::vector<uint32_t> all_ids;
+            auto or_its = new_its(num_tokens);
+            result_iter_state_t istate(nullptr, 0, filter_ids_ptr, filter_ids_length);
+            or_iterator_t::intersect(or_its, istate, [&all_ids](uint32_t id, std::vector<or_iterator_t>& its) {
+                all_ids.push_back(id);
+            });
+
+            // every 5th match skips the IDs that are less than 40 past it
+            std::vector<uint32_t> expected;
+            uint32_t skip_until = 0;
+            for(uint32_t id: all_ids) {
+                if(id < skip_until) {
+                    continue;
+                }
+
+                expected.push_back(id);
+                if(expected.size() % 5 == 0) {
+                    skip_until = id + 40;
+                }
+            }
+
+            std::vector<uint32_t> actual;
+            or_its = new_its(num_tokens);
+            result_iter_state_t skip_istate(nullptr, 0, filter_ids_ptr, filter_ids_length);
+            or_iterator_t::intersect(or_its, skip_istate, [&actual](uint32_t id, std::vector<or_iterator_t>& its) {
+                actual.push_back(id);
+                if(actual.size() % 5 == 0) {
+                    for(auto& it: its) {
+                        it.skip_to(id + 40);
+                    }
+                }
+            });
+
+            ASSERT_LT(expected.size(), all_ids.size());
+            ASSERT_EQ(expected, actual);
+        }
+    }
+
+    for(auto plist: plists) {
+        delete plist;
+    }
+}
@@ -2,6 +2,7 @@
 #include "posting.h"
 #include "array_utils.h"
 #include <chrono>
+#include <random>
 #include <vector>
 
 class PostingListTest : public ::testing::Test {
@@ -699,6 +700,77 @@ TEST_F(PostingListTest, IntersectionBasics) {
     ASSERT_EQ(0, result_ids.size());
 }
 
+TEST_F(PostingListTest, BlockIntersectionAcrossThreads) {
+    std::mt19937 gen(137723);
+    std::uniform_int_distribution<uint32_t> dist(0, 10000);
+    std::vector<uint32_t> offsets = {0, 1, 3};
+
+    std::vector<posting_list_t*> plists;
+    std::vector<void*> raw_lists;
+
+    for(size_t i = 0; i < 3; i++) {
+        plists.push_back(new posting_list_t(4));
+        raw_lists.push_back(plists.back());
+
+        for(size_t j = 0; j < 4000; j++) {
+            plists.back()->upsert(dist(gen), offsets);
+        }
+    }
+
+    std::vector<uint32_t> expected;
+    posting_list_t::intersect(plists, expected);
+    ASSERT_FALSE(expected.empty());
+
+    for(size_t concurrency: {1, 3, 4, 16}) {
+        std::vector<std::vector<uint32_t>> window_ids(concurrency);
+        result_iter_state_t iter_state;
+
+        posting_t::block_intersector_t(raw_lists, iter_state, pool).intersect([&](auto id, auto& its, size_t index) {
+            window_ids[index].push_back(id);
+        }, concurrency);
+
+        std::vector<uint32_t> result_ids;
+        for(const auto& ids: window_ids) {
+            result_ids.insert(result_ids.end(), ids.begin(), ids.end());
+        }
+
+        ASSERT_EQ(expected, result_ids);
+    }
+
+    for(auto plist: plists) {
+        delete plist;
+    }
+}
+
+TEST_F(PostingListTest, RangeIteratorStopsAtRangeEnd) {
+    std::vector<uint32_t> offsets = {0, 1, 3};
+    posting_list_t pl(2);
+
+    for(uint32_t id = 0; id < 20; id += 2) {
+        pl.upsert(id, offsets);
+    }
+
+    auto it = pl.new_iterator();
+    auto range_it = it.range_iterator(5, 9);
+
+    std::vector<uint32_t> ids;
+    while(range_it.valid()) {
+        ids.push_back(range_it.id());
+        range_it.next();
+    }
+
+    // blocks are [0, 2] [4, 6] [8, 10] ..., so the last block of the range contains 10
+    ASSERT_EQ(std::vector<uint32_t>({6, 8, 10}), ids);
+
+    // skipping past the range must not enter the blocks beyond it
+    auto skipped_range_it = it.range_iterator(5, 9);
+    skipped_range_it.skip_to(14);
+    ASSERT_FALSE(skipped_range_it.valid());
+
+    auto empty_range_it = it.range_iterator(21, 30);
+    ASSERT_FALSE(empty_range_it.valid());
+}
+
 TEST_F(PostingListTest, ResultsAndOffsetsBasics) {
     // NOTE: due to the way offsets1 are parsed, the actual positions are 1 less than the offset values stored
     // (to account for the special offset `0` which indicates last offset
@@ -1388,6 +1460,39 @@ TEST_F(PostingListTest, PostingListMustHaveAtleast1Element) {
     }
 }
 
+TEST_F(PostingListTest, BlockTracksPossibleVerbatimMatch) {
+    posting_list_t pl(2);
+
+    pl.upsert(0, {2, 3});
+    pl.upsert(1, {4});
+
+    {
+        auto it = pl.new_iterator();
+        ASSERT_FALSE(posting_list_t::maybe_single_token_verbatim_match(it));
+    }
+
+    // second block holds a document whose only token is the query token
+    pl.upsert(2, {1, 0});
+    pl.upsert(3, {5, 6});
+
+    ASSERT_EQ(2, pl.num_blocks());
+
+    {
+        auto it = pl.new_iterator();
+        it.skip_to(3);
+        ASSERT_TRUE(it.valid());
+        ASSERT_TRUE(posting_list_t::maybe_single_token_verbatim_match(it));
+    }
+
+    // flag survives block merges after erasure
+    pl.erase(1);
+    pl.erase(0);
+
+    auto it = pl.new_iterator();
+    ASSERT_EQ(2, it.id());
+    ASSERT_TRUE(posting_list_t::maybe_single_token_verbatim_match(it));
+}
+
 TEST_F(PostingListTest, DISABLED_RandInsertAndErase) {
     std::vector<uint32_t> offsets = {0, 1, 3};
     posting_list_t pl(5);
@@ -1540,3 +1645,36 @@ TEST_F(PostingListTest, DISABLED_BenchmarkIntersection) {
     LOG(INFO) << "Sorted array result len: " << abc_len;
     LOG(INFO) << "Time taken for sorted array intersection: " << timeMicros;
 }
+
+TEST_F(PostingListTest, GetIdOffsets) {
+    for(size_t num_ids: {3, 200}) {
+        void* obj = SET_COMPACT_POSTING(compact_posting_list_t::create(0, nullptr, nullptr, 0, nullptr));
+
+        for(uint32_t id = 0; id < num_ids; id++) {
+            std::vector<uint32_t> id_offsets;
+            for(uint32_t j = 0; j <= id % 3; j++) {
+                id_offsets.push_back(id + j);
+            }
+
+            posting_t::upsert(obj, id * 2, id_offsets);
+        }
+
+        ASSERT_EQ(num_ids > 3, !IS_COMPACT_POSTING(obj));
+
+        std::vector<uint32_t> ids, offset_index, offsets;
+        posting_t::get_id_offsets(obj, ids, offset_index, offsets);
+
+        ASSERT_EQ(num_ids, ids.size());
+        ASSERT_EQ(num_ids, offset_index.size());
+
+        for(uint32_t i = 0; i < num_ids; i++) {
+            ASSERT_EQ(i * 2, ids[i]);
+
+            const uint32_t end = (i + 1 < num_ids) ? offset_index[i + 1] : offsets.size();
+            ASSERT_EQ(i % 3 + 1, end - offset_index[i]);
+            ASSERT_EQ(i, offsets[offset_index[i]]);
+        }
+
+        posting_t::destroy_list(obj);
+    }
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <fstream>
+#include <random>
+#include "sort_column.h"
+
+TEST(SortColumnTest, UpsertFindAndErase) {
+    sort_column_t column;
+    ASSERT_TRUE(column.empty());
+
+    column.upsert(0, 100);
+    column.upsert(5, -200);
+    column.upsert(sort_column_t::CHUNK_SIZE * 3 + 7, INT64_MAX);
+
+    ASSERT_EQ(3, column.size());
+    ASSERT_TRUE(column.contains(0));
+    ASSERT_TRUE(column.contains(5));
+    ASSERT_FALSE(column.contains(1));
+    ASSERT_FALSE(column.contains(sort_column_t::CHUNK_SIZE));
+    ASSERT_FALSE(column.contains(UINT32_MAX));
+
+    int64_t value;
+    ASSERT_TRUE(column.find(5, value));
+    ASSERT_EQ(-200, value);
+    ASSERT_TRUE(column.find(sort_column_t::CHUNK_SIZE * 3 + 7, value));
+    ASSERT_EQ(INT64_MAX, value);
+    ASSERT_FALSE(column.find(6, value));
+
+    ASSERT_EQ(INT64_MIN, column.get_or_default(6, INT64_MIN));
+    ASSERT_EQ(100, column.get_or_default(0, INT64_MIN));
+
+    // overwrite does not change size
+    column.upsert(5, 300);
+    ASSERT_EQ(3, column.size());
+    ASSERT_EQ(300, column.get_or_default(5, 0));
+
+    column.erase(5);
+    column.erase(5);
+    column.erase(1000000);
+    ASSERT_EQ(2, column.size());
+    ASSERT_FALSE(column.contains(5));
+
+    column.erase(sort_column_t::CHUNK_SIZE * 3 + 7);
+    ASSERT_FALSE(column.contains(sort_column_t::CHUNK_SIZE * 3 + 7));
+
+    // re-populating an emptied chunk
+    column.upsert(sort_column_t::CHUNK_SIZE * 3 + 8, 42);
+    ASSERT_EQ(42, column.get_or_default(sort_column_t::CHUNK_SIZE * 3 + 8, 0));
+    ASSERT_FALSE(column.contains(sort_column_t::CHUNK_SIZE * 3 + 7));
+
+    column.clear();
+    ASSERT_TRUE(column.empty());
+    ASSERT_FALSE(column.contains(0));
+}
+
+TEST(SortColumnTest, MatchesHashMap) {
+    std::mt19937 gen(137723);
+    std::uniform_int_distribution<uint32_t> id_dist(0, 50000);
+    std::uniform_int_distribution<int64_t> value_dist(INT64_MIN, INT64_MAX);
+
+    sort_column_t column;
+    std::map<uint32_t, int64_t> expected;
+
+    for(size_t i = 0; i < 20000; i++) {
+        uint32_t seq_id = id_dist(gen);
+
+        if(i % 3 == 0) {
+            column.erase(seq_id);
+            expected.erase(seq_id);
+        } else {
+            int64_t value = value_dist(gen);
+            column.upsert(seq_id, value);
+            expected[seq_id] = value;
+        }
+    }
+
+    ASSERT_EQ(expected.size(), column.size());
+
+    for(uint32_t seq_id = 0; seq_id <= 50000; seq_id++) {
+        auto it = expected.find(seq_id);
+        int64_t value;
+
+        if(it == expected.end()) {
+            ASSERT_FALSE(column.find(seq_id, value));
+        } else {
+            ASSERT_TRUE(column.find(seq_id, value));
+            ASSERT_EQ(it->second, value);
+        }
+    }
+}
+
+TEST(SortColumnTest, SaveAndLoad) {
+    sort_column_t column;
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE * 3; seq_id += 3) {
+        column.upsert(seq_id, int64_t(seq_id) * -7);
+    }
+
+    // leaves an empty chunk in between
+    for(uint32_t seq_id = sort_column_t::CHUNK_SIZE; seq_id < sort_column_t::CHUNK_SIZE * 2; seq_id++) {
+        column.erase(seq_id);
+    }
+
+    const std::string image_path = "/tmp/typesense_test_sort_column.idx";
+
+    index_image_writer_t writer(image_path);
+    column.save(writer);
+    writer.write_value<uint32_t>(42);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(image_path);
+    ASSERT_TRUE(reader.ok());
+
+    sort_column_t loaded_column;
+    ASSERT_TRUE(loaded_column.load(reader));
+
+    uint32_t trailer;
+    ASSERT_TRUE(reader.read_value(trailer));
+    ASSERT_EQ(42, trailer);
+    ASSERT_TRUE(reader.at_end());
+
+    ASSERT_EQ(column.size(), loaded_column.size());
+
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE * 3 + 10; seq_id++) {
+        ASSERT_EQ(column.contains(seq_id), loaded_column.contains(seq_id));
+        ASSERT_EQ(column.get_or_default(seq_id, 1), loaded_column.get_or_default(seq_id, 1));
+    }
+
+    // a corrupted image is rejected up front
+    std::fstream image_file(image_path, std::ios::in | std::ios::out | std::ios::binary);
+    image_file.seekp(100);
+    image_file.put(char(0x7F));
+    image_file.close();
+
+    index_image_reader_t corrupt_reader(image_path);
+    ASSERT_FALSE(corrupt_reader.ok());
+    ASSERT_FALSE(corrupt_reader.read_value(trailer));
+}
+
+TEST(SortColumnTest, SparseChunks) {
+    sort_column_t column;
+
+    // a value every 64 documents leaves every chunk sparse
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE * 16; seq_id += 64) {
+        column.upsert(seq_id, int64_t(seq_id) * 3);
+    }
+
+    ASSERT_EQ(sort_column_t::CHUNK_SIZE / 4, column.size());
+    ASSERT_GT(column.size() * 32, column.chunk_bytes());
+
+    int64_t value;
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE * 16; seq_id++) {
+        ASSERT_EQ(seq_id % 64 == 0, column.find(seq_id, value));
+    }
+
+    // filling up a chunk makes it dense, and emptying it makes it sparse again
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE; seq_id++) {
+        column.upsert(seq_id, -int64_t(seq_id));
+    }
+
+    ASSERT_LT(sort_column_t::CHUNK_SIZE * sizeof(int64_t), column.chunk_bytes());
+
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE; seq_id++) {
+        ASSERT_TRUE(column.find(seq_id, value));
+        ASSERT_EQ(-int64_t(seq_id), value);
+    }
+
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE; seq_id++) {
+        if(seq_id % 128 != 0) {
+            column.erase(seq_id);
+        }
+    }
+
+    ASSERT_GT(column.size() * 32, column.chunk_bytes());
+
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE; seq_id++) {
+        ASSERT_EQ(seq_id % 128 == 0, column.find(seq_id, value));
+    }
+
+    ASSERT_EQ(-128, column.get_or_default(128, 0));
+    ASSERT_EQ(sort_column_t::CHUNK_SIZE / 4 - 32, column.size());
+
+    const std::string image_path = "/tmp/typesense_test_sort_column_sparse.idx";
+
+    index_image_writer_t writer(image_path);
+    column.save(writer);
+    ASSERT_TRUE(writer.close());
+
+    index_image_reader_t reader(image_path);
+    ASSERT_TRUE(reader.ok());
+
+    sort_column_t loaded_column;
+    ASSERT_TRUE(loaded_column.load(reader));
+    ASSERT_TRUE(reader.at_end());
+
+    ASSERT_EQ(column.size(), loaded_column.size());
+    ASSERT_GE(column.chunk_bytes(), loaded_column.chunk_bytes());
+
+    for(uint32_t seq_id = 0; seq_id < sort_column_t::CHUNK_SIZE * 16; seq_id++) {
+        ASSERT_EQ(column.get_or_default(seq_id, 1), loaded_column.get_or_default(seq_id, 1));
+    }
+}
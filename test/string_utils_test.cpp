@@ -296,3 +296,17 @@ TEST(StringUtilsTest, ContainsWord) {
     ASSERT_FALSE(StringUtils::contains_word("foobar baz", "bar baz"));
     ASSERT_FALSE(StringUtils::contains_word("baz foobar", "foo"));
 }
+
+TEST(StringUtilsTest, SplitFacetFields) {
+    std::vector<std::string> facet_fields;
+    StringUtils::split_facet_fields("brand, price(0-10,10-50, 50-),rating", facet_fields);
+    ASSERT_EQ(std::vector<std::string>({"brand", "price(0-10,10-50, 50-)", "rating"}), facet_fields);
+
+    facet_fields.clear();
+    StringUtils::split_facet_fields("brand,,", facet_fields);
+    ASSERT_EQ(std::vector<std::string>({"brand"}), facet_fields);
+
+    facet_fields.clear();
+    StringUtils::split_facet_fields("", facet_fields);
+    ASSERT_TRUE(facet_fields.empty());
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "threadpool.h"
+
+TEST(ThreadPoolTest, EnqueueReturnsResults) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> results;
+
+    for(int i = 0; i < 100; i++) {
+        results.push_back(pool.enqueue([i]() { return i * i; }));
+    }
+
+    for(int i = 0; i < 100; i++) {
+        ASSERT_EQ(i * i, results[i].get());
+    }
+
+    pool.shutdown();
+
+    auto stats = pool.get_stats();
+    ASSERT_EQ(4, stats.num_threads);
+    ASSERT_EQ(0, stats.num_queued);
+    ASSERT_EQ(100, stats.num_executed);
+}
+
+TEST(ThreadPoolTest, NestedForksDoNotExhaustWorkers) {
+    // every worker blocks on a fan-out of its own, which can only complete by running the subtasks inline
+    ThreadPool pool(2);
+    std::atomic<size_t> num_leaves{0};
+
+    std::vector<std::future<void>> results;
+
+    for(size_t i = 0; i < 8; i++) {
+        results.push_back(pool.enqueue([&pool, &num_leaves]() {
+            std::mutex m_process;
+            size_t num_processed = 0;
+
+            for(size_t j = 0; j < 16; j++) {
+                pool.fork([&num_leaves, &m_process, &num_processed]() {
+                    num_leaves++;
+                    std::unique_lock<std::mutex> lock(m_process);
+                    num_processed++;
+                });
+            }
+
+            pool.wait_until([&]() {
+                std::unique_lock<std::mutex> lock(m_process);
+                return num_processed == 16;
+            });
+        }));
+    }
+
+    for(auto& result: results) {
+        result.get();
+    }
+
+    pool.shutdown();
+    ASSERT_EQ(8 * 16, num_leaves);
+
+    auto stats = pool.get_stats();
+    ASSERT_EQ(8 + 8 * 16, stats.num_executed);
+}
+
+TEST(ThreadPoolTest, WaitFromOutsideThePool) {
+    ThreadPool pool(3);
+    std::mutex m_process;
+    size_t num_processed = 0;
+    std::vector<size_t> values(1000, 0);
+
+    for(size_t i = 0; i < values.size(); i++) {
+        pool.fork([i, &values, &m_process, &num_processed]() {
+            values[i] = i + 1;
+            std::unique_lock<std::mutex> lock(m_process);
+            num_processed++;
+        });
+    }
+
+    pool.wait_until([&]() {
+        std::unique_lock<std::mutex> lock(m_process);
+        return num_processed == values.size();
+    });
+
+    for(size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(i + 1, values[i]);
+    }
+
+    pool.shutdown();
+}
+
+TEST(ThreadPoolTest, LaneConcurrencyIsCapped) {
+    ThreadPool pool(4);
+    pool.set_lane(ThreadPool::lane_t::WRITE, 1, 0);
+
+    std::atomic<size_t> num_running{0};
+    std::atomic<size_t> max_running{0};
+    std::vector<std::future<void>> results;
+
+    for(size_t i = 0; i < 32; i++) {
+        results.push_back(pool.enqueue(ThreadPool::lane_t::WRITE, [&num_running, &max_running]() {
+            size_t running = ++num_running;
+            size_t prev_max = max_running;
+            while(running > prev_max && !max_running.compare_exchange_weak(prev_max, running)) {}
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            num_running--;
+        }));
+    }
+
+    // searches are not held back by the capped lane
+    std::atomic<size_t> num_searches{0};
+    for(size_t i = 0; i < 32; i++) {
+        results.push_back(pool.enqueue(ThreadPool::lane_t::SEARCH, [&num_searches]() { num_searches++; }));
+    }
+
+    for(auto& result: results) {
+        result.get();
+    }
+
+    pool.shutdown();
+
+    ASSERT_EQ(1, max_running);
+    ASSERT_EQ(32, num_searches);
+
+    auto stats = pool.get_stats();
+    ASSERT_EQ(32, stats.lanes[size_t(ThreadPool::lane_t::WRITE)].num_executed);
+    ASSERT_EQ(32, stats.lanes[size_t(ThreadPool::lane_t::SEARCH)].num_executed);
+    ASSERT_EQ(0, stats.lanes[size_t(ThreadPool::lane_t::WRITE)].num_running);
+}
+
+TEST(ThreadPoolTest, HigherPriorityLaneRunsFirst) {
+    ThreadPool pool(1);
+    std::mutex m_order;
+    std::vector<int> order;
+
+    // blocks the only worker while the other tasks are queued
+    std::promise<void> gate;
+    std::shared_future<void> gate_future = gate.get_future().share();
+    auto blocker = pool.enqueue(ThreadPool::lane_t::ADMIN, [gate_future]() { gate_future.wait(); });
+
+    std::vector<std::future<void>> results;
+    for(int i = 0; i < 3; i++) {
+        results.push_back(pool.enqueue(ThreadPool::lane_t::WRITE, [i, &m_order, &order]() {
+            std::unique_lock<std::mutex> lock(m_order);
+            order.push_back(i);
+        }));
+    }
+
+    for(int i = 10; i < 13; i++) {
+        results.push_back(pool.enqueue(ThreadPool::lane_t::SEARCH, [i, &m_order, &order]() {
+            std::unique_lock<std::mutex> lock(m_order);
+            order.push_back(i);
+        }));
+    }
+
+    gate.set_value();
+
+    blocker.get();
+    for(auto& result: results) {
+        result.get();
+    }
+
+    pool.shutdown();
+
+    std::vector<int> expected = {10, 11, 12, 0, 1, 2};
+    ASSERT_EQ(expected, order);
+}
+
+TEST(ThreadPoolTest, TasksInheritTheLaneOfTheirParent) {
+    ThreadPool pool(2);
+    std::mutex m_process;
+    size_t num_processed = 0;
+
+    auto parent = pool.enqueue(ThreadPool::lane_t::WRITE, [&]() {
+        for(size_t i = 0; i < 4; i++) {
+            pool.fork([&]() {
+                std::unique_lock<std::mutex> lock(m_process);
+                num_processed++;
+            });
+        }
+
+        pool.wait_until([&]() {
+            std::unique_lock<std::mutex> lock(m_process);
+            return num_processed == 4;
+        });
+    });
+
+    parent.get();
+    pool.shutdown();
+
+    auto stats = pool.get_stats();
+    ASSERT_EQ(5, stats.lanes[size_t(ThreadPool::lane_t::WRITE)].num_executed);
+    ASSERT_EQ(0, stats.lanes[size_t(ThreadPool::lane_t::SEARCH)].num_executed);
+}